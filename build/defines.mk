@@ -202,12 +202,6 @@ CPATH := $(CPATH):/usr/lib/wx/include/gtk2-unicode-release-2.8:/usr/include/wx-2
 LIBS += -pthread -Wl,-Bsymbolic-functions  -lwx_gtk2u_richtext-2.8 -lwx_gtk2u_aui-2.8 -lwx_gtk2u_xrc-2.8 -lwx_gtk2u_qa-2.8 -lwx_gtk2u_html-2.8 -lwx_gtk2u_adv-2.8 -lwx_gtk2u_core-2.8 -lwx_baseu_xml-2.8 -lwx_baseu_net-2.8 -lwx_baseu-2.8
 endif
 
-ifeq ($(ANN),1)
-DEPEND_UBUNTU += libann-dev
-CXXFLAGS  += -DRAI_ANN
-LIBS += -lann
-endif
-
 ifeq ($(QHULL),1)
 DEPEND_UBUNTU += libqhull-dev
 CXXFLAGS  += -DRAI_QHULL
@@ -12,14 +12,14 @@
 
 //===========================================================================
 //
-// Approximate Nearest Neighbor Search (kd-tree)
+// Approximate Nearest Neighbor Search (on the dynamic rai::KDTree)
 //
 
 struct ANN {
   unique_ptr<struct sANN> self;
 
   arr X;       //the data set for which a ANN tree is build
-  uint bufferSize; //a tree is only rebuild if there are more than 'buffer' new points appended [default: 20]
+  uint bufferSize; //unused: appended points are inserted into the (dynamic) tree at the next query
 
   ANN();
   ANN(const ANN& ann);
@@ -28,7 +28,7 @@ struct ANN {
   void clear();              //clears the tree and X
   void setX(const arr& _X);  //set X
   void append(const arr& x); //append to X
-  void calculate();          //compute a tree for all of X
+  void calculate();          //insert the points appended since the last call into the tree (rebuild after setX)
 
   uint getNN(const arr& x, double eps=.0, bool verbose=false);
   void getkNN(intA& idx, const arr& x, uint k, double eps=.0, bool verbose=false);
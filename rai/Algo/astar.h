@@ -11,6 +11,8 @@
 #include "priorityQueue.h"
 #include "../Core/graph.h"
 
+#include <unordered_map>
+
 //===========================================================================
 
 template<class NodeType>
@@ -18,6 +20,7 @@ struct AStarOnGraph {
   rai::Graph& G;
   NodeType* start, *goal;
   PriorityQueue<NodeType*> queue;
+  std::unordered_map<NodeType*, uint> handles; ///< queue handles of the open nodes, for decrease-key
   rai::Array<NodeType*> solutions;
   uint iters=0;
 
@@ -25,7 +28,7 @@ struct AStarOnGraph {
     :G(_G), start(_start), goal(_goal) {
     start->astar_g = 0;
     double f = start->astar_heuristic(goal);
-    queue.add(f, start);
+    handles[start] = queue.add(f, start);
   }
 
   bool step() {
@@ -35,21 +38,22 @@ struct AStarOnGraph {
     }
     //pop
     NodeType* node =  queue.pop();
-    //loop/graph check
-    if(!node->astar_isClosed) {
-      //goal check
-      if(node==goal) return true;
-      //expand
-      rai::Array<NodeType*> N = getNeighbors(node);
-      for(NodeType* child:N) {
-        double cost = node->astar_g + child->astar_cost(node);
-        if(child->isFeasible || child==goal) {
-          if(cost < child->astar_g) {
-            child->astar_g = cost;
-            child->astar_parent = node;
-            double f = child->astar_g + child->astar_heuristic(goal);
-            queue.add(f, child, true);
-          }
+    handles.erase(node);
+    //goal check
+    if(node==goal) return true;
+    node->astar_isClosed = true;
+    //expand
+    rai::Array<NodeType*> N = getNeighbors(node);
+    for(NodeType* child:N) {
+      double cost = node->astar_g + child->astar_cost(node);
+      if(child->isFeasible || child==goal) {
+        if(cost < child->astar_g) {
+          child->astar_g = cost;
+          child->astar_parent = node;
+          double f = child->astar_g + child->astar_heuristic(goal);
+          auto it = handles.find(child);
+          if(it!=handles.end()) queue.update(it->second, f); //decrease-key instead of a duplicate
+          else { child->astar_isClosed = false;  handles[child] = queue.add(f, child, true); } //(re)open
         }
       }
     }
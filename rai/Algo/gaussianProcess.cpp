@@ -7,6 +7,7 @@
     --------------------------------------------------------------  */
 
 #include "gaussianProcess.h"
+#include "../Core/taskPool.h"
 
 #define RAI_GP_DEBUG 0
 
@@ -56,68 +57,275 @@ void GaussianProcess::setGaussKernelGP(
   covDD_D=GaussKernelDD_D;
 }
 
+//===========================================================================
+//
+// packed lower triangular factors: row i of L holds L(i,0..i) and starts at i(i+1)/2
+//
+
+namespace {
+
+inline double* row(arr& L, uint i) { return L.p+i*(i+1)/2; }
+inline const double* row(const arr& L, uint i) { return L.p+i*(i+1)/2; }
+inline uint rows(const arr& L) { return (uint)(::sqrt(8.*L.N+1.)-1.)/2; }
+
+inline double dot(const double* a, const double* b, uint n) {
+  double s0=0., s1=0., s2=0., s3=0.; //independent accumulators (the sum is latency bound otherwise)
+  uint j=0;
+  for(; j+4<=n; j+=4) { s0+=a[j]*b[j];  s1+=a[j+1]*b[j+1];  s2+=a[j+2]*b[j+2];  s3+=a[j+3]*b[j+3]; }
+  for(; j<n; j++) s0+=a[j]*b[j];
+  return (s0+s1)+(s2+s3);
+}
+
+//b <- L^-1 b
+void forwardSolve(const arr& L, double* b) {
+  uint n=rows(L);
+  for(uint i=0; i<n; i++) {
+    const double* l=row(L, i);
+    b[i] = (b[i]-dot(l, b, i))/l[i];
+  }
+}
+
+//B <- L^-1 B for B with n rows of m columns; tiled, so that a tile of solved rows is reused from cache by a tile of rows
+void forwardSolve(const arr& L, double* B, uint m) {
+  uint n=rows(L);
+  const uint T=32;
+  for(uint i0=0; i0<n; i0+=T) {
+    uint i1=rai::MIN(n, i0+T);
+    for(uint j0=0; j0<i0; j0+=T) {
+      for(uint i=i0; i<i1; i++) {
+        const double* l=row(L, i);
+        double* bi=B+i*m;
+        for(uint j=j0; j<j0+T; j++) { double lij=l[j];  const double* bj=B+j*m;  for(uint k=0; k<m; k++) bi[k] -= lij*bj[k]; }
+      }
+    }
+    for(uint i=i0; i<i1; i++) { //the diagonal tile
+      const double* l=row(L, i);
+      double* bi=B+i*m;
+      for(uint j=i0; j<i; j++) { double lij=l[j];  const double* bj=B+j*m;  for(uint k=0; k<m; k++) bi[k] -= lij*bj[k]; }
+      double d=1./l[i];
+      for(uint k=0; k<m; k++) bi[k] *= d;
+    }
+  }
+}
+
+//b <- L^-T b
+void backSolve(const arr& L, double* b) {
+  for(uint i=rows(L); i--;) {
+    const double* l=row(L, i);
+    b[i] /= l[i];
+    for(uint j=0; j<i; j++) b[j] -= l[j]*b[i];
+  }
+}
+
+//b <- (L L^T)^-1 b
+void cholSolve(const arr& L, arr& b) { forwardSolve(L, b.p);  backSolve(L, b.p); }
+
+//appends the row (l, d) to L such that the new last row/column of L L^T is (k, kdiag); returns d
+double cholAppend(arr& L, arr& l, const arr& k, double kdiag) {
+  CHECK_EQ(k.N, rows(L), "");
+  l=k;
+  forwardSolve(L, l.p);
+  double d = kdiag-sumOfSqr(l);
+  CHECK_GE(d, 1e-14*kdiag, "Gram matrix not positive definite (increase obsVar?)");
+  d = ::sqrt(d);
+  L.append(l);
+  L.append(d);
+  return d;
+}
+
+//L L^T <- L L^T + sign v v^T, only touching rows and columns >=k0 (v is overwritten)
+void cholUpdate(arr& L, double* v, uint k0=0, double sign=1.) {
+  uint n=rows(L);
+  for(uint k=k0; k<n; k++) {
+    double* lk=row(L, k);
+    double r2 = lk[k]*lk[k] + sign*v[k]*v[k];
+    CHECK_GE(r2, 0., "Cholesky downdate lost positive definiteness");
+    double r=::sqrt(r2), c=r/lk[k], s=v[k]/lk[k];
+    lk[k]=r;
+    for(uint i=k+1; i<n; i++) {
+      double& lik=row(L, i)[k];
+      lik = (lik + sign*s*v[i])/c;
+      v[i] = c*v[i] - s*lik;
+    }
+  }
+}
+
+//removes row and column i of L L^T
+void cholDelete(arr& L, uint i) {
+  uint n=rows(L);
+  arr v(n);
+  v.setZero();
+  for(uint j=i+1; j<n; j++) v(j) = row(L, j)[i];
+  //compact: drop row i and the entry i of all later rows
+  arr L2(L.N-n);
+  double* p=L2.p;
+  for(uint j=0; j<n; j++) {
+    if(j==i) continue;
+    const double* l=row(L, j);
+    for(uint k=0; k<=j; k++) if(k!=i) *(p++) = l[k];
+  }
+  L=L2;
+  v.remove(i);
+  cholUpdate(L, v.p, i);
+}
+
+//packed lower factor from a full symmetric positive definite matrix
+void cholFactor(arr& L, const arr& A) {
+  arr U;
+  lapack_cholesky(U, A); //A = U^T U
+  uint n=A.d0;
+  L.resize(n*(n+1)/2);
+  for(uint i=0; i<n; i++) { double* l=row(L, i);  for(uint j=0; j<=i; j++) l[j]=U(j, i); }
+}
+
+} //namespace
+
+//===========================================================================
+
 void GaussianProcess::recompute(const arr& _XX, const arr& _YY) {
   X.referTo(_XX);
   Y.referTo(_YY);
   recompute();
 }
 
-void GaussianProcess::recompute() {
-  uint i, j, N=Y.N, dN=dY.N;
-  arr gram, xi, xj, Mu_func;
-  gram.resize(N+dN, N+dN);
-  if(!gram.N) return;
-  for(i=0; i<N; i++) {
-    xi.referToDim(X, i);
-    gram(i, i) = cov(kernelP, xi, xi);
-    Mu_func.append(mu_func(xi, priorP));
-  }
-  for(i=1; i<N; i++) {
-    xi.referToDim(X, i);
-    for(j=0; j<i; j++) {
-      xj.referToDim(X, j);
-      gram(i, j) = gram(j, i) = cov(kernelP, xi, xj);
-    }
+//prior residual of all observations (value observations, then derivative observations)
+static arr residuals(GaussianProcess& gp) {
+  arr r(gp.Y.N+gp.dY.N), xi;
+  for(uint i=0; i<gp.Y.N; i++) { xi.referToDim(gp.X, i);  r(i) = gp.Y(i) - gp.mu_func(xi, gp.priorP) - gp.mu; }
+  for(uint i=0; i<gp.dY.N; i++) r(gp.Y.N+i) = gp.dY(i);
+  return r;
+}
+
+//covariance between observations i and j (in the order values, derivatives), without obsVar
+static double gramEntry(GaussianProcess& gp, uint i, uint j) {
+  uint N=gp.Y.N;
+  if(i<j) std::swap(i, j);
+  arr xi, xj;
+  if(i<N) {
+    xi.referToDim(gp.X, i);
+    if(i==j) return gp.cov(gp.kernelP, xi, xi);
+    xj.referToDim(gp.X, j);
+    return gp.cov(gp.kernelP, xi, xj);
   }
-  if(dN) { //derivative observations
-    for(i=0; i<dN; i++) { xi.referToDim(dX, i); gram(N+i, N+i) = covD_D(dI(i), dI(i), kernelP, xi, xi); }
-    for(i=0; i<dN; i++) {
-      xi.referToDim(dX, i);
-      for(j=0; j<N; j++) {
-        xj.referToDim(X, j);
-        gram(N+i, j) = gram(j, N+i) = covF_D(dI(i), kernelP, xj, xi);
-      }
-      for(j=0; j<i; j++) {
-        xj.referToDim(dX, j);
-        gram(N+i, N+j) = gram(N+j, N+i) = covD_D(dI(i), dI(j), kernelP, xi, xj);
-      }
+  xi.referToDim(gp.dX, i-N);
+  if(j<N) { xj.referToDim(gp.X, j);  return gp.covF_D(gp.dI(i-N), gp.kernelP, xj, xi); }
+  if(i==j) return gp.covD_D(gp.dI(i-N), gp.dI(i-N), gp.kernelP, xi, xi);
+  xj.referToDim(gp.dX, j-N);
+  return gp.covD_D(gp.dI(i-N), gp.dI(j-N), gp.kernelP, xi, xj);
+}
+
+void GaussianProcess::recompute() {
+  uint n=Y.N+dY.N;
+  if(Z.N) { //sparse mode
+    CHECK(!dY.N, "derivative observations are not supported in sparse mode");
+    uint m=Z.d0;
+    arr Kzz(m, m), zi, zj;
+    for(uint i=0; i<m; i++) {
+      zi.referToDim(Z, i);
+      for(uint j=0; j<i; j++) { zj.referToDim(Z, j);  Kzz(i, j) = Kzz(j, i) = cov(kernelP, zi, zj); }
+      Kzz(i, i) = cov(kernelP, zi, zi);
     }
+    double jitter = 1e-8*trace(Kzz)/m;
+    for(uint i=0; i<m; i++) Kzz(i, i) += jitter;
+    cholFactor(Lzz, Kzz);
+    arr Kxz;
+    kernelMatrix(Kxz, X);
+    arr S = Kzz;
+    if(n) S += (1./obsVar) * (~Kxz * Kxz);
+    cholFactor(Ls, S);
+    bz = zeros(m);
+    if(n) bz = (1./obsVar) * (~Kxz * residuals(*this));
+    GinvY = bz;
+    cholSolve(Ls, GinvY);
+    return;
   }
-  gram = gram + obsVar * eye(gram.d0);
-  inverse_SymPosDef(Ginv, gram);
-  if(!dN) {
-    if(N) GinvY = Ginv * (Y-Mu_func-mu); else GinvY.clear();
-  } else {
-    arr Yfull; Yfull.append(Y-Mu_func-mu); Yfull.append(dY);
-    GinvY = Ginv * Yfull;
-  }
-  //cout <<"gram=" <<gram <<" Ginv=" <<Ginv <<endl;
+  if(!n) { L.clear();  LinvY.clear();  GinvY.clear();  return; }
+  arr gram(n, n);
+  for(uint i=0; i<n; i++) for(uint j=0; j<=i; j++) gram(i, j) = gram(j, i) = gramEntry(*this, i, j);
+  for(uint i=0; i<n; i++) gram(i, i) += obsVar;
+  cholFactor(L, gram);
+  LinvY = residuals(*this);
+  forwardSolve(L, LinvY.p);
+  GinvY = LinvY;
+  backSolve(L, GinvY.p);
 }
 
 void GaussianProcess::appendObservation(const arr& x, double y) {
-  uint N=X.d0;
+  uint N=X.d0, n=N+dY.N;
+  bool factorIsGood = (Z.N ? Ls.N>0 : L.N==n*(n+1)/2);
   X.append(x); //append it to the data
   Y.append(y);
   X.reshape(N+1, x.N);
   Y.reshape(N+1);
+  if(!factorIsGood || (!Z.N && dY.N)) { recompute();  return; } //(value observations precede derivative observations in the Gram matrix)
+
+  double r = y - mu_func(x, priorP) - mu;
+  if(Z.N) { //sparse mode: rank-1 update of K_zz + K_zx K_xz / obsVar
+    arr kz;
+    kernelMatrix(kz, x);
+    bz += (r/obsVar) * kz;
+    kz /= ::sqrt(obsVar);
+    cholUpdate(Ls, kz.p);
+    GinvY = bz;
+    cholSolve(Ls, GinvY);
+  } else {
+    arr k(N), l, xi;
+    for(uint i=0; i<N; i++) { xi.referToDim(X, i);  k(i) = cov(kernelP, x, xi); }
+    xi.referToDim(X, N);
+    double d = cholAppend(L, l, k, cov(kernelP, xi, xi) + obsVar);
+    LinvY.append((r - scalarProduct(l, LinvY))/d); //one forward solve and one backward solve in total
+    GinvY = LinvY;
+    backSolve(L, GinvY.p);
+  }
 #if RAI_GP_DEBUG
-  arr iG=Ginv;
+  arr L2=L, G2=GinvY;
   recompute();
-  double err=maxDiff(iG, Ginv);
-  CHECK(err<1e-6, "mis-updated inverse Gram matrix" <<err <<endl <<iG <<Ginv);
+  double err=maxDiff(G2, GinvY);
+  CHECK(err<1e-6, "mis-updated Cholesky factor" <<err);
 #endif
 }
 
+void GaussianProcess::removeObservation(uint i) {
+  uint N=X.d0, n=N+dY.N;
+  CHECK_LE(i+1, N, "");
+  bool factorIsGood = (Z.N ? Ls.N>0 : L.N==n*(n+1)/2);
+  arr kz;
+  if(Z.N && factorIsGood) {
+    kernelMatrix(kz, X[i]);
+    bz -= ((Y(i) - mu_func(X[i], priorP) - mu)/obsVar) * kz;
+  }
+  X.delRows(i);
+  Y.remove(i);
+  if(!factorIsGood) { recompute();  return; }
+  if(Z.N) {
+    kz /= ::sqrt(obsVar);
+    cholUpdate(Ls, kz.p, 0, -1.);
+    GinvY = bz;
+    cholSolve(Ls, GinvY);
+  } else {
+    cholDelete(L, i);
+    LinvY = residuals(*this);
+    forwardSolve(L, LinvY.p);
+    GinvY = LinvY;
+    backSolve(L, GinvY.p);
+  }
+}
+
+void GaussianProcess::setInducingPoints(const arr& _Z) {
+  Z = _Z;
+  if(!Z.N) { Lzz.clear();  Ls.clear();  bz.clear(); }
+  recompute();
+}
+
+void GaussianProcess::setInducingPoints(uint m) {
+  CHECK_LE(m, X.d0, "fewer data than inducing points");
+  uintA perm;
+  perm.setRandomPerm(X.d0);
+  arr _Z(m, X.d1);
+  for(uint i=0; i<m; i++) _Z[i] = X[perm(i)];
+  setInducingPoints(_Z);
+}
+
 void GaussianProcess::appendDerivativeObservation(const arr& x, double y, uint i) {
   uint N=dX.d0;
   dX.append(x); //append it to the data
@@ -137,50 +345,77 @@ double GaussianProcess::max_var() {
 }
 
 void GaussianProcess::evaluate(const arr& x, double& y, double& sig, bool calcSig) {
-  uint i, N=Y.N, dN=dY.N;
-  /*static*/ arr k, xi, Ginvk; //danny: why was there a static
+  uint N=Y.N, dN=dY.N;
   if(N+dN==0) { //no data
     y = mu_func(x, priorP) + mu;
     sig=::sqrt(cov(kernelP, x, x));
     return;
   }
-  if(k.N!=N+dN) k.resize(N+dN);
-  for(i=0; i<N; i++) { xi.referToDim(X, i); k(i)=cov(kernelP, x, xi); }
-  //derivative observations
-  for(i=0; i<dN; i++) { xi.referToDim(dX, i); k(N+i)=covF_D(dI(i), kernelP, x, xi); }
+  arr k;
+  kernelMatrix(k, x);
 
   y = scalarProduct(k, GinvY) + mu_func(x, priorP) + mu;
   if(calcSig) {
-    op_innerProduct(Ginvk, Ginv, k);
-    sig = cov(kernelP, x, x) - scalarProduct(k, Ginvk);
-    //if(sig<=10e-10) {
-    //cout << "---" << endl;
-    //cout << "x==" << x << endl;
-    //cout << "k==" << k << endl;
-    //cout << "Ginv==" << Ginv << endl;
-    //cout << "kGinvk==" << scalarProduct(k, Ginvk) << endl;
-    //sig=::sqrt(sig);
-    //cout << "sig==" << sig << endl;
-    //}
-    //else
-    sig = ::sqrt(sig);
+    double s = cov(kernelP, x, x);
+    if(Z.N) {
+      arr v=k;
+      forwardSolve(Lzz, k.p);
+      forwardSolve(Ls, v.p);
+      s += sumOfSqr(v) - sumOfSqr(k);
+    } else {
+      forwardSolve(L, k.p);
+      s -= sumOfSqr(k);
+    }
+    sig = ::sqrt(rai::MAX(s, 0.));
   }
 }
 
 double GaussianProcess::log_likelihood() {
-  arr gram;
-  inverse_SymPosDef(gram, Ginv);
-  return (-.5*~Y*GinvY - .5*log(length(gram)) - (X.N+dX.N)/2 * log(2*RAI_PI))(0); // actually a degenerated array of size 1x1
+  CHECK(!Z.N, "NIY in sparse mode");
+  uint n=rows(L);
+  double logDet=0.;
+  for(uint i=0; i<n; i++) logDet += 2.*::log(row(L, i)[i]);
+  return -.5*scalarProduct(residuals(*this), GinvY) - .5*logDet - .5*n*::log(2.*RAI_PI);
 }
 
-/** vector of covariances between test point and N+dN observation points */
+/** vector of covariances between test point and N+dN observation points (or the inducing points) */
 void GaussianProcess::k_star(const arr& x, arr& k) {
-  uint i, N=Y.N, dN=dY.N;
-  arr xi;
+  kernelMatrix(k, x);
+}
 
-  if(k.N!=N+dN) k.resize(N+dN);
-  for(i=0; i<N; i++) { xi.referToDim(X, i); k(i)=cov(kernelP, x, xi); }
-  for(i=0; i<dN; i++) { xi.referToDim(dX, i); k(N+i)=covF_D(dI(i), kernelP, x, xi); }
+void GaussianProcess::kernelMatrix(arr& K, const arr& Xq) {
+  const arr& P = (Z.N ? Z : X);
+  uint N=P.d0, dN=(Z.N ? 0 : dY.N), m=(Xq.nd==1 ? 1 : Xq.d0), d=(Xq.nd==1 ? Xq.N : Xq.d1);
+  if(Xq.nd==1) K.resize(N+dN); else K.resize(m, N+dN);
+  if(!K.N) return;
+  if(cov==GaussKernel && N) { //closed form on raw memory, no function pointer per entry
+    CHECK_EQ(d, P.d1, "dimensions don't match");
+    const GaussKernelParams& G = *((GaussKernelParams*)kernelP);
+    double a=-.5/G.widthVar;
+    for(uint q=0; q<m; q++) {
+      const double* xq=Xq.p+q*d;
+      double* k=K.p+q*(N+dN);
+      for(uint i=0; i<N; i++) {
+        const double* xi=P.p+i*d;
+        double s=0.;
+        for(uint j=0; j<d; j++) { double e=xq[j]-xi[j];  s+=e*e; }
+        k[i] = G.priorVar*::exp(a*s);
+      }
+    }
+  } else {
+    arr xq, xi;
+    for(uint q=0; q<m; q++) {
+      if(Xq.nd==1) xq.referTo(Xq); else xq.referToDim(Xq, q);
+      for(uint i=0; i<N; i++) { xi.referToDim(P, i);  K.p[q*(N+dN)+i] = cov(kernelP, xq, xi); }
+    }
+  }
+  if(dN) { //derivative observations
+    arr xq, xi;
+    for(uint q=0; q<m; q++) {
+      if(Xq.nd==1) xq.referTo(Xq); else xq.referToDim(Xq, q);
+      for(uint i=0; i<dN; i++) { xi.referToDim(dX, i);  K.p[q*(N+dN)+N+i] = covF_D(dI(i), kernelP, xq, xi); }
+    }
+  }
 }
 
 /** vector of covariances between test point and N+dN  observation points */
@@ -249,7 +484,8 @@ the resulting \(\nabla f(x) \) is vector of the dimensionality of the GP
 void GaussianProcess::gradient(arr& grad, const arr& x) {
   CHECK(X.N || dX.N, "can't recompute gradient without data");
   CHECK((X.N && x.N==X.d1) || (dX.N && x.N==dX.d1), "dimensions don't match!");
-  uint i, d, N=Y.N, dN=dY.N, dim;
+  const arr& P = (Z.N ? Z : X); //the mean is a combination of kernels at the data (or the inducing points)
+  uint i, d, N=P.d0, dN=dY.N, dim;
   dim = X.d1?X.d1:dX.d1;
   arr dk(dim);
   /*static*/ arr xi, dxi; //danny: why was there a static?
@@ -257,7 +493,7 @@ void GaussianProcess::gradient(arr& grad, const arr& x) {
   grad.setZero();
   // take the gradient in the function value observations
   for(i=0; i<N; i++) {
-    xi.referToDim(X, i);
+    xi.referToDim(P, i);
     dcov(dk, kernelP, x, xi);
     grad += GinvY(i) * dk;
     //cout << dk << endl;
@@ -340,7 +576,8 @@ void GaussianProcess::hessianPos(arr& hess, const arr& x) {
   //Danny: I think that this is wrong.. Or at least numerical Hessian checking fails
   CHECK(X.N || dX.N, "can't recompute Hessian without data");
   CHECK((X.N && x.N==X.d1) || (dX.N && x.N==dX.d1), "dimensions don't match!");
-  uint i, j, n, N=Y.N, dN=dY.N, dim;
+  const arr& P = (Z.N ? Z : X);
+  uint i, j, n, N=P.d0, dN=dY.N, dim;
   dim = X.d1?X.d1:dX.d1;
   arr d2k(N+dN, dim, dim);
   /*static*/ arr xn, dxn; //danny: why was there a static
@@ -349,7 +586,7 @@ void GaussianProcess::hessianPos(arr& hess, const arr& x) {
   hess.setZero();
   // function value observations
   for(n=0; n<N; n++) {
-    xn.referToDim(X, n);
+    xn.referToDim(P, n);
     for(i=0; i<dim; i++) {
       for(j=0; j<dim; j++) {
         d2k(n, i, j)=covD_D(i, j, kernelP, x, xn);
@@ -372,15 +609,40 @@ void GaussianProcess::hessianPos(arr& hess, const arr& x) {
 }
 
 void GaussianProcess::gradientV(arr& grad, const arr& x) {
+  CHECK(!Z.N, "NIY in sparse mode");
   arr k, dk;
   k_star(x, k);
   dk_star(x, dk);
-  grad = -2.0*~k*Ginv*dk;
+  cholSolve(L, k);
+  grad = -2.0*~k*dk;
 }
 
-void GaussianProcess::evaluate(const arr& X, arr& Y, arr& S) {
-  uint i;
-  arr xi;
-  Y.resize(X.d0); S.resize(X.d0);
-  for(i=0; i<X.d0; i++) { xi.referToDim(X, i); evaluate(xi, Y(i), S(i)); }
+void GaussianProcess::evaluate(const arr& Xq, arr& Yq, arr& S) {
+  uint m=Xq.d0, n=GinvY.N;
+  Yq.resize(m); S.resize(m);
+  if(!n) {
+    arr xi;
+    for(uint i=0; i<m; i++) { xi.referToDim(Xq, i); evaluate(xi, Yq(i), S(i)); }
+    return;
+  }
+  //blocks of queries in parallel: one kernel matrix and one multi-column triangular solve per block
+  const uint B=64;
+  rai::taskPool().parallel_for(0, (m+B-1)/B, [&](uint b) {
+    uint q0=b*B, q1=rai::MIN(m, q0+B), mb=q1-q0;
+    arr Xb, K, V, W, xi;
+    Xb.referToRange(Xq, q0, q1-1);
+    kernelMatrix(K, Xb);
+    K.reshape(mb, n);
+    V = ~K;
+    if(Z.N) { W=V;  forwardSolve(Lzz, V.p, mb);  forwardSolve(Ls, W.p, mb); }
+    else forwardSolve(L, V.p, mb);
+    for(uint q=0; q<mb; q++) {
+      xi.referToDim(Xb, q);
+      Yq(q0+q) = scalarProduct(K[q], GinvY) + mu_func(xi, priorP) + mu;
+      double s = cov(kernelP, xi, xi);
+      for(uint i=0; i<n; i++) s -= rai::sqr(V.p[i*mb+q]);
+      if(Z.N) for(uint i=0; i<n; i++) s += rai::sqr(W.p[i*mb+q]);
+      S(q0+q) = ::sqrt(rai::MAX(s, 0.));
+    }
+  }, 1);
 }
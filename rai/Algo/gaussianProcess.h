@@ -20,7 +20,14 @@ struct GaussianProcess {
   arr X, Y;   ///< data
   arr dX, dY; ///< derivative data
   uintA dI;  ///< derivative data (derivative indexes)
-  arr Ginv, GinvY, ig2;  ///< inverse gram matrix (and a second buffer for push/pop)
+  arr L;      ///< Cholesky factor of the Gram matrix (incl. obsVar), lower triangle packed by rows (row i starts at i(i+1)/2)
+  arr LinvY;  ///< L^{-1} (Y - prior), extended in O(n) per append
+  arr GinvY;  ///< Gram^{-1} (Y - prior) = L^{-T} LinvY
+
+  //-- sparse mode
+  arr Z;      ///< inducing points: if set, the GP is the DTC approximation on these (use for n>5k with m of a few hundred)
+  arr Lzz, Ls; ///< (sparse mode) packed Cholesky factors of K_zz and of K_zz + K_zx K_xz / obsVar
+  arr bz;     ///< (sparse mode) K_zx (Y - prior) / obsVar
 
   //--prior function
   double mu; ///< const bias of the GP
@@ -56,18 +63,18 @@ struct GaussianProcess {
 
   GaussianProcess(const GaussianProcess& f) {
     X=f.X; Y=f.Y; dX=f.dX; dY=f.dY; dI=f.dI;
-    Ginv=f.Ginv; GinvY=f.GinvY; ig2=f.ig2;
+    L=f.L; LinvY=f.LinvY; GinvY=f.GinvY; Z=f.Z; Lzz=f.Lzz; Ls=f.Ls; bz=f.bz;
     mu=f.mu; mu_func=f.mu_func; priorP=f.priorP;
     cov=f.cov; dcov=f.dcov; covF_D=f.covF_D;
     covD_D=f.covD_D; covDD_F=f.covDD_F; covDD_D=f.covDD_D;
     kernelP=f.kernelP; obsVar=f.obsVar;
   }
 
-  void clear() { X.clear(); Y.clear(); dX.clear(); dY.clear(); dI.clear(); Ginv.clear(); GinvY.clear(); ig2.clear(); }
+  void clear() { X.clear(); Y.clear(); dX.clear(); dY.clear(); dI.clear(); L.clear(); LinvY.clear(); GinvY.clear(); Lzz.clear(); Ls.clear(); bz.clear(); }
 
   void copyFrom(GaussianProcess& f) {
     X=f.X; Y=f.Y; dX=f.dX; dY=f.dY; dI=f.dI;
-    Ginv=f.Ginv; GinvY=f.GinvY; ig2=f.ig2;
+    L=f.L; LinvY=f.LinvY; GinvY=f.GinvY; Z=f.Z; Lzz=f.Lzz; Ls=f.Ls; bz=f.bz;
     mu=f.mu; mu_func=f.mu_func; priorP=f.priorP;
     cov=f.cov; dcov=f.dcov; covF_D=f.covF_D;
     covD_D=f.covD_D; covDD_F=f.covDD_F; covDD_D=f.covDD_D;
@@ -113,24 +120,28 @@ struct GaussianProcess {
   void setGaussKernelGP(void* _kernelP, double(*_mu)(const arr&, const void*), void*);
   void setGaussKernelGP(void* _kernelP, double _mu);
 
-  void recompute(const arr& X, const arr& Y);             ///< calculates the inv Gram matrix for the given data
-  void recompute();                                      ///< recalculates the inv Gram matrix for the current data
-  void appendObservation(const arr& x, double y);     ///< add a new datum to the data and updates the inv Gram matrix
+  void recompute(const arr& X, const arr& Y);             ///< factorizes the Gram matrix for the given data
+  void recompute();                                      ///< refactorizes the Gram matrix for the current data (needed after changing data, kernel or obsVar directly)
+  void appendObservation(const arr& x, double y);     ///< add a new datum; rank-1 extension of the factorization in O(n^2) (O(m^2) in sparse mode)
+  void removeObservation(uint i);                     ///< remove datum i; rank-1 downdate of the factorization in O(n^2) (O(m^2) in sparse mode)
+  void setInducingPoints(const arr& _Z);               ///< switch to sparse mode with the given inducing points ({}: back to exact)
+  void setInducingPoints(uint m);                      ///< switch to sparse mode with m random data points as inducing points
   void appendDerivativeObservation(const arr& x, double dy, uint i);
   void appendGradientObservation(const arr& x, const arr& dydx);
 
   void evaluate(const arr& x, double& y, double& sig, bool calcSig = true);   ///< evaluate the GP at some point - returns y and sig (=standard deviation)
-  void evaluate(const arr& X, arr& Y, arr& S);   ///< evaluate the GP at some array of points - returns all y's and sig's
+  void evaluate(const arr& X, arr& Y, arr& S);   ///< evaluate the GP at some array of points - returns all y's and sig's (batched and in parallel)
   double log_likelihood();
   double max_var(); // the variance when no data present
   void gradient(arr& grad, const arr& x);           ///< evaluate the gradient dy/dx of the mean at some point
   void hessianPos(arr& hess, const arr& x);            ///< evaluate the hessian dy/dx1dx2 of the mean at some point
   void gradientV(arr& grad, const arr& x); ///< variance gradient
   void k_star(const arr& x, arr& k);
+  void kernelMatrix(arr& K, const arr& Xq);   ///< covariances between the rows of Xq and all observations (or the inducing points)
   void dk_star(const arr& x, arr& k);
 
-  void push(const arr& x, double y) { ig2=Ginv; appendObservation(x, y); recompute(); }
-  void pop() { Ginv=ig2; X.resizeCopy(X.d0-1, X.d1); Y.resizeCopy(Y.N-1); }
+  void push(const arr& x, double y) { appendObservation(x, y); }
+  void pop() { removeObservation(Y.N-1); }
 };
 
 #define KRONEKER(a, b)   ( ((a)==(b)) ? 1 : 0 )
@@ -260,8 +271,8 @@ inline void randomFunction(GaussianProcess& gp, arr& Xbase, bool illustrate, boo
     gp.evaluate(x, y, sig);      //sample it from the GP itself
     y+=sig*rnd.gauss();        //with standard deviation..
     gp.appendObservation(x, y);
-    gp.recompute();
   }
 
   gp.obsVar=orgObsVar;
+  gp.recompute(); //the factor was built with the small sampling noise
 }
@@ -13,7 +13,7 @@
  * (section 1.5.1 of Guido Schäfer's Master's thesis
  * http://homepages.cwi.nl/~schaefer/ftp/pdf/masters-thesis.pdf
  *
- * The Hungarian is not really efficient. More efficient implementations of graph matching are found here:
+ * More general (non-bipartite) implementations of graph matching are found here:
  * http://pub.ist.ac.at/~vnk/software.html#BLOSSOM5
  * and here
  * https://www.cs.purdue.edu/homes/apothen/software.html
@@ -22,182 +22,182 @@
  * https://en.wikipedia.org/wiki/Matching_(graph_theory)
  * https://en.wikipedia.org/wiki/Blossom_algorithm
  *
- * If it is not an efficiency bottleneck, we stick with Hungarian first.
+ * The solver below is the shortest augmenting path variant (Jonker & Volgenant, 1987; in the form of
+ * Crouse, 2016) on compressed rows, so that gated pairs cost nothing. Hungarian only wraps it.
  */
 
 #include "hungarian.h"
 
-Hungarian::Hungarian(const arr& cost_matrix) {
-  costs = cost_matrix;
-  dim = costs.dim(0);
-  starred = zeros(dim, dim);
-  primed = starred;
-  covered_rows = zeros(dim);
-  covered_cols = covered_rows;
-  minimize();
-}
-
-Hungarian::~Hungarian() {}
-
-void Hungarian::minimize() {
-  covered_rows = covered_cols = zeros(dim);
-  starred = primed = zeros(dim, dim);
-  for(uint i = 0; i < dim; i++) {
-    double minRow = costs[i]().argmin();
-    costs[i]() -= costs(i, minRow);
-  }
-  costs = ~costs;
-
-  for(uint i = 0; i < dim; i++) {
-    double minRow = costs[i]().argmin();
-    costs[i]() -= costs(i, minRow);
-  }
-  costs = ~costs;
-  starZeros();
-}
-
-void Hungarian::starZeros() {
-  for(uint i = 0; i < dim; i++) {
-    if(covered_rows(i))
-      continue;
-
-    for(uint j = 0; j < dim; j++) {
-      if(covered_cols(j))
-        continue;
 
-      if(costs(i, j) == 0) {
-        starred(i, j) = 1;
-        covered_rows(i) = 1;
-        covered_cols(j) = 1;
-        break;
+//===========================================================================
+
+void LinearAssignment::setRows(const arr& C, double unassignedCost, bool transpose) {
+  CHECK_EQ(C.nd, 2, "cost matrix needs to be 2D");
+  nRows = transpose?C.d1:C.d0;
+  uint K = transpose?C.d0:C.d1;
+  bool dummies = unassignedCost>=0.;
+  nCols = dummies ? K+nRows : K;
+
+  //collect admissible (row, col, cost) entries
+  uintA count(nRows);
+  count.setZero();
+  uint nnz=0;
+  auto forEntries = [&](const std::function<void(uint, uint, double)>& f) {
+    if(isSparseMatrix(C)) {
+      const intA& elems = C.sparse().elems;
+      for(uint k=0; k<elems.d0; k++) {
+        double x = C.p[k];
+        if(!std::isinf(x)) { if(transpose) f(elems(k, 1), elems(k, 0), x); else f(elems(k, 0), elems(k, 1), x); }
       }
+    } else {
+      for(uint i=0; i<C.d0; i++) for(uint j=0; j<C.d1; j++) {
+          double x = C.p[i*C.d1+j];
+          if(!std::isinf(x)) { if(transpose) f(j, i, x); else f(i, j, x); }
+        }
     }
-  }
-
-  covered_rows = zeros(dim);
-  covered_cols = covered_rows;
-  coverColumns();
+  };
+  forEntries([&](uint i, uint, double) { count.p[i]++;  nnz++; });
+  if(dummies) { for(uint i=0; i<nRows; i++) count.p[i]++;  nnz+=nRows; }
+
+  rowStart.resize(nRows+1);
+  rowStart.p[0]=0;
+  for(uint i=0; i<nRows; i++) rowStart.p[i+1] = rowStart.p[i] + count.p[i];
+  cols.resize(nnz);
+  c.resize(nnz);
+  for(uint i=0; i<nRows; i++) count.p[i] = rowStart.p[i];
+  forEntries([&](uint i, uint j, double x) { uint& k=count.p[i];  cols.p[k]=j;  c.p[k]=x;  k++; });
+  if(dummies) for(uint i=0; i<nRows; i++) { uint& k=count.p[i];  cols.p[k]=K+i;  c.p[k]=unassignedCost;  k++; }
 }
 
-void Hungarian::coverColumns() {
-  uint count = 0;
-  starred = ~starred;
-  for(uint i = 0; i < dim; i++) {
-    if(sum(starred[i]()) > 0) {
-      covered_cols(i) = 1;
-      count++;
+double LinearAssignment::solve(const arr& C, double unassignedCost, bool warmStart) {
+  transposed = unassignedCost<0. && C.d0>C.d1; //then assign all columns instead of all rows
+  setRows(C, unassignedCost, transposed);
+  uint K = transposed?C.d0:C.d1;
+
+  //-- initial duals: column prices (warm or zero), row potentials as the min reduced cost
+  if(warmStart && !transposed) {
+    CHECK_EQ(prices.N, C.d1, "warm start needs the prices of the same columns");
+    for(double& p:prices) if(p>0.) p=0.; //dual feasibility: prices are nonpositive
+    prices.append(zeros(nCols-K));
+  } else {
+    prices = zeros(nCols);
+  }
+  u.resize(nRows);
+  rowMatch.resize(nRows) = -1;
+  colMatch.resize(nCols) = -1;
+
+  //-- greedy: assign rows whose cheapest column (reduced cost 0) is still free
+  for(uint i=0; i<nRows; i++) {
+    double best=INFINITY;
+    int bestj=-1;
+    for(uint k=rowStart.p[i]; k<rowStart.p[i+1]; k++) {
+      double r = c.p[k] - prices.p[cols.p[k]];
+      if(r<best || (r==best && colMatch.p[cols.p[k]]==-1)) { best=r;  bestj=cols.p[k]; }
     }
+    u.p[i] = bestj<0 ? 0. : best;
+    if(bestj>=0 && colMatch.p[bestj]==-1) { rowMatch.p[i]=bestj;  colMatch.p[bestj]=i; }
   }
-  starred = ~starred;
 
-  if(count == dim)
-    return;
+  //-- shortest augmenting path for each remaining row
+  arr dist(nCols);
+  dist = INFINITY;
+  intA pred(nCols);
+  boolA done(nCols);
+  done.setZero();
+  uintA touched, scannedRows;
+  for(uint i=0; i<nRows; i++) if(rowMatch.p[i]==-1) augment(i, dist, pred, touched, scannedRows, done);
+
+  //-- optimal only if every free column has zero price (complementary slackness); a warm price of a column that
+  //   was assigned before but is free now may violate this: then solve cold
+  if(warmStart && !transposed) {
+    for(uint j=0; j<nCols; j++) if(colMatch.p[j]==-1 && prices.p[j]<0.) return solve(C, unassignedCost, false);
+  }
 
-  prime();
+  //-- read out: total cost, drop dummy columns, undo the transposition
+  cost=0.;
+  for(uint i=0; i<nRows; i++) {
+    int j = rowMatch.p[i];
+    if(j<0) continue;
+    for(uint k=rowStart.p[i]; k<rowStart.p[i+1]; k++) if(cols.p[k]==(uint)j) { cost += c.p[k];  break; }
+    if((uint)j>=K) rowMatch.p[i]=-1;
+  }
+  prices.resizeCopy(K);
+  colMatch.resizeCopy(K);
+  if(transposed) {
+    rowMatch.swap(colMatch);
+    u.swap(prices);
+  }
+  return cost;
 }
 
-void Hungarian::prime() {
-  // Find an uncovered zero.
-  for(uint i = 0; i < dim; i++) {
-    if(covered_rows(i))
-      continue;
-
-    for(uint j = 0; j < dim; j++) {
-      if(covered_cols(j))
-        continue;
-
-      if(costs(i, j) == 0) {
-        primed(i, j) = 1;
-        // Check to see if there is a starred zero in this row.
-
-        if(sum(starred[i]()) == 0) {
-          path_row.clear();
-          path_row.push_back(i);
-          path_col.clear();
-          path_col.push_back(j);
-          makePath();
-          return;
-        } else {
-          // Cover this row
-          covered_rows(i) = 1;
-          // Uncover columns containing star
-          uint maxIndex = starred[i]().argmax();
-          covered_cols(maxIndex) = 0;
-          prime();
-          return;
-        }
+bool LinearAssignment::augment(uint row, arr& dist, intA& pred, uintA& touched, uintA& scannedRows, boolA& done) {
+  touched.clear();
+  scannedRows.clear();
+  double minVal=0.;
+  uint i=row;
+  int sink=-1;
+  while(sink<0) {
+    //relax the edges of row i
+    scannedRows.append(i);
+    double ui = u.p[i];
+    for(uint k=rowStart.p[i]; k<rowStart.p[i+1]; k++) {
+      uint j = cols.p[k];
+      if(done.p[j]) continue;
+      double r = minVal + c.p[k] - ui - prices.p[j];
+      if(r<dist.p[j]) {
+        if(std::isinf(dist.p[j])) touched.append(j);
+        dist.p[j]=r;
+        pred.p[j]=i;
       }
     }
+    //closest unscanned column, preferring free ones
+    int j=-1;
+    double lowest=INFINITY;
+    for(uint jj:touched) if(!done.p[jj]) {
+        if(dist.p[jj]<lowest || (dist.p[jj]==lowest && colMatch.p[jj]==-1)) { lowest=dist.p[jj];  j=jj; }
+      }
+    if(j<0) { //no augmenting path: the row stays unassigned
+      for(uint jj:touched) { dist.p[jj]=INFINITY;  done.p[jj]=false; }
+      return false;
+    }
+    minVal=lowest;
+    done.p[j]=true;
+    if(colMatch.p[j]==-1) sink=j; else i=colMatch.p[j];
   }
-  modifyCost();
-  return;
-}
-
-void Hungarian::makePath() {
-  uint count = 0;
-
-  while(1) {
-    starred = ~starred;
-    // find the star in the column
-    int row = starred[path_col.at(count)]().argmax();
-
-    starred = ~starred;
-    if(starred(row, path_col.at(count)) == 0)
-      break;
-
-    count++;
-    path_row.push_back(row);
-    path_col.push_back(path_col.at(count - 1));
-
-    // find the prime in this row
-    int col = primed[row]().argmax();
-    count++;
-    path_row.push_back(path_row.at(count - 1));
-    path_col.push_back(col);
-  }
-
-  // Modify it.
-  for(uint i = 0; i <= count; i++) {
-    uint row = path_row.at(i);
-    uint col = path_col.at(i);
 
-    if(starred(row, col)) {
-      starred(row, col) = 0;
-    } else {
-      starred(row, col) = 1;
-    }
+  //-- update duals
+  u.p[row] += minVal;
+  for(uint ii:scannedRows) if(ii!=row) u.p[ii] += minVal - dist.p[rowMatch.p[ii]];
+  for(uint j:touched) if(done.p[j]) prices.p[j] -= minVal - dist.p[j];
+
+  //-- flip the path
+  for(int j=sink;;) {
+    uint ii=pred.p[j];
+    colMatch.p[j]=ii;
+    std::swap(rowMatch.p[ii], j);
+    if(ii==row) break;
   }
 
-  // Clear covers and primes, call cover columns.
-  covered_rows = covered_cols = zeros(dim);
-  primed = zeros(dim, dim);
-  coverColumns();
+  for(uint j:touched) { dist.p[j]=INFINITY;  done.p[j]=false; }
+  return true;
 }
 
-void Hungarian::modifyCost() {
-  auto minCost = max(costs);
-  for(uint i = 0; i < dim; i++) {
-    if(covered_rows(i))
-      continue;
-
-    for(uint j = 0; j < dim; j++) {
-      if(covered_cols(j))
-        continue;
+arr LinearAssignment::reducedCosts(const arr& C) const {
+  CHECK(!isSparseMatrix(C), "only for dense cost matrices");
+  CHECK_EQ(u.N, C.d0, "solve first");
+  CHECK_EQ(prices.N, C.d1, "solve first");
+  arr R(C.d0, C.d1);
+  for(uint i=0; i<C.d0; i++) for(uint j=0; j<C.d1; j++) R(i, j) = C(i, j) - u(i) - prices(j);
+  return R;
+}
 
-      if(costs(i, j) < minCost)
-        minCost = costs(i, j);
-    }
-  }
-  // Modify the costs
-  for(uint i = 0; i < dim; i++) {
-    for(uint j = 0; j < dim; j++) {
-      if(covered_rows(i)) {
-        costs(i, j) += minCost;
-      } else if(!covered_cols(j)) {
-        costs(i, j) -= minCost;
-      }
-    }
-  }
+//===========================================================================
 
-  prime();
+Hungarian::Hungarian(const arr& cost_matrix) {
+  LinearAssignment A(cost_matrix);
+  costs = A.reducedCosts(cost_matrix);
+  starred = zeros(cost_matrix.d0, cost_matrix.d1);
+  for(uint i=0; i<A.rowMatch.N; i++) if(A.rowMatch(i)>=0) starred(i, A.rowMatch(i)) = 1.;
 }
+
+Hungarian::~Hungarian() {}
@@ -6,30 +6,53 @@
     Please see <root-path>/LICENSE for details.
     --------------------------------------------------------------  */
 
+#pragma once
+
 #include "../Core/array.h"
 
-#include <vector>
+//===========================================================================
+
+/** Minimum cost assignment of rows to columns (Jonker-Volgenant shortest augmenting paths, O(n^3) dense,
+ *  O(n E) sparse). The cost matrix may be rectangular; entries that are infinite, or missing in a sparse
+ *  matrix (isSparseMatrix), are gated: that pair can never be assigned. With unassignedCost>=0 each row
+ *  may instead stay unassigned at that cost; otherwise as many rows as possible are assigned.
+ *  The dual column prices are kept: when solving a similar problem (e.g., the next frame in tracking)
+ *  with the same columns, pass them in (warmStart) and most rows are assigned without any search. If a
+ *  column with a nonzero warm price ends up unassigned, the warm duals are invalid and it solves cold. */
+struct LinearAssignment {
+  intA rowMatch;  ///< for each row the assigned column, -1 if unassigned
+  intA colMatch;  ///< for each column the assigned row, -1 if unassigned
+  arr prices;     ///< dual column prices (one per column), input for warm starts
+  double cost=0.; ///< total cost, including unassignedCost for unassigned rows
+
+  LinearAssignment() {}
+  LinearAssignment(const arr& C, double unassignedCost=-1.) { solve(C, unassignedCost); }
 
+  /// returns the total cost; warmStart: use the current prices (of the same columns) as initialization
+  double solve(const arr& C, double unassignedCost=-1., bool warmStart=false);
+
+  /// reduced costs C(i,j) - u(i) - prices(j): nonnegative for all admissible pairs, zero for assigned ones
+  arr reducedCosts(const arr& C) const;
+
+ private:
+  arr u;  //row potentials
+  //compressed rows: row i has the columns cols(rowStart(i)..rowStart(i+1)-1) with costs c(...)
+  uintA rowStart, cols;
+  arr c;
+  uint nRows=0, nCols=0;
+  bool transposed=false;
+
+  void setRows(const arr& C, double unassignedCost, bool transpose);
+  bool augment(uint row, arr& dist, intA& pred, uintA& touched, uintA& scannedRows, boolA& done);
+};
+
+//===========================================================================
+
+/// perfect matching of a square cost matrix; thin wrapper of LinearAssignment
 struct Hungarian {
   arr costs, starred;
   Hungarian(const arr& cost_matrix);
   ~Hungarian();
 
   uint getMatch_row(uint i) { return starred[i].argmax(); }
-
- private:
-  arr primed;
-  uint dim;
-  arr covered_rows;
-  arr covered_cols;
-
-  void minimize();
-  void starZeros();
-  void coverColumns();
-  void prime();
-  void makePath();
-  void modifyCost();
-
-  std::vector<uint> path_row;
-  std::vector<uint> path_col;
 };
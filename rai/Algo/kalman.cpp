@@ -7,6 +7,7 @@
     --------------------------------------------------------------  */
 
 #include "kalman.h"
+#include "../Core/taskPool.h"
 
 void Kalman::stepPredict(const arr& A, const arr& a, const arr& Q) {
   b_mean = A*b_mean + a;
@@ -27,3 +28,281 @@ void Kalman::step(const arr& A, const arr& a, const arr& Q, const arr& y, const
   stepObserve(y, C, c, W);
 }
 
+
+//===========================================================================
+//
+// KalmanBank
+//
+
+namespace {
+
+const uint L=8;  //filters per block, processed in SIMD lanes
+
+/// everything a block kernel needs; matrices are row-major, bank arrays (component, filter)
+struct BankData {
+  double* x, *P;
+  uint n, m, N;
+  const double* A, *a, *Q;              //prediction
+  const double* y, *C, *c, *W;          //observation
+  const byte* observed;
+  byte* accepted;
+  double* nis;
+  bool joseph;
+  double gate;
+};
+
+/// fixed: the sizes are NX, NY; otherwise they are the runtime sizes of D, at most NX, NY
+template<uint NX, bool fixed>
+void predictBlock(const BankData& D, uint f0) {
+  const uint n = fixed?NX:D.n, N=D.N, l=std::min(L, N-f0);
+  double x[NX][L], P[NX][NX][L], AP[NX][NX][L];
+  for(uint i=0; i<n; i++) for(uint w=0; w<L; w++) x[i][w] = w<l ? D.x[i*N+f0+w] : 0.;
+  for(uint i=0; i<n*n; i++) for(uint w=0; w<L; w++) P[i/n][i%n][w] = w<l ? D.P[i*N+f0+w] : 0.;
+
+  for(uint i=0; i<n; i++) {
+    double xi[L];
+    for(uint w=0; w<L; w++) xi[w] = D.a[i];
+    for(uint j=0; j<n; j++) { double Aij=D.A[i*n+j];  for(uint w=0; w<L; w++) xi[w] += Aij*x[j][w]; }
+    for(uint w=0; w<l; w++) D.x[i*N+f0+w] = xi[w];
+  }
+  for(uint i=0; i<n; i++) for(uint j=0; j<n; j++) {
+      double* s=AP[i][j];
+      for(uint w=0; w<L; w++) s[w]=0.;
+      for(uint k=0; k<n; k++) { double Aik=D.A[i*n+k];  for(uint w=0; w<L; w++) s[w] += Aik*P[k][j][w]; }
+    }
+  for(uint i=0; i<n; i++) for(uint j=i; j<n; j++) {
+      double s[L];
+      for(uint w=0; w<L; w++) s[w] = D.Q[i*n+j];
+      for(uint k=0; k<n; k++) { double Ajk=D.A[j*n+k];  for(uint w=0; w<L; w++) s[w] += AP[i][k][w]*Ajk; }
+      for(uint w=0; w<l; w++) D.P[(i*n+j)*N+f0+w] = D.P[(j*n+i)*N+f0+w] = s[w];
+    }
+}
+
+template<uint NX, uint NY, bool fixed>
+void observeBlock(const BankData& D, uint f0) {
+  const uint n = fixed?NX:D.n, m = fixed?NY:D.m, N=D.N, l=std::min(L, N-f0);
+  double x[NX][L], P[NX][NX][L], nu[NY][L], PCt[NX][NY][L], S[NY][NY][L], K[NX][NY][L], d2[L];
+  for(uint i=0; i<n; i++) for(uint w=0; w<L; w++) x[i][w] = w<l ? D.x[i*N+f0+w] : 0.;
+  for(uint i=0; i<n*n; i++) for(uint w=0; w<L; w++) P[i/n][i%n][w] = w<l ? D.P[i*N+f0+w] : 0.;
+
+  //innovation nu = y - C x - c, PC' and S = C P C' + W
+  for(uint k=0; k<m; k++) {
+    for(uint w=0; w<L; w++) nu[k][w] = (w<l ? D.y[k*N+f0+w] : 0.) - D.c[k];
+    for(uint i=0; i<n; i++) { double Cki=D.C[k*n+i];  for(uint w=0; w<L; w++) nu[k][w] -= Cki*x[i][w]; }
+  }
+  for(uint i=0; i<n; i++) for(uint k=0; k<m; k++) {
+      double* s=PCt[i][k];
+      for(uint w=0; w<L; w++) s[w]=0.;
+      for(uint j=0; j<n; j++) { double Ckj=D.C[k*n+j];  for(uint w=0; w<L; w++) s[w] += P[i][j][w]*Ckj; }
+    }
+  for(uint k=0; k<m; k++) for(uint q=0; q<=k; q++) {
+      double* s=S[k][q];
+      for(uint w=0; w<L; w++) s[w] = D.W[k*m+q];
+      for(uint i=0; i<n; i++) { double Cki=D.C[k*n+i];  for(uint w=0; w<L; w++) s[w] += Cki*PCt[i][q][w]; }
+    }
+
+  //Cholesky S = R R' in place (lower triangle)
+  for(uint k=0; k<m; k++) for(uint q=0; q<=k; q++) {
+      double* s=S[k][q];
+      for(uint r=0; r<q; r++) for(uint w=0; w<L; w++) s[w] -= S[k][r][w]*S[q][r][w];
+      if(q==k) for(uint w=0; w<L; w++) s[w] = ::sqrt(s[w]);
+      else for(uint w=0; w<L; w++) s[w] /= S[q][q][w];
+    }
+
+  //NIS = |R^-1 nu|^2
+  {
+    double z[NY][L];
+    for(uint w=0; w<L; w++) d2[w]=0.;
+    for(uint k=0; k<m; k++) {
+      for(uint w=0; w<L; w++) z[k][w] = nu[k][w];
+      for(uint r=0; r<k; r++) for(uint w=0; w<L; w++) z[k][w] -= S[k][r][w]*z[r][w];
+      for(uint w=0; w<L; w++) { z[k][w] /= S[k][k][w];  d2[w] += z[k][w]*z[k][w]; }
+    }
+  }
+
+  //gain K = PC' S^-1, by forward and backward substitution for each row
+  for(uint i=0; i<n; i++) {
+    for(uint k=0; k<m; k++) {
+      for(uint w=0; w<L; w++) K[i][k][w] = PCt[i][k][w];
+      for(uint r=0; r<k; r++) for(uint w=0; w<L; w++) K[i][k][w] -= S[k][r][w]*K[i][r][w];
+      for(uint w=0; w<L; w++) K[i][k][w] /= S[k][k][w];
+    }
+    for(uint k=m; k--;) {
+      for(uint r=k+1; r<m; r++) for(uint w=0; w<L; w++) K[i][k][w] -= S[r][k][w]*K[i][r][w];
+      for(uint w=0; w<L; w++) K[i][k][w] /= S[k][k][w];
+    }
+  }
+
+  bool acc[L];
+  uint nAcc=0;
+  for(uint w=0; w<l; w++) {
+    acc[w] = (!D.observed || D.observed[f0+w]) && (D.gate<0. || d2[w]<=D.gate);
+    if(D.accepted) D.accepted[f0+w] = acc[w];
+    if(D.nis) D.nis[f0+w] = (!D.observed || D.observed[f0+w]) ? d2[w] : 0.;
+    if(acc[w]) nAcc++;
+  }
+  if(!nAcc) return;
+
+  //x <- x + K nu
+  for(uint i=0; i<n; i++) {
+    double xi[L];
+    for(uint w=0; w<L; w++) xi[w] = x[i][w];
+    for(uint k=0; k<m; k++) for(uint w=0; w<L; w++) xi[w] += K[i][k][w]*nu[k][w];
+    for(uint w=0; w<l; w++) if(acc[w]) D.x[i*N+f0+w] = xi[w];
+  }
+
+  if(D.joseph) {
+    //P <- M P M' + K W K' with M = I - K C, expanded as MP + (K W - MP C') K' with MP = P - K (PC')', all O(n^2 m)
+    double MP[NX][NX][L], G[NX][NY][L];
+    for(uint i=0; i<n; i++) for(uint j=0; j<n; j++) {
+        double* s=MP[i][j];
+        for(uint w=0; w<L; w++) s[w] = P[i][j][w];
+        for(uint k=0; k<m; k++) for(uint w=0; w<L; w++) s[w] -= K[i][k][w]*PCt[j][k][w];
+      }
+    for(uint i=0; i<n; i++) for(uint k=0; k<m; k++) {
+        double* s=G[i][k];
+        for(uint w=0; w<L; w++) s[w]=0.;
+        for(uint q=0; q<m; q++) { double Wqk=D.W[q*m+k];  for(uint w=0; w<L; w++) s[w] += K[i][q][w]*Wqk; }
+        for(uint j=0; j<n; j++) { double Ckj=D.C[k*n+j];  for(uint w=0; w<L; w++) s[w] -= MP[i][j][w]*Ckj; }
+      }
+    for(uint i=0; i<n; i++) for(uint j=i; j<n; j++) {
+        double s[L];
+        for(uint w=0; w<L; w++) s[w] = MP[i][j][w];
+        for(uint k=0; k<m; k++) for(uint w=0; w<L; w++) s[w] += G[i][k][w]*K[j][k][w];
+        for(uint w=0; w<l; w++) if(acc[w]) D.P[(i*n+j)*N+f0+w] = D.P[(j*n+i)*N+f0+w] = s[w];
+      }
+  } else {
+    //P <- P - K C P = P - K (PC')'
+    for(uint i=0; i<n; i++) for(uint j=i; j<n; j++) {
+        double s[L];
+        for(uint w=0; w<L; w++) s[w] = P[i][j][w];
+        for(uint k=0; k<m; k++) for(uint w=0; w<L; w++) s[w] -= K[i][k][w]*PCt[j][k][w];
+        for(uint w=0; w<l; w++) if(acc[w]) D.P[(i*n+j)*N+f0+w] = D.P[(j*n+i)*N+f0+w] = s[w];
+      }
+  }
+}
+
+typedef void (*BlockKernel)(const BankData&, uint);
+
+BlockKernel predictKernel(uint n) {
+  switch(n) {
+    case 1: return predictBlock<1, true>;
+    case 2: return predictBlock<2, true>;
+    case 3: return predictBlock<3, true>;
+    case 4: return predictBlock<4, true>;
+    case 5: return predictBlock<5, true>;
+    case 6: return predictBlock<6, true>;
+  }
+  CHECK_LE(n, 16, "KalmanBank supports state dimensions up to 16");
+  return predictBlock<16, false>;
+}
+
+template<uint NX> BlockKernel observeKernel(uint m) {
+  switch(m) {
+    case 1: return observeBlock<NX, 1, true>;
+    case 2: return observeBlock<NX, 2, true>;
+    case 3: return observeBlock<NX, 3, true>;
+  }
+  CHECK_LE(m, 8, "KalmanBank supports observation dimensions up to 8");
+  return observeBlock<16, 8, false>;
+}
+
+BlockKernel observeKernel(uint n, uint m) {
+  switch(n) {
+    case 1: return observeKernel<1>(m);
+    case 2: return observeKernel<2>(m);
+    case 3: return observeKernel<3>(m);
+    case 4: return observeKernel<4>(m);
+    case 5: return observeKernel<5>(m);
+    case 6: return observeKernel<6>(m);
+  }
+  CHECK_LE(n, 16, "KalmanBank supports state dimensions up to 16");
+  CHECK_LE(m, 8, "KalmanBank supports observation dimensions up to 8");
+  return observeBlock<16, 8, false>;
+}
+
+void runBlocks(const BankData& D, BlockKernel kernel) {
+  const uint B=64; //blocks per task
+  uint nBlocks = (D.N+L-1)/L;
+  if(nBlocks<=4*B) {
+    for(uint b=0; b<nBlocks; b++) kernel(D, b*L);
+  } else {
+    rai::taskPool().parallel_for(0, (nBlocks+B-1)/B, [&](uint t) {
+      for(uint b=t*B; b<std::min(nBlocks, (t+1)*B); b++) kernel(D, b*L);
+    }, 1);
+  }
+}
+
+} //namespace
+
+void KalmanBank::initialize(uint N, const arr& _mean, const arr& _var) {
+  uint n=_mean.N;
+  CHECK_EQ(_var.nd, 2, "");
+  CHECK_EQ(_var.d0, n, "");
+  CHECK_EQ(_var.d1, n, "");
+  mean.resize(n, N);
+  var.resize(n, n, N);
+  for(uint i=0; i<n; i++) for(uint f=0; f<N; f++) mean.p[i*N+f] = _mean.elem(i);
+  for(uint i=0; i<n*n; i++) for(uint f=0; f<N; f++) var.p[i*N+f] = _var.elem(i);
+}
+
+void KalmanBank::set(uint f, const arr& _mean, const arr& _var) {
+  uint n=dim();
+  CHECK_EQ(_mean.N, n, "");
+  CHECK_EQ(_var.N, n*n, "");
+  for(uint i=0; i<n; i++) mean.p[i*N()+f] = _mean.elem(i);
+  for(uint i=0; i<n*n; i++) var.p[i*N()+f] = _var.elem(i);
+}
+
+arr KalmanBank::getMean(uint f) const {
+  uint n=dim();
+  arr x(n);
+  for(uint i=0; i<n; i++) x.p[i] = mean.p[i*N()+f];
+  return x;
+}
+
+arr KalmanBank::getVar(uint f) const {
+  uint n=dim();
+  arr P(n, n);
+  for(uint i=0; i<n*n; i++) P.p[i] = var.p[i*N()+f];
+  return P;
+}
+
+void KalmanBank::stepPredict(const arr& A, const arr& a, const arr& Q) {
+  uint n=dim();
+  CHECK_EQ(A.N, n*n, "");
+  CHECK_EQ(a.N, n, "");
+  CHECK_EQ(Q.N, n*n, "");
+  if(!N()) return;
+  BankData D;
+  D.x=mean.p;  D.P=var.p;  D.n=n;  D.m=0;  D.N=N();
+  D.A=A.p;  D.a=a.p;  D.Q=Q.p;
+  runBlocks(D, predictKernel(n));
+}
+
+uint KalmanBank::stepObserve(const arr& y, const arr& C, const arr& c, const arr& W,
+                             const byteA& observed, byteA& accepted, arr& nis) {
+  uint n=dim(), m=c.N;
+  CHECK_EQ(y.nd, 2, "y needs to be (m,N)");
+  CHECK_EQ(y.d0, m, "");
+  CHECK_EQ(y.d1, N(), "");
+  CHECK_EQ(C.N, m*n, "");
+  CHECK_EQ(W.N, m*m, "");
+  if(!!observed) CHECK_EQ(observed.N, N(), "");
+  byteA acc(N());
+  if(!!nis) nis.resize(N());
+  if(!N()) { if(!!accepted) accepted=acc;  return 0; }
+  BankData D;
+  D.x=mean.p;  D.P=var.p;  D.n=n;  D.m=m;  D.N=N();
+  D.y=y.p;  D.C=C.p;  D.c=c.p;  D.W=W.p;
+  D.observed = !!observed ? observed.p : 0;
+  D.accepted = acc.p;
+  D.nis = !!nis ? nis.p : 0;
+  D.joseph=joseph;
+  D.gate=gate;
+  runBlocks(D, observeKernel(n, m));
+  uint count=0;
+  for(byte b:acc) if(b) count++;
+  if(!!accepted) accepted=acc;
+  return count;
+}
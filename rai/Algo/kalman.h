@@ -6,6 +6,8 @@
     Please see <root-path>/LICENSE for details.
     --------------------------------------------------------------  */
 
+#pragma once
+
 #include "../Core/array.h"
 
 struct Kalman {
@@ -16,3 +18,34 @@ struct Kalman {
   void step(const arr& A, const arr& a, const arr& Q, const arr& y, const arr& C, const arr& c, const arr& W);
 };
 
+//===========================================================================
+
+/** A bank of N Kalman filters with the same state dimension n and the same (linear) models, e.g., many tracked
+ *  objects or joints. Beliefs are stored component-major (SoA): component i of filter f is mean(i,f), so that
+ *  the kernels process blocks of filters in SIMD lanes. Kernels are fixed-size for n<=6 and observation
+ *  dimension m<=3, and generic up to n=16, m=8. Large banks are processed in parallel on rai::taskPool(). */
+struct KalmanBank {
+  arr mean;          ///< (n,N) means
+  arr var;           ///< (n,n,N) covariances
+  bool joseph=true;  ///< Joseph-form covariance update (I-KC)P(I-KC)'+KWK', which stays symmetric pos-def under roundoff
+  double gate=-1.;   ///< reject an observation if its squared Mahalanobis distance (NIS) exceeds this, e.g., a chi^2 quantile; <0: no gating
+
+  KalmanBank() {}
+  KalmanBank(uint N, const arr& _mean, const arr& _var) { initialize(N, _mean, _var); }
+
+  void initialize(uint N, const arr& _mean, const arr& _var); ///< all N filters start with the same belief
+  void set(uint f, const arr& _mean, const arr& _var);
+  arr getMean(uint f) const;
+  arr getVar(uint f) const;
+  uint dim() const { return mean.d0; }
+  uint N() const { return mean.d1; }
+
+  /// x <- A x + a, P <- A P A' + Q for all filters
+  void stepPredict(const arr& A, const arr& a, const arr& Q);
+
+  /** observation y = C x + c + noise(W); y is (m,N) with one column per filter. Only filters with observed(f)
+   *  (default: all) are updated, and only if they pass the gate. Optionally returns accepted(f) and the
+   *  normalized innovation squared nis(f) (0 for unobserved filters). Returns the number of accepted updates. */
+  uint stepObserve(const arr& y, const arr& C, const arr& c, const arr& W,
+                   const byteA& observed=NoByteA, byteA& accepted=NoByteA, arr& nis=NoArr);
+};
@@ -0,0 +1,334 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "kdTree.h"
+#include "../Core/taskPool.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace {
+
+const double alpha=.7; //a subtree is rebuilt when one child holds more than this fraction of its points
+
+//distance of angle x to the arc [lo,hi]
+inline double arcDistance(double x, double lo, double hi) {
+  if(hi-lo>=RAI_2PI) return 0.;
+  double t = fmod(x-lo, RAI_2PI);
+  if(t<0.) t+=RAI_2PI;
+  if(t<=hi-lo) return 0.;
+  return rai::MIN(t-(hi-lo), RAI_2PI-t);
+}
+
+inline double intervalDistance(double x, double lo, double hi) {
+  if(x<lo) return lo-x;
+  if(x>hi) return x-hi;
+  return 0.;
+}
+
+} //namespace
+
+//===========================================================================
+
+void rai::KDTree::setMetric(const arr& weights, const uintA& angular, const uintA& quaternions) {
+  CHECK(!d || weights.N==d, "metric has dimension " <<weights.N <<" but the points " <<d);
+  w = weights;
+  kind.resize(w.N).setZero();
+  for(uint i:angular) { CHECK_LT(i, w.N, "angular dimension exceeds the dimension");  kind(i)=1; }
+  for(uint i:quaternions) {
+    CHECK_LE(i+4, w.N, "quaternion block exceeds the dimension");
+    kind(i)=2;
+    kind(i+1)=kind(i+2)=kind(i+3)=3;
+  }
+}
+
+double rai::KDTree::sqrDistance(const double* a, const double* b) const {
+  double s=0.;
+  for(uint i=0; i<d; i++) {
+    switch(kind.p[i]) {
+      case 0: { double e=a[i]-b[i];  s += w.p[i]*e*e; } break;
+      case 1: { double e=remainder(a[i]-b[i], RAI_2PI);  s += w.p[i]*e*e; } break;
+      case 2: {
+        double sp=0., sm=0.;
+        for(uint j=i; j<i+4; j++) { double ep=a[j]-b[j], em=a[j]+b[j];  sp += w.p[j]*ep*ep;  sm += w.p[j]*em*em; }
+        s += rai::MIN(sp, sm);
+        i+=3;
+      } break;
+    }
+  }
+  return s;
+}
+
+//lower bound of the squared distance of x to any point in node i (may stop early once it exceeds bound)
+double rai::KDTree::boxBound(int i, const double* x, double bound) const {
+  const double* lo = boxes.p+2*d*i, *hi = lo+d;
+  double s=0.;
+  for(uint j=0; j<d && s<bound; j++) {
+    switch(kind.p[j]) {
+      case 0: { double e=intervalDistance(x[j], lo[j], hi[j]);  s += w.p[j]*e*e; } break;
+      case 1: { double e=arcDistance(x[j], lo[j], hi[j]);  s += w.p[j]*e*e; } break;
+      case 2: {
+        double sp=0., sm=0.;
+        for(uint l=j; l<j+4; l++) {
+          double ep=intervalDistance(x[l], lo[l], hi[l]), em=intervalDistance(-x[l], lo[l], hi[l]);
+          sp += w.p[l]*ep*ep;  sm += w.p[l]*em*em;
+        }
+        s += rai::MIN(sp, sm);
+        j+=3;
+      } break;
+    }
+  }
+  return s;
+}
+
+//===========================================================================
+
+void rai::KDTree::clear() {
+  X.clear();
+  nodes.clear();
+  boxes.clear();
+  freeNodes.clear();
+  alive.clear();
+  root=-1;
+  d=n=maxSize=0;
+}
+
+void rai::KDTree::set(const arr& _X) {
+  clear();
+  CHECK_EQ(_X.nd, 2, "");
+  X = _X;
+  d = X.d1;
+  if(w.N!=d) setMetric(ones(d));
+  n = maxSize = X.d0;
+  alive.resize(n) = 1;
+  if(!n) return;
+  uintA ids;
+  ids.setStraightPerm(n);
+  root = build(ids.p, n);
+}
+
+int rai::KDTree::newNode() {
+  if(freeNodes.N) {
+    int i=freeNodes.popLast();
+    nodes[i] = Node();
+    return i;
+  }
+  nodes.emplace_back();
+  boxes.resizeCopy(nodes.size()*2*d);
+  return nodes.size()-1;
+}
+
+int rai::KDTree::build(uint* ids, uint m) {
+  int i = newNode();
+  //-- bounding box
+  double* lo = boxes.p+2*d*i, *hi = lo+d;
+  for(uint j=0; j<d; j++) lo[j]=hi[j]=X.p[ids[0]*d+j];
+  for(uint k=1; k<m; k++) {
+    const double* x = X.p+ids[k]*d;
+    for(uint j=0; j<d; j++) { if(x[j]<lo[j]) lo[j]=x[j];  if(x[j]>hi[j]) hi[j]=x[j]; }
+  }
+  nodes[i].size = m;
+
+  //-- split the widest (weighted) dimension at the median
+  uint dim=0;
+  double spread=0.;
+  for(uint j=0; j<d; j++) {
+    double s = (hi[j]-lo[j])*::sqrt(w.p[j]);
+    if(s>spread) { spread=s;  dim=j; }
+  }
+  if(m<=leafSize || spread<=0.) { //leaf (or all points coincide)
+    nodes[i].points.setCarray(ids, m);
+    return i;
+  }
+  auto coord = [this, dim](uint id) { return X.p[id*d+dim]; };
+  std::nth_element(ids, ids+m/2, ids+m, [&coord](uint a, uint b) { return coord(a)<coord(b); });
+  double split = coord(ids[m/2]);
+  uint ml = std::partition(ids, ids+m, [&](uint a) { return coord(a)<split; }) - ids;
+  if(!ml) { //the median is the minimum: split above it instead
+    double next = hi[dim];
+    for(uint k=0; k<m; k++) if(coord(ids[k])>split && coord(ids[k])<next) next=coord(ids[k]);
+    split = next;
+    ml = std::partition(ids, ids+m, [&](uint a) { return coord(a)<split; }) - ids;
+  }
+  nodes[i].dim = dim;
+  nodes[i].split = split;
+  int l = build(ids, ml);
+  int r = build(ids+ml, m-ml);
+  nodes[i].child[0]=l;
+  nodes[i].child[1]=r;
+  return i;
+}
+
+void rai::KDTree::collect(uintA& ids, int i) {
+  Node& N = nodes[i];
+  if(N.child[0]<0) ids.append(N.points);
+  else { collect(ids, N.child[0]);  collect(ids, N.child[1]); }
+  freeNodes.append(i);
+}
+
+void rai::KDTree::rebuild(int i, int parent) {
+  uintA ids;
+  ids.reserveMEM(nodes[i].size);
+  collect(ids, i);
+  int j = ids.N ? build(ids.p, ids.N) : -1;
+  if(parent<0) root=j;
+  else {
+    Node& P = nodes[parent];
+    P.child[P.child[0]==i ? 0 : 1] = j;
+  }
+}
+
+uint rai::KDTree::add(const arr& x) {
+  if(!d) {
+    d=x.N;
+    X.resize(0, d);
+    if(w.N!=d) setMetric(ones(d));
+  }
+  CHECK_EQ(x.N, d, "point has wrong dimension");
+  uint id=X.d0;
+  X.append(x);
+  X.reshape(id+1, d);
+  alive.append(1);
+  n++;
+  if(n>maxSize) maxSize=n;
+
+  if(root<0) { root = build(&id, 1);  return id; }
+
+  //-- descend, extending boxes and counts
+  int path[128];
+  uint depth=0;
+  for(int i=root;;) {
+    CHECK_LE(depth, 127, "kd-tree degenerated");
+    path[depth++]=i;
+    double* lo = boxes.p+2*d*i, *hi = lo+d;
+    for(uint j=0; j<d; j++) { if(x.p[j]<lo[j]) lo[j]=x.p[j];  if(x.p[j]>hi[j]) hi[j]=x.p[j]; }
+    Node& N = nodes[i];
+    N.size++;
+    if(N.child[0]<0) { N.points.append(id);  break; }
+    i = N.child[x.p[N.dim]<N.split ? 0 : 1];
+  }
+
+  //-- rebuild the highest unbalanced subtree on the path, or split the leaf if it overflows
+  for(uint k=0; k<depth; k++) {
+    Node& N = nodes[path[k]];
+    if(N.child[0]<0) {
+      if(N.points.N>leafSize) rebuild(path[k], k ? path[k-1] : -1);
+      break;
+    }
+    uint s = rai::MAX(nodes[N.child[0]].size, nodes[N.child[1]].size);
+    if(N.size>2*leafSize && s>alpha*N.size) { rebuild(path[k], k ? path[k-1] : -1);  break; }
+  }
+  return id;
+}
+
+void rai::KDTree::remove(uint id) {
+  CHECK(contains(id), "point " <<id <<" is not in the tree");
+  const double* x = X.p+id*d;
+  for(int i=root;;) {
+    Node& N = nodes[i];
+    N.size--;
+    if(N.child[0]<0) { N.points.removeValue(id);  break; }
+    i = N.child[x[N.dim]<N.split ? 0 : 1];
+  }
+  alive.p[id]=0;
+  n--;
+  if(maxSize>2*leafSize && 2*n<maxSize) { //many removed: rebuild all (boxes are only shrunk by rebuilds)
+    rebuild(root, -1);
+    maxSize=n;
+  }
+}
+
+//===========================================================================
+
+void rai::KDTree::knnSearch(int i, const double* x, uint k, double f, uint* idx, double* dists, uint& m) const {
+  const Node& N = nodes[i];
+  if(N.child[0]<0) {
+    for(uint id:N.points) {
+      double s = sqrDistance(x, X.p+id*d);
+      if(m==k && s>=dists[k-1]) continue;
+      uint j = (m<k ? m++ : k-1);
+      for(; j && dists[j-1]>s; j--) { dists[j]=dists[j-1];  idx[j]=idx[j-1]; }
+      dists[j]=s;  idx[j]=id;
+    }
+    return;
+  }
+  int c[2];
+  if(x[N.dim]<N.split) { c[0]=N.child[0];  c[1]=N.child[1]; } else { c[0]=N.child[1];  c[1]=N.child[0]; }
+  for(int j:c) {
+    double worst = (m<k ? INFINITY : f*dists[k-1]);
+    if(boxBound(j, x, worst)<worst) knnSearch(j, x, k, f, idx, dists, m);
+  }
+}
+
+uint rai::KDTree::knnRaw(uint* idx, double* dists, const double* x, uint k, double eps) const {
+  uint m=0;
+  if(root>=0 && k) knnSearch(root, x, k, 1./((1.+eps)*(1.+eps)), idx, dists, m);
+  return m;
+}
+
+uint rai::KDTree::nearest(const arr& x) const {
+  CHECK_EQ(x.N, d, "query point has wrong dimension");
+  CHECK(n, "empty tree");
+  uint id;
+  double dist;
+  knnRaw(&id, &dist, x.p, 1, 0.);
+  return id;
+}
+
+void rai::KDTree::knn(uintA& idx, arr& sqrDists, const arr& x, uint k, double eps) const {
+  CHECK_EQ(x.N, d, "query point has wrong dimension");
+  idx.resize(k);
+  sqrDists.resize(k);
+  uint m = knnRaw(idx.p, sqrDists.p, x.p, k, eps);
+  idx.resizeCopy(m);
+  sqrDists.resizeCopy(m);
+}
+
+void rai::KDTree::radiusSearch(int i, const double* x, double r2, uintA& idx, arr& dists) const {
+  const Node& N = nodes[i];
+  if(N.child[0]<0) {
+    for(uint id:N.points) {
+      double s = sqrDistance(x, X.p+id*d);
+      if(s<=r2) { idx.append(id);  dists.append(s); }
+    }
+    return;
+  }
+  for(int j:N.child) if(boxBound(j, x, INFINITY)<=r2) radiusSearch(j, x, r2, idx, dists);
+}
+
+void rai::KDTree::radius(uintA& idx, arr& sqrDists, const arr& x, double r) const {
+  CHECK_EQ(x.N, d, "query point has wrong dimension");
+  uintA I;
+  arr D;
+  if(root>=0) radiusSearch(root, x.p, r*r, I, D);
+  uintA perm;
+  perm.setStraightPerm(I.N);
+  std::sort(perm.p, perm.p+perm.N, [&D](uint a, uint b) { return D.p[a]<D.p[b]; });
+  idx.resize(I.N);
+  sqrDists.resize(I.N);
+  for(uint i=0; i<I.N; i++) { idx.p[i]=I.p[perm.p[i]];  sqrDists.p[i]=D.p[perm.p[i]]; }
+}
+
+void rai::KDTree::knnBatch(uintA& idx, arr& sqrDists, const arr& Q, uint k, double eps) const {
+  CHECK(Q.nd==2 && Q.d1==d, "queries need to be rows of dimension " <<d);
+  CHECK_LE(k, n, "fewer points than neighbors requested");
+  idx.resize(Q.d0, k);
+  sqrDists.resize(Q.d0, k);
+  rai::taskPool().parallel_for(0, Q.d0, [&](uint q) {
+    knnRaw(idx.p+q*k, sqrDists.p+q*k, Q.p+q*d, k, eps);
+  }, 16);
+}
+
+void rai::KDTree::radiusBatch(Array<uintA>& idx, const arr& Q, double r) const {
+  CHECK(Q.nd==2 && Q.d1==d, "queries need to be rows of dimension " <<d);
+  idx.resize(Q.d0);
+  rai::taskPool().parallel_for(0, Q.d0, [&](uint q) {
+    arr dists;
+    radius(idx(q), dists, Q[q], r);
+  }, 16);
+}
@@ -0,0 +1,84 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "../Core/array.h"
+
+#include <vector>
+
+namespace rai {
+
+//===========================================================================
+
+/** Dynamic kd-tree for exact (or (1+eps)-approximate) nearest neighbor queries. Points get consecutive ids (rows of X)
+ *  and can be added and removed at any time: an insertion descends to a leaf and rebuilds the highest subtree it left
+ *  unbalanced (scapegoat-style), so the depth stays logarithmic without ever rebuilding the whole tree; removal takes
+ *  the point out of its leaf. Removed points stay in X but are not found anymore.
+ *  Nodes bound their points by boxes, which allows non-Euclidean metrics: per-dimension weights, angular dimensions,
+ *  and unit quaternion blocks (where q and -q are the same rotation) -- e.g., SE(3) are 3 positions and a quaternion.
+ *  Queries are const and may run concurrently (the batch variants run on rai::taskPool()), but not concurrently with
+ *  add/remove. */
+struct KDTree {
+  arr X;              ///< all points ever added; row i is the point with id i
+  uint leafSize=8;    ///< max points per leaf
+
+  KDTree() {}
+  explicit KDTree(const arr& _X) { set(_X); }
+
+  /// squared distance sum_i w_i d_i^2, with d_i wrapped to [-pi,pi] for angular dimensions; for a quaternion block
+  /// (4 dimensions starting at each entry of quaternions) the min over q and -q
+  void setMetric(const arr& weights, const uintA& angular= {}, const uintA& quaternions= {});
+
+  void clear();                   ///< removes all points (the metric is kept)
+  void set(const arr& _X);        ///< replaces all points by the rows of _X (ids 0..n-1), building a balanced tree
+  uint add(const arr& x);         ///< returns the id of the new point
+  void remove(uint id);
+  uint size() const { return n; } ///< number of points that are not removed
+  bool contains(uint id) const { return id<alive.N && alive.p[id]; }
+
+  uint nearest(const arr& x) const;
+  /// min(k,size()) nearest neighbors by ascending squared distance; eps>0: each is within (1+eps) of the true one
+  void knn(uintA& idx, arr& sqrDists, const arr& x, uint k, double eps=0.) const;
+  /// all points within distance r, by ascending squared distance
+  void radius(uintA& idx, arr& sqrDists, const arr& x, double r) const;
+  /// knn for each row of Q in parallel; idx and sqrDists are (Q.d0, k); needs k<=size()
+  void knnBatch(uintA& idx, arr& sqrDists, const arr& Q, uint k, double eps=0.) const;
+  /// radius for each row of Q in parallel
+  void radiusBatch(Array<uintA>& idx, const arr& Q, double r) const;
+
+  double sqrDistance(const double* a, const double* b) const;
+
+ private:
+  struct Node {
+    int child[2]= {-1, -1};   ///< -1: leaf
+    uint dim=0;
+    double split=0.;          ///< points with x[dim]<split are left
+    uint size=0;              ///< number of points in the subtree
+    uintA points;             ///< of a leaf
+  };
+  std::vector<Node> nodes;
+  arr boxes;                  ///< lo and hi (each of dimension d) of the points of each node
+  uintA freeNodes;
+  int root=-1;
+  uint d=0, n=0, maxSize=0;   ///< maxSize: max n since the last full build
+  byteA alive;
+  arr w;                      ///< metric weights
+  byteA kind;                 ///< metric type per dimension: 0 linear, 1 angular, 2 quaternion block start, 3 within
+
+  int newNode();
+  int build(uint* ids, uint m);
+  void rebuild(int i, int parent);
+  void collect(uintA& ids, int i);
+  double boxBound(int i, const double* x, double bound) const;
+  void knnSearch(int i, const double* x, uint k, double f, uint* idx, double* dists, uint& m) const;
+  void radiusSearch(int i, const double* x, double r2, uintA& idx, arr& dists) const;
+  uint knnRaw(uint* idx, double* dists, const double* x, uint k, double eps) const;
+};
+
+} //namespace
@@ -13,6 +13,8 @@
 template<class T> struct PriorityQueueEntry {
   double p;
   T x;
+  uint handle; ///< see PriorityQueue::add
+  int64_t seq; ///< tie breaker: insertion order (FIFO) or reversed (LIFO)
 
   void write(std::ostream& os) const { os <<'[' <<p <<": " <<*x <<']'; }
   static bool cmp(const PriorityQueueEntry<T>& a, const PriorityQueueEntry<T>& b);
@@ -29,28 +31,98 @@ template<class T> bool operator<=(const PriorityQueueEntry<T>& a, const Priority
   return a.p <= b.p;
 }
 
+/** Min-queue on p as a 4-ary heap: add and pop are O(log n). The array holds the entries in heap order (first() is the
+ *  top; iteration is unordered). Every add returns a handle, which stays valid until the entry is popped or erased and
+ *  allows to change its priority (decrease-key) or to erase it -- instead of adding duplicates. Handles of popped or
+ *  erased entries are reused by later adds, so handles stay below the largest queue size. */
 template<class T> struct PriorityQueue : rai::Array<PriorityQueueEntry<T>> {
+  typedef rai::Array<PriorityQueueEntry<T>> Base;
+
   PriorityQueue() {
-    rai::Array<PriorityQueueEntry<T>>::memMove = true;
+    Base::memMove = true;
   }
 
-  void add(double p, const T& x, bool fromBackIfEqual=false) { //'fromBack=true' makes it a FIFO (breadth first search); otherwise LIFO (depth first search)
-    PriorityQueueEntry<T> e = {p, x};
-    rai::Array<PriorityQueueEntry<T>>::insertInSorted(e, PriorityQueueEntry<T>::cmp, fromBackIfEqual);
+  /// 'fromBack=true' makes it a FIFO among equal priorities (breadth first search); otherwise LIFO (depth first search)
+  uint add(double p, const T& x, bool fromBackIfEqual=false) {
+    uint h;
+    if(freeHandles.N) { h = freeHandles.popLast();  pos.p[h] = Base::N; }
+    else { h = pos.N;  pos.append(Base::N); }
+    count++;
+    Base::append(PriorityQueueEntry<T>{p, x, h, fromBackIfEqual ? count : -count});
+    siftUp(Base::N-1);
+    return h;
   }
 
   T pop() {
-    T x=rai::Array<PriorityQueueEntry<T>>::first().x;
-    rai::Array<PriorityQueueEntry<T>>::remove(0);
+    T x=Base::first().x;
+    erase(Base::first().handle);
     return x;
   }
 
-  //  void add_replace(double p, const T& x){
-  //    PriorityQueueEntry<T> e = {p, x};
-  //    uint pos = rankInSorted(e, cmp_PriorityQueueEntry);
-  //    PriorityQueueEntry<T>& e_after = elem(pos);
-  //    if(e_after.x==e.x){
-  //      if(e_after)
-  //      e_after.p =
-  //  }
+  bool contains(uint handle) const { return handle<pos.N && pos.p[handle]!=UINT_MAX; }
+
+  PriorityQueueEntry<T>& entry(uint handle) { CHECK(contains(handle), "");  return Base::elem(pos.p[handle]); }
+
+  /// change the priority of an entry (decrease or increase)
+  void update(uint handle, double p) {
+    uint i = pos(handle);
+    CHECK(i!=UINT_MAX, "entry is not in the queue");
+    double old = Base::elem(i).p;
+    Base::elem(i).p = p;
+    if(p<old) siftUp(i); else siftDown(i);
+  }
+
+  void erase(uint handle) {
+    uint i = pos(handle);
+    CHECK(i!=UINT_MAX, "entry is not in the queue");
+    pos(handle) = UINT_MAX;
+    freeHandles.append(handle);
+    uint last = Base::N-1;
+    if(i!=last) {
+      Base::elem(i) = Base::elem(last);
+      pos(Base::elem(i).handle) = i;
+    }
+    Base::resizeCopy(last);
+    if(i<last) { siftUp(i);  siftDown(i); }
+  }
+
+  void clear() { Base::clear();  pos.clear();  freeHandles.clear(); }
+
+ private:
+  uintA pos; //for each handle the heap index, UINT_MAX if popped or erased
+  uintA freeHandles; //handles of popped or erased entries, to be reused
+  int64_t count=0;
+
+  static bool before(const PriorityQueueEntry<T>& a, const PriorityQueueEntry<T>& b) {
+    return a.p<b.p || (a.p==b.p && a.seq<b.seq);
+  }
+
+  void place(uint i, PriorityQueueEntry<T>& e) {
+    Base::elem(i) = e;
+    pos.p[e.handle] = i;
+  }
+
+  void siftUp(uint i) {
+    PriorityQueueEntry<T> e = Base::elem(i);
+    while(i>0) {
+      uint parent = (i-1)/4;
+      if(!before(e, Base::elem(parent))) break;
+      place(i, Base::elem(parent));
+      i = parent;
+    }
+    place(i, e);
+  }
+
+  void siftDown(uint i) {
+    PriorityQueueEntry<T> e = Base::elem(i);
+    for(;;) {
+      uint c = 4*i+1, best=i;
+      const PriorityQueueEntry<T>* b = &e;
+      for(uint k=c; k<c+4 && k<Base::N; k++) if(before(Base::elem(k), *b)) { best=k;  b=&Base::elem(k); }
+      if(best==i) break;
+      place(i, Base::elem(best));
+      i = best;
+    }
+    place(i, e);
+  }
 };
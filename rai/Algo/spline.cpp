@@ -7,19 +7,139 @@
     --------------------------------------------------------------  */
 
 #include "spline.h"
+#include "../Core/taskPool.h"
+
+#include <algorithm>
+
+namespace rai {
 
 //==============================================================================
 //
-// Spline
+// PiecewisePolynomial
 //
 
-namespace rai {
+PiecewisePolynomial& PiecewisePolynomial::operator=(const PiecewisePolynomial& pp) {
+  degree = pp.degree;
+  times = pp.times;
+  coeffs = pp.coeffs;
+  holdStill = pp.holdStill;
+  hint = 0;
+  return *this;
+}
+
+void PiecewisePolynomial::resize(uint S, uint _degree, uint n) {
+  degree = _degree;
+  times.resize(S+1);
+  coeffs.resize(S, degree+1, n);
+  hint = 0;
+}
+
+void PiecewisePolynomial::clear() {
+  times.clear();
+  coeffs.clear();
+  hint = 0;
+}
+
+uint PiecewisePolynomial::segment(double t, uint h) const {
+  uint S = segments();
+  const double* tp = times.p;
+  if(h>=S) h=0;
+  if(tp[h]<=t) { //the same or the next segment
+    if(h+1==S || t<tp[h+1]) return h;
+    if(h+2==S || t<tp[h+2]) return h+1;
+  }
+  uint s = std::upper_bound(tp, tp+S, t) - tp;
+  return s ? s-1 : 0;
+}
+
+uint PiecewisePolynomial::segment(double t) const {
+  uint h = hint.load(std::memory_order_relaxed);
+  uint s = segment(t, h);
+  if(s!=h) hint.store(s, std::memory_order_relaxed);
+  return s;
+}
+
+void PiecewisePolynomial::evalRaw(double* x, double* xDot, double* xDDot, double t, uint s) const {
+  uint n = dim(), p = degree;
+  const double* c = coeffs.p + s*(p+1)*n;
+  bool outside = t<times.p[0] || t>times.p[segments()];
+  double tau = t - times.p[s];
+  if(tau<0.) tau=0.;
+  if(tau>times.p[s+1]-times.p[s]) tau=times.p[s+1]-times.p[s];
+
+  //Horner schemes for the value and the derivatives
+  if(x) {
+    for(uint k=0; k<n; k++) x[k] = c[p*n+k];
+    for(uint d=p; d--;) {
+      const double* cd = c+d*n;
+      for(uint k=0; k<n; k++) x[k] = x[k]*tau + cd[k];
+    }
+  }
+  if(xDot) {
+    if(!p || (outside && holdStill)) {
+      for(uint k=0; k<n; k++) xDot[k] = 0.;
+    } else {
+      for(uint k=0; k<n; k++) xDot[k] = p*c[p*n+k];
+      for(uint d=p; --d;) {
+        const double* cd = c+d*n;
+        for(uint k=0; k<n; k++) xDot[k] = xDot[k]*tau + d*cd[k];
+      }
+    }
+  }
+  if(xDDot) {
+    if(p<2 || outside) {
+      for(uint k=0; k<n; k++) xDDot[k] = 0.;
+    } else {
+      for(uint k=0; k<n; k++) xDDot[k] = p*(p-1)*c[p*n+k];
+      for(uint d=p-1; d>=2; d--) {
+        const double* cd = c+d*n;
+        for(uint k=0; k<n; k++) xDDot[k] = xDDot[k]*tau + d*(d-1)*cd[k];
+      }
+    }
+  }
+}
+
+void PiecewisePolynomial::eval(arr& x, arr& xDot, arr& xDDot, double t) const {
+  CHECK(segments(), "spline is empty");
+  uint n = dim();
+  if(!!x && (x.nd!=1 || x.N!=n)) x.resize(n);
+  if(!!xDot && (xDot.nd!=1 || xDot.N!=n)) xDot.resize(n);
+  if(!!xDDot && (xDDot.nd!=1 || xDDot.N!=n)) xDDot.resize(n);
+  evalRaw(!!x ? x.p : 0, !!xDot ? xDot.p : 0, !!xDDot ? xDDot.p : 0, t, segment(t));
+}
+
+void PiecewisePolynomial::eval(arr& X, arr& XDot, arr& XDDot, const arr& ts) const {
+  CHECK(segments(), "spline is empty");
+  uint n = dim(), T = ts.N;
+  if(!!X && (X.nd!=2 || X.d0!=T || X.d1!=n)) X.resize(T, n);
+  if(!!XDot && (XDot.nd!=2 || XDot.d0!=T || XDot.d1!=n)) XDot.resize(T, n);
+  if(!!XDDot && (XDDot.nd!=2 || XDDot.d0!=T || XDDot.d1!=n)) XDDot.resize(T, n);
+  double* x = !!X ? X.p : 0;
+  double* xDot = !!XDot ? XDot.p : 0;
+  double* xDDot = !!XDDot ? XDDot.p : 0;
+  auto block = [&](uint b0, uint b1) {
+    uint s = segment(ts.p[b0], 0);
+    for(uint i=b0; i<b1; i++) {
+      s = segment(ts.p[i], s);
+      evalRaw(x ? x+i*n : 0, xDot ? xDot+i*n : 0, xDDot ? xDDot+i*n : 0, ts.p[i], s);
+    }
+  };
+  const uint B=1024;
+  if(T<=B) block(0, T);
+  else taskPool().parallel_for(0, (T+B-1)/B, [&](uint b) { block(b*B, std::min(T, (b+1)*B)); }, 1);
+}
+
+//==============================================================================
+//
+// Spline
+//
 
 void Spline::clear() {
   points.clear();
   times.clear();
   knotPoints.clear();
   knotTimes.clear();
+  pp.clear();
 }
 
 arr Spline::getCoeffs(double t, uint K, uint derivative) const {
@@ -107,43 +227,6 @@ void Spline::getCoeffs2(arr& b, arr& db, arr& ddb, double t, uint degree, double
   }
 }
 
-void Spline::eval(arr& x, arr& xDot, arr& xDDot, double t) const {
-#if 0 //computing coeffs for ALL knot points (most zero...)
-//  uint K = knotPoints.d0-1;
-//  arr coeffs = getCoeffs(t, K, derivative);
-  arr coeffs = getCoeffs2(t, degree, knotTimes.p, knotPoints.d0, knotTimes.N, derivative);
-  return (~coeffs * knotPoints).reshape(knotPoints.d1);
-#else //pick out only the LOCAL knot points
-
-  //find the first knotTime >t
-  int offset = knotTimes.rankInSorted(t, rai::lowerEqual<double>, true);
-  offset -= degree+1;
-  if(offset<0) offset=0;
-
-  uint knotN = degree+1;
-  uint knotTimesN = knotN + 1+degree;
-  if(offset+knotTimesN>knotTimes.N) offset = knotTimes.N - knotTimesN;
-
-  //get coeffs
-  arr b, db, ddb;
-  uint derivative=0;
-  if(!!xDot) derivative=1;
-  if(!!xDDot) derivative=2;
-  getCoeffs2(b, db, ddb, t, degree, knotTimes.p+offset, knotN, knotTimesN, derivative);
-
-  //linear combination
-  uint n = knotPoints.d1;
-  if(!!x) x.resize(n).setZero();
-  if(!!xDot) xDot.resize(n).setZero();
-  if(!!xDDot) xDDot.resize(n).setZero();
-  for(uint j=0;j<b.N;j++){
-    if(!!x) for(uint k=0;k<n;k++) x.elem(k) += b.elem(j)*knotPoints(offset+j,k);
-    if(!!xDot) for(uint k=0;k<n;k++) xDot.elem(k) += db.elem(j)*knotPoints(offset+j,k);
-    if(!!xDDot) for(uint k=0;k<n;k++) xDDot.elem(k) += ddb.elem(j)*knotPoints(offset+j,k);
-  }
-#endif
-}
-
 arr Spline::eval(double t, uint derivative) const{
   arr x;
   if(derivative==0) eval(x, NoArr, NoArr, t);
@@ -153,12 +236,68 @@ arr Spline::eval(double t, uint derivative) const{
   return x;
 }
 
-arr Spline::eval(const arr& ts){
-  arr f(ts.N, points.d1);
-  for(uint i=0;i<ts.N;i++) f[i] = eval(ts(i));
+arr Spline::eval(const arr& ts) const {
+  arr f;
+  pp.eval(f, NoArr, NoArr, ts);
   return f;
 }
 
+void Spline::precompute() {
+  if(!knotPoints.N) { pp.clear(); return; }
+  uint K = knotPoints.d0, n = knotPoints.d1, p = degree;
+  const double* kt = knotTimes.p;
+
+  //the non-empty knot intervals [kt[j], kt[j+1]); a spline without any is constant
+  uintA J;
+  for(uint j=p; j<K; j++) if(kt[j+1]>kt[j]) J.append(j);
+  if(!J.N) {
+    pp.resize(1, 0, n);
+    pp.times = kt[0];
+    for(uint k=0; k<n; k++) pp.coeffs.p[k] = knotPoints(0, k);
+    pp.holdStill = true;
+    return;
+  }
+
+  pp.resize(J.N, p, n);
+  pp.holdStill = true;
+  arr P(p+1, p+1), Q(p+1, p+1);
+  for(uint s=0; s<J.N; s++) {
+    uint j = J(s);
+    double tj = kt[j];
+    pp.times(s) = tj;
+    pp.times(s+1) = kt[j+1];
+
+    //Cox-de Boor on polynomials in tau=t-tj: P(l,d) is the coefficient of tau^d of the basis function j-p+l
+    P.setZero();
+    P(p, 0) = 1.;
+    for(uint q=1; q<=p; q++) {
+      Q.setZero();
+      for(uint l=p-q; l<=p; l++) {
+        uint i = j-p+l;
+        double den = kt[i+q]-kt[i];
+        if(den) { //(tau + tj - t_i)/den * N_{i,q-1}
+          double a0 = (tj-kt[i])/den, a1 = 1./den;
+          for(uint d=0; d<=q; d++) Q(l, d) += a0*P(l, d) + (d ? a1*P(l, d-1) : 0.);
+        }
+        den = kt[i+q+1]-kt[i+1];
+        if(l<p && den) { //(t_{i+q+1} - tj - tau)/den * N_{i+1,q-1}
+          double b0 = (kt[i+q+1]-tj)/den, b1 = -1./den;
+          for(uint d=0; d<=q; d++) Q(l, d) += b0*P(l+1, d) + (d ? b1*P(l+1, d-1) : 0.);
+        }
+      }
+      P = Q;
+    }
+
+    //combine with the knot points
+    double* c = pp.coeffs.p + s*(p+1)*n;
+    for(uint d=0; d<=p; d++) for(uint k=0; k<n; k++) {
+        double sum=0.;
+        for(uint l=0; l<=p; l++) sum += P(l, d)*knotPoints(j-p+l, k);
+        c[d*n+k] = sum;
+      }
+  }
+}
+
 Spline& Spline::set(uint _degree, const arr& _points, const arr& _times, const arr& startVel, const arr& endVel) {
   CHECK_EQ(_times.nd, 1, "");
   CHECK_LE(_points.nd, 2, "");
@@ -194,6 +333,7 @@ Spline& Spline::set(uint _degree, const arr& _points, const arr& _times, const a
 
   CHECK_EQ(knotPoints.d0, knotTimes.N-degree-1 , "");
 
+  precompute();
   return *this;
 }
 
@@ -259,6 +399,7 @@ void Spline::append(const arr& _points, const arr& _times){
   knotTimes.append(_times(-1)+Tend,1+2*(degree/2));
 
   CHECK_EQ(knotPoints.d0, knotTimes.N-degree-1 , "");
+  precompute();
 }
 
 
@@ -267,6 +408,7 @@ void Spline::doubleKnot(uint t){
   knotPoints[t+degree/2] = points[t];
 
   knotTimes.insert(t+degree+1,times(t));
+  precompute();
 }
 
 void Spline::setDoubleKnotVel(int t, const arr& vel){
@@ -276,6 +418,7 @@ void Spline::setDoubleKnotVel(int t, const arr& vel){
   CHECK(maxDiff(a,b)<1e-10,"this is not a double knot!");
   a -= vel*.5*(knotTimes(t+degree+1)-knotTimes(t+degree));
   b += vel*.5*(knotTimes(t+degree+2)-knotTimes(t+degree+1));
+  precompute();
 }
 
 //==============================================================================
@@ -295,6 +438,7 @@ void Path::transform_CurrentBecomes_EndFixed(const arr& current, double t) {
     double a = (1.-ti)/(1.-t);
     knotPoints[i]() += a*delta;
   }
+  precompute();
 }
 
 void Path::transform_CurrentFixed_EndBecomes(const arr& end, double t) {
@@ -304,11 +448,13 @@ void Path::transform_CurrentFixed_EndBecomes(const arr& end, double t) {
     double a = (ti-t)/(1.-t);
     knotPoints[i]() += a*delta;
   }
+  precompute();
 }
 
 void Path::transform_CurrentBecomes_AllFollow(const arr& current, double t) {
   arr delta = current - eval(t);
   for(uint i=0; i<knotPoints.d0; i++) knotPoints[i]() += delta;
+  precompute();
 }
 
 //==============================================================================
@@ -340,6 +486,21 @@ void CubicPiece::eval(arr& x, arr& xDot, arr& xDDot, double t) const {
   }
 }
 
+//pieces(k) as segment k of pp (d, c, b, a are the coefficients of tau^0..3)
+static void setPolynomial(PiecewisePolynomial& pp, const Array<CubicPiece>& pieces, const arr& times) {
+  uint n = pieces.first().d.N;
+  pp.resize(pieces.N, 3, n);
+  pp.times = times;
+  for(uint s=0; s<pieces.N; s++) {
+    const CubicPiece& P = pieces(s);
+    double* c = pp.coeffs.p + s*4*n;
+    memmove(c, P.d.p, n*sizeof(double));
+    memmove(c+n, P.c.p, n*sizeof(double));
+    memmove(c+2*n, P.b.p, n*sizeof(double));
+    memmove(c+3*n, P.a.p, n*sizeof(double));
+  }
+}
+
 void CubicSpline::set(const arr& pts, const arr& vels, const arr& _times){
   CHECK_GE(_times.N, 2, "need at least 2 knots");
   times = _times;
@@ -348,6 +509,7 @@ void CubicSpline::set(const arr& pts, const arr& vels, const arr& _times){
   for(uint k=0;k<K;k++){
     pieces(k).set(pts[k], vels[k], pts[k+1], vels[k+1], times(k+1)-times(k));
   }
+  setPolynomial(pp, pieces, times);
 }
 
 void CubicSpline::append(const arr& pts, const arr& vels, const arr& _times){
@@ -368,31 +530,13 @@ void CubicSpline::append(const arr& pts, const arr& vels, const arr& _times){
   for(uint k=1;k<K;k++){
     pieces(K0+k).set(pts[k-1], vels[k-1], pts[k], vels[k], _times(k)-_times(k-1));
   }
+  setPolynomial(pp, pieces, times);
 }
 
 
 void CubicSpline::eval(arr& x, arr& xDot, arr& xDDot, double t) const {
   CHECK_GE(times.N, 2, "spline is empty");
-  if(t<times(0)){
-    pieces(0).eval(x, xDot, xDDot, 0.);
-    if(!!xDDot) xDDot.setZero();
-    return;
-  }
-  if(t>times(-1)){
-    pieces(-1).eval(x, xDot, xDDot, times(-1)-times(-2));
-    if(!!xDDot) xDDot.setZero();
-    return;
-  }
-
-  uint k = times.rankInSorted(t,rai::lowerEqual<double>, false);
-  if(k<times.N){ CHECK_LE(t, times(k), ""); }
-  else{ CHECK_GE(t, times.last(), ""); }
-  if(k) k--;
-  if(k>=pieces.N-1) k=pieces.N-1;
-  //    CHECK_GE(t, times(k), "");
-  //    cout <<"t: " <<t <<" k: " <<k <<' ' <<times <<endl;
-
-  pieces(k).eval(x, xDot, xDDot, t-times(k));
+  pp.eval(x, xDot, xDDot, t);
 }
 
 arr CubicSpline::eval(double t, uint diff) const{
@@ -405,8 +549,8 @@ arr CubicSpline::eval(double t, uint diff) const{
 }
 
 arr CubicSpline::eval(const arr& T) const{
-  arr x(T.N, pieces.first().d.N);
-  for(uint i=0;i<T.N;i++) x[i] = eval(T(i));
+  arr x;
+  pp.eval(x, NoArr, NoArr, T);
   return x;
 }
 
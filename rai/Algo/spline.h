@@ -10,15 +10,57 @@
 
 #include "../Core/array.h"
 
+#include <atomic>
+
 namespace rai {
 
 //==============================================================================
 
+/** The evaluation engine of the splines below: S polynomial segments of a given degree, with the coefficients of all
+ *  segments and dimensions in one contiguous array. Segment lookup remembers the last segment, so that monotone time
+ *  queries (a control loop, a time grid) cost O(1); evaluation writes into preallocated outputs without allocation and
+ *  runs over the dimensions in innermost (vectorizable) loops. */
+struct PiecewisePolynomial {
+  uint degree=0;
+  arr times;              ///< S+1 non-decreasing breakpoints
+  arr coeffs;             ///< (S, degree+1, n): in segment s, f(t) = sum_d coeffs(s,d,:) (t-times(s))^d
+  bool holdStill=false;   ///< outside [begin,end] f is held at the boundary with zero acceleration, and, if holdStill, zero velocity
+
+  PiecewisePolynomial() {}
+  PiecewisePolynomial(const PiecewisePolynomial& pp) { *this=pp; }
+  PiecewisePolynomial& operator=(const PiecewisePolynomial& pp);
+
+  void resize(uint S, uint _degree, uint n);
+  void clear();
+  uint segments() const { return coeffs.d0; }
+  uint dim() const { return coeffs.d2; }
+  double begin() const { return times.first(); }
+  double end() const { return times.last(); }
+
+  /// the segment s with times(s)<=t<times(s+1) (clamped to the first and last); starts searching at the last result
+  uint segment(double t) const;
+  uint segment(double t, uint hint) const;
+
+  /// x, xDot, xDDot may be NoArr; they are only resized if they don't have dimension dim() already
+  void eval(arr& x, arr& xDot, arr& xDDot, double t) const;
+  /// all times of ts at once (ts in any order, sorted is fastest); outputs are (ts.N, dim()), large grids in parallel
+  void eval(arr& X, arr& XDot, arr& XDDot, const arr& ts) const;
+
+  /// raw version: the outputs are dim() doubles (or nullptr)
+  void evalRaw(double* x, double* xDot, double* xDDot, double t, uint s) const;
+
+ private:
+  mutable std::atomic<uint> hint= {0};
+};
+
+//==============================================================================
+
 /// a spline
 struct Spline {
   uint degree;
   arr points, times; ///< the points and times as provided by the user
   arr knotPoints, knotTimes; ///< the points and times with (non-intuitive) head and tail added depending on degree
+  PiecewisePolynomial pp;    ///< the polynomial segments between the knots, as evaluated by eval
 
   //-- methods to define the points and times
   Spline& set(uint degree, const arr& _points, const arr& _times, const arr& startVel=NoArr, const arr& endVel=NoArr);
@@ -34,9 +76,13 @@ struct Spline {
   void setDoubleKnotVel(int t, const arr& vel);
 
   /// core method to evaluate spline
-  void eval(arr& x, arr& xDot, arr& xDDot, double t) const;
+  void eval(arr& x, arr& xDot, arr& xDDot, double t) const { pp.eval(x, xDot, xDDot, t); }
   arr eval(double t, uint derivative=0) const;
-  arr eval(const arr& ts);
+  arr eval(const arr& ts) const;
+  void eval(arr& X, arr& XDot, arr& XDDot, const arr& ts) const { pp.eval(X, XDot, XDDot, ts); }
+
+  /// recomputes pp from knotPoints and knotTimes; all methods above do this, call it after modifying them directly
+  void precompute();
 
   /// for t \in [0,1] the coefficients are the weighting of the points: f(t) = coeffs(t)^T * points
   arr getCoeffs(double t, uint K, uint derivative=0) const;
@@ -66,6 +112,7 @@ struct CubicSplineCtor{ arr pts, vels, times; };
 struct CubicSpline{
   rai::Array<CubicPiece> pieces;
   arr times;
+  PiecewisePolynomial pp;  ///< the pieces in contiguous memory, as evaluated by eval
 
   void set(const arr& pts, const arr& vels, const arr& _times);
   void append(const arr& pts, const arr& vels, const arr& _times);
@@ -73,6 +120,7 @@ struct CubicSpline{
   void eval(arr& x, arr& xDot, arr& xDDot, double t) const;
   arr eval(double t, uint diff=0) const;
   arr eval(const arr& T) const;
+  void eval(arr& X, arr& XDot, arr& XDDot, const arr& T) const { pp.eval(X, XDot, XDDot, T); }
 
   double begin() const { return times.first(); }
   double end() const { return times.last(); }
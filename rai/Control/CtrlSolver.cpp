@@ -16,6 +16,7 @@ CtrlSolver::CtrlSolver(const rai::Configuration& _C, double _tau, uint k_order)
   komo.setModel(_C, true);
   komo.setTiming(1., 1, _tau, k_order);
   komo.setupPathConfig();
+  useQP = rai::getParameter<bool>("CtrlSolver/useQP", false);
 }
 
 CtrlSolver::~CtrlSolver(){
@@ -115,6 +116,7 @@ void CtrlSolver::report(std::ostream& os) {
 static int animate=0;
 
 arr CtrlSolver::solve() {
+  if(useQP) return solve_QP();
 #if 0
   TaskControlMethods M(komo.getConfiguration_t(0).getHmetric());
   arr q = komo.getConfiguration_t(0).getJointState();
@@ -152,3 +154,117 @@ arr CtrlSolver::solve() {
   return solve_optim(*this);
 #endif
 }
+
+arr CtrlSolver::solve_QP() {
+  //-- ground the objectives in komo only if the set of active objectives changed (targets are changed in-place in the features)
+  bool changed = !qp_mp;
+  uint n=0;
+  for(auto& o: objectives) if(o->active) {
+    if(n>=qp_objectives.N || qp_objectives(n)!=o.get()) changed=true;
+    n++;
+  }
+  if(n!=qp_objectives.N) changed=true;
+  if(changed) {
+    qp_objectives.clear();
+    komo.clearObjectives();
+    for(auto& o: objectives) if(o->active) {
+      komo.addObjective({}, o->feat, {}, o->type);
+      qp_objectives.append(o.get());
+    }
+    komo.solver = rai::KS_dense;
+    qp_mp = komo.mp_SparseNonFactored();
+    qp_mp->getBounds(qp_lo, qp_up);
+    qp.clearWarmStart();
+  }
+  if(changed || qp_nFrames!=komo.pathConfig.frames.N) {
+    rai::Configuration& P = komo.pathConfig;
+    auto sliceDofs = [&](int t) { return P.getDofs(P.getFrames(komo.orgJointIndices + komo.timeSlices(komo.k_order+t, 0)->ID), false); };
+    qp_dofs0 = sliceDofs(0);
+    qp_dofs1 = sliceDofs(-1);
+    if(komo.k_order>=2) qp_dofs2 = sliceDofs(-2); else qp_dofs2.clear();
+    qp_nFrames = P.frames.N;
+  }
+  if(!optReport["qp_converged"]) { //the full solve() replaces the report
+    optReport.clear();
+    optReport.newNode<double>({"qp_iters"}, {}, 0.);
+    optReport.newNode<double>({"qp_primalResidual"}, {}, 0.);
+    optReport.newNode<double>({"qp_dualResidual"}, {}, 0.);
+    optReport.newNode<bool>({"qp_converged"}, {}, false);
+  }
+
+  //-- the QP over the step dx has n variables, qp_m linearized constraints and n box rows; resize only if that changed
+  rai::Configuration& P = komo.pathConfig;
+  arr& x = qp_x;
+  x = P.getJointState();
+  n = x.N;
+  if(changed || qp.H.d0!=n || qp.A.d0!=qp_m+n) {
+    qp.resize(n, qp_m+n);
+    for(uint j=0; j<n; j++) qp.A(qp_m+j, j) = 1.;
+  } else {
+    qp.H.setZero();
+    qp.g.setZero();
+  }
+
+  //-- linearize all objectives once at the current state, folding them directly into the QP:
+  //   sos features enter the Hessian J^T J, eq/ineq features are linearized constraints
+  komo.set_x(x); //(as the MathematicalProgram's evaluate: also updates collisions)
+  P.jacMode = rai::Configuration::JM_dense;
+  double* H=qp.H.p, *g=qp.g.p;
+  uint m=qp_m, c=0;
+  for(shared_ptr<GroundedObjective>& ob: komo.objs) {
+    arr y = ob->feat->eval(ob->frames);
+    if(!y.N) continue;
+    CHECK(y.jac && !isSpecial(y.J()), "solve_QP needs dense feature Jacobians");
+    const arr& J = y.J();
+    CHECK_EQ(J.d1, n, "");
+    if(ob->type==OT_sos) {
+      for(uint i=0; i<y.N; i++) {
+        const double* Ji = J.p + i*n;
+        double phi_i = y.p[i];
+        for(uint j=0; j<n; j++) {
+          if(!Ji[j]) continue;
+          g[j] += phi_i*Ji[j];
+          for(uint k=j; k<n; k++) H[j*n+k] += Ji[j]*Ji[k];
+        }
+      }
+    } else if(ob->type==OT_eq || ob->type==OT_ineq) {
+      for(uint i=0; i<y.N; i++, c++) if(c<m) {
+        memmove(qp.A.p+c*n, J.p+i*n, n*sizeof(double));
+        qp.up.p[c] = -y.p[i];
+        qp.lo.p[c] = (ob->type==OT_eq ? -y.p[i] : -INFINITY);
+      }
+    }
+  }
+  if(c!=m) { qp_m=c;  return solve_QP(); } //the number of constraints changed: resize and redo this tick
+  for(uint j=0; j<n; j++) H[j*n+j] += damping;
+
+  //-- box rows: joint limits (if up>=lo), velocity and acceleration bounds as in CtrlProblem_MathematicalProgram
+  arr& q_1 = qp_q1, &q_2 = qp_q2;
+  komo.pathConfig.getDofState(q_1, qp_dofs1);
+  if(komo.k_order>=2) komo.pathConfig.getDofState(q_2, qp_dofs2); else q_2.clear();
+  for(uint j=0; j<n; j++) {
+    double lo=-INFINITY, up=INFINITY;
+    if(qp_up(j)>=qp_lo(j)) { lo=qp_lo(j); up=qp_up(j); }
+    if(q_1.N==n) {
+      lo = rai::MAX(lo, q_1(j) - maxVel*tau);
+      up = rai::MIN(up, q_1(j) + maxVel*tau);
+      if(q_2.N==n) {
+        lo = rai::MAX(lo, 2.*q_1(j) - q_2(j) - maxAcc*tau*tau);
+        up = rai::MIN(up, 2.*q_1(j) - q_2(j) + maxAcc*tau*tau);
+      }
+    }
+    qp.lo(m+j) = lo - x(j);
+    qp.up(m+j) = up - x(j);
+  }
+
+  //-- solve (warm started from the previous step) and apply the step
+  bool converged = qp.solve();
+  x += qp.x;
+  komo.set_x(x);
+
+  optReport.get<double>("qp_iters") = qp.iters;
+  optReport.get<double>("qp_primalResidual") = qp.primalResidual;
+  optReport.get<double>("qp_dualResidual") = qp.dualResidual;
+  optReport.get<bool>("qp_converged") = converged;
+  return komo.pathConfig.getDofState(qp_dofs0);
+}
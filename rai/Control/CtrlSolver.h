@@ -12,6 +12,7 @@
 #include "CtrlSet.h"
 
 #include "../KOMO/komo.h"
+#include "../Optim/denseQP.h"
 
 //===========================================================================
 
@@ -24,6 +25,18 @@ struct CtrlSolver : NonCopyable {
 
   rai::Array<shared_ptr<CtrlObjective>> objectives;    ///< list of objectives
 
+  //-- condensed QP fast path (see solve_QP)
+  bool useQP=false;       ///< solve() linearizes once and solves a dense QP instead of running the full KOMO optimizer
+  double damping=1e-1;    ///< regularization of the QP Hessian (as the Newton damping of the full solve)
+  DenseQP qp;
+  shared_ptr<MathematicalProgram> qp_mp;
+  rai::Array<CtrlObjective*> qp_objectives; ///< the active objectives that komo is currently grounded with
+  arr qp_lo, qp_up;
+  arr qp_x, qp_q1, qp_q2;   ///< per-tick work arrays, reused across solve_QP calls
+  uint qp_m=0;              ///< number of linearized eq/ineq constraints (the QP is only resized when it changes)
+  DofL qp_dofs0, qp_dofs1, qp_dofs2; ///< dofs of the current and previous slices, cached while the pathConfig is unchanged
+  uint qp_nFrames=0;
+
   CtrlSolver(const rai::Configuration& _C, double _tau, uint k_order=1);
   ~CtrlSolver();
 
@@ -34,5 +47,6 @@ struct CtrlSolver : NonCopyable {
   void update(const arr& q_real, const arr& qDot_real, rai::Configuration& C);
   void report(ostream& os=std::cout);
   arr solve();
+  arr solve_QP();
 
 };
@@ -63,3 +63,26 @@ void LeapMPC::solve(){
   xT = komo.getConfiguration_qOrg(komo.T-1); //the last one
   tau = komo.getPath_tau();
 }
+
+void LeapMPC::solve_realtime(double timeBudget, uint maxNewtonSteps){
+  double start = rai::realTime();
+  if(!rt_opt){
+    rai::OptOptions opt;
+    opt.stopTolerance = 1e-4;
+    opt.stopGTolerance = 1e-4;
+    opt.verbose = 0;
+    komo.opt.verbose = 0;
+    komo.run_prepare(0.);
+    rt_mp = komo.mp_SparseNonFactored();
+    rt_opt = make_shared<OptConstrained>(komo.x, komo.dual, rt_mp, opt);
+  }else{
+    //warm start: the previous iterate, with the (re-initialized) prefix synced into x
+    komo.x = komo.pathConfig.getJointState();
+  }
+
+  rt_opt->runRealtime(timeBudget-(rai::realTime()-start), maxNewtonSteps); //the setup above counts against the budget
+
+  x1 = komo.getConfiguration_qOrg(0);
+  xT = komo.getConfiguration_qOrg(komo.T-1);
+  tau = komo.getPath_tau();
+}
@@ -3,16 +3,22 @@
 #include "CtrlSet.h"
 #include "../Kin/F_LeapCost.h"
 #include "../KOMO/komo.h"
+#include "../Optim/constrained.h"
 
 struct LeapMPC{
   KOMO komo;
   //for info only:
   arr x1, xT, tau;
 
+  //real-time iteration: persistent problem & solver over komo.x
+  shared_ptr<MathematicalProgram> rt_mp;
+  shared_ptr<OptConstrained> rt_opt;
+
   LeapMPC(rai::Configuration& C, double timingScale=1.);
 
   void reinit(const arr& x, const arr& v);
   void reinit(const rai::Configuration& C);
 
   void solve();
+  void solve_realtime(double timeBudget=1e-3, uint maxNewtonSteps=1);
 };
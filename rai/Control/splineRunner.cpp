@@ -35,8 +35,8 @@ arr SplineRunner::run(double dt, arr& qref_dot) {
     //read out the new reference
     phase += dt;
     double maxPhase = refSpline.knotTimes.last();
-    arr q_ref = refSpline.eval(phase);
-    if(!!qref_dot) qref_dot = refSpline.eval(phase, 1);
+    arr q_ref;
+    refSpline.eval(q_ref, qref_dot, NoArr, phase);
     if(phase>maxPhase) { //clear spline buffer
       q_ref = refPoints[-1];
       stop();
@@ -1,6 +1,8 @@
 #include "timingMPC.h"
 #include "timingOpt.h"
 #include "../Optim/MP_Solver.h"
+#include "../Optim/constrained.h"
+#include "../Optim/optimization.h"
 
 TimingMPC::TimingMPC(const arr& _waypoints, double _timeCost, double _ctrlCost)
   : waypoints(_waypoints),
@@ -53,6 +55,74 @@ shared_ptr<SolverReturn> TimingMPC::solve(const arr& x0, const arr& v0, int verb
   return ret;
 }
 
+shared_ptr<SolverReturn> TimingMPC::solve_realtime(const arr& x0, const arr& v0, double timeBudget, uint maxNewtonSteps, int verbose){
+  CHECK(!done(), "");
+  double start = rai::realTime();
+  double time = -rai::cpuTime();
+  if(!vels.N){
+    vels = zeros(waypoints.d0-1, waypoints.d1);
+    if(tangents.N) vels=zeros(waypoints.d0-1);
+  }
+
+  uint K = waypoints.d0-phase;
+  uint vStride = vels.d0 ? vels.N/vels.d0 : 0;
+
+  uint nTangents = tangents.N ? tangents.N - phase*tangents.d1 : 0;
+  if(!rt_opt || rt_phase!=phase || rt_mp->tangents.N!=nTangents){
+    //(re)build the problem structure -- only when the phase (or the use of tangents) changed
+    rt_mp = make_shared<TimingProblem>(waypoints({phase, -1}), tangents({phase, -1}),
+                                       x0, v0, timeCost,
+                                       vels({phase, -1}), tau({phase, -1}),
+                                       true,
+                                       -1., -1., -1., ctrlCost);
+    rt_x = rt_mp->getInitializationSample();
+    warmstart_dual.clear(); //the constraint dimensionality changed
+    rt_opt.reset();
+    rt_opt = make_shared<OptConstrained>(rt_x, warmstart_dual, rt_mp, opt);
+    rt_opt->newton.options.verbose = 0;
+    rt_opt->opt.verbose = rai::MAX(verbose-1, 0);
+    rt_phase = phase;
+    if(!rt_ret) rt_ret = make_shared<SolverReturn>();
+  }else{
+    //only the start state and waypoints changed: overwrite in place
+    CHECK_EQ(x0.N, rt_mp->x0.N, "");
+    for(uint i=0;i<x0.N;i++){ rt_mp->x0.elem(i) = x0.elem(i);  rt_mp->v0.elem(i) = v0.elem(i); }
+    for(uint i=0;i<rt_mp->waypoints.N;i++) rt_mp->waypoints.elem(i) = waypoints.elem(phase*waypoints.d1+i);
+    for(uint i=0;i<nTangents;i++) rt_mp->tangents.elem(i) = tangents.elem(phase*tangents.d1+i);
+  }
+
+  //warm start from the shifted previous solution (update_progressTime shifts tau)
+  for(uint k=0;k<K;k++) rt_x(k) = tau(phase+k);
+  for(uint i=0;i<rt_x.N-K;i++) rt_x(K+i) = vels.elem(phase*vStride+i);
+  boundClip(rt_x, rt_opt->newton.bounds_lo, rt_opt->newton.bounds_up);
+
+  rt_opt->runRealtime(timeBudget-(rai::realTime()-start), maxNewtonSteps); //the setup above counts against the budget
+
+  //the newton iterate is the best (line-search accepted) point at the deadline
+  for(uint k=0;k<K;k++) tau(phase+k) = rt_x(k);
+  for(uint i=0;i<rt_x.N-K;i++) vels.elem(phase*vStride+i) = rt_x(K+i);
+
+  time += rai::cpuTime();
+  SolverReturn& ret = *rt_ret;
+  ret.x = rt_x;
+  ret.dual = warmstart_dual;
+  ret.evals = rt_opt->newton.evals;
+  ret.time = time;
+  if(rt_opt->rtEvaluated){
+    ret.ineq = rt_opt->L.get_sumOfGviolations();
+    ret.eq = rt_opt->L.get_sumOfHviolations();
+    ret.sos = rt_opt->L.get_cost_sos();
+    ret.f = rt_opt->L.get_cost_f();
+  }else{ //no evaluation at ret.x within the budget
+    ret.ineq = ret.eq = ret.sos = ret.f = -1.;
+  }
+
+  if(verbose>0){
+    cout <<"phase: " <<phase <<" tau: " <<tau <<" (" <<ret <<")" <<endl;
+  }
+  return rt_ret;
+}
+
 arr TimingMPC::getVels() const{
   if(done()) return arr{};
   arr _vels;
@@ -5,6 +5,8 @@
 #include "../Algo/spline.h"
 
 struct SolverReturn;
+struct TimingProblem;
+struct OptConstrained;
 
 //A wrapper of TimingOpt optimize the timing (and vels) along given waypoints, and progressing/backtracking the phase
 struct TimingMPC{
@@ -26,9 +28,17 @@ struct TimingMPC{
   uint phase=0;
   uintA backtrackingTable;
 
+  //real-time iteration: persistent problem & solver, rebuilt only on phase changes
+  shared_ptr<TimingProblem> rt_mp;
+  shared_ptr<OptConstrained> rt_opt;
+  shared_ptr<SolverReturn> rt_ret;
+  arr rt_x;
+  uint rt_phase=0;
+
   TimingMPC(const arr& _waypoints, double _timeCost=1e0, double _ctrlCost=1e0);
 
   shared_ptr<SolverReturn> solve(const arr& x0, const arr& v0, int verbose=1);
+  shared_ptr<SolverReturn> solve_realtime(const arr& x0, const arr& v0, double timeBudget=1e-3, uint maxNewtonSteps=1, int verbose=0); ///< f, sos, eq, ineq are -1 (unknown) if the budget didn't allow to evaluate the returned x
 
   bool done() const{ return phase>=waypoints.d0; }
   arr getWaypoints() const{ if(done()) return arr{}; return waypoints({phase, -1}).copy(); }
@@ -11,6 +11,14 @@
 #include "array.ipp"
 
 #include <map>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #ifdef RAI_JSON
 #  include <jsoncpp/json/json.h>
@@ -73,11 +81,18 @@ inline Node* readTypeIntoNode(Graph& container, const char* key, std::istream& i
 //  Node methods
 //
 
+namespace {
+uint64_t hashKey(const char* key) { return key && *key ? rai::hashBytes(key, strlen(key)) : 0; }
+std::mutex keyIndexMutex; //only guards building indices (searching is const and may be concurrent)
+}
+
 Node::Node(const std::type_info& _type, Graph& _container, const char* _key, const NodeL& _parents)
   : type(_type), container(_container), key(_key) {
   CHECK(&container!=&NoGraph, "This is a NGraph (nullptr) -- don't do that anymore!");
   index=container.N;
   container.NodeL::append(this);
+  keyHash = hashKey(key.p);
+  if(container.keyIndexed) container.keyIndex[keyHash].append(this);
   if(_parents.N) for(Node* p: _parents) addParent(p);
 }
 
@@ -85,6 +100,13 @@ Node::~Node() {
   if(container.isDoubleLinked) while(children.N) children.last()->removeParent(this);
   if(numChildren) LOG(-2) <<"It is not allowed to delete nodes that still have children";
   while(parents.N) removeParent(parents.last());
+  if(container.keyIndexed) { //the stored hash is right even if the key was written directly
+    auto it = container.keyIndex.find(keyHash);
+    if(it!=container.keyIndex.end()) {
+      it->second.removeValue(this, false);
+      if(!it->second.N) container.keyIndex.erase(it);
+    }
+  }
   if(this==container.last()) { //great: this is very efficient to remove without breaking indexing
     container.resizeCopy(container.N-1);
   } else {
@@ -119,6 +141,24 @@ void Node::swapParent(uint i, Node* p) {
   if(container.isDoubleLinked) parents(i)->children.append(this);
 }
 
+void Node::setKey(const char* _key) {
+  if(container.keyIndexed) {
+    auto it = container.keyIndex.find(keyHash);
+    if(it!=container.keyIndex.end()) it->second.removeValue(this, false);
+    key = _key;
+    keyHash = hashKey(key.p);
+    //keep the bucket ordered as the graph
+    NodeL& L = container.keyIndex[keyHash];
+    uint i=0;
+    if(!container.isIndexed) container.index();
+    while(i<L.N && L.elem(i)->index<index) i++;
+    L.insert(i, this);
+  } else {
+    key = _key;
+    keyHash = hashKey(key.p);
+  }
+}
+
 bool Node::matches(const char* _key) {
   if(key==_key) return true;
   return false;
@@ -247,10 +287,16 @@ Graph::Graph() : isNodeOfGraph(nullptr), pi(nullptr), ri(nullptr) {
 
 Graph::Graph(const char* filename, bool parseInfo): Graph() {
   FileToken file(filename, true);
-  read(file, parseInfo);
+  if(parseInfo) read(file, parseInfo);
+  else readFile(file.name);
   file.cd_start();
 }
 
+Graph::Graph(FileToken& file) : Graph() {
+  if(file.is) read(*file.is);
+  else readFile(file.name);
+}
+
 Graph::Graph(istream& is) : Graph() {
   read(is);
 }
@@ -287,9 +333,11 @@ void Graph::clear() {
   if(ri) { delete ri; ri=nullptr; }
   if(pi) { delete pi; pi=nullptr; }
   DEBUG(checkConsistency();)
+  clearKeyIndex();
   if(!isNodeOfGraph) { //this is not a subgraph; save to delete connections in batch -> faster
     NodeL all = getAllNodesRecursively();
     for(Node* n:all) {
+      n->container.clearKeyIndex();
       n->parents.clear();
       n->numChildren=0;
       n->children.clear();
@@ -339,8 +387,23 @@ void Graph::appendDict(const std::map<std::string, std::string>& dict) {
   }
 }
 
+const NodeL* Graph::findKey(const char* key) const {
+  if(!keyIndexed) {
+    if(N<32) return nullptr; //small graphs are faster searched linearly
+    std::lock_guard<std::mutex> lock(keyIndexMutex);
+    if(!keyIndexed) {
+      for(Node* n: (*this)) { n->keyHash = hashKey(n->key.p);  keyIndex[n->keyHash].append(n); }
+      keyIndexed=true;
+    }
+  }
+  static const NodeL none;
+  auto it = keyIndex.find(hashKey(key));
+  return it==keyIndex.end() ? &none : &it->second;
+}
+
 Node* Graph::findNode(const char* key, bool recurseUp, bool recurseDown) const {
-  for(Node* n: (*this)) if(n->matches(key)) return n;
+  const NodeL* L = findKey(key);
+  for(Node* n: (L?*L:*this)) if(n->matches(key)) return n;
   Node* ret=nullptr;
   if(recurseUp && isNodeOfGraph) ret = isNodeOfGraph->container.findNode(key, true, false);
   if(ret) return ret;
@@ -352,7 +415,8 @@ Node* Graph::findNode(const char* key, bool recurseUp, bool recurseDown) const {
 }
 
 Node* Graph::findNodeOfType(const std::type_info& type, const char* key, bool recurseUp, bool recurseDown) const {
-  for(Node* n: (*this)) if(n->type==type && (!key || n->matches(key))) return n;
+  const NodeL* L = key ? findKey(key) : nullptr;
+  for(Node* n: (L?*L:*this)) if(n->type==type && (!key || n->matches(key))) return n;
   Node* ret=nullptr;
   if(recurseUp && isNodeOfGraph) ret = isNodeOfGraph->container.findNodeOfType(type, key, true, false);
   if(ret) return ret;
@@ -365,7 +429,8 @@ Node* Graph::findNodeOfType(const std::type_info& type, const char* key, bool re
 
 NodeL Graph::findNodes(const char* key, bool recurseUp, bool recurseDown) const {
   NodeL ret;
-  for(Node* n: (*this)) if(n->matches(key)) ret.append(n);
+  const NodeL* L = findKey(key);
+  for(Node* n: (L?*L:*this)) if(n->matches(key)) ret.append(n);
   if(recurseUp && isNodeOfGraph) ret.append(isNodeOfGraph->container.findNodes(key, true, false));
   if(recurseDown) for(Node* n: (*this)) if(n->isGraph()) ret.append(n->graph().findNodes(key, false, true));
   return ret;
@@ -373,7 +438,8 @@ NodeL Graph::findNodes(const char* key, bool recurseUp, bool recurseDown) const
 
 NodeL Graph::findNodesOfType(const std::type_info& type, const char* key, bool recurseUp, bool recurseDown) const {
   NodeL ret;
-  for(Node* n: (*this)) if(n->type==type && (!key || n->matches(key))) ret.append(n);
+  const NodeL* L = key ? findKey(key) : nullptr;
+  for(Node* n: (L?*L:*this)) if(n->type==type && (!key || n->matches(key))) ret.append(n);
   if(recurseUp && isNodeOfGraph) ret.append(isNodeOfGraph->container.findNodesOfType(type, key, true, false));
   if(recurseDown) for(Node* n: (*this)) if(n->isGraph()) ret.append(n->graph().findNodesOfType(type, key, false, true));
   return ret;
@@ -591,78 +657,92 @@ void Graph::copy(const Graph& G, bool appendInsteadOfClear, bool enforceCopySubg
   DEBUG(G.checkConsistency());
 }
 
-void Graph::read(std::istream& is, bool parseInfo) {
-  uint Nbefore = N;
-  if(parseInfo) getParseInfo(nullptr).beg=is.tellg();
-  String namePrefix;
-  StringA tags;
-  for(;;) {
-    DEBUG(checkConsistency());
-    char c=peerNextChar(is, " \n\r\t,");
-    if(!is.good() || c=='}') { is.clear(); break; }
-    Node* n = readNode(is, tags, NULL, false, parseInfo);
-    if(!n) break;
-    if(n->key=="Parent" && n->isOfType<NodeL>()) {
-      NodeL& P = n->get<NodeL>();
-      Node *nn = n->container.isNodeOfGraph;
-      CHECK(nn,"can set 'Parent' only within a subgraph node");
-      for(Node *par:P) nn->addParent(par);
-      delete n; n=nullptr;
-    }else if(n->key=="Quit") {
-      delete n; n=nullptr;
-    }else if(n->key=="Include") {
-      uint Nbefore = N;
-      read(n->get<FileToken>().getIs(true), parseInfo);
-      if(namePrefix.N) { //prepend a naming prefix to all nodes just read
-        for(uint i=Nbefore; i<N; i++) elem(i)->key.prepend(namePrefix);
-        namePrefix.clear();
-      }
-      n->get<FileToken>().cd_start();
-      delete n; n=nullptr;
-    } else if(n->key=="Prefix") {
-      if(n->isOfType<String>()) {
-        namePrefix = n->get<String>();
-      } else if(n->isOfType<bool>() && !n->get<bool>()) {
-        namePrefix.clear();
-      } else LOG(-1) <<*n <<" is not a proper name prefix";
-      delete n; n=nullptr;
-    } else if(n->key=="ChDir") {
-      n->get<FileToken>().cd_file();
-    } else if(tags.N && tags(0)=="Delete") {
-//      n->key.remove(0);
-      NodeL dels = getNodes(n->key);
-      for(Node* d: dels) { delete d; d=nullptr; }
+//handles the special nodes Parent, Quit, Include, Prefix, ChDir and Delete right after they were read (n is deleted if
+//it was only an instruction); include reads the FileToken of an Include node
+static void readSpecialNode(Graph& G, Node*& n, bool isDelete, String& namePrefix, const std::function<void(FileToken&)>& include) {
+  if(n->key=="Parent" && n->isOfType<NodeL>()) {
+    NodeL& P = n->get<NodeL>();
+    Node *nn = n->container.isNodeOfGraph;
+    CHECK(nn,"can set 'Parent' only within a subgraph node");
+    for(Node *par:P) nn->addParent(par);
+    delete n; n=nullptr;
+  }else if(n->key=="Quit") {
+    delete n; n=nullptr;
+  }else if(n->key=="Include") {
+    uint Nbefore = G.N;
+    include(n->get<FileToken>());
+    if(namePrefix.N) { //prepend a naming prefix to all nodes just read
+      for(uint i=Nbefore; i<G.N; i++) G.elem(i)->key.prepend(namePrefix);
+      G.clearKeyIndex();
+      namePrefix.clear();
     }
+    n->get<FileToken>().cd_start();
+    delete n; n=nullptr;
+  } else if(n->key=="Prefix") {
+    if(n->isOfType<String>()) {
+      namePrefix = n->get<String>();
+    } else if(n->isOfType<bool>() && !n->get<bool>()) {
+      namePrefix.clear();
+    } else LOG(-1) <<*n <<" is not a proper name prefix";
+    delete n; n=nullptr;
+  } else if(n->key=="ChDir") {
+    n->get<FileToken>().cd_file();
+  } else if(isDelete) {
+//      n->key.remove(0);
+    NodeL dels = G.getNodes(n->key);
+    for(Node* d: dels) { delete d; d=nullptr; }
   }
-  if(parseInfo) getParseInfo(nullptr).end=is.tellg();
+}
 
-  DEBUG(checkConsistency());
+//after reading: applies all Edit nodes read since Nbefore, deletes ChDir nodes (in reverse order) and indexes
+static void readFinish(Graph& G, uint Nbefore) {
+  DEBUG(G.checkConsistency());
 
   //-- merge all Mege keys
   NodeL edits;// = getNodesWithTag("%Edit");
-  for(uint i=Nbefore; i<N; i++) {
-    Node* n=elem(i);
+  for(uint i=Nbefore; i<G.N; i++) {
+    Node* n=G.elem(i);
     if(n->isGraph() && n->graph().findNode("%Edit")) edits.append(n);
   }
   for(Node* ed:edits) {
 //    CHECK_EQ(ed->key.first(), "Edit", "an edit node needs Edit as first key");
     ed->graph().delNode(ed->graph().findNode("%Edit"));
 //    ed->key.remove(0);
-    edit(ed);
+    G.edit(ed);
   }
 
-  DEBUG(checkConsistency();)
+  DEBUG(G.checkConsistency();)
 
   //-- delete all ChDir nodes in reverse order
-  for(uint i=N; i--;) {
-    Node* n=elem(i);
+  for(uint i=G.N; i--;) {
+    Node* n=G.elem(i);
     if(n->key=="ChDir") {
       n->get<FileToken>().cd_start();
       delete n; n=nullptr;
     }
   }
 
-  index();
+  G.index();
+}
+
+void Graph::read(std::istream& is, bool parseInfo) {
+  uint Nbefore = N;
+  if(parseInfo) getParseInfo(nullptr).beg=is.tellg();
+  String namePrefix;
+  StringA tags;
+  for(;;) {
+    DEBUG(checkConsistency());
+    char c=peerNextChar(is, " \n\r\t,");
+    if(!is.good() || c=='}') { is.clear(); break; }
+    Node* n = readNode(is, tags, NULL, false, parseInfo);
+    if(!n) break;
+    readSpecialNode(*this, n, tags.N && tags(0)=="Delete", namePrefix, [this, parseInfo](FileToken& file) {
+      read(file.getIs(true), parseInfo);
+    });
+  }
+  if(parseInfo) getParseInfo(nullptr).end=is.tellg();
+
+  readFinish(*this, Nbefore);
 }
 
 void writeFromStream(std::ostream& os, std::istream& is, istream::pos_type beg, istream::pos_type end) {
@@ -904,6 +984,546 @@ Node* Graph::readNode(std::istream& is, StringA& tags, const char* predetermined
   return node;
 }
 
+//===========================================================================
+//
+// reading from memory: the grammar of readNode on a buffer, e.g. a memory-mapped file. Tokens are views into the
+// buffer; only keys and string values are copied (into the nodes). Values that are rare in files (StringA, arrA,
+// arrays with a <dim> tag) are passed to the stream parsers.
+//
+
+namespace {
+
+struct Token {
+  const char* p=nullptr;
+  uint n=0;
+  bool operator==(const char* s) const { return strlen(s)==n && !strncmp(p, s, n); }
+};
+
+/// a set of characters as a lookup table
+struct CharSet {
+  bool has[256];
+  CharSet(const char* s) { memset(has, 0, 256);  for(; *s; s++) has[(byte)*s]=true; }
+  bool operator()(char c) const { return has[(byte)c]; }
+};
+
+const CharSet white(" \n\r\t"), blank(" \t"), none(""), graphSkip(" \n\r\t,"), keyStop(" \t\n\r,;([{}=:!\'"),
+      parentSkip(" \t\n\r,"), parentStop(" \t\n\r,)"), wordStop(" \n\r\t,;}"), quote("\""), fileQuote("\'"),
+      angle(">"), paren(")"), arraySkip(" ,\r\t"), number("+-.0123456789eE"), numberStart("-.0123456789");
+
+struct GraphParser {
+  const char *beg, *p, *end;
+  bool fail=false;        ///< as the failbit of a stream: reading stops until the next '}' or the end
+  String key, str;        ///< 0-terminated copies of the current key and value tokens (reused)
+  std::vector<Token> tags;
+
+  GraphParser(const char* buf, size_t n) : beg(buf), p(buf), end(buf+n) {}
+
+  //-- as get, putback, rai::skip, getNextChar and String::read on a stream; 0 is the end of the buffer
+  char get() { if(fail || p>=end || !*p) return 0;  return *p++; }
+  void unget(char c) { if(c) p--; }
+  void skip(const CharSet* skipSymbols, const CharSet* stopSymbols=nullptr, bool skipCommentLines=true) {
+    while(!fail && p<end) {
+      char c=*p;
+      if(skipCommentLines && c=='#') { while(p<end && *p!='\n') p++;  continue; }
+      if(skipSymbols && !(*skipSymbols)(c)) break;
+      if(stopSymbols && (*stopSymbols)(c)) break;
+      p++;
+    }
+  }
+  char getNextChar(const CharSet& skipSymbols) { skip(&skipSymbols);  return get(); }
+  char peerNextChar(const CharSet& skipSymbols) { char c=getNextChar(skipSymbols);  unget(c);  return c; }
+  Token readToken(const CharSet& skipSymbols, const CharSet& stopSymbols, bool eatStopSymbol) {
+    skip(&skipSymbols);
+    Token t;
+    t.p=p;
+    while(!fail && p<end && *p && !stopSymbols(*p)) p++;
+    t.n=p-t.p;
+    if(eatStopSymbol && get()) {}
+    return t;
+  }
+  const char* set(String& s, const Token& t) { s.set(t.p, t.n);  return s.p; }
+
+  void parse(char c) {
+    skip(&white);
+    char d=get();
+    if(d!=c) {
+      unget(d);
+      error(STRING("expected '" <<c <<"'"));
+      fail=true;
+    }
+  }
+
+  /// as istream>>double: the longest prefix that is a number
+  bool readDouble(double& x) {
+    char buf[64];
+    uint n=0;
+    for(const char* q=p; q<end && n<63 && number(*q); q++) buf[n++]=*q;
+    buf[n]=0;
+    char* e;
+    x = strtod(buf, &e);
+    if(e==buf) { x=0.;  return false; }
+    p += e-buf;
+    return true;
+  }
+
+  uint lineCount() const { uint l=1;  for(const char* q=beg; q<p && q<end; q++) if(*q=='\n') l++;  return l; }
+  void error(const char* msg) {
+    cerr <<"[[error in parsing Graph file (line=" <<lineCount() <<"): " <<msg <<":\n  \"";
+    cerr.write(p, std::min<long>(end-p, 40));
+    cerr <<"<<<\"  ]]" <<endl;
+  }
+
+  /// the position after the ']' matching the '[' at q (ignoring brackets within quotes)
+  const char* closingBracket(const char* q) const {
+    int depth=0;
+    bool quoted=false;
+    for(; q<end; q++) {
+      if(quoted) { if(*q=='"') quoted=false;  continue; }
+      if(*q=='"') quoted=true;
+      else if(*q=='[') depth++;
+      else if(*q==']' && !--depth) return q+1;
+    }
+    return end;
+  }
+
+  /// parses the bracketed value starting at open with a stream
+  template<class T> void readWithStream(T& x, const char* open) {
+    const char* close = closingBracket(open);
+    std::istringstream is(std::string(open, close-open));
+    is >>x;
+    p = close;
+  }
+
+  /// as Array<double>::read after the '['
+  void readArr(arr& x, const char* open) {
+    if(peerNextChar(white)=='<') { readWithStream(x, open);  return; }
+    uint i=0, d=0;
+    x.resize(0);
+    for(;;) {
+      skip(&arraySkip);
+      char c=get();
+      if(c==']' || !c) break;
+      if(c==';' || c=='\n') {  //set an array width
+        if(!d) d=i; else if(i%d) HALT("mis-structured array in row " <<i/d <<" (line=" <<lineCount() <<")");
+        continue;
+      }
+      if(c!=',') unget(c);
+      double v;
+      if(!readDouble(v)) break;
+      if(i>=x.N) x.resizeCopy(i+1000);
+      x.elem(i++)=v;
+    }
+    x.resizeCopy(i);
+    if(d) {
+      if(x.N%d) HALT("mis-structured array in last row (line=" <<lineCount() <<")");
+      x.reshape(x.N/d, d);
+    }
+  }
+
+  void readParents(Graph& G, NodeL& parents) {
+    for(uint j=0;; j++) {
+      Token t=readToken(parentSkip, parentStop, false);
+      if(!t.n) break;
+      Node* e = G.findNode(set(str, t), true, false); //important: recurse up
+      if(e) { //sucessfully found
+        parents.append(e);
+      } else { //this element is not known -- a negative integer?
+        int rel = strtol(str.p, nullptr, 10);
+        if(rel<0 && (int)G.N+rel>=0) {
+          parents.append(G.elem(G.N+rel));
+        } else {
+          error(STRING("unknown " <<j <<". parent '" <<str <<"'"));
+          skip(nullptr, &paren, false);
+        }
+      }
+    }
+    parse(')');
+  }
+
+  Node* readNode(Graph& G, bool& isDelete) {
+    //-- read keys
+    tags.clear();
+    skip(&white);
+    for(;;) {
+      Token t=readToken(blank, keyStop, false);
+      if(!t.n) break;
+      if(t.p[0]=='"' && t.p[t.n-1]=='"') { if(t.n>1) { t.p++;  t.n-=2; } else t.n=0; }
+      tags.push_back(t);
+    }
+    uint ntags = tags.size();
+    isDelete = ntags && tags[0]=="Delete";
+    if(ntags) set(key, tags.back()); else key.clear();
+    const char* k = ntags ? key.p : nullptr; //as readNode: no tags is a null key, not an empty one
+
+    //-- read parents
+    NodeL parents;
+    char c=getNextChar(blank); //don't skip new lines
+    if(c=='(') {
+      readParents(G, parents);
+      c=getNextChar(blank);
+    }
+
+    //-- read value
+    Node* node=nullptr;
+    if(c=='=' || c==':' || c=='{' || c=='[' || c=='<' || c=='!' || c=='\'') {
+      if(c=='=' || c==':') c=getNextChar(blank);
+      if((c>='a' && c<='z') || (c>='A' && c<='Z') || c=='_') { //String or boolean
+        unget(c);
+        Token t=readToken(none, wordStop, false);
+        if(t=="true" || t=="True") node = G.newNode<bool>(k, parents, true);
+        else if(t=="false" || t=="False") node = G.newNode<bool>(k, parents, false);
+        else node = G.newNode<String>(k, parents, set(str, t));
+      } else if(c && numberStart(c)) {  //single double
+        unget(c);
+        double d;
+        if(!readDouble(d)) { error("can't parse the double number");  fail=true; }
+        node = G.newNode<double>(k, parents, d);
+      } else switch(c) {
+          case '!': { //boolean false
+            node = G.newNode<bool>(k, parents, false);
+          } break;
+          case '\'': { //FileToken
+            set(str, readToken(none, fileQuote, true));
+            try {
+              node = G.newNode<FileToken>(k, parents, FileToken(str, false));
+            } catch(...) {
+              delete node; node=nullptr;
+              error(STRING("file " <<str <<" does not exist -> converting to string!"));
+              node = G.newNode<String>(k, parents, str);
+            }
+          } break;
+          case '\"': { //String
+            node = G.newNode<String>(k, parents, set(str, readToken(none, quote, true)));
+          } break;
+          case '[': { //arr or StringA
+            const char* open=p-1;
+            char c2=getNextChar(blank);
+            if(c2=='"' || (c2>='a' && c2<='z') || (c2>='A' && c2<='Z')) { //StringA
+              Node_typed<StringA>* n = G.newNode<StringA>(k, parents);
+              if(c2=='"') {
+                String::readSkipSymbols=",\"";
+                String::readStopSymbols="\"";
+              } else {
+                String::readStopSymbols=" ,\n\t]";
+                String::readEatStopSymbol = 0;
+              }
+              readWithStream(n->value, open);
+              String::readSkipSymbols = " \t";
+              String::readStopSymbols = "\n\r";
+              String::readEatStopSymbol = 1;
+              node = n;
+            } else if(c2=='[') { //arrA
+              Node_typed<arrA>* n = G.newNode<arrA>(k, parents);
+              readWithStream(n->value, open);
+              node = n;
+            } else {
+              unget(c2);
+              Node_typed<arr>* n = G.newNode<arr>(k, parents);
+              readArr(n->value, open);
+              node = n;
+            }
+          } break;
+          case '<': { //any type parser
+            node = G.newNode<String>(k, parents, set(str, readToken(none, angle, true)));
+          } break;
+          case '(': { // set of parent nodes
+            Node_typed<NodeL>* n = G.newNode<NodeL>(k, parents);
+            readParents(G, n->value);
+            node = n;
+          } break;
+          case '{': { // sub graph
+            std::vector<Token> nodeTags = tags;
+            Graph& subgraph = G.newSubgraph(k, parents);
+            readGraph(subgraph);
+            parse('}');
+            node = subgraph.isNodeOfGraph;
+            for(uint i=0; i+1<nodeTags.size(); i++) {
+              str.resize(nodeTags[i].n+1, false);
+              str.p[0]='%';
+              memmove(str.p+1, nodeTags[i].p, nodeTags[i].n);
+              subgraph.newNode<bool>(str);
+            }
+          } break;
+          default: { //error
+            unget(c);
+            error(STRING("unknown value indicator '" <<c <<"'"));
+            fail=true;
+            return nullptr;
+          }
+        }
+    } else { //no ':' or '{' -> boolean
+      unget(c);
+      node = G.newNode<bool>(k, parents, true);
+    }
+
+    if(ntags>1) {
+      if(node->isOfType<bool>() && ntags==2 && isDelete) {
+        node->get<bool>() = false;
+      } else if(!node->isGraph()) {
+        StringA T(ntags);
+        for(uint i=0; i<ntags; i++) T(i).set(tags[i].p, tags[i].n);
+        LOG(-1) <<"you specified tags " <<T <<" for node '" <<*node <<"', which is of non-graph type -- ignored";
+      }
+    }
+
+    //eat the next , or ;
+    c=getNextChar(white);
+    if(c==',' || c==';') {} else unget(c);
+
+    return node;
+  }
+
+  void readGraph(Graph& G) {
+    uint Nbefore = G.N;
+    String namePrefix;
+    std::function<void(FileToken&)> include = [&G](FileToken& file) {
+      file.cd_file();
+      G.readFile(file.name);
+    };
+    for(;;) {
+      char c=peerNextChar(graphSkip);
+      if(!c || c=='}') { fail=false;  break; }
+      bool isDelete;
+      Node* n = readNode(G, isDelete);
+      if(!n) break;
+      readSpecialNode(G, n, isDelete, namePrefix, include);
+    }
+    readFinish(G, Nbefore);
+  }
+};
+
+//===========================================================================
+//
+// binary serialization
+//
+
+const char* binaryMagic = "raiGraph";
+const uint32_t binaryVersion = 1;
+
+enum BinaryType : byte { _bool=1, _double, _int, _uint, _String, _FileToken, _arr, _intA, _uintA, _StringA, _arrA, _NodeL, _Graph };
+
+BinaryType binaryType(const Node* n) {
+  if(n->isOfType<bool>()) return _bool;
+  if(n->isOfType<double>()) return _double;
+  if(n->isOfType<int>()) return _int;
+  if(n->isOfType<uint>()) return _uint;
+  if(n->isOfType<String>()) return _String;
+  if(n->isOfType<FileToken>()) return _FileToken;
+  if(n->isOfType<arr>()) return _arr;
+  if(n->isOfType<intA>()) return _intA;
+  if(n->isOfType<uintA>()) return _uintA;
+  if(n->isOfType<StringA>()) return _StringA;
+  if(n->isOfType<arrA>()) return _arrA;
+  if(n->isOfType<NodeL>()) return _NodeL;
+  if(n->isGraph()) return _Graph;
+  HALT("binary serialization of node '" <<*n <<"' of type '" <<n->type.name() <<"' is not implemented");
+}
+
+struct GraphWriter {
+  std::ostream& os;
+  std::unordered_map<const Node*, uint32_t> ids; ///< nodes in depth-first order
+
+  GraphWriter(std::ostream& _os) : os(_os) {}
+
+  void enumerate(const Graph& G) {
+    for(const Node* n:G) {
+      ids.emplace(n, ids.size());
+      if(n->isGraph()) enumerate(n->graph());
+    }
+  }
+
+  template<class T> void write(const T& x) { os.write((const char*)&x, sizeof(T)); }
+  void write(const String& s) { write<uint32_t>(s.N);  os.write(s.p, s.N); }
+  template<class T> void writeDim(const Array<T>& x) {
+    write<uint32_t>(x.nd);
+    for(uint i=0; i<x.nd; i++) write<uint32_t>(x.dim(i));
+  }
+  void write(const NodeL& L) {
+    write<uint32_t>(L.N);
+    for(Node* n:L) {
+      auto it = ids.find(n);
+      CHECK(it!=ids.end(), "node '" <<*n <<"' is referred to but not part of the graph that is written");
+      write<uint32_t>(it->second);
+    }
+  }
+
+  void write(const Graph& G) {
+    write<uint32_t>(G.N);
+    for(Node* n:G) {
+      byte type = binaryType(n);
+      write(type);
+      write(n->key);
+      write(n->parents);
+      switch(type) {
+        case _bool: write<byte>(n->get<bool>());  break;
+        case _double: write(n->get<double>());  break;
+        case _int: write(n->get<int>());  break;
+        case _uint: write(n->get<uint>());  break;
+        case _String: write(n->get<String>());  break;
+        case _FileToken: {
+          const FileToken& f = n->get<FileToken>();
+          write(f.cwd);  write(f.path);  write(f.name);
+        } break;
+        case _arr: writePOD(n->get<arr>());  break;
+        case _intA: writePOD(n->get<intA>());  break;
+        case _uintA: writePOD(n->get<uintA>());  break;
+        case _StringA: {
+          const StringA& x = n->get<StringA>();
+          writeDim(x);
+          for(const String& s:x) write(s);
+        } break;
+        case _arrA: {
+          const arrA& x = n->get<arrA>();
+          write<uint32_t>(x.N);
+          for(const arr& a:x) writePOD(a);
+        } break;
+        case _NodeL: write(n->get<NodeL>());  break;
+        case _Graph: write(n->graph());  break;
+      }
+    }
+  }
+
+  template<class T> void writePOD(const Array<T>& x) { writeDim(x);  os.write((const char*)x.p, x.N*sizeof(T)); }
+};
+
+struct GraphReader {
+  const char *p, *end;
+  NodeL nodes; ///< all nodes read, in depth-first order
+  struct Deferred { Node* node;  NodeL* list;  uintA ids; };
+  std::vector<Deferred> deferred; ///< references to nodes that come later
+  String key, str;
+
+  GraphReader(const char* buf, size_t n) : p(buf), end(buf+n) {}
+
+  void need(size_t n) { if(p+n>end) HALT("binary Graph data is truncated"); }
+  template<class T> T read() { need(sizeof(T));  T x;  memmove(&x, p, sizeof(T));  p+=sizeof(T);  return x; }
+  void read(String& s) { uint32_t n=read<uint32_t>();  need(n);  s.set(p, n);  p+=n; }
+  template<class T> void readDim(Array<T>& x) {
+    uint32_t nd=read<uint32_t>();
+    CHECK_LE(nd, 10, "corrupt binary Graph data");
+    uint dim[10];
+    for(uint i=0; i<nd; i++) dim[i]=read<uint32_t>();
+    if(nd) x.resize(nd, dim); else x.clear();
+  }
+  template<class T> void readPOD(Array<T>& x) {
+    readDim(x);
+    need(x.N*sizeof(T));
+    memmove(x.p, p, x.N*sizeof(T));
+    p += x.N*sizeof(T);
+  }
+  /// the list is resolved now if all nodes exist, otherwise (a reference to a later node) at the end
+  bool readRefs(NodeL& L, Node* node) {
+    uint32_t n=read<uint32_t>();
+    uintA ids(n);
+    bool later=false;
+    for(uint i=0; i<n; i++) { ids(i)=read<uint32_t>();  if(ids(i)>=nodes.N) later=true; }
+    if(later) { deferred.push_back({node, &L, ids});  return false; }
+    L.resize(n);
+    for(uint i=0; i<n; i++) L(i) = nodes(ids(i));
+    return true;
+  }
+
+  void readGraph(Graph& G) {
+    uint32_t N=read<uint32_t>();
+    NodeL parents;
+    for(uint32_t i=0; i<N; i++) {
+      byte type=read<byte>();
+      read(key);
+      const char* k = key.N ? key.p : nullptr;
+      parents.clear();
+      uint d=deferred.size();
+      bool now = readRefs(parents, nullptr);
+      Node* n=nullptr;
+      switch(type) {
+        case _bool: n = G.newNode<bool>(k, parents, read<byte>());  break;
+        case _double: n = G.newNode<double>(k, parents, read<double>());  break;
+        case _int: n = G.newNode<int>(k, parents, read<int>());  break;
+        case _uint: n = G.newNode<uint>(k, parents, read<uint>());  break;
+        case _String: read(str);  n = G.newNode<String>(k, parents, str);  break;
+        case _FileToken: {
+          Node_typed<FileToken>* f = G.newNode<FileToken>(k, parents);
+          read(f->value.cwd);  read(f->value.path);  read(f->value.name);
+          n = f;
+        } break;
+        case _arr: { auto* x = G.newNode<arr>(k, parents);  readPOD(x->value);  n=x; } break;
+        case _intA: { auto* x = G.newNode<intA>(k, parents);  readPOD(x->value);  n=x; } break;
+        case _uintA: { auto* x = G.newNode<uintA>(k, parents);  readPOD(x->value);  n=x; } break;
+        case _StringA: {
+          auto* x = G.newNode<StringA>(k, parents);
+          readDim(x->value);
+          for(String& s:x->value) read(s);
+          n=x;
+        } break;
+        case _arrA: {
+          auto* x = G.newNode<arrA>(k, parents);
+          x->value.resize(read<uint32_t>());
+          for(arr& a:x->value) readPOD(a);
+          n=x;
+        } break;
+        case _NodeL: {
+          auto* x = G.newNode<NodeL>(k, parents);
+          nodes.append(x); //(the list may refer to the node itself)
+          readRefs(x->value, nullptr);
+          n=x;
+        } break;
+        case _Graph: {
+          Graph& g = G.newSubgraph(k, parents);
+          n = g.isNodeOfGraph;
+          nodes.append(n);
+          readGraph(g);
+        } break;
+        default: HALT("corrupt binary Graph data (unknown type " <<(int)type <<")");
+      }
+      if(!now) deferred[d].node=n;
+      if(type!=_NodeL && type!=_Graph) nodes.append(n);
+    }
+    G.index();
+  }
+
+  void read(Graph& G) {
+    need(12);
+    CHECK(!memcmp(p, binaryMagic, 8), "not a binary Graph");
+    p+=8;
+    uint32_t version=read<uint32_t>();
+    CHECK_EQ(version, binaryVersion, "unknown binary Graph version");
+    readGraph(G);
+    for(Deferred& d:deferred) {
+      if(d.node) { for(uint i:d.ids) d.node->addParent(nodes(i)); }
+      else { d.list->resize(d.ids.N);  for(uint i=0; i<d.ids.N; i++) d.list->elem(i) = nodes(d.ids(i)); }
+    }
+  }
+};
+
+} //namespace
+
+void Graph::readFile(const char* filename) {
+  int fd = ::open(filename, O_RDONLY);
+  if(fd<0) THROW("could not open file '" <<filename <<"' for input from '" <<getcwd_string() <<"'");
+  struct stat st;
+  if(fstat(fd, &st)) { close(fd);  THROW("could not stat file '" <<filename <<"'"); }
+  size_t n = st.st_size;
+  if(!n) { close(fd);  readFinish(*this, N);  return; }
+  void* buf = mmap(nullptr, n, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(buf==MAP_FAILED) THROW("could not map file '" <<filename <<"'");
+  std::shared_ptr<void> unmap(buf, [n](void* b) { munmap(b, n); });
+  if(n>=8 && !memcmp(buf, binaryMagic, 8)) GraphReader((const char*)buf, n).read(*this);
+  else GraphParser((const char*)buf, n).readGraph(*this);
+}
+
+void Graph::writeBinary(std::ostream& os) const {
+  GraphWriter W(os);
+  W.enumerate(*this);
+  os.write(binaryMagic, 8);
+  W.write(binaryVersion);
+  W.write(*this);
+}
+
+void Graph::readBinary(std::istream& is) {
+  std::string buf((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+  GraphReader(buf.data(), buf.size()).read(*this);
+}
+
 #ifdef RAI_JSON
 void addJasonValues(Graph& G, const char* key, Json::Value& value);
 
@@ -1136,6 +1756,7 @@ void Graph::sortByDotOrder() {
   permuteInv(perm);
   it_COUNT=0;
   for(Node *it: list()) it->index=it_COUNT++;
+  clearKeyIndex();
 }
 
 ParseInfo& Graph::getParseInfo(Node* n) {
@@ -1202,6 +1823,11 @@ bool Graph::checkConsistency() const {
   for(Node* node: *this) {
     CHECK_EQ(&node->container, this, "");
     if(isIndexed) CHECK_EQ(node->index, idx, "");
+    if(keyIndexed) {
+      CHECK_EQ(node->keyHash, hashKey(node->key.p), "node '" <<node->key <<"' was renamed without setKey");
+      auto it = keyIndex.find(node->keyHash);
+      CHECK(it!=keyIndex.end() && it->second.findValue(node)!=-1, "node '" <<node->key <<"' is not in the key index (renamed without setKey?)");
+    }
     if(isDoubleLinked) {
       CHECK_EQ(node->numChildren, node->children.N, "");
 #ifndef RAI_NOCHECK
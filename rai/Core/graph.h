@@ -12,6 +12,8 @@
 
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <atomic>
 
 //===========================================================================
 
@@ -35,11 +37,12 @@ namespace rai {
 struct Node {
   const std::type_info& type;
   Graph& container;
-  String key;
+  String key;           ///< to rename, use setKey(), which keeps the container's key index consistent
   NodeL parents;
   NodeL children;
   uint numChildren=0;
   uint index;
+  uint64_t keyHash=0;   ///< hash under which the node is listed in the container's key index
 
   Node(const std::type_info& _type, Graph& _container, const char* _key, const NodeL& _parents);
   virtual ~Node();
@@ -47,6 +50,7 @@ struct Node {
   void addParent(Node* p, bool prepend=false);
   void removeParent(Node* p);
   void swapParent(uint i, Node* p);
+  void setKey(const char* _key);
 
   //-- get value
   template<class T> bool isOfType() const { return type==typeid(T); }
@@ -101,6 +105,7 @@ struct Graph : NodeL {
   Graph();                                               ///< empty graph
   explicit Graph(const char* filename, bool parseInfo=false);         ///< read from a file
   explicit Graph(istream& is);                           ///< read from a stream
+  explicit Graph(FileToken& file);                       ///< read from a file (see readFile)
   Graph(const std::map<std::string, std::string>& dict); ///< useful to represent Python dicts
   Graph(std::initializer_list<struct NodeInitializer> list);         ///< initialize, e.g.: {"x", "b", {"a", 3.}, {"b", {"x"}, 5.}, {"c", rai::String("BLA")} };
   Graph(const Graph& G);                                 ///< copy constructor
@@ -180,6 +185,14 @@ struct Graph : NodeL {
   void read(std::istream& is, bool parseInfo=false);
   Node* readNode(std::istream& is, StringA& tags, const char* predeterminedKey, bool verbose, bool parseInfo); //used only internally..
   void readJson(std::istream& is);
+  /// reads a text file (the same syntax as read) or a file written by writeBinary; the file is memory-mapped and parsed
+  /// in place, which is much faster than read, but does not provide parse info
+  void readFile(const char* filename);
+  /// compact binary format (host byte order) of all node types that files contain (bool, double, int, uint, String,
+  /// FileToken, arr, intA, uintA, StringA, arrA, NodeL, Graph); references (parents and NodeL values) need to be
+  /// within the graph
+  void writeBinary(std::ostream& os) const;
+  void readBinary(std::istream& is);
   void write(std::ostream& os=std::cout, const char* ELEMSEP=",\n", const char* BRACKETS="{}", bool yamlMode=false) const;
   void writeDot(std::ostream& os, bool withoutHeader=false, bool defaultEdges=false, int nodesOrEdges=0, int focusIndex=-1, bool subGraphsAsNodes=false);
   void writeHtml(std::ostream& os, std::istream& is);
@@ -191,6 +204,13 @@ struct Graph : NodeL {
   friend struct Node;
   uint index(bool subKVG=false, uint start=0);
 
+  /** hash of key -> nodes with that key (in order); built on the first search of a large graph, then kept up to date by
+   *  node creation, deletion, and Node::setKey */
+  mutable std::unordered_map<uint64_t, NodeL> keyIndex;
+  mutable std::atomic<bool> keyIndexed= {false};
+  const NodeL* findKey(const char* key) const; ///< nullptr: no index, search linearly
+  void clearKeyIndex() const { keyIndex.clear();  keyIndexed=false; }
+
 };
 
 bool operator==(const Graph& A, const Graph& B);
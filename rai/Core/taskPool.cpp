@@ -0,0 +1,256 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "taskPool.h"
+
+namespace rai {
+
+//===========================================================================
+//
+// TaskPool
+//
+
+static thread_local TaskPool* _currentPool=nullptr;
+static thread_local int _currentWorker=-1;
+static thread_local uint _stealStart=0;
+
+TaskPool::TaskPool(uint nThreads) : pending(0), nextQueue(0), stop(false) {
+  if(!nThreads) nThreads = rai::getParameter<int>("taskPool/threads", std::thread::hardware_concurrency());
+  if(!nThreads) nThreads=1;
+  workers.resize(nThreads);
+  for(uint i=0; i<nThreads; i++) workers(i) = new Worker;
+  for(uint i=0; i<nThreads; i++) workers(i)->thread = std::thread(&TaskPool::workerMain, this, i);
+}
+
+TaskPool::~TaskPool() {
+  {
+    std::lock_guard<std::mutex> lock(periodicMutex);
+    stop = true;
+    periodicCond.notify_all();
+  }
+  if(timerThread) timerThread->join();
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    sleepCond.notify_all();
+  }
+  for(Worker* w:workers) { w->thread.join(); delete w; }
+  workers.clear();
+}
+
+void TaskPool::submit(const Task& task) {
+  uint q;
+  if(_currentPool==this && _currentWorker>=0) q = _currentWorker; //own deque
+  else q = (nextQueue++)%workers.N; //round robin from outside
+  {
+    std::lock_guard<std::mutex> lock(workers(q)->mutex);
+    workers(q)->deque.push_back(task);
+  }
+  pending++;
+  std::lock_guard<std::mutex> lock(sleepMutex);
+  sleepCond.notify_one();
+}
+
+bool TaskPool::popTask(Task& task, int self) {
+  //own deque: LIFO from the back
+  if(self>=0) {
+    Worker* w = workers(self);
+    std::lock_guard<std::mutex> lock(w->mutex);
+    if(w->deque.size()) {
+      task = std::move(w->deque.back());
+      w->deque.pop_back();
+      pending--;
+      return true;
+    }
+  }
+  //steal: FIFO from the front of others
+  uint n = workers.N;
+  uint start = (self>=0 ? self+1 : _stealStart++);
+  for(uint k=0; k<n; k++) {
+    Worker* w = workers((start+k)%n);
+    std::unique_lock<std::mutex> lock(w->mutex, std::try_to_lock);
+    if(!lock.owns_lock()) continue;
+    if(w->deque.size()) {
+      task = std::move(w->deque.front());
+      w->deque.pop_front();
+      pending--;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TaskPool::runPendingTask() {
+  if(!pending.load()) return false;
+  Task task;
+  if(!popTask(task, _currentPool==this ? _currentWorker : -1)) return false;
+  task();
+  return true;
+}
+
+void TaskPool::workerMain(uint i) {
+  _currentPool = this;
+  _currentWorker = i;
+  Task task;
+  for(;;) {
+    if(popTask(task, i)) { task(); task=nullptr; continue; }
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    if(stop && !pending.load()) break;
+    sleepCond.wait_for(lock, std::chrono::milliseconds(10), [this]() { return pending.load()>0 || stop.load(); });
+  }
+}
+
+void TaskPool::parallel_for(uint begin, uint end, const std::function<void(uint)>& f, uint grain) {
+  if(end<=begin) return;
+  uint n = end-begin;
+  if(!grain) grain = rai::MAX(1u, n/(4*workers.N));
+  if(n<=grain) { for(uint i=begin; i<end; i++) f(i); return; }
+  TaskGroup G(*this);
+  for(uint i=begin; i<end; i+=grain) {
+    uint e = rai::MIN(i+grain, end);
+    G.run([&f, i, e]() { for(uint j=i; j<e; j++) f(j); });
+  }
+  G.wait();
+}
+
+int TaskPool::addPeriodic(double intervalSec, const Task& f) {
+  CHECK(intervalSec>0., "periodic tasks need a positive interval");
+  std::lock_guard<std::mutex> lock(periodicMutex);
+  Periodic p;
+  p.id = periodicCount++;
+  p.interval = intervalSec;
+  p.next = std::chrono::steady_clock::now();
+  p.f = f;
+  p.running = std::make_shared<std::atomic<bool>>(false);
+  periodics.append(p);
+  if(!timerThread) timerThread = std::make_unique<std::thread>(&TaskPool::timerMain, this);
+  periodicCond.notify_all();
+  return p.id;
+}
+
+void TaskPool::removePeriodic(int id) {
+  std::shared_ptr<std::atomic<bool>> running;
+  {
+    std::lock_guard<std::mutex> lock(periodicMutex);
+    for(uint i=0; i<periodics.N; i++) if(periodics(i).id==id) {
+        running = periodics(i).running;
+        periodics.remove(i);
+        break;
+      }
+    periodicCond.notify_all();
+  }
+  CHECK(running, "periodic task " <<id <<" does not exist");
+  while(running->load()) {
+    if(!runPendingTask()) std::this_thread::yield();
+  }
+}
+
+void TaskPool::timerMain() {
+  std::unique_lock<std::mutex> lock(periodicMutex);
+  while(!stop) {
+    auto now = std::chrono::steady_clock::now();
+    auto wakeup = now + std::chrono::milliseconds(100);
+    for(Periodic& p:periodics) {
+      if(p.next<=now) {
+        if(!p.running->load()) { //skip (drop the tick) when the previous call is still running
+          p.running->store(true);
+          Task f = p.f;
+          std::shared_ptr<std::atomic<bool>> running = p.running;
+          submit([f, running]() {
+            try { //there is nobody to rethrow to: report, and keep the task scheduled
+              f();
+            } catch(const std::exception& ex) {
+              LOG(-1) <<"periodic task failed: " <<ex.what();
+            } catch(...) {
+              LOG(-1) <<"periodic task failed";
+            }
+            running->store(false);
+          });
+        }
+        auto dt = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(p.interval));
+        p.next += dt;
+        if(p.next<now) p.next = now+dt; //don't try to catch up lost ticks
+      }
+      if(p.next<wakeup) wakeup=p.next;
+    }
+    periodicCond.wait_until(lock, wakeup);
+  }
+}
+
+TaskPool& taskPool() {
+  static TaskPool pool;
+  return pool;
+}
+
+//===========================================================================
+//
+// TaskGroup
+//
+
+void TaskGroup::run(const TaskPool::Task& f) {
+  count++;
+  pool.submit([this, f]() {
+    try {
+      f();
+    } catch(...) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if(!error) error = std::current_exception();
+    }
+    count--;
+  });
+}
+
+void TaskGroup::join() {
+  while(count.load()>0) {
+    if(!pool.runPendingTask()) std::this_thread::yield();
+  }
+}
+
+void TaskGroup::wait() {
+  join();
+  if(error) {
+    std::exception_ptr e = error;
+    error = nullptr;
+    std::rethrow_exception(e);
+  }
+}
+
+//===========================================================================
+//
+// TaskGraph
+//
+
+uint TaskGraph::add(const TaskPool::Task& f, const uintA& deps) {
+  uint id = nodes.N;
+  auto n = std::make_shared<Node>();
+  n->f = f;
+  n->numDeps = deps.N;
+  for(uint d:deps) {
+    CHECK(d<id, "dependencies must be added before");
+    nodes(d)->successors.append(id);
+  }
+  nodes.append(n);
+  return id;
+}
+
+void TaskGraph::launch(uint i, TaskGroup& G) {
+  G.run([this, i, &G]() {
+    nodes(i)->f();
+    for(uint j:nodes(i)->successors) {
+      if(--nodes(j)->remaining==0) launch(j, G);
+    }
+  });
+}
+
+void TaskGraph::run(TaskPool& pool) {
+  for(auto& n:nodes) n->remaining = n->numDeps;
+  TaskGroup G(pool);
+  for(uint i=0; i<nodes.N; i++) if(!nodes(i)->numDeps) launch(i, G);
+  G.wait();
+}
+
+} //namespace
@@ -0,0 +1,137 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "util.h"
+#include "array.h"
+
+#include <deque>
+#include <future>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+namespace rai {
+
+//===========================================================================
+//
+/** A process-wide work-stealing task pool. Each worker owns a deque: it pushes/pops its own tasks at the back
+    (LIFO, cache-friendly for nested parallelism), idle workers steal from the front of others. Threads that wait
+    for tasks (TaskGroup::wait, parallel_for, TaskPool::get) execute pending tasks meanwhile, so nested waiting
+    does not deadlock and does not oversubscribe cores. Use rai::taskPool() to access the global instance. */
+struct TaskPool : NonCopyable {
+  typedef std::function<void()> Task;
+
+  TaskPool(uint nThreads=0); ///< nThreads=0: #hardware threads (or parameter 'taskPool/threads')
+  ~TaskPool();
+
+  uint numThreads() const { return workers.N; }
+
+  /// enqueue a fire-and-forget task
+  void submit(const Task& task);
+
+  /// enqueue a task and get a future of its return value
+  template<class F> auto async(F&& f) -> std::future<decltype(f())> {
+    typedef decltype(f()) R;
+    auto pt = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+    std::future<R> fut = pt->get_future();
+    submit([pt]() { (*pt)(); });
+    return fut;
+  }
+
+  /// wait for a future while executing pending tasks (use this instead of fut.get() from within tasks)
+  template<class R> R get(std::future<R>& fut) {
+    while(fut.wait_for(std::chrono::seconds(0))!=std::future_status::ready) {
+      if(!runPendingTask()) std::this_thread::yield();
+    }
+    return fut.get();
+  }
+
+  /// run f(i) for i in [begin, end) in chunks of size grain (grain=0: automatic); the caller participates
+  void parallel_for(uint begin, uint end, const std::function<void(uint)>& f, uint grain=0);
+
+  /// periodic tasks: f is submitted every interval>0 seconds (skipped if the previous call is still running); exceptions are logged
+  int addPeriodic(double intervalSec, const Task& f);
+  void removePeriodic(int id); ///< blocks until a running call of the task is finished
+
+  /// execute one pending task in the calling thread; returns false if there was none
+  bool runPendingTask();
+
+  //-- internals
+  struct Worker {
+    std::deque<Task> deque;
+    std::mutex mutex;
+    std::thread thread;
+  };
+  struct Periodic {
+    int id;
+    double interval;
+    std::chrono::time_point<std::chrono::steady_clock> next;
+    Task f;
+    std::shared_ptr<std::atomic<bool>> running;
+  };
+  rai::Array<Worker*> workers;
+  std::atomic<int> pending;
+  std::atomic<uint> nextQueue;
+  std::atomic<bool> stop;
+  std::mutex sleepMutex;
+  std::condition_variable sleepCond;
+
+  rai::Array<Periodic> periodics;
+  int periodicCount=0;
+  std::mutex periodicMutex;
+  std::condition_variable periodicCond;
+  std::unique_ptr<std::thread> timerThread;
+
+  bool popTask(Task& task, int self);
+  void workerMain(uint i);
+  void timerMain();
+};
+
+TaskPool& taskPool();
+
+//===========================================================================
+
+/// a set of tasks that can be waited for jointly (the waiting thread helps executing)
+struct TaskGroup : NonCopyable {
+  TaskPool& pool;
+  std::atomic<int> count;
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  TaskGroup(TaskPool& _pool=taskPool()) : pool(_pool), count(0) {}
+  ~TaskGroup() { join(); }
+
+  void run(const TaskPool::Task& f);
+  void wait(); ///< rethrows the first exception of a task
+  void join(); ///< only waits (no rethrow)
+};
+
+//===========================================================================
+
+/** A static DAG of tasks: add tasks with their dependencies (ids of previously added tasks), then run();
+    each task is submitted as soon as all its predecessors are done */
+struct TaskGraph : NonCopyable {
+  struct Node {
+    TaskPool::Task f;
+    uintA successors;
+    uint numDeps=0;
+    std::atomic<int> remaining;
+    Node() : remaining(0) {}
+  };
+  rai::Array<std::shared_ptr<Node>> nodes;
+
+  uint add(const TaskPool::Task& f, const uintA& deps= {});
+  void run(TaskPool& pool=taskPool()); ///< blocks until all tasks are done
+
+ private:
+  void launch(uint i, TaskGroup& G);
+};
+
+} //namespace
@@ -8,6 +8,7 @@
 
 #include "thread.h"
 #include "graph.h"
+#include "taskPool.h"
 
 #include <exception>
 #include <signal.h>
@@ -385,6 +386,10 @@ Thread::Thread(const char* _name, double beatIntervalSec)
 }
 
 Thread::~Thread() {
+    if(periodicTask>=0) { //don't leave a task calling into this on the pool (close() can't be called anymore, see below)
+      rai::taskPool().removePeriodic(periodicTask);
+      periodicTask=-1;
+    }
     if (thread) {
         std::cerr << "Call 'threadClose()' in the destructor of the DERIVED class! \
            That's because the 'virtual table is destroyed' before calling the destructor ~Thread (google 'call virtual function\
@@ -419,6 +424,16 @@ void Thread::threadOpen(bool wait, int priority) {
 void Thread::threadClose(double timeoutForce) {
   event.stopListening();
   event.setStatus(tsToClose);
+  if(periodicTask>=0) {
+    rai::taskPool().removePeriodic(periodicTask);
+    periodicTask=-1;
+    {
+      auto mux = stepMutex(RAI_HERE);
+      close(); //virtual close routine
+    }
+    event.setStatus(tsIsClosed);
+    return;
+  }
   if(!thread) { event.setStatus(tsIsClosed); return; }
   for(;;) {
     bool ended = event.waitForStatusEq(tsIsClosed, 0, .2);
@@ -480,6 +495,27 @@ void Thread::threadLoop(bool waitForOpened) {
   }
 }
 
+void Thread::threadLoopOnPool() {
+  CHECK(!thread, "thread '" <<name <<"' is already running in its own thread");
+  CHECK(metronome.ticInterval>1e-10, "only beating threads can become periodic tasks");
+  if(periodicTask>=0) return;
+  {
+    auto mux = stepMutex(RAI_HERE);
+    open(); //virtual open routine
+  }
+  event.setStatus(tsBEATING);
+  timer.reset();
+  periodicTask = rai::taskPool().addPeriodic(metronome.ticInterval, [this]() {
+    timer.cycleStart();
+    {
+      auto mux = stepMutex(RAI_HERE);
+      step(); //virtual step routine
+    }
+    step_count++;
+    timer.cycleDone();
+  });
+}
+
 void Thread::threadStop(bool wait) {
   if(thread) {
     event.setStatus(tsIDLE);
@@ -16,6 +16,7 @@
 #include <shared_mutex>
 #include <condition_variable>
 #include <thread>
+#include <atomic>
 
 enum ThreadState { tsIsClosed=-6, tsToOpen=-1, tsLOOPING=-2, tsBEATING=-3, tsIDLE=0, tsToStep=1, tsToClose=-4,  tsFAILURE=-5,  }; //positive states indicate steps-to-go
 struct Signaler;
@@ -223,6 +224,132 @@ struct Var {
 
 template<class T> std::ostream& operator<<(std::ostream& os, Var<T>& x) { x.write(os); return os; }
 
+//===========================================================================
+//
+// lock-free single-writer/multi-reader variables (for high-rate streams)
+//
+
+/** A ring of K slots: the (single) writer fills a slot that is neither the latest nor pinned by a reader and then
+    publishes it atomically; readers pin the latest slot with two atomic ops and never wait for the writer. The
+    writer only waits (yields) if all K-1 other slots are pinned by slow readers. Revision counting and callbacks
+    (and thereby Events/listening threads) follow Var_base; the rwlock is only taken by the writer around callbacks */
+template<class T, uint K=4>
+struct RingVar_data : Var_base {
+  struct Slot {
+    T data;
+    std::atomic<int> readers;
+    double data_time=0.;
+    int revision=0; ///< the revision under which this slot was published
+    Slot() : data(), readers(0) {}
+  };
+  Slot slots[K];
+  std::atomic<uint> latest;
+  std::atomic<uint> atomicRevision;
+
+  RingVar_data(const char* name=0) : Var_base(name), latest(0), atomicRevision(0) { static_assert(K>=3, "RingVar needs at least 3 slots"); }
+
+  uint pin() {
+    for(;;) {
+      uint i = latest.load();
+      slots[i].readers++;
+      if(latest.load()==i) return i; //the writer can't have chosen slot i since we pinned it
+      slots[i].readers--;
+    }
+  }
+  void unpin(uint i) { slots[i].readers--; }
+
+  uint beginWrite(bool copyLatest) {
+    uint cur = latest.load();
+    for(uint k=1;; k++) {
+      uint i = (cur+k)%K;
+      if(i!=cur && !slots[i].readers.load()) {
+        if(copyLatest) slots[i].data = slots[cur].data;
+        return i;
+      }
+      if(!(k%K)) std::this_thread::yield();
+    }
+  }
+  int endWrite(uint i, double dataTime) {
+    int rev = atomicRevision.load()+1; //(single writer)
+    slots[i].data_time = dataTime;
+    slots[i].revision = rev;
+    latest.store(i);
+    atomicRevision.store(rev);
+    rwlock.writeLock();
+    revision = rev;
+    write_time = rai::clockTime();
+    data_time = dataTime;
+    for(auto* c:callbacks) c->call()(this);
+    rwlock.unlock();
+    return rev;
+  }
+};
+
+template<class T, uint K>
+struct RingRToken {
+  RingVar_data<T, K>* var;
+  uint slot;
+  RingRToken(RingVar_data<T, K>& _var, int* getRevision=nullptr) : var(&_var) {
+    slot = var->pin();
+    if(getRevision) *getRevision = revision();
+  }
+  RingRToken(RingRToken&& t) : var(t.var), slot(t.slot) { t.var=nullptr; }
+  ~RingRToken() { if(var) var->unpin(slot); }
+  const T* operator->() { return &var->slots[slot].data; }
+  operator const T& () { return var->slots[slot].data; }
+  const T& operator()() { return var->slots[slot].data; }
+  double dataTime() { return var->slots[slot].data_time; }
+  int revision() { return var->slots[slot].revision; } ///< the revision of the data read (not of later writes)
+};
+
+template<class T, uint K>
+struct RingWToken {
+  RingVar_data<T, K>* var;
+  uint slot;
+  double dataTime;
+  RingWToken(RingVar_data<T, K>& _var, double _dataTime, bool copyLatest=true) : var(&_var), dataTime(_dataTime) {
+    slot = var->beginWrite(copyLatest);
+  }
+  RingWToken(RingWToken&& t) : var(t.var), slot(t.slot), dataTime(t.dataTime) { t.var=nullptr; }
+  ~RingWToken() { if(var) var->endWrite(slot, dataTime); }
+  void operator=(const T& y) { var->slots[slot].data=y; }
+  T* operator->() { return &var->slots[slot].data; }
+  operator T& () { return var->slots[slot].data; }
+  T& operator()() { return var->slots[slot].data; }
+};
+
+/** Same role as Var<T>, but reads are lock-free (never block, never block the writer). There must only be ONE
+    writing thread. set() is copy-on-write (read-modify-write like Var::set()); overwrite() skips the copy when the
+    whole value is assigned anyway. Best suited for small messages (CtrlCmdMsg, CtrlStateMsg, images) */
+template<class T, uint K=4>
+struct RingVar {
+  ptr<RingVar_data<T, K>> data;
+  Thread* thread;             ///< which thread is the owner
+  int last_read_revision;     ///< last revision that has been read
+
+  RingVar();
+  RingVar(const RingVar<T, K>& v) : RingVar(nullptr, v, false) {}
+  RingVar(Thread* _thread, bool threadListens=false);
+  RingVar(Thread* _thread, const RingVar<T, K>& v, bool threadListens=false);
+
+  RingVar& operator=(const RingVar& v){ HALT("you can't copy Var!") }
+
+  RingRToken<T, K> get() { return RingRToken<T, K>(*data, &last_read_revision); } ///< lock-free read access to the latest data
+  RingWToken<T, K> set(double dataTime=0.) { return RingWToken<T, K>(*data, dataTime); } ///< write access (only from one thread!)
+  RingWToken<T, K> overwrite(double dataTime=0.) { return RingWToken<T, K>(*data, dataTime, false); } ///< write access without copying the previous value
+  operator Var_base& () { return *std::dynamic_pointer_cast<Var_base>(data); }
+
+  rai::String& name() const { return data->name; }
+  int getRevision() { return data->atomicRevision.load(); }
+  bool hasNewRevision() { return getRevision()>last_read_revision; }
+  void waitForNextRevision(uint multipleRevisions=0) { waitForRevisionGreaterThan(last_read_revision+multipleRevisions); }
+  int waitForRevisionGreaterThan(int rev);
+
+  void addCallback(const std::function<void(Var_base*)>& call, const void* callbackID=0) {
+    data->addCallback(call, callbackID);
+  }
+};
+
 //===========================================================================
 
 /// a basic condition variable
@@ -336,6 +463,7 @@ struct Thread {
   uint step_count;              ///< how often the step was called
   Metronome metronome;          ///< used for beat-looping
   CycleTimer timer;             ///< measure how the time spend per cycle, within step, idle
+  int periodicTask=-1;          ///< id of the periodic task on rai::taskPool() (instead of an own thread), see threadLoopOnPool
 
   /// @name c'tor/d'tor
   /** DON'T open drivers/devices/files or so here in the constructor,
@@ -355,6 +483,7 @@ struct Thread {
   void threadLoop(bool waitForOpened=false);  ///< loop, either with fixed beat or at full speed
   void threadStop(bool wait=false);     ///< stop looping
   void threadCancel();                  ///< a hard kill (pthread_cancel) of the thread
+  void threadLoopOnPool();              ///< instead of an own thread: open() now, then step() as periodic task (with the beat interval) on rai::taskPool()
 
   void waitForOpened();                 ///< caller waits until opening is done (working -> idle mode)
   void waitForIdle();                   ///< caller waits until step is done (working -> idle mode)
@@ -448,3 +577,32 @@ int Var<T>::waitForRevisionGreaterThan(int rev) {
 
 template<class T>
 void Var<T>::stopListening() { thread->event.stopListenTo(data); }
+
+template<class T, uint K>
+RingVar<T, K>::RingVar()
+  : data(make_shared<RingVar_data<T, K>>()), thread(0), last_read_revision(0) {}
+
+template<class T, uint K>
+RingVar<T, K>::RingVar(Thread* _thread, bool threadListens)
+  : data(make_shared<RingVar_data<T, K>>()), thread(_thread), last_read_revision(0) {
+  if(thread && threadListens) thread->event.listenTo(*data);
+}
+
+template<class T, uint K>
+RingVar<T, K>::RingVar(Thread* _thread, const RingVar<T, K>& v, bool threadListens)
+  : data(v.data), thread(_thread), last_read_revision(0) {
+  if(thread && threadListens) thread->event.listenTo(*data);
+}
+
+template<class T, uint K>
+int RingVar<T, K>::waitForRevisionGreaterThan(int rev) {
+  EventFunction evFct = [&rev](const rai::Array<Var_base*>& vars, int whoChanged) -> int {
+    CHECK_EQ(vars.N, 1, "");
+    if(vars.scalar()->revision > (uint)rev) return 1;
+    return 0;
+  };
+
+  Event ev({data.get()}, evFct, 0);
+  ev.waitForStatusEq(1);
+  return getRevision();
+}
@@ -137,6 +137,25 @@ void open(std::ifstream& fs, const char* name, const char* errmsg) {
   if(!fs.good()) HALT("could not open file '" <<name <<"' for input" <<errmsg);
 }
 
+/// creates the directory '\c path' including all missing parents; HALTs if that fails
+void createDirectories(const char* path) {
+#ifndef RAI_MSVC
+  String p(path);
+  for(uint i=1; i<=p.N; i++) {
+    if(i<p.N && p.p[i]!='/') continue;
+    char c=p.p[i];
+    p.p[i]=0;
+    int r = mkdir(p.p, 0755), err = errno;
+    p.p[i]=c;
+    if(r && err!=EEXIST) HALT("could not create directory '" <<p <<"': " <<strerror(err));
+  }
+  struct stat st;
+  if(stat(path, &st) || !S_ISDIR(st.st_mode)) HALT("'" <<path <<"' exists but is not a directory");
+#else
+  NIY;
+#endif
+}
+
 /// returns true if the (0-terminated) string s contains c
 bool contains(const char* s, char c) {
   if(!s) return false;
@@ -236,6 +255,21 @@ void flip(byte& b, uint i) { b ^= 1 <<(7-(i&7)); }
 /// filps the i-th bit of b
 void flip(int& b, uint i) { b ^= 1 <<(7-(i&7)); }
 
+/// splitmix64 finalizer over 8-byte words
+uint64_t hashBytes(const void* p, size_t n, uint64_t seed) {
+  const unsigned char* c = (const unsigned char*)p;
+  uint64_t h = seed;
+  for(size_t i=0; i<n; i+=8) {
+    uint64_t w=0;
+    memmove(&w, c+i, (n-i<8 ? n-i : 8));
+    h ^= w;
+    h = (h ^ (h>>30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h>>27)) * 0x94d049bb133111ebull;
+    h ^= h>>31;
+  }
+  return h;
+}
+
 double MIN(double a, double b) { return a<b?a:b; }
 double MAX(double a, double b) { return a>b?a:b; }
 uint MAX(uint a, uint b) { return a>b?a:b; }
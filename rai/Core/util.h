@@ -100,6 +100,7 @@ void system(const char* cmd);
 //----- files
 void open(std::ofstream& fs, const char* name, const char* errmsg="");
 void open(std::ifstream& fs, const char* name, const char* errmsg="");
+void createDirectories(const char* path);
 String raiPath(const char* rel=nullptr);
 
 //----- very basic ui
@@ -119,6 +120,7 @@ bool skipUntil(std::istream& is, const char* tag);
 byte bit(byte* str, uint i);
 void flip(byte& b, uint i);
 void flip(int& b, uint i);
+uint64_t hashBytes(const void* p, size_t n, uint64_t seed=0); ///< fast non-cryptographic hash, e.g. to key disk caches by content
 double MIN(double a, double b);
 double MAX(double a, double b);
 uint MAX(uint a, uint b);
@@ -362,12 +364,16 @@ extern String errString;
 #define CHECK_LE(A, B, msg) \
   if(!(A<=B)){ LOG(-2) <<"CHECK_LE failed: '" <<#A<<"'=" <<A <<" '" <<#B <<"'=" <<B <<" -- " <<msg; throw std::runtime_error(rai::errString.p); }
 
+#define CHECK_LT(A, B, msg) \
+  if(!(A<B)){ LOG(-2) <<"CHECK_LT failed: '" <<#A<<"'=" <<A <<" '" <<#B <<"'=" <<B <<" -- " <<msg; throw std::runtime_error(rai::errString.p); }
+
 #else
 #define CHECK(cond, msg)
 #define CHECK_ZERO(expr, tolerance, msg)
 #define CHECK_EQ(A, B, msg)
 #define CHECK_GE(A, B, msg)
 #define CHECK_LE(A, B, msg)
+#define CHECK_LT(A, B, msg)
 #endif
 
 //===========================================================================
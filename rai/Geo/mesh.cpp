@@ -9,6 +9,7 @@
 #include "mesh.h"
 #include "qhull.h"
 #include "mesh_readAssimp.h"
+#include "../Core/taskPool.h"
 
 #include "../Optim/newton.h"
 
@@ -48,6 +49,7 @@ void rai::Mesh::clear() {
   if(C.nd==2) C.clear();
   T.clear(); Tn.clear();
   graph.clear();
+  _isHull=false;
 }
 
 void rai::Mesh::setBox() {
@@ -374,6 +376,7 @@ void rai::Mesh::box() {
 
 void rai::Mesh::addMesh(const Mesh& mesh2, const rai::Transformation& X) {
   uint n=V.d0, tn=tex.d0, t=T.d0, tt=Tt.d0;
+  _isHull=false;
   V.append(mesh2.V);
   if(V.N==C.N && mesh2.V.N==mesh2.C.N) C.append(mesh2.C); else C.clear();
   tex.append(mesh2.tex);
@@ -404,6 +407,8 @@ void rai::Mesh::makeConvexHull() {
   Tt.clear();
   tex.clear();
   texImg.clear();
+  _isHull=true;
+  if(V.d0>64) buildGraph(); else graph.clear(); //for hill-climbing support queries
 #else
   uintA H = getHullIndices(V, T);
   intA Hinv = consts<int>(-1, V.d0);
@@ -428,6 +433,74 @@ void rai::Mesh::makeConvexHull() {
 #endif
 }
 
+/** collision LOD: replaces the mesh by the hull of at most K of its hull vertices (an inner approximation): first the
+ *  supports along evenly spread directions, then repeatedly those vertices farthest outside the current LOD. Returns the
+ *  exact distance r of the full hull to the LOD, so that the full hull is contained in the LOD inflated by r */
+double rai::Mesh::makeConvexHullLOD(uint K) {
+  CHECK_GE(K, 4, "LOD needs at least a tetrahedron");
+  makeConvexHull();
+  if(V.d0<=K) return 0.;
+  arr full = V;
+
+  //-- supports along directions on a Fibonacci sphere
+  uintA sel;
+  uint nDir = K>=8 ? K/2 : K, start=0;
+  for(uint i=0; i<nDir; i++) {
+    double z = 1.-(2.*i+1.)/nDir, r = ::sqrt(1.-z*z), phi = i*RAI_PI*(3.-::sqrt(5.));
+    double d[3] = {r*::cos(phi), r*::sin(phi), z};
+    sel.setAppend(support(d, start));
+  }
+
+  arr dist(full.d0);
+  double r=0.;
+  for(;;) {
+    V.resize(sel.N, 3);
+    for(uint i=0; i<sel.N; i++) memmove(V.p+3*i, full.p+3*sel(i), 3*sizeof(double));
+    makeConvexHull();
+
+    //-- distances of all full hull vertices to the LOD (zero inside)
+    arr c = mean(V);
+    uint nT=T.d0;
+    arr n(nT, 3);
+    for(uint t=0; t<nT; t++) {
+      const double *a=V.p+3*T.p[3*t], *b=V.p+3*T.p[3*t+1], *cc=V.p+3*T.p[3*t+2];
+      Vector e = (Vector(b)-Vector(a))^(Vector(cc)-Vector(a));
+      if((Vector(a)-Vector(c.p))*e<0.) e*=-1.; //outward, whatever the orientation of T
+      memmove(n.p+3*t, &e.x, 3*sizeof(double));
+    }
+    r=0.;
+    for(uint i=0; i<full.d0; i++) {
+      const double* p=full.p+3*i;
+      bool outside=false;
+      for(uint t=0; t<nT && !outside; t++) {
+        const double *a=V.p+3*T.p[3*t], *e=n.p+3*t;
+        if((p[0]-a[0])*e[0]+(p[1]-a[1])*e[1]+(p[2]-a[2])*e[2] > 0.) outside=true;
+      }
+      dist(i)=0.;
+      if(!outside) continue;
+      double dmin=INFINITY, q[3];
+      for(uint t=0; t<nT; t++) {
+        closestPointOnTriangle(q, p, V.p+3*T.p[3*t], V.p+3*T.p[3*t+1], V.p+3*T.p[3*t+2]);
+        double d = rai::sqr(p[0]-q[0])+rai::sqr(p[1]-q[1])+rai::sqr(p[2]-q[2]);
+        if(d<dmin) dmin=d;
+      }
+      dist(i) = ::sqrt(dmin);
+      if(dist(i)>r) r=dist(i);
+    }
+    if(sel.N>=K || r==0.) break;
+
+    //-- add the farthest vertices
+    uint m = rai::MAX(1u, (K-sel.N)/2);
+    for(uint k=0; k<m; k++) {
+      uint i = argmax(dist);
+      if(dist(i)<=0.) break;
+      sel.setAppend(i);
+      dist(i)=0.;
+    }
+  }
+  return r;
+}
+
 void rai::Mesh::makeTriangleFan() {
   T.clear();
   for(uint i=1; i+1<V.d0; i++) {
@@ -615,6 +688,7 @@ void deleteZeroTriangles(rai::Mesh& m) {
 
 void permuteVertices(rai::Mesh& m, uintA& p) {
   CHECK_EQ(p.N, m.V.d0, "");
+  m.graph.clear();
   uint i;
   arr x(p.N, 3);
   for(i=0; i<p.N; i++) { x(i, 0)=m.V(p(i), 0); x(i, 1)=m.V(p(i), 1); x(i, 2)=m.V(p(i), 2); }
@@ -659,12 +733,6 @@ void rai::Mesh::deleteUnusedVertices() {
   V.resizeCopy(Nused, 3);
 }
 
-arr* COMP_V;
-bool COMP(uint i, uint j) {
-  bool r=(*COMP_V)[i]<(*COMP_V)[j];
-  return r;
-}
-
 /** @brief delete all void triangles (with vertex indices (0, 0, 0)) and void
   vertices (not used for triangles or strips) */
 void rai::Mesh::fuseNearVertices(double tol) {
@@ -678,9 +746,7 @@ void rai::Mesh::fuseNearVertices(double tol) {
   //cout <<V <<endl;
   //sort vertices lexically
   p.setStraightPerm(V.d0);
-  COMP_V=&V;
-  uint* pstop=p.p+p.N;
-  std::sort(p.p, pstop, COMP);
+  std::sort(p.p, p.p+p.N, [this](uint i, uint j) { return V[i]<V[j]; }); //no global comparator state: safe to run concurrently on different meshes
   permuteVertices(*this, p);
 
 //  cout <<"permuting.." <<std::flush;
@@ -1656,6 +1722,29 @@ void glDrawMeshes(void* P, OpenGL& gl) {
 
 //==============================================================================
 
+/// closest point c on triangle (a,b,cc) to p (Ericson, Real-Time Collision Detection, 5.1.5)
+void closestPointOnTriangle(double* c, const double* p, const double* a, const double* b, const double* cc) {
+  auto dot3 = [](const double* x, const double* y) { return x[0]*y[0]+x[1]*y[1]+x[2]*y[2]; };
+  double ab[3], ac[3], ap[3];
+  for(uint i=0; i<3; i++) { ab[i]=b[i]-a[i];  ac[i]=cc[i]-a[i];  ap[i]=p[i]-a[i]; }
+  double d1=dot3(ab, ap), d2=dot3(ac, ap);
+  if(d1<=0. && d2<=0.) { memmove(c, a, 3*sizeof(double)); return; }
+  double bp[3];  for(uint i=0; i<3; i++) bp[i]=p[i]-b[i];
+  double d3=dot3(ab, bp), d4=dot3(ac, bp);
+  if(d3>=0. && d4<=d3) { memmove(c, b, 3*sizeof(double)); return; }
+  double vc = d1*d4-d3*d2;
+  if(vc<=0. && d1>=0. && d3<=0.) { double v=d1/(d1-d3);  for(uint i=0; i<3; i++) c[i]=a[i]+v*ab[i]; return; }
+  double cp[3];  for(uint i=0; i<3; i++) cp[i]=p[i]-cc[i];
+  double d5=dot3(ab, cp), d6=dot3(ac, cp);
+  if(d6>=0. && d5<=d6) { memmove(c, cc, 3*sizeof(double)); return; }
+  double vb = d5*d2-d1*d6;
+  if(vb<=0. && d2>=0. && d6<=0.) { double w=d2/(d2-d6);  for(uint i=0; i<3; i++) c[i]=a[i]+w*ac[i]; return; }
+  double va = d3*d6-d5*d4;
+  if(va<=0. && (d4-d3)>=0. && (d5-d6)>=0.) { double w=(d4-d3)/((d4-d3)+(d5-d6));  for(uint i=0; i<3; i++) c[i]=b[i]+w*(cc[i]-b[i]); return; }
+  double denom=1./(va+vb+vc), v=vb*denom, w=vc*denom;
+  for(uint i=0; i<3; i++) c[i]=a[i]+ab[i]*v+ac[i]*w;
+}
+
 void inertiaSphere(double* I, double& mass, double density, double radius) {
   double r2=radius*radius;
   if(density) mass=density*4./3.*RAI_PI*r2*radius;
@@ -1808,84 +1897,207 @@ double GJK_distance(rai::Mesh& mesh1, rai::Mesh& mesh2,
 #ifdef RAI_Lewiner
 #  include "Lewiner/MarchingCubes.h"
 
-void rai::Mesh::setImplicitSurface(ScalarFunction f, double lo, double hi, uint res) {
-  setImplicitSurface(f, lo, hi, lo, hi, lo, hi, res);
-}
+namespace {
 
-void rai::Mesh::setImplicitSurface(ScalarFunction f, double xLo, double xHi, double yLo, double yHi, double zLo, double zHi, uint res) {
-  MarchingCubes mc(res, res, res);
-  mc.init_all() ;
-
-  //compute data
-  uint k=0, j=0, i=0;
-  float x, y, z;
-  for(k=0; k<res; k++) {
-    z = zLo+k*(zHi-zLo)/res;
-    for(j=0; j<res; j++) {
-      y = yLo+j*(yHi-yLo)/res;
-      for(i=0; i<res; i++) {
-        x = xLo+i*(xHi-xLo)/res;
-        mc.set_data(f(NoArr, NoArr, ARR((double)x, (double)y, (double)z)), i, j, k) ;
+struct SlabMarchingCubes : MarchingCubes { //exposes the per-edge vertex tables
+  using MarchingCubes::MarchingCubes;
+  using MarchingCubes::get_x_vert;
+  using MarchingCubes::get_y_vert;
+};
+
+/* Marching cubes on nx*ny*nz grid values (x fastest) in parallel z-slabs. Every slab runs its own Lewiner instance on the
+   shared data; vertices on the plane between two slabs are created by both, and the upper slab maps its copies onto the
+   lower slab's using Lewiner's per-edge vertex tables -- no locks or hashing. The output is written into preallocated V
+   and T, with vertex (i,j,k) at lo + (i,j,k)*delta. If transposed, the data is z fastest (a row-major arr(x,y,z)), and
+   nx, nz are the sizes along z, x. */
+void marchingCubes(rai::Mesh& M, const double* data, uint nx, uint ny, uint nz, const arr& lo, const arr& delta, bool transposed) {
+  M.clear();
+  if(nx<2 || ny<2 || nz<2) return;
+
+  struct Slab {
+    uint k0, n;          ///< first plane and number of planes
+    arr V;               ///< vertices in grid coordinates
+    intA T;
+    intA bottom, top;    ///< vertex ids on the x- and y-edges of the first and last plane (-1: none)
+    intA map;            ///< local -> global vertex index (-1: duplicate of the slab below)
+    uint nDup=0, offsetV=0, offsetT=0;
+  };
+  uint nSlabs = rai::MIN((nz-1)/4, 2*rai::taskPool().numThreads());
+  if(!nSlabs) nSlabs=1;
+  rai::Array<Slab> S(nSlabs);
+  for(uint s=0; s<nSlabs; s++) {
+    S(s).k0 = (s*(nz-1))/nSlabs;
+    S(s).n = ((s+1)*(nz-1))/nSlabs - S(s).k0 + 1;
+  }
+
+  //-- run the slabs
+  rai::taskPool().parallel_for(0, nSlabs, [&](uint s) {
+    Slab& slab = S(s);
+    SlabMarchingCubes mc(nx, ny, slab.n);
+    mc.set_ext_data(const_cast<double*>(data) + slab.k0*nx*ny); //read only
+    mc.init_all();
+    mc.run();
+    slab.V.resize(mc.nverts(), 3);
+    for(uint i=0; i<slab.V.d0; i++) {
+      const Vertex* v = mc.vert(i);
+      slab.V(i, 0)=v->x;  slab.V(i, 1)=v->y;  slab.V(i, 2)=v->z+slab.k0;
+    }
+    slab.T.resize(mc.ntrigs(), 3);
+    for(uint i=0; i<slab.T.d0; i++) {
+      const Triangle* t = mc.trig(i);
+      slab.T(i, 0)=t->v1;  slab.T(i, 1)=t->v2;  slab.T(i, 2)=t->v3;
+    }
+    slab.bottom.resize(2, ny, nx);
+    slab.top.resize(2, ny, nx);
+    for(uint j=0; j<ny; j++) for(uint i=0; i<nx; i++) {
+        slab.bottom(0, j, i) = mc.get_x_vert(i, j, 0);
+        slab.bottom(1, j, i) = mc.get_y_vert(i, j, 0);
+        slab.top(0, j, i) = mc.get_x_vert(i, j, slab.n-1);
+        slab.top(1, j, i) = mc.get_y_vert(i, j, slab.n-1);
+        if(s && slab.bottom(0, j, i)>=0) slab.nDup++;
+        if(s && slab.bottom(1, j, i)>=0) slab.nDup++;
+      }
+    mc.clean_temps();
+  }, 1);
+
+  //-- offsets into the output buffers
+  uint nV=0, nT=0;
+  for(Slab& slab:S) {
+    slab.offsetV=nV;  nV += slab.V.d0-slab.nDup;
+    slab.offsetT=nT;  nT += slab.T.d0;
+  }
+
+  //-- vertex maps: first own vertices, then the shared ones (which need the map of the slab below)
+  rai::taskPool().parallel_for(0, nSlabs, [&](uint s) {
+    Slab& slab = S(s);
+    slab.map.resize(slab.V.d0) = 0;
+    if(s) for(int v:slab.bottom) if(v>=0) slab.map(v)=-1;
+    uint m=slab.offsetV;
+    for(int& i:slab.map) i = (i<0 ? -1 : (int)m++);
+  }, 1);
+  rai::taskPool().parallel_for(1, nSlabs, [&](uint s) {
+    Slab& slab = S(s);
+    const Slab& below = S(s-1);
+    for(uint e=0; e<slab.bottom.N; e++) if(slab.bottom.elem(e)>=0) {
+        CHECK_GE(below.top.elem(e), 0, "slab planes disagree");
+        slab.map(slab.bottom.elem(e)) = below.map(below.top.elem(e));
+      }
+  }, 1);
+
+  //-- write into the preallocated mesh
+  M.V.resize(nV, 3);
+  M.T.resize(nT, 3);
+  rai::taskPool().parallel_for(0, nSlabs, [&](uint s) {
+    const Slab& slab = S(s);
+    for(uint i=0; i<slab.V.d0; i++) if(slab.map(i)>=0) {
+        const double* g = &slab.V(i, 0);
+        double* x = &M.V(slab.map(i), 0);
+        for(uint d=0; d<3; d++) x[d] = lo(d) + (transposed ? g[2-d] : g[d])*delta(d);
       }
+    for(uint i=0; i<slab.T.d0; i++) {
+      uint* t = &M.T(slab.offsetT+i, 0);
+      t[0] = slab.map(slab.T(i, 0));
+      t[1] = slab.map(slab.T(i, transposed ? 2 : 1)); //transposing the axes flips the orientation
+      t[2] = slab.map(slab.T(i, transposed ? 1 : 2));
     }
-  }
+  }, 1);
+}
 
-  mc.run();
-  mc.clean_temps();
+/* Evaluates f on the grid lo + (i,j,k)*(hi-lo)/res in batches of equal (j,k) -- concurrently only if parallel -- and meshes
+   the result. sparse: see Mesh::setImplicitSurface(VectorFunction...) */
+void implicitSurface(rai::Mesh& M, const VectorFunction& f, const arr& lo, const arr& hi, uint res, bool sparse, bool parallel) {
+  arr delta = (hi-lo)/double(res);
+  arr data(res, res, res); //(z,y,x): x fastest, as marchingCubes expects
 
-  //convert to Mesh
-  clear();
-  V.resize(mc.nverts(), 3);
-  T.resize(mc.ntrigs(), 3);
-  for(i=0; i<V.d0; i++) {
-    V(i, 0)=xLo+mc.vert(i)->x*(xHi-xLo)/res;
-    V(i, 1)=yLo+mc.vert(i)->y*(yHi-yLo)/res;
-    V(i, 2)=zLo+mc.vert(i)->z*(zHi-zLo)/res;
-  }
-  for(i=0; i<T.d0; i++) {
-    T(i, 0)=mc.trig(i)->v1;
-    T(i, 1)=mc.trig(i)->v2;
-    T(i, 2)=mc.trig(i)->v3;
-  }
-}
+  auto forEach = [parallel](uint n, const std::function<void(uint)>& body) {
+    if(parallel) rai::taskPool().parallel_for(0, n, body);
+    else for(uint r=0; r<n; r++) body(r);
+  };
 
-void rai::Mesh::setImplicitSurface(const arr& gridValues, const arr& lo, const arr& hi){
-  CHECK_EQ(gridValues.nd, 3, "");
+  auto evalRow = [&](uint j, uint k, const uintA& I) { //evaluates the points I of row (j,k) in one call
+    arr X(I.N, 3);
+    for(uint n=0; n<I.N; n++) {
+      X(n, 0)=lo(0)+I(n)*delta(0);  X(n, 1)=lo(1)+j*delta(1);  X(n, 2)=lo(2)+k*delta(2);
+    }
+    arr y = f(X);
+    CHECK_EQ(y.N, I.N, "the function needs to return one value per row of X");
+    for(uint n=0; n<I.N; n++) data(k, j, I(n)) = y.p[n];
+  };
 
-  MarchingCubes mc(gridValues.d0, gridValues.d1, gridValues.d2);
-  mc.init_all() ;
-  uint k=0, j=0, i=0;
-  for(k=0; k<gridValues.d2; k++) {
-    for(j=0; j<gridValues.d1; j++) {
-      for(i=0; i<gridValues.d0; i++) {
-        mc.set_data(gridValues(i,j,k), i, j, k) ;
+  if(!sparse) {
+    uintA I;
+    I.setStraightPerm(res);
+    forEach(res*res, [&](uint r) { evalRow(r%res, r/res, I); });
+  } else {
+    //evaluate only block centers first; a block whose |f| exceeds its radius plus a cell diagonal contains no surface and
+    //no point of it is corner of a cell with a sign change -- filling it with the center value gives the dense result
+    const uint B=8, nb=(res+B-1)/B;
+    arr C(nb*nb*nb, 3), radius(nb*nb*nb);
+    double cell = length(delta);
+    for(uint k=0; k<nb; k++) for(uint j=0; j<nb; j++) for(uint i=0; i<nb; i++) {
+          uint b=(k*nb+j)*nb+i, idx[3]= {i, j, k};
+          arr ext(3);
+          for(uint d=0; d<3; d++) {
+            double w = rai::MIN(B, res-idx[d]*B)-1;
+            C(b, d) = lo(d)+(idx[d]*B+.5*w)*delta(d);
+            ext(d) = .5*w*delta(d);
+          }
+          radius(b) = length(ext)+cell;
+        }
+    arr fc(C.d0);
+    forEach(nb*nb, [&](uint r) {
+      arr y = f(C({r*nb, r*nb+nb-1}));
+      CHECK_EQ(y.N, nb, "the function needs to return one value per row of X");
+      for(uint i=0; i<nb; i++) fc(r*nb+i) = y.p[i];
+    });
+    forEach(res*res, [&](uint r) {
+      uint j=r%res, k=r/res;
+      uintA I;
+      for(uint ib=0; ib<nb; ib++) {
+        uint b=((k/B)*nb+j/B)*nb+ib;
+        for(uint i=ib*B; i<rai::MIN((ib+1)*B, res); i++) {
+          if(fabs(fc(b))>radius(b)) data(k, j, i) = fc(b);
+          else I.append(i);
+        }
       }
-    }
+      if(I.N) evalRow(j, k, I);
+    });
   }
 
-  mc.run();
-  mc.clean_temps();
-
-  //convert to Mesh
-  clear();
-  V.resize(mc.nverts(), 3);
-  T.resize(mc.ntrigs(), 3);
-  for(i=0; i<V.d0; i++) {
-    V(i, 0)=lo(0)+mc.vert(i)->x*(hi(0)-lo(0))/(gridValues.d0-1);
-    V(i, 1)=lo(1)+mc.vert(i)->y*(hi(1)-lo(1))/(gridValues.d1-1);
-    V(i, 2)=lo(2)+mc.vert(i)->z*(hi(2)-lo(2))/(gridValues.d2-1);
-  }
-  for(i=0; i<T.d0; i++) {
-    T(i, 0)=mc.trig(i)->v1;
-    T(i, 1)=mc.trig(i)->v2;
-    T(i, 2)=mc.trig(i)->v3;
-  }
+  marchingCubes(M, data.p, res, res, res, lo, delta, false);
 }
 
-#else //Lewiner
+} //namespace
+
 void rai::Mesh::setImplicitSurface(ScalarFunction f, double lo, double hi, uint res) {
-  NICO
+  setImplicitSurface(f, lo, hi, lo, hi, lo, hi, res);
+}
+
+void rai::Mesh::setImplicitSurface(ScalarFunction f, double xLo, double xHi, double yLo, double yHi, double zLo, double zHi, uint res) {
+  VectorFunction rows = [&f](const arr& X) {
+    arr y(X.d0);
+    for(uint i=0; i<X.d0; i++) y.p[i] = f(NoArr, NoArr, X[i]);
+    return y;
+  };
+  implicitSurface(*this, rows, arr{xLo, yLo, zLo}, arr{xHi, yHi, zHi}, res, false, false); //f is not required to be thread safe
+}
+
+void rai::Mesh::setImplicitSurface(const VectorFunction& f, const arr& lo, const arr& hi, uint res, bool sparse) {
+  implicitSurface(*this, f, lo, hi, res, sparse, true);
 }
+
+void rai::Mesh::setImplicitSurface(const arr& gridValues, const arr& lo, const arr& hi) {
+  CHECK_EQ(gridValues.nd, 3, "");
+  arr delta = hi-lo;
+  for(uint d=0; d<3; d++) delta(d) /= double(gridValues.dim(d)-1);
+  marchingCubes(*this, gridValues.p, gridValues.d2, gridValues.d1, gridValues.d0, lo, delta, true);
+}
+
+#else //Lewiner
+void rai::Mesh::setImplicitSurface(ScalarFunction f, double lo, double hi, uint res) { NICO }
+void rai::Mesh::setImplicitSurface(ScalarFunction f, double xLo, double xHi, double yLo, double yHi, double zLo, double zHi, uint res) { NICO }
+void rai::Mesh::setImplicitSurface(const VectorFunction& f, const arr& lo, const arr& hi, uint res, bool sparse) { NICO }
+void rai::Mesh::setImplicitSurface(const arr& gridValues, const arr& lo, const arr& hi) { NICO }
 #endif
 
 void rai::Mesh::setImplicitSurfaceBySphereProjection(ScalarFunction f, double rad, uint fineness){
@@ -1926,52 +2138,31 @@ inline double __scalarProduct(const double* p1, const double* p2) {
   return p1[0]*p2[0]+p1[1]*p2[1]+p1[2]*p2[2];
 }
 
-uint rai::Mesh::support(const double* dir) {
-#if 1
-
-  arr _dir(dir, 3, true);
-  arr q = V*_dir;
-  return argmax(q);
-
-#elif 0
-
-  double s = __scalarProduct(dir, V.p);
-  double ms=s;
-  uint mi=0;
-  for(uint i=0; i<V.d0; i++) {
-    s = __scalarProduct(dir, V.p+3*i);
-    if(s>ms) { ms = s;  mi = i; }
-  }
-  _support_vertex = mi;
-  return _support_vertex;
-
-#else
-  if(!graph.N) buildGraph();
-
-  uint mi = _support_vertex;
-  double s = __scalarProduct(dir, V.p+3*mi);
-  double ms=s;
-  for(;;) {
-    //comput scalar product for all neighbors
-    uintA& neigh=graph.p[mi];
-
-    bool stop=true;
-    for(uint i:neigh) {
-      s = __scalarProduct(dir, V.p+3*i);
-      if(s>ms) {
-        mi = i;
-        ms = s;
-        stop = false;
-        break;
+uint rai::Mesh::support(const double* dir, uint& start) const {
+  if(_isHull && graph.N==V.d0 && V.d0>64) {
+    //hill climbing on the vertex graph (exact on convex hulls), warm-started at the caller's last support vertex: ~O(sqrt(n))
+    uint mi = start<V.d0 ? start : 0;
+    double ms = __scalarProduct(dir, V.p+3*mi);
+    for(bool improved=true; improved;) {
+      improved=false;
+      for(uint i:graph.p[mi]) {
+        double s = __scalarProduct(dir, V.p+3*i);
+        if(s>ms) { ms=s;  mi=i;  improved=true; }
       }
     }
-    if(stop) {
-      _support_vertex = mi;
-      return _support_vertex;
-    }
+    start = mi;
+    return mi;
   }
 
-#endif
+  //linear scan (without allocating V*dir)
+  double ms = __scalarProduct(dir, V.p);
+  uint mi=0;
+  for(uint i=1; i<V.d0; i++) {
+    double s = __scalarProduct(dir, V.p+3*i);
+    if(s>ms) { ms=s;  mi=i; }
+  }
+  start = mi;
+  return mi;
 }
 
 void rai::Mesh::supportMargin(uintA& verts, const arr& dir, double margin, int initialization) {
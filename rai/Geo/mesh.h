@@ -45,7 +45,7 @@ struct Mesh : GLDrawer {
   long parsing_pos_start;
   long parsing_pos_end;
 
-  uint _support_vertex=0;
+  bool _isHull=false;   ///< set by makeConvexHull: support() may then hill-climb on the graph
 
   Mesh();
 
@@ -64,9 +64,13 @@ struct Mesh : GLDrawer {
   void setCapsule(double r, double l, uint fineness=2);
   void setSSBox(double x_width, double y_width, double z_height, double r, uint fineness=2);
   void setSSCvx(const arr& core, double r, uint fineness=2);
-  void setImplicitSurface(ScalarFunction f, double lo=-10., double hi=+10., uint res=100);
+  void setImplicitSurface(ScalarFunction f, double lo=-10., double hi=+10., uint res=100); ///< f is evaluated serially (only the meshing is parallel)
   void setImplicitSurface(ScalarFunction f, double xLo, double xHi, double yLo, double yHi, double zLo, double zHi, uint res);
-  void setImplicitSurface(const arr& gridValues, const arr& lo, const arr& hi);
+  /** marching cubes on the grid lo + (i,j,k)*(hi-lo)/res, i,j,k<res, computed in parallel slabs. f is called concurrently (needs to be thread safe), each
+   *  time with a batch X of grid points (rows of X) of equal y and z, and returns one value per point. sparse: first evaluates
+   *  block centers and skips blocks far from the surface -- requires |f| to bound the distance to the surface (as SDFs do) */
+  void setImplicitSurface(const VectorFunction& f, const arr& lo, const arr& hi, uint res, bool sparse=false);
+  void setImplicitSurface(const arr& gridValues, const arr& lo, const arr& hi); ///< grid value (i,j,k) at lo + (i,j,k)*(hi-lo)/(dim-1)
   void setImplicitSurfaceBySphereProjection(ScalarFunction f, double rad, uint fineness=3);
   Mesh& setRandom(uint vertices=10);
   void setGrid(uint X, uint Y);
@@ -83,11 +87,13 @@ struct Mesh : GLDrawer {
   void box();
   void addMesh(const rai::Mesh& mesh2, const rai::Transformation& X=0);
   void makeConvexHull();
+  double makeConvexHullLOD(uint K); ///< hull of at most K of the hull vertices; returns r such that the full hull lies within the result inflated by r
   void makeTriangleFan();
   void makeLineStrip();
 
   /// @name support function
-  uint support(const double* dir);
+  uint support(const double* dir, uint& start) const; ///< start: vertex to hill-climb from (on large hulls); returns the support vertex, also in start
+  uint support(const double* dir) const { uint start=0;  return support(dir, start); }
   void supportMargin(uintA& verts, const arr& dir, double margin, int initialization=-1);
 
   /// @name internal computations & cleanup
@@ -150,6 +156,7 @@ arr MinkowskiSum(const arr& A, const arr& B);
 // C-style functions
 //
 
+void closestPointOnTriangle(double* c, const double* p, const double* a, const double* b, const double* cc);
 void inertiaSphere(double* Inertia, double& mass, double density, double radius);
 void inertiaBox(double* Inertia, double& mass, double density, double dx, double dy, double dz);
 void inertiaCylinder(double* Inertia, double& mass, double density, double height, double radius);
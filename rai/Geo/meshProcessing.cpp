@@ -0,0 +1,217 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "meshProcessing.h"
+#include "../Core/taskPool.h"
+
+#include <math.h>
+#include <unistd.h>
+
+namespace {
+
+//true if the points span less than 3 dimensions (qhull would fail on them)
+bool isFlat(const arr& V) {
+  if(V.d0<4) return true;
+  const double* p0=V.p;
+  auto far = [&V](const std::function<double(const double*)>& d, double& dmax) {
+    uint imax=0;
+    dmax=0.;
+    for(uint i=0; i<V.d0; i++) { double di=d(V.p+3*i);  if(di>dmax) { dmax=di;  imax=i; } }
+    return V.p+3*imax;
+  };
+  double scale, l, h;
+  const double* p1 = far([p0](const double* x) { return rai::sqr(x[0]-p0[0])+rai::sqr(x[1]-p0[1])+rai::sqr(x[2]-p0[2]); }, scale);
+  scale = ::sqrt(scale);
+  if(scale<1e-12) return true;
+  rai::Vector a(p0), e = rai::Vector(p1)-a;
+  e.normalize();
+  const double* p2 = far([&](const double* x) { rai::Vector d = rai::Vector(x)-a;  return (d - (d*e)*e).length(); }, l);
+  if(l<1e-6*scale) return true;
+  rai::Vector n = e ^ (rai::Vector(p2)-a);
+  n.normalize();
+  far([&](const double* x) { return fabs((rai::Vector(x)-a)*n); }, h);
+  return h<1e-6*scale;
+}
+
+//convex hull of M's vertices; returns its volume (zero for flat point sets, whose hull is just the points)
+double convexHullOf(rai::Mesh& H, const rai::Mesh& M) {
+  H.clear();
+  H.V = M.V;
+  if(M.C.N<=4) H.C = M.C;
+  if(isFlat(H.V)) return 0.;
+  H.makeConvexHull();
+  return H.getVolume();
+}
+
+//clips M's triangles by the plane x_k=c into the parts below (A) and above (B)
+void splitMesh(rai::Mesh& A, rai::Mesh& B, const rai::Mesh& M, uint k, double c) {
+  A.clear();  B.clear();
+  if(M.C.N<=4) { A.C = M.C;  B.C = M.C; }
+  auto addPolygon = [](rai::Mesh& S, const double* P, uint n) {
+    uint v=S.V.d0;
+    S.V.append(arr(P, 3*n, true).reshape(n, 3));
+    S.V.reshape(-1, 3);
+    for(uint i=1; i+1<n; i++) S.T.append(uintA{v, v+i, v+i+1});
+  };
+  double eps=0.;
+  for(uint i=0; i<M.V.d0; i++) eps = rai::MAX(eps, fabs(M.V.p[3*i+k]-c));
+  eps *= 1e-10;
+  double P[3][3], s[3], below[4*3], above[4*3];
+  for(uint t=0; t<M.T.d0; t++) {
+    for(uint i=0; i<3; i++) {
+      memmove(P[i], M.V.p+3*M.T.p[3*t+i], 3*sizeof(double));
+      s[i] = P[i][k]-c;
+      if(fabs(s[i])<eps) s[i]=0.;
+    }
+    if(s[0]==0. && s[1]==0. && s[2]==0.) { //in the plane: belongs to the side it bounds (the one its normal points away from)
+      double n = (P[1][(k+1)%3]-P[0][(k+1)%3])*(P[2][(k+2)%3]-P[0][(k+2)%3]) - (P[1][(k+2)%3]-P[0][(k+2)%3])*(P[2][(k+1)%3]-P[0][(k+1)%3]);
+      addPolygon(n>0. ? A : B, P[0], 3);
+      continue;
+    }
+    uint nb=0, na=0;
+    for(uint i=0; i<3; i++) { //Sutherland-Hodgman for both sides at once
+      const double *p=P[i], *q=P[(i+1)%3];
+      double sp=s[i], sq=s[(i+1)%3];
+      if(sp<=0.) { memmove(below+3*nb, p, 3*sizeof(double));  nb++; }
+      if(sp>=0.) { memmove(above+3*na, p, 3*sizeof(double));  na++; }
+      if((sp<0. && sq>0.) || (sp>0. && sq<0.)) {
+        double s=sp/(sp-sq), x[3];
+        for(uint j=0; j<3; j++) x[j] = p[j] + s*(q[j]-p[j]);
+        memmove(below+3*nb, x, 3*sizeof(double));  nb++;
+        memmove(above+3*na, x, 3*sizeof(double));  na++;
+      }
+    }
+    if(nb>=3) addPolygon(A, below, nb);
+    if(na>=3) addPolygon(B, above, na);
+  }
+  A.T.reshape(-1, 3);
+  B.T.reshape(-1, 3);
+  if(A.V.N) A.fuseNearVertices(1e-10);
+  if(B.V.N) B.fuseNearVertices(1e-10);
+}
+
+void decompose(MeshA& parts, const rai::Mesh& M, rai::Mesh& hull, double hullVol, double concavity, uint depth) {
+  if(depth && M.T.d0>=4 && hullVol>0.) {
+    //-- try splitting along each axis through the vertex mean
+    arr m = mean(M.V);
+    MeshA S(6), H(6);
+    arr vol(6);
+    int best=-1;
+    for(uint k=0; k<3; k++) {
+      splitMesh(S(2*k), S(2*k+1), M, k, m(k));
+      if(!S(2*k).T.N || !S(2*k+1).T.N) continue;
+      vol(2*k) = convexHullOf(H(2*k), S(2*k));
+      vol(2*k+1) = convexHullOf(H(2*k+1), S(2*k+1));
+      if(best<0 || vol(2*k)+vol(2*k+1) < vol(2*best)+vol(2*best+1)) best=k;
+    }
+    //-- recurse if the split removes enough empty hull volume
+    if(best>=0 && vol(2*best)+vol(2*best+1) < (1.-concavity)*hullVol) {
+      decompose(parts, S(2*best), H(2*best), vol(2*best), concavity, depth-1);
+      decompose(parts, S(2*best+1), H(2*best+1), vol(2*best+1), concavity, depth-1);
+      return;
+    }
+  }
+  parts.append(hull);
+}
+
+void writeCache(const char* filename, const rai::Mesh& M, const MeshA& parts) {
+  rai::String tmp;
+  tmp <<filename <<'.' <<getpid() <<'.' <<(void*)&M;
+  {
+    ofstream fil;
+    rai::open(fil, tmp);
+    auto writeMesh = [&fil](const rai::Mesh& m) {
+      m.V.writeTagged(fil, "V", true);
+      m.T.writeTagged(fil, "T", true);
+      m.C.writeTagged(fil, "C", true);
+      m.Vn.writeTagged(fil, "Vn", true);
+      m.Tn.writeTagged(fil, "Tn", true);
+    };
+    writeMesh(M);
+    uintA({parts.N}).writeTagged(fil, "parts", true);
+    for(const rai::Mesh& p:parts) writeMesh(p);
+    if(!fil.good()) { fil.close();  unlink(tmp);  return; }
+  }
+  rename(tmp, filename); //atomic: concurrent loaders never see partial files
+}
+
+bool readCache(const char* filename, rai::Mesh& M, MeshA& parts) {
+  ifstream fil(filename, std::ios::binary);
+  if(!fil.good()) return false;
+  auto readMesh = [&fil](rai::Mesh& m) {
+    return m.V.readTagged(fil, "V") && m.T.readTagged(fil, "T") && m.C.readTagged(fil, "C")
+           && m.Vn.readTagged(fil, "Vn") && m.Tn.readTagged(fil, "Tn");
+  };
+  rai::Mesh R;
+  uintA n;
+  if(!readMesh(R) || !n.readTagged(fil, "parts") || n.N!=1) return false;
+  MeshA P(n(0));
+  for(rai::Mesh& p:P) if(!readMesh(p)) return false;
+  M.V.swap(R.V);
+  M.T.swap(R.T);
+  M.C.swap(R.C);
+  M.Vn.swap(R.Vn);
+  M.Tn.swap(R.Tn);
+  parts = P;
+  return true;
+}
+
+} //namespace
+
+//===========================================================================
+
+void rai::decomposeConvex(MeshA& parts, const Mesh& mesh, double concavity, uint maxDepth) {
+  parts.clear();
+  Mesh hull;
+  double vol = convexHullOf(hull, mesh);
+  decompose(parts, mesh, hull, vol, concavity, maxDepth);
+}
+
+void rai::processMeshes(const MeshL& meshes, const MeshProcessing_Options& opt, rai::Array<MeshA>* parts) {
+  if(parts) parts->resize(meshes.N);
+  if(opt.fuseTolerance<=0. && !opt.normals && !opt.convexHull && opt.decompose<=0.) return; //nothing to do
+  if(opt.cachePath.N) rai::createDirectories(opt.cachePath);
+
+  //the cache key covers everything that determines the result
+  const double optKey[5] = {opt.fuseTolerance, (double)opt.normals, (double)opt.convexHull, opt.decompose, (double)opt.decomposeDepth};
+
+  rai::taskPool().parallel_for(0, meshes.N, [&](uint i) {
+    Mesh& M = *meshes(i);
+    MeshA P;
+    if(!M.V.N) return;
+
+    rai::String file;
+    if(opt.cachePath.N) {
+      uint64_t h = hashBytes(optKey, sizeof(optKey), 0x6d657368);
+      h = hashBytes(M.V.p, M.V.N*sizeof(double), h);
+      h = hashBytes(M.T.p, M.T.N*sizeof(uint), h);
+      h = hashBytes(M.C.p, M.C.N*sizeof(double), h);
+      //texture state: textured meshes are processed differently (not fused)
+      uint texDims[3] = {M.texImg.N, M.tex.N, M.Tt.N};
+      h = hashBytes(texDims, sizeof(texDims), h);
+      h = hashBytes(M.tex.p, M.tex.N*sizeof(double), h);
+      h = hashBytes(M.Tt.p, M.Tt.N*sizeof(uint), h);
+      file <<opt.cachePath <<'/' <<std::hex <<h <<std::dec <<".mesh";
+    }
+
+    if(file.N && readCache(file, M, P)) {
+      if(opt.convexHull) { M.Tt.clear();  M.tex.clear();  M.texImg.clear(); }
+    } else {
+      //textured meshes are not fused: texture coordinates are per (unfused) vertex
+      if(opt.fuseTolerance>0. && M.T.N && !M.texImg.N) M.fuseNearVertices(opt.fuseTolerance);
+      if(opt.decompose>0. && M.T.N) decomposeConvex(P, M, opt.decompose, opt.decomposeDepth);
+      if(opt.convexHull && !isFlat(M.V)) M.makeConvexHull();
+      if(opt.normals) {
+        if(M.T.N) M.computeNormals();
+        for(Mesh& p:P) if(p.T.N) p.computeNormals();
+      }
+      if(file.N) writeCache(file, M, P);
+    }
+    if(parts) (*parts)(i) = P;
+  }, 1);
+}
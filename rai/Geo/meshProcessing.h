@@ -0,0 +1,37 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "mesh.h"
+
+namespace rai {
+
+//===========================================================================
+
+struct MeshProcessing_Options {
+  RAI_PARAM("MeshProcessing/", double, fuseTolerance, 0.)     ///< fuseNearVertices tolerance (<=0: don't fuse)
+  RAI_PARAM("MeshProcessing/", bool, normals, false)          ///< compute normals
+  RAI_PARAM("MeshProcessing/", bool, convexHull, false)       ///< replace each mesh by its convex hull
+  RAI_PARAM("MeshProcessing/", double, decompose, 0.)         ///< >0: approximate convex decomposition; split while this fraction of hull volume is gained
+  RAI_PARAM("MeshProcessing/", int, decomposeDepth, 4)        ///< max splitting depth (at most 2^depth parts)
+  RAI_PARAM("MeshProcessing/", rai::String, cachePath, "")    ///< content-addressed disk cache, e.g. z.meshCache (empty: no caching)
+};
+
+/** Runs fusing, hull, normals, and decomposition on all meshes concurrently (one task per mesh on rai::taskPool()).
+ *  All steps and the cache are opt-in: with default options the meshes are left untouched.
+ *  Results are stored under a hash of the input mesh and the options, so repeated loads of the same asset skip the work.
+ *  If parts is given, it returns the convex parts of each mesh (empty unless opt.decompose>0).
+ *  Note: qhull is not reentrant, so the hull calls themselves are serialized (see getHull); all else runs in parallel. */
+void processMeshes(const MeshL& meshes, const MeshProcessing_Options& opt=MeshProcessing_Options(), rai::Array<MeshA>* parts=nullptr);
+
+/** approximate convex decomposition: recursively cuts the mesh by an axis-aligned plane through its vertex mean, choosing
+ *  the axis that shrinks the summed hull volume most, as long as this removes more than fraction 'concavity' of the volume */
+void decomposeConvex(MeshA& parts, const Mesh& mesh, double concavity=.05, uint maxDepth=4);
+
+} //namespace
@@ -284,8 +284,6 @@ void PairCollision::libccd(rai::Mesh& m1, rai::Mesh& m2, CCDmethod method) {
     int ret = ccdMPRPenetration(&m1, &m2, &ccd, &_depth, &_dir, &_pos, simplex);
     if(ret<0) {
       LOG(0) <<"WARNING: called MPR penetration for non intersecting meshes...";
-      m1._support_vertex = rnd(m1.V.d0);
-      m2._support_vertex = rnd(m2.V.d0);
       libccd(m1, m2, _ccdGJKIntersect);
       if(distance<0.) {
         LOG(0) <<"WARNING: but GJK says intersection";
@@ -317,8 +315,6 @@ void PairCollision::libccd(rai::Mesh& m1, rai::Mesh& m2, CCDmethod method) {
       int ret = ccdGJKPenetration(&m1, &m2, &ccd, &_depth, &_dir, &_pos);
       if(ret<0) {
         LOG(0) <<"WARNING: called MPR penetration for non intersecting meshes...";
-        m1._support_vertex = rnd(m1.V.d0);
-        m2._support_vertex = rnd(m2.V.d0);
         libccd(m1, m2, _ccdGJKIntersect);
         if(distance<0.) {
           LOG(0) <<"WARNING: but GJK says intersection";
@@ -909,3 +905,443 @@ double coll_3on3(arr& p1, arr& p2, arr& normal, const arr& pts1, const arr& pts2
   p1.reshape(3);
   return d;
 }
+
+//===========================================================================
+//
+// PairCollisionBatch: GJK on support functions in local frames
+//
+
+namespace {
+
+struct ConvexSupport {
+  enum Type { _point, _segment, _box, _hull } type;
+  const rai::Mesh* mesh;
+  double a[3], b[3]; //point, segment ends, or box half extents (a)
+  double R[9], pos[3];
+
+  void init(const rai::Mesh& m, const rai::Transformation& t) {
+    mesh = &m;
+    t.rot.getMatrix(R);
+    pos[0]=t.pos.x;  pos[1]=t.pos.y;  pos[2]=t.pos.z;
+    const double* V = m.V.p;
+    if(m.V.d0==1) { type=_point;  memmove(a, V, 3*sizeof(double)); }
+    else if(m.V.d0==2) { type=_segment;  memmove(a, V, 3*sizeof(double));  memmove(b, V+3, 3*sizeof(double)); }
+    else if(isCenteredBox(m.V)) type=_box;
+    else type=_hull;
+  }
+
+  void init(const PrimitiveCore& c, const rai::Transformation& t) {
+    mesh = 0;
+    t.rot.getMatrix(R);
+    pos[0]=t.pos.x;  pos[1]=t.pos.y;  pos[2]=t.pos.z;
+    a[0]=a[1]=a[2]=b[0]=b[1]=0.;
+    switch(c.type) {
+      case PrimitiveCore::_point: type=_point; break;
+      case PrimitiveCore::_segment: type=_segment;  a[2]=-c.half[2];  b[2]=c.half[2]; break;
+      case PrimitiveCore::_box: type=_box;  memmove(a, c.half, 3*sizeof(double)); break;
+      default: HALT("");
+    }
+  }
+
+  //8 vertices at (+-a0, +-a1, +-a2), all sign combinations present
+  bool isCenteredBox(const arr& V) {
+    if(V.d0!=8) return false;
+    for(uint k=0; k<3; k++) { a[k]=fabs(V.p[k]); if(a[k]<1e-10) return false; }
+    uint signs=0;
+    for(uint i=0; i<8; i++) {
+      uint bits=0;
+      for(uint k=0; k<3; k++) {
+        double v=V.p[3*i+k];
+        if(fabs(fabs(v)-a[k])>1e-12) return false;
+        if(v>0.) bits |= 1<<k;
+      }
+      signs |= 1<<bits;
+    }
+    return signs==0xff;
+  }
+
+  //world support point p in world direction dir
+  void support(double* p, const double* dir) const {
+    double d[3], l[3]={0., 0., 0.};
+    for(uint i=0; i<3; i++) d[i] = R[i]*dir[0] + R[3+i]*dir[1] + R[6+i]*dir[2];
+    switch(type) {
+      case _point: memmove(l, a, 3*sizeof(double)); break;
+      case _segment: {
+        double da = d[0]*a[0]+d[1]*a[1]+d[2]*a[2];
+        double db = d[0]*b[0]+d[1]*b[1]+d[2]*b[2];
+        memmove(l, da>=db ? a : b, 3*sizeof(double));
+      } break;
+      case _box: for(uint k=0; k<3; k++) l[k] = d[k]>=0. ? a[k] : -a[k]; break;
+      case _hull: {
+        const double* V = mesh->V.p;
+        uint n = mesh->V.d0, best=0;
+        double bestDot = d[0]*V[0]+d[1]*V[1]+d[2]*V[2];
+        for(uint i=1; i<n; i++) {
+          double dot = d[0]*V[3*i]+d[1]*V[3*i+1]+d[2]*V[3*i+2];
+          if(dot>bestDot) { bestDot=dot; best=i; }
+        }
+        memmove(l, V+3*best, 3*sizeof(double));
+      } break;
+      default: HALT("unknown support type");
+    }
+    for(uint i=0; i<3; i++) p[i] = R[3*i]*l[0] + R[3*i+1]*l[1] + R[3*i+2]*l[2] + pos[i];
+  }
+};
+
+inline double dot3(const double* x, const double* y) { return x[0]*y[0]+x[1]*y[1]+x[2]*y[2]; }
+
+//solves the symmetric m-by-m system G x = r (m<=3) with partial pivoting; false if singular
+bool solveSmall(double G[3][3], double* r, uint m) {
+  for(uint c=0; c<m; c++) {
+    uint piv=c;
+    for(uint i=c+1; i<m; i++) if(fabs(G[i][c])>fabs(G[piv][c])) piv=i;
+    if(fabs(G[piv][c])<1e-20) return false;
+    if(piv!=c) { for(uint j=0; j<m; j++) std::swap(G[c][j], G[piv][j]);  std::swap(r[c], r[piv]); }
+    for(uint i=c+1; i<m; i++) {
+      double f = G[i][c]/G[c][c];
+      for(uint j=c; j<m; j++) G[i][j] -= f*G[c][j];
+      r[i] -= f*r[c];
+    }
+  }
+  for(uint c=m; c--;) {
+    for(uint j=c+1; j<m; j++) r[c] -= G[c][j]*r[j];
+    r[c] /= G[c][c];
+  }
+  return true;
+}
+
+struct GJK {
+  double W[4][3], PA[4][3], PB[4][3], lambda[4];
+  uint n=0;
+
+  //closest point v of the simplex hull to the origin; reduces the simplex to the supporting subset
+  //(enumerates all subsets, smallest first -- robust and cheap for <=4 points)
+  double reduce(double* v) {
+    double best=INFINITY, bestLambda[4];
+    uint bestMask=0;
+    for(uint m=1; m<=n; m++) for(uint mask=1; mask<(1u<<n); mask++) {
+        uint idx[4]={0, 0, 0, 0}, k=0;
+        for(uint i=0; i<n; i++) if(mask&(1<<i)) idx[k++]=i;
+        if(k!=m) continue;
+        double lam[4], x[3];
+        const double* y0 = W[idx[0]];
+        if(m==1) {
+          lam[0]=1.;
+          memmove(x, y0, 3*sizeof(double));
+        } else {
+          double E[3][3]={}, G[3][3], r[3];
+          for(uint j=1; j<m; j++) for(uint c=0; c<3; c++) E[j-1][c] = W[idx[j]][c]-y0[c];
+          for(uint i=0; i<m-1; i++) {
+            for(uint j=0; j<m-1; j++) G[i][j] = dot3(E[i], E[j]);
+            r[i] = -dot3(E[i], y0);
+          }
+          if(!solveSmall(G, r, m-1)) continue;
+          lam[0]=1.;
+          bool inside=true;
+          for(uint j=1; j<m; j++) { lam[j]=r[j-1];  lam[0]-=r[j-1];  if(lam[j]<=0.) inside=false; }
+          if(!inside || lam[0]<=0.) continue;
+          for(uint c=0; c<3; c++) { x[c]=y0[c];  for(uint j=1; j<m; j++) x[c] += lam[j]*E[j-1][c]; }
+        }
+        double d = dot3(x, x);
+        if(d<best*(1.-1e-10)) {
+          best=d;  bestMask=mask;
+          for(uint j=0; j<m; j++) bestLambda[j]=lam[j];
+          memmove(v, x, 3*sizeof(double));
+        }
+      }
+    CHECK(bestMask, "GJK: no valid sub-simplex");
+    uint k=0;
+    for(uint i=0; i<n; i++) if(bestMask&(1<<i)) {
+        if(k!=i) {
+          memmove(W[k], W[i], 3*sizeof(double));
+          memmove(PA[k], PA[i], 3*sizeof(double));
+          memmove(PB[k], PB[i], 3*sizeof(double));
+        }
+        lambda[k]=bestLambda[k];
+        k++;
+      }
+    n=k;
+    return best;
+  }
+
+  //returns false if the shapes (nearly) intersect, or if it did not converge within maxIters (callers then use the exact path)
+  bool run(const ConvexSupport& A, const ConvexSupport& B, uint maxIters=64) {
+    double v[3], mv[3];
+    for(uint c=0; c<3; c++) v[c] = A.pos[c]-B.pos[c];
+    if(dot3(v, v)<1e-20) { v[0]=1.; v[1]=v[2]=0.; }
+    n=0;
+    double vv = INFINITY;
+    for(uint iter=0; iter<maxIters; iter++) {
+      for(uint c=0; c<3; c++) mv[c]=-v[c];
+      double *a=PA[n], *b=PB[n], *w=W[n];
+      A.support(a, mv);
+      B.support(b, v);
+      for(uint c=0; c<3; c++) w[c]=a[c]-b[c];
+      if(n) {
+        //converged: the new support point does not get closer to the origin than v
+        if(vv - dot3(v, w) <= 1e-12*vv) break;
+        bool dup=false;
+        for(uint i=0; i<n; i++) if(W[i][0]==w[0] && W[i][1]==w[1] && W[i][2]==w[2]) { dup=true; break; }
+        if(dup) break;
+      }
+      n++;
+      double vvNew = reduce(v);
+      if(n==4 || vvNew<1e-20) return false; //origin enclosed or touching
+      if(vvNew>=vv) break; //no more progress
+      vv = vvNew;
+      if(iter+1==maxIters) return false; //v is not converged
+    }
+    return true;
+  }
+};
+
+void uniquePoints(arr& S, const double P[4][3], uint n) {
+  uint k=0;
+  S.resize(n, 3);
+  for(uint i=0; i<n; i++) {
+    bool dup=false;
+    for(uint j=0; j<i; j++) if(P[i][0]==P[j][0] && P[i][1]==P[j][1] && P[i][2]==P[j][2]) { dup=true; break; }
+    if(!dup) memmove(S.p+3*(k++), P[i], 3*sizeof(double));
+  }
+  S.resizeCopy(k, 3);
+}
+
+//witness points, normal and simplices from a converged GJK; false if the cores touch
+bool setFromGJK(PairCollision& coll, const GJK& gjk) {
+  coll.p1.resize(3).setZero();
+  coll.p2.resize(3).setZero();
+  coll.normal.resize(3);
+  for(uint k=0; k<gjk.n; k++) for(uint c=0; c<3; c++) {
+      coll.p1.p[c] += gjk.lambda[k]*gjk.PA[k][c];
+      coll.p2.p[c] += gjk.lambda[k]*gjk.PB[k][c];
+    }
+  for(uint c=0; c<3; c++) coll.normal.p[c] = coll.p1.p[c]-coll.p2.p[c];
+  coll.distance = length(coll.normal);
+  if(coll.distance<=1e-10) return false;
+  coll.normal /= coll.distance;
+  uniquePoints(coll.simplex1, gjk.PA, gjk.n);
+  uniquePoints(coll.simplex2, gjk.PB, gjk.n);
+  return true;
+}
+
+}//namespace
+
+uint PairCollisionBatch::add(rai::Mesh& mesh1, rai::Mesh& mesh2, const rai::Transformation& t1, const rai::Transformation& t2, double rad1, double rad2) {
+  pairs.append({&mesh1, &mesh2, &t1, &t2, rad1, rad2});
+  return pairs.N-1;
+}
+
+void PairCollisionBatch::compute() {
+  colls.resizeCopy(pairs.N);
+  fallbacks=0;
+  ConvexSupport A, B;
+  GJK gjk;
+  for(uint i=0; i<pairs.N; i++) {
+    Pair& P = pairs(i);
+    bool pointToPcl = (P.mesh1->V.d0==1 && P.mesh2->V.d0>2 && !P.mesh2->T.N);
+    bool done=false;
+    if(!pointToPcl && P.mesh1->V.d0 && P.mesh2->V.d0) {
+      A.init(*P.mesh1, *P.t1);
+      B.init(*P.mesh2, *P.t2);
+      if(gjk.run(A, B, maxIters)) {
+        //reuse the previous output object (and its buffers) if nobody else holds it
+        shared_ptr<PairCollision>& coll = colls(i);
+        if(!coll || coll.use_count()>1) coll = make_shared<PairCollision>();
+        coll->mesh1=P.mesh1;  coll->mesh2=P.mesh2;
+        coll->t1=P.t1;  coll->t2=P.t2;
+        coll->rad1=P.rad1;  coll->rad2=P.rad2;
+        coll->poly.clear();  coll->polyNorm.clear();
+        done = setFromGJK(*coll, gjk);
+      }
+    }
+    if(!done) {
+      colls(i) = make_shared<PairCollision>(*P.mesh1, *P.mesh2, *P.t1, *P.t2, P.rad1, P.rad2);
+      fallbacks++;
+    }
+  }
+}
+
+//===========================================================================
+//
+// closed-form collisions of primitive cores
+//
+
+namespace {
+
+struct WorldCore {
+  PrimitiveCore::Type type;
+  double R[9], pos[3], half[3];
+  double s0[3], s1[3]; //segment ends in world coordinates
+
+  WorldCore(const PrimitiveCore& c, const rai::Transformation& t) : type(c.type) {
+    t.rot.getMatrix(R);
+    pos[0]=t.pos.x;  pos[1]=t.pos.y;  pos[2]=t.pos.z;
+    memmove(half, c.half, 3*sizeof(double));
+    if(type==PrimitiveCore::_segment) {
+      for(uint i=0; i<3; i++) { s0[i] = pos[i]-half[2]*R[3*i+2];  s1[i] = pos[i]+half[2]*R[3*i+2]; }
+    }
+  }
+  void toWorld(double* y, const double* l) const {
+    for(uint i=0; i<3; i++) y[i] = R[3*i]*l[0] + R[3*i+1]*l[1] + R[3*i+2]*l[2] + pos[i];
+  }
+};
+
+inline double clamp01(double x) { return x<0. ? 0. : (x>1. ? 1. : x); }
+
+//rows of S: the given points
+void setSimplex(arr& S, std::initializer_list<const double*> pts) {
+  S.resize(pts.size(), 3);
+  uint i=0;
+  for(const double* p:pts) memmove(S.p+3*(i++), p, 3*sizeof(double));
+}
+
+//the simplex of a segment at parameter s: the end point, or both ends if s is interior
+void setSegmentSimplex(arr& S, const WorldCore& c, double s) {
+  if(s<=0.) setSimplex(S, {c.s0});
+  else if(s>=1.) setSimplex(S, {c.s1});
+  else setSimplex(S, {c.s0, c.s1});
+}
+
+//p1, p2 given: normal and distance from their difference; false if they (nearly) coincide
+bool finalize(PairCollision& coll) {
+  coll.normal = coll.p1-coll.p2;
+  coll.distance = length(coll.normal);
+  if(coll.distance<=1e-10) return false;
+  coll.normal /= coll.distance;
+  return true;
+}
+
+bool collPointPoint(PairCollision& coll, const WorldCore& c1, const WorldCore& c2) {
+  coll.p1 = arr(c1.pos, 3, false);
+  coll.p2 = arr(c2.pos, 3, false);
+  setSimplex(coll.simplex1, {c1.pos});
+  setSimplex(coll.simplex2, {c2.pos});
+  return finalize(coll);
+}
+
+bool collPointSegment(PairCollision& coll, const WorldCore& c1, const WorldCore& c2) {
+  double d[3], r[3];
+  for(uint i=0; i<3; i++) { d[i]=c2.s1[i]-c2.s0[i];  r[i]=c1.pos[i]-c2.s0[i]; }
+  double s = clamp01(dot3(r, d)/dot3(d, d));
+  coll.p1 = arr(c1.pos, 3, false);
+  coll.p2.resize(3);
+  for(uint i=0; i<3; i++) coll.p2.p[i] = c2.s0[i]+s*d[i];
+  setSimplex(coll.simplex1, {c1.pos});
+  setSegmentSimplex(coll.simplex2, c2, s);
+  return finalize(coll);
+}
+
+//closest points of two segments (Ericson, Real-Time Collision Detection, 5.1.9)
+bool collSegmentSegment(PairCollision& coll, const WorldCore& c1, const WorldCore& c2) {
+  double d1[3], d2[3], r[3];
+  for(uint i=0; i<3; i++) { d1[i]=c1.s1[i]-c1.s0[i];  d2[i]=c2.s1[i]-c2.s0[i];  r[i]=c1.s0[i]-c2.s0[i]; }
+  double a=dot3(d1, d1), e=dot3(d2, d2), f=dot3(d2, r), c=dot3(d1, r), b=dot3(d1, d2);
+  double denom = a*e-b*b;
+  double s = denom>1e-12*a*e ? clamp01((b*f-c*e)/denom) : 0.;
+  double t = (b*s+f)/e;
+  if(t<0.) { t=0.;  s=clamp01(-c/a); }
+  else if(t>1.) { t=1.;  s=clamp01((b-c)/a); }
+  coll.p1.resize(3);
+  coll.p2.resize(3);
+  for(uint i=0; i<3; i++) { coll.p1.p[i] = c1.s0[i]+s*d1[i];  coll.p2.p[i] = c2.s0[i]+t*d2[i]; }
+  setSegmentSimplex(coll.simplex1, c1, s);
+  setSegmentSimplex(coll.simplex2, c2, t);
+  return finalize(coll);
+}
+
+//point vs box, including the point being inside the box (negative distance, normal along the nearest face)
+bool collPointBox(PairCollision& coll, const WorldCore& c1, const WorldCore& c2) {
+  const double* h = c2.half;
+  double x[3], q[3];
+  for(uint k=0; k<3; k++) {
+    x[k] = 0.;
+    for(uint i=0; i<3; i++) x[k] += c2.R[3*i+k]*(c1.pos[i]-c2.pos[i]);
+  }
+  uint nClamped=0;
+  bool clamped[3];
+  for(uint k=0; k<3; k++) {
+    q[k] = x[k];
+    clamped[k] = (x[k]<=-h[k] || x[k]>=h[k]);
+    if(clamped[k]) { q[k] = x[k]<0. ? -h[k] : h[k];  nClamped++; }
+  }
+  bool inside = !nClamped;
+  uint face=0;
+  if(inside) { //project onto the nearest face
+    for(uint k=1; k<3; k++) if(h[k]-fabs(x[k]) < h[face]-fabs(x[face])) face=k;
+    q[face] = x[face]<0. ? -h[face] : h[face];
+    clamped[face]=true;
+    nClamped=1;
+  }
+
+  coll.p1 = arr(c1.pos, 3, false);
+  coll.p2.resize(3);
+  c2.toWorld(coll.p2.p, q);
+  setSimplex(coll.simplex1, {c1.pos});
+
+  //simplex2: the face, edge or vertex the witness lies on
+  double corner[4][3];
+  if(nClamped==1) {
+    uint k=0;  while(!clamped[k]) k++;
+    uint j=(k+1)%3, l=(k+2)%3;
+    double sj[3]={-1., 1., 1.}, sl[3]={-1., -1., 1.};
+    for(uint m=0; m<3; m++) {
+      double lc[3];
+      lc[k]=q[k];  lc[j]=sj[m]*h[j];  lc[l]=sl[m]*h[l];
+      c2.toWorld(corner[m], lc);
+    }
+    setSimplex(coll.simplex2, {corner[0], corner[1], corner[2]});
+  } else if(nClamped==2) {
+    uint j=0;  while(clamped[j]) j++;
+    double lc[3];
+    memmove(lc, q, 3*sizeof(double));
+    lc[j]=-h[j];  c2.toWorld(corner[0], lc);
+    lc[j]=h[j];  c2.toWorld(corner[1], lc);
+    setSimplex(coll.simplex2, {corner[0], corner[1]});
+  } else {
+    setSimplex(coll.simplex2, {coll.p2.p});
+  }
+
+  if(!inside) return finalize(coll);
+
+  //penetration: normal is the outward face normal, such that <normal, p1-p2> = distance < 0
+  coll.normal.resize(3);
+  double sgn = x[face]<0. ? -1. : 1.;
+  for(uint i=0; i<3; i++) coll.normal.p[i] = sgn*c2.R[3*i+face];
+  coll.distance = scalarProduct(coll.normal, coll.p1-coll.p2);
+  return coll.distance<-1e-10;
+}
+
+//exchanges the roles of the two objects
+void swapPair(PairCollision& coll) {
+  coll.p1.swap(coll.p2);
+  coll.simplex1.swap(coll.simplex2);
+  coll.normal *= -1.;
+}
+
+}//namespace
+
+bool primitiveCollision(PairCollision& coll, const PrimitiveCore& c1, const PrimitiveCore& c2,
+                        const rai::Transformation& t1, const rai::Transformation& t2) {
+  typedef PrimitiveCore PC;
+  coll.mesh1=coll.mesh2=0;
+  coll.t1=&t1;  coll.t2=&t2;
+  coll.rad1=c1.radius;  coll.rad2=c2.radius;
+  coll.poly.clear();  coll.polyNorm.clear();
+
+  WorldCore w1(c1, t1), w2(c2, t2);
+  bool ret=false;
+  if(c1.type==PC::_point && c2.type==PC::_point) ret = collPointPoint(coll, w1, w2);
+  else if(c1.type==PC::_point && c2.type==PC::_segment) ret = collPointSegment(coll, w1, w2);
+  else if(c1.type==PC::_segment && c2.type==PC::_point) { ret = collPointSegment(coll, w2, w1);  swapPair(coll); }
+  else if(c1.type==PC::_segment && c2.type==PC::_segment) ret = collSegmentSegment(coll, w1, w2);
+  else if(c1.type==PC::_point && c2.type==PC::_box) ret = collPointBox(coll, w1, w2);
+  else if(c1.type==PC::_box && c2.type==PC::_point) { ret = collPointBox(coll, w2, w1);  swapPair(coll); }
+  else { //segment-box, box-box: GJK on the closed-form supports
+    ConvexSupport A, B;
+    A.init(c1, t1);
+    B.init(c2, t2);
+    GJK gjk;
+    if(gjk.run(A, B)) ret = setFromGJK(coll, gjk);
+  }
+  return ret;
+}
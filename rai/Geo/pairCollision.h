@@ -33,6 +33,7 @@ struct PairCollision : GLDrawer, NonCopyable {
                 const rai::Transformation& t1, const rai::Transformation& t2,
                 double rad1=0., double rad2=0.);
   PairCollision(ScalarFunction func1, ScalarFunction func2, const arr& seed);
+  PairCollision() {} ///< empty: outputs are filled externally (see PairCollisionBatch)
   ~PairCollision() {}
 
   void write(std::ostream& os) const;
@@ -79,3 +80,42 @@ double coll_2on3(arr& p1, arr& p2, arr& normal, const arr& pts1, const arr& pts2
 double coll_3on3(arr& p1, arr& p2, arr& normal, const arr& pts1, const arr& pts2, const arr& center);
 
 stdOutPipe(PairCollision)
+
+//===========================================================================
+
+/// a primitive convex core for closed-form collisions: a point (sphere), a segment along the local z-axis (capsule), or a box (ssBox)
+struct PrimitiveCore {
+  enum Type { _none=-1, _point, _segment, _box } type=_none;
+  double half[3]={0., 0., 0.}; ///< segment: half[2] is the half length; box: half extents
+  double radius=0.;
+};
+
+/** closed-form collision of two primitive cores, no meshes involved: point-point, point-segment, segment-segment and
+ *  point-box (also penetrating) exactly; segment-box and box-box by GJK on their closed-form supports. Fills coll as
+ *  the PairCollision constructor would (distance of the cores, witness points, normal, simplices); returns false
+ *  (coll undefined) if the cores intersect in a case not handled, so the caller can fall back to meshes */
+bool primitiveCollision(PairCollision& coll, const PrimitiveCore& c1, const PrimitiveCore& c2,
+                        const rai::Transformation& t1, const rai::Transformation& t2);
+
+//===========================================================================
+
+/** Batched narrow phase for convex pairs (typically sscCores: points, segments, boxes or small hulls).
+ *  Each pair runs a compact GJK directly on support functions evaluated in the shapes' local frames, i.e., without
+ *  the transformed mesh copies of PairCollision; point, segment and axis-aligned box cores have closed-form
+ *  supports, other hulls a flat max-dot loop. Pairs whose cores (nearly) intersect, or whose GJK does not converge within
+ *  maxIters, fall back to PairCollision. */
+struct PairCollisionBatch {
+  struct Pair {
+    rai::Mesh *mesh1, *mesh2;
+    const rai::Transformation *t1, *t2;
+    double rad1, rad2;
+  };
+  rai::Array<Pair> pairs;
+  rai::Array<shared_ptr<PairCollision>> colls; ///< OUTPUT: one PairCollision per pair (distance, p1, p2, normal, simplex1, simplex2)
+  uint maxIters=64;                              ///< GJK iterations per pair; pairs that do not converge within them fall back
+  uint fallbacks=0;                              ///< number of pairs in the last compute() that needed the full PairCollision
+
+  uint add(rai::Mesh& mesh1, rai::Mesh& mesh2, const rai::Transformation& t1, const rai::Transformation& t2, double rad1=0., double rad2=0.);
+  void clear() { pairs.clear(); colls.clear(); }
+  void compute();
+};
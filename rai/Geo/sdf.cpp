@@ -0,0 +1,369 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "sdf.h"
+#include "pairCollision.h"
+
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+const char SDF_MAGIC[8] = {'R', 'A', 'I', 'S', 'D', 'F', '0', '1'};
+
+struct SDF_Header {
+  char magic[8];
+  uint64_t hash;
+  double lo[3], res, band;
+  uint32_t nb[3], nNear;
+};
+
+inline double dot3(const double* a, const double* b) { return a[0]*b[0]+a[1]*b[1]+a[2]*b[2]; }
+
+} //namespace
+
+namespace rai {
+
+SparseSDF::~SparseSDF() {
+  if(mapped) munmap(mapped, mappedSize);
+}
+
+uint64_t SparseSDF::getHash(const Mesh& mesh, double res, double band) {
+  uint64_t h = 0x5df0;
+  h = hashBytes(mesh.V.p, mesh.V.N*sizeof(double), h);
+  h = hashBytes(mesh.T.p, mesh.T.N*sizeof(uint), h);
+  h = hashBytes(&res, sizeof(double), h);
+  h = hashBytes(&band, sizeof(double), h);
+  return h;
+}
+
+void SparseSDF::build(const Mesh& mesh, double _res, double _band) {
+  CHECK(mesh.T.N, "SDF needs a triangle mesh");
+  CHECK_GE(_band, _res, "band should cover at least a cell");
+  if(mapped) { munmap(mapped, mappedSize);  mapped=0; }
+  res=_res;
+  band=_band;
+  hash=getHash(mesh, res, band);
+
+  //-- grid: mesh bounds padded by band and a cell, rounded up to full bricks
+  double mi[3]={INFINITY, INFINITY, INFINITY}, ma[3]={-INFINITY, -INFINITY, -INFINITY};
+  for(uint i=0; i<mesh.V.d0; i++) for(uint k=0; k<3; k++) {
+      double v=mesh.V.p[3*i+k];
+      if(v<mi[k]) mi[k]=v;
+      if(v>ma[k]) ma[k]=v;
+    }
+  uint n[3];
+  for(uint k=0; k<3; k++) {
+    lo[k] = mi[k]-band-res;
+    uint cells = ceil((ma[k]+band+res-lo[k])/res);
+    nb[k] = (cells+B-1)/B;
+    n[k] = nb[k]*B+1;
+  }
+  uint N = n[0]*n[1]*n[2];
+  auto id = [&n](uint i, uint j, uint k) { return i + n[0]*(j + n[1]*k); };
+
+  //-- orientation: flip normals if the mesh is inward oriented (negative volume)
+  const double* V = mesh.V.p;
+  double vol=0.;
+  for(uint t=0; t<mesh.T.d0; t++) {
+    const double *a=V+3*mesh.T.p[3*t], *b=V+3*mesh.T.p[3*t+1], *c=V+3*mesh.T.p[3*t+2];
+    vol += a[0]*(b[1]*c[2]-b[2]*c[1]) - a[1]*(b[0]*c[2]-b[2]*c[0]) + a[2]*(b[0]*c[1]-b[1]*c[0]);
+  }
+  double orient = vol<0. ? -1. : 1.;
+
+  //-- unsigned distance within band: rasterize each triangle's padded bounding box
+  arr dist(N), faceOn(N);
+  byteA inside(N);
+  dist = INFINITY;
+  faceOn = 0.f;
+  inside = 0;
+  for(uint t=0; t<mesh.T.d0; t++) {
+    const double *a=V+3*mesh.T.p[3*t], *b=V+3*mesh.T.p[3*t+1], *c=V+3*mesh.T.p[3*t+2];
+    double nrm[3], ab[3], ac[3];
+    for(uint i=0; i<3; i++) { ab[i]=b[i]-a[i];  ac[i]=c[i]-a[i]; }
+    nrm[0]=ab[1]*ac[2]-ab[2]*ac[1];  nrm[1]=ab[2]*ac[0]-ab[0]*ac[2];  nrm[2]=ab[0]*ac[1]-ab[1]*ac[0];
+    double l=::sqrt(dot3(nrm, nrm));
+    if(l<1e-20) continue;
+    for(uint i=0; i<3; i++) nrm[i] *= orient/l;
+    uint from[3], to[3];
+    for(uint k=0; k<3; k++) {
+      double mi=rai::MIN(a[k], rai::MIN(b[k], c[k]))-band, ma=rai::MAX(a[k], rai::MAX(b[k], c[k]))+band;
+      from[k] = rai::MAX(0., floor((mi-lo[k])/res));
+      to[k] = rai::MIN(double(n[k]-1), ceil((ma-lo[k])/res));
+    }
+    double p[3], q[3], d[3];
+    for(uint kk=from[2]; kk<=to[2]; kk++) for(uint jj=from[1]; jj<=to[1]; jj++) for(uint ii=from[0]; ii<=to[0]; ii++) {
+          p[0]=lo[0]+ii*res;  p[1]=lo[1]+jj*res;  p[2]=lo[2]+kk*res;
+          closestPointOnTriangle(q, p, a, b, c);
+          for(uint i=0; i<3; i++) d[i]=p[i]-q[i];
+          double dd=::sqrt(dot3(d, d));
+          if(dd>band) continue;
+          uint x=id(ii, jj, kk);
+          //sign from the most face-on of the (equally) closest triangles
+          double cosine = dd>1e-12 ? dot3(nrm, d)/dd : 1.;
+          if(dd<dist.p[x]-1e-9 || (dd<dist.p[x]+1e-9 && fabs(cosine)>faceOn.p[x])) {
+            dist.p[x]=dd;
+            faceOn.p[x]=fabs(cosine);
+            inside.p[x]=(cosine<0.);
+          }
+        }
+  }
+
+  //-- sign outside the band: flood fill from the grid boundary through far points; unreached far points are inside
+  byteA outside(N);
+  outside = 0;
+  uintA queue;
+  auto push = [&](uint x) { if(!outside.p[x] && dist.p[x]==INFINITY) { outside.p[x]=1;  queue.append(x); } };
+  for(uint k=0; k<n[2]; k++) for(uint j=0; j<n[1]; j++) for(uint i=0; i<n[0]; i++) {
+        if(i==0 || j==0 || k==0 || i==n[0]-1 || j==n[1]-1 || k==n[2]-1) push(id(i, j, k));
+      }
+  for(uint q=0; q<queue.N; q++) {
+    uint x=queue.p[q];
+    uint i=x%n[0], j=(x/n[0])%n[1], k=x/(n[0]*n[1]);
+    if(i>0) push(x-1);
+    if(i<n[0]-1) push(x+1);
+    if(j>0) push(x-n[0]);
+    if(j<n[1]-1) push(x+n[0]);
+    if(k>0) push(x-n[0]*n[1]);
+    if(k<n[2]-1) push(x+n[0]*n[1]);
+  }
+  auto signedValue = [&](uint x)->float {
+    if(dist.p[x]==INFINITY) return outside.p[x] ? band : -band;
+    return inside.p[x] ? -dist.p[x] : dist.p[x];
+  };
+
+  //-- bricks
+  uint nBricks = nb[0]*nb[1]*nb[2];
+  const uint S=B+1;
+  _index.resize(nBricks);
+  _value.resize(nBricks);
+  _data.clear();
+  nNear=0;
+  for(uint bk=0; bk<nb[2]; bk++) for(uint bj=0; bj<nb[1]; bj++) for(uint bi=0; bi<nb[0]; bi++) {
+        uint b = bi + nb[0]*(bj + nb[1]*bk);
+        bool near=false;
+        for(uint k=0; k<S && !near; k++) for(uint j=0; j<S && !near; j++) for(uint i=0; i<S; i++) {
+              if(dist.p[id(bi*B+i, bj*B+j, bk*B+k)]<INFINITY) { near=true; break; }
+            }
+        _value.p[b] = signedValue(id(bi*B+B/2, bj*B+B/2, bk*B+B/2));
+        if(!near) { _index.p[b] = UINT32_MAX;  continue; }
+        _index.p[b] = nNear++;
+        uint off = _data.N;
+        _data.resizeCopy(off+S*S*S);
+        for(uint k=0; k<S; k++) for(uint j=0; j<S; j++) for(uint i=0; i<S; i++) {
+              _data.p[off + i + S*(j + S*k)] = signedValue(id(bi*B+i, bj*B+j, bk*B+k));
+            }
+      }
+  index=_index.p;
+  value=_value.p;
+  data=_data.p;
+}
+
+double SparseSDF::eval(double* g, const double* x) const {
+  const uint S=B+1;
+  double u[3], outside[3]={0., 0., 0.};
+  uint c[3];
+  for(uint k=0; k<3; k++) {
+    double hi = lo[k]+nb[k]*B*res;
+    double xk = x[k];
+    if(xk<lo[k]) { outside[k]=xk-lo[k];  xk=lo[k]; }
+    if(xk>hi) { outside[k]=xk-hi;  xk=hi; }
+    u[k] = (xk-lo[k])/res;
+    c[k] = floor(u[k]);
+    if(c[k]>=nb[k]*B) c[k]=nb[k]*B-1;
+    u[k] -= c[k];
+  }
+  double out = ::sqrt(dot3(outside, outside));
+  if(out>0.) { //beyond the grid: far away by construction
+    if(g) for(uint k=0; k<3; k++) g[k]=outside[k]/out;
+    return band+out;
+  }
+
+  uint b = c[0]/B + nb[0]*(c[1]/B + nb[1]*(c[2]/B));
+  uint ib = index[b];
+  if(ib==UINT32_MAX) {
+    if(g) g[0]=g[1]=g[2]=0.;
+    return value[b];
+  }
+
+  //-- trilinear interpolation within the brick, with its gradient
+  const float* D = data + ib*S*S*S;
+  uint i=c[0]%B, j=c[1]%B, k=c[2]%B;
+  double v[8];
+  for(uint m=0; m<8; m++) v[m] = D[(i+(m&1)) + S*((j+((m>>1)&1)) + S*(k+((m>>2)&1)))];
+  double x0=u[0], x1=u[1], x2=u[2];
+  double c00=v[0]*(1.-x0)+v[1]*x0, c10=v[2]*(1.-x0)+v[3]*x0;
+  double c01=v[4]*(1.-x0)+v[5]*x0, c11=v[6]*(1.-x0)+v[7]*x0;
+  double c0=c00*(1.-x1)+c10*x1, c1=c01*(1.-x1)+c11*x1;
+  if(g) {
+    double d00=v[1]-v[0], d10=v[3]-v[2], d01=v[5]-v[4], d11=v[7]-v[6];
+    g[0] = ((d00*(1.-x1)+d10*x1)*(1.-x2) + (d01*(1.-x1)+d11*x1)*x2)/res;
+    g[1] = ((c10-c00)*(1.-x2) + (c11-c01)*x2)/res;
+    g[2] = (c1-c0)/res;
+  }
+  return c0*(1.-x2)+c1*x2;
+}
+
+double SparseSDF::f(arr& g, const arr& x) const {
+  CHECK_EQ(x.N, 3, "");
+  if(!!g) { g.resize(3);  return eval(g.p, x.p); }
+  return eval(nullptr, x.p);
+}
+
+ScalarFunction SparseSDF::functional(const Transformation& pose) const {
+  return [this, pose](arr& g, arr& H, const arr& x)->double {
+    Vector y = pose / Vector(x);
+    double gl[3];
+    double d = eval(!!g ? gl : nullptr, &y.x);
+    if(!!g) g = conv_vec2arr(pose.rot * Vector(gl[0], gl[1], gl[2]));
+    if(!!H) H.resize(3, 3).setZero();
+    return d;
+  };
+}
+
+void SparseSDF::write(const char* filename) const {
+  SDF_Header h;
+  memmove(h.magic, SDF_MAGIC, 8);
+  h.hash=hash;
+  memmove(h.lo, lo, 3*sizeof(double));
+  h.res=res;  h.band=band;
+  for(uint k=0; k<3; k++) h.nb[k]=nb[k];
+  h.nNear=nNear;
+  uint nBricks=nb[0]*nb[1]*nb[2];
+  ofstream fil;
+  rai::open(fil, filename);
+  fil.write((const char*)&h, sizeof(h));
+  fil.write((const char*)index, nBricks*sizeof(uint32_t));
+  fil.write((const char*)value, nBricks*sizeof(float));
+  fil.write((const char*)data, size_t(nNear)*(B+1)*(B+1)*(B+1)*sizeof(float));
+  CHECK(fil.good(), "could not write SDF to '" <<filename <<"'");
+}
+
+bool SparseSDF::map(const char* filename) {
+  int fd = ::open(filename, O_RDONLY);
+  if(fd<0) return false;
+  struct stat st;
+  if(fstat(fd, &st) || (size_t)st.st_size<sizeof(SDF_Header)) { close(fd);  return false; }
+  void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(p==MAP_FAILED) return false;
+  const SDF_Header& h = *(const SDF_Header*)p;
+  uint nBricks = h.nb[0]*h.nb[1]*h.nb[2];
+  size_t size = sizeof(SDF_Header) + nBricks*(sizeof(uint32_t)+sizeof(float)) + size_t(h.nNear)*(B+1)*(B+1)*(B+1)*sizeof(float);
+  if(memcmp(h.magic, SDF_MAGIC, 8) || (size_t)st.st_size!=size) { munmap(p, st.st_size);  return false; }
+
+  if(mapped) munmap(mapped, mappedSize);
+  mapped=p;
+  mappedSize=st.st_size;
+  hash=h.hash;
+  memmove(lo, h.lo, 3*sizeof(double));
+  res=h.res;  band=h.band;
+  for(uint k=0; k<3; k++) nb[k]=h.nb[k];
+  nNear=h.nNear;
+  const char* c = (const char*)p + sizeof(SDF_Header);
+  index = (const uint32_t*)c;  c += nBricks*sizeof(uint32_t);
+  value = (const float*)c;     c += nBricks*sizeof(float);
+  data = (const float*)c;
+  _index.clear();  _value.clear();  _data.clear();
+  return true;
+}
+
+std::shared_ptr<SparseSDF> SparseSDF::getCached(const Mesh& mesh, double res, double band) {
+  rai::String path = rai::getParameter<rai::String>("SDF/cachePath", "");
+  auto sdf = make_shared<SparseSDF>();
+  if(!path.N) { sdf->build(mesh, res, band);  return sdf; } //no disk cache
+
+  uint64_t h = getHash(mesh, res, band);
+  rai::String file;
+  file <<path <<'/' <<std::hex <<h <<std::dec <<".sdf";
+
+  if(sdf->map(file) && sdf->hash==h) return sdf;
+
+  sdf->build(mesh, res, band);
+  rai::createDirectories(path);
+  rai::String tmp;
+  tmp <<file <<'.' <<getpid();
+  sdf->write(tmp);
+  rename(tmp, file); //atomic: concurrent builders never see partial files
+  return sdf;
+}
+
+} //namespace
+
+//===========================================================================
+
+bool sdfCollision(PairCollision& coll, const rai::SparseSDF& sdf, const rai::Transformation& tSdf,
+                  const PrimitiveCore& core, const rai::Transformation& tCore, bool sdfIsFirst) {
+  if(core.type!=PrimitiveCore::_point && core.type!=PrimitiveCore::_segment) return false;
+
+  //-- core point(s) in the SDF frame
+  rai::Transformation rel;
+  rel.setDifference(tSdf, tCore);
+  rai::Vector a = rel.pos, dir(0., 0., 0.);
+  double len=0.;
+  if(core.type==PrimitiveCore::_segment) {
+    dir = rel.rot.getZ();
+    len = 2.*core.half[2];
+    a -= core.half[2]*dir;
+  }
+
+  //-- deepest point along the segment: samples at cell spacing, then golden section around the best
+  auto eval = [&](double s) { rai::Vector x = a + s*dir; return sdf.eval(nullptr, &x.x); };
+  double s=0., d=eval(0.);
+  if(len>0.) {
+    uint n = 1+ceil(len/sdf.res);
+    for(uint i=1; i<=n; i++) {
+      double si = len*i/n, di = eval(si);
+      if(di<d) { d=di;  s=si; }
+    }
+    double l=rai::MAX(0., s-len/n), u=rai::MIN(len, s+len/n);
+    const double gr=.5*(::sqrt(5.)-1.);
+    double x1=u-gr*(u-l), x2=l+gr*(u-l), f1=eval(x1), f2=eval(x2);
+    for(uint k=0; k<20; k++) {
+      if(f1<f2) { u=x2;  x2=x1;  f2=f1;  x1=u-gr*(u-l);  f1=eval(x1); }
+      else { l=x1;  x1=x2;  f1=f2;  x2=l+gr*(u-l);  f2=eval(x2); }
+    }
+    double sm=.5*(l+u), dm=eval(sm);
+    if(dm<d) { d=dm;  s=sm; }
+  }
+
+  //-- witness points and normal in world coordinates
+  rai::Vector x = a + s*dir;
+  double gx[3];
+  d = sdf.eval(gx, &x.x);
+  rai::Vector g(gx);
+  double gl = g.length();
+  if(gl<1e-10) return false; //far brick: no gradient
+  g /= gl;
+  rai::Vector p1 = tSdf * x;
+  rai::Vector n = tSdf.rot * g;
+  rai::Vector p2 = p1 - d*n;
+
+  coll.mesh1=coll.mesh2=0;
+  coll.poly.clear();  coll.polyNorm.clear();
+  coll.distance = d;
+  if(!sdfIsFirst) {
+    coll.t1=&tCore;  coll.t2=&tSdf;
+    coll.rad1=core.radius;  coll.rad2=0.;
+    coll.p1 = conv_vec2arr(p1);
+    coll.p2 = conv_vec2arr(p2);
+    coll.normal = conv_vec2arr(n);
+  } else {
+    coll.t1=&tSdf;  coll.t2=&tCore;
+    coll.rad1=0.;  coll.rad2=core.radius;
+    coll.p1 = conv_vec2arr(p2);
+    coll.p2 = conv_vec2arr(p1);
+    coll.normal = -conv_vec2arr(n);
+  }
+  coll.simplex1 = ~coll.p1;
+  coll.simplex2 = ~coll.p2;
+  return true;
+}
@@ -0,0 +1,68 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "mesh.h"
+
+struct PairCollision;
+struct PrimitiveCore;
+
+namespace rai {
+
+//===========================================================================
+
+/** A signed distance field of a static, closed (possibly non-convex) mesh on a sparse voxel grid, for O(1) queries.
+ *  The grid is split into bricks of B^3 cells; only bricks within 'band' of the surface store their (B+1)^3 corner
+ *  values, all others a single clamped value (+-band). Distances beyond the band are therefore clamped (with zero
+ *  gradient) -- choose band larger than the largest query radius plus margin. Fields are built offline (build) and
+ *  stored in a flat binary file that is memory-mapped on load; getCached() keys these files by a hash of the mesh. */
+struct SparseSDF : NonCopyable {
+  static const uint B=8;   ///< cells per brick side
+
+  double lo[3];            ///< grid origin (mesh frame)
+  double res=0.;           ///< cell size
+  double band=0.;          ///< distances are exact within this band, clamped beyond
+  uint nb[3];              ///< bricks per axis
+  uint64_t hash=0;         ///< of mesh, res and band (key of the disk cache)
+
+  SparseSDF() {}
+  ~SparseSDF();
+
+  void build(const Mesh& mesh, double _res, double _band);
+
+  /// signed distance (negative inside) and gradient at x (mesh frame); g may be nullptr
+  double eval(double* g, const double* x) const;
+  double f(arr& g, const arr& x) const;  ///< same, with arrays
+  ScalarFunction functional(const Transformation& pose) const; ///< in world coordinates (H not provided)
+
+  void write(const char* filename) const;
+  bool map(const char* filename);       ///< memory-maps a file written by write(); false if missing or invalid
+
+  static uint64_t getHash(const Mesh& mesh, double res, double band);
+  /// loads (maps) the field from the disk cache (parameter 'SDF/cachePath', e.g. z.sdfCache; empty default: no caching) or builds and caches it
+  static std::shared_ptr<SparseSDF> getCached(const Mesh& mesh, double res, double band);
+
+ private:
+  //either point into the owned arrays or into the mapped file
+  const uint32_t* index=0;   ///< per brick: index of its data block, or UINT32_MAX for a far brick
+  const float* value=0;      ///< per brick: clamped value (used for far bricks)
+  const float* data=0;       ///< (B+1)^3 corner values per near brick (x fastest)
+  uint nNear=0;
+  rai::Array<uint32_t> _index;
+  floatA _value, _data;
+  void* mapped=0;
+  size_t mappedSize=0;
+};
+
+} //namespace
+
+/** distance between a point or segment core and a mesh represented by its SDF; fills coll as PairCollision does, with the
+ *  SDF's mesh as object 2 (or object 1 if sdfIsFirst); false if the core is not a point or segment */
+bool sdfCollision(PairCollision& coll, const rai::SparseSDF& sdf, const rai::Transformation& tSdf,
+                  const PrimitiveCore& core, const rai::Transformation& tCore, bool sdfIsFirst=false);
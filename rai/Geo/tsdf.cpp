@@ -0,0 +1,308 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "tsdf.h"
+#include "../Core/taskPool.h"
+
+#include <math.h>
+
+namespace {
+
+const int B = rai::TSDF::B;
+const int C = 4; //blocks per meshing chunk side
+
+//block coordinates are packed into 21 bits each
+inline uint64_t blockKey(int x, int y, int z) {
+  const uint64_t o=1<<20, m=(1<<21)-1;
+  return ((uint64_t(x+o)&m)<<42) | ((uint64_t(y+o)&m)<<21) | (uint64_t(z+o)&m);
+}
+
+inline int floorDiv(int a, int b) { return a>=0 ? a/b : -((-a+b-1)/b); }
+
+//camera intrinsics and pose (camera-to-world as a row-major matrix and translation)
+struct DepthCamera {
+  double fx, fy, px, py, R[9], t[3];
+  DepthCamera(const arr& Fxypxy, const rai::Transformation& pose) {
+    CHECK_EQ(Fxypxy.N, 4, "need 4 intrinsic parameters");
+    fx=Fxypxy.elem(0);  fy=Fxypxy.elem(1);  px=Fxypxy.elem(2);  py=Fxypxy.elem(3);
+    pose.rot.getMatrix(R);
+    t[0]=pose.pos.x;  t[1]=pose.pos.y;  t[2]=pose.pos.z;
+  }
+  void toCamera(double* c, const double* x) const {
+    double d[3] = {x[0]-t[0], x[1]-t[1], x[2]-t[2]};
+    for(uint k=0; k<3; k++) c[k] = R[k]*d[0] + R[3+k]*d[1] + R[6+k]*d[2];
+  }
+  void rotate(double* x, const double* c) const {
+    for(uint k=0; k<3; k++) x[k] = R[3*k]*c[0] + R[3*k+1]*c[1] + R[3*k+2]*c[2];
+  }
+  //world direction of the ray through pixel (i,j), scaled such that its camera-frame depth is 1
+  void ray(double* dir, double i, double j) const {
+    double c[3] = {(j-px)/fx, -(i-py)/fy, -1.};
+    rotate(dir, c);
+  }
+};
+
+} //namespace
+
+namespace rai {
+
+void TSDF::clear() {
+  blocks.clear();
+  blockCoords.clear();
+  index.clear();
+}
+
+const TSDF::Block* TSDF::getBlock(int bx, int by, int bz) const {
+  auto it = index.find(blockKey(bx, by, bz));
+  if(it==index.end()) return 0;
+  return &blocks.elem(it->second);
+}
+
+float TSDF::voxel(int x, int y, int z, float* w) const {
+  const Block* b = getBlock(x>>3, y>>3, z>>3);
+  uint v = (x&(B-1)) + B*((y&(B-1)) + B*(z&(B-1)));
+  if(!b || !b->w[v]) { if(w) *w=0.f;  return opt.truncation; }
+  if(w) *w=b->w[v];
+  return b->d[v];
+}
+
+void TSDF::integrate(const floatA& depth, const arr& Fxypxy, const Transformation& pose) {
+  static_assert(B==8, "voxel() uses shifts for floor division");
+  CHECK_EQ(depth.nd, 2, "");
+  const uint H=depth.d0, W=depth.d1;
+  const DepthCamera cam(Fxypxy, pose);
+  const double vox=opt.voxel, bs=B*vox, tr=opt.truncation;
+
+  //-- allocate the blocks hit by the truncation band around each measured point (rows in parallel, merged serially)
+  std::vector<std::vector<uint64_t>> rowKeys(H);
+  const uint nSamples = ceil(2.*tr/(.5*bs))+1;
+  rai::taskPool().parallel_for(0, H, [&](uint i) {
+    std::vector<uint64_t>& keys = rowKeys[i];
+    uint64_t last=~uint64_t(0);
+    double dir[3];
+    for(uint j=0; j<W; j++) {
+      double d = depth.p[i*W+j];
+      if(!(d>0.) || d>opt.maxDepth) continue;
+      cam.ray(dir, i, j);
+      for(uint n=0; n<nSamples; n++) {
+        double s = d-tr + (2.*tr*n)/(nSamples-1);
+        if(s<=0.) continue;
+        uint64_t key = blockKey(floor((cam.t[0]+s*dir[0])/bs), floor((cam.t[1]+s*dir[1])/bs), floor((cam.t[2]+s*dir[2])/bs));
+        if(key!=last) { keys.push_back(key);  last=key; }
+      }
+    }
+  });
+  uint n0=blocks.N, n=n0;
+  for(std::vector<uint64_t>& keys:rowKeys) for(uint64_t key:keys) {
+      if(index.emplace(key, n).second) n++;
+    }
+  if(n>n0) {
+    blocks.resizeCopy(n);
+    memset(&blocks.elem(n0), 0, (n-n0)*sizeof(Block));
+    blockCoords.resizeCopy(n, 3);
+    for(auto& it:index) if(it.second>=n0) {
+        const uint64_t o=1<<20, m=(1<<21)-1;
+        int* c = &blockCoords(it.second, 0);
+        c[0] = int((it.first>>42)&m)-o;  c[1] = int((it.first>>21)&m)-o;  c[2] = int(it.first&m)-o;
+      }
+  }
+
+  //-- update all blocks in the view frustum (this also carves free space in front of the measured surfaces)
+  uintA update;
+  for(uint b=0; b<blocks.N; b++) {
+    const int* c = &blockCoords(b, 0);
+    for(uint k=0; k<8; k++) {
+      double x[3] = {(c[0]+int(k&1))*bs, (c[1]+int((k>>1)&1))*bs, (c[2]+int((k>>2)&1))*bs}, p[3];
+      cam.toCamera(p, x);
+      if(p[2]>=0.) continue;
+      double j = cam.fx*p[0]/(-p[2])+cam.px, i = -cam.fy*p[1]/(-p[2])+cam.py;
+      if(i>=0. && i<H && j>=0. && j<W) { update.append(b);  break; }
+    }
+  }
+
+  rai::taskPool().parallel_for(0, update.N, [&](uint u) {
+    Block& blk = blocks.elem(update.elem(u));
+    const int* c = &blockCoords(update.elem(u), 0);
+    //voxel centers in camera coordinates are affine in the voxel index
+    double x0[3] = {(c[0]*int(B)+.5)*vox, (c[1]*int(B)+.5)*vox, (c[2]*int(B)+.5)*vox}, p0[3], e[3][3];
+    cam.toCamera(p0, x0);
+    for(uint k=0; k<3; k++) for(uint l=0; l<3; l++) e[k][l] = cam.R[3*k+l]*vox;
+    for(uint z=0; z<B; z++) for(uint y=0; y<B; y++) for(uint x=0; x<B; x++) {
+          double zc = -(p0[2] + x*e[0][2] + y*e[1][2] + z*e[2][2]);
+          if(zc<=0.) continue;
+          int j = lround(cam.fx*(p0[0] + x*e[0][0] + y*e[1][0] + z*e[2][0])/zc + cam.px);
+          int i = lround(-cam.fy*(p0[1] + x*e[0][1] + y*e[1][1] + z*e[2][1])/zc + cam.py);
+          if(i<0 || j<0 || i>=(int)H || j>=(int)W) continue;
+          double d = depth.p[i*W+j];
+          if(!(d>0.) || d>opt.maxDepth) continue;
+          double sdf = d-zc;
+          if(sdf<-tr) continue; //occluded
+          if(sdf>tr) sdf=tr;
+          uint v = x+B*(y+B*z);
+          float w = blk.w[v];
+          blk.d[v] = (blk.d[v]*w + sdf)/(w+1.f);
+          blk.w[v] = rai::MIN(w+1.f, (float)opt.maxWeight);
+        }
+  });
+}
+
+double TSDF::eval(double* g, const double* x) const {
+  double u[3];
+  int i[3];
+  for(uint k=0; k<3; k++) { u[k] = x[k]/opt.voxel-.5;  i[k] = floor(u[k]);  u[k] -= i[k]; }
+  float c[8], w;
+  const Block* b = 0;
+  if((i[0]&(B-1))<B-1 && (i[1]&(B-1))<B-1 && (i[2]&(B-1))<B-1) b = getBlock(i[0]>>3, i[1]>>3, i[2]>>3); //all 8 in one block
+  for(uint k=0; k<8; k++) {
+    int p[3] = {i[0]+int(k&1), i[1]+int((k>>1)&1), i[2]+int((k>>2)&1)};
+    if(b) {
+      uint v = (p[0]&(B-1)) + B*((p[1]&(B-1)) + B*(p[2]&(B-1)));
+      c[k] = b->d[v];  w = b->w[v];
+    } else c[k] = voxel(p[0], p[1], p[2], &w);
+    if(!w) { if(g) g[0]=g[1]=g[2]=0.;  return opt.truncation; }
+  }
+  double c00 = c[0]+u[0]*(c[1]-c[0]), c10 = c[2]+u[0]*(c[3]-c[2]);
+  double c01 = c[4]+u[0]*(c[5]-c[4]), c11 = c[6]+u[0]*(c[7]-c[6]);
+  double c0 = c00+u[1]*(c10-c00), c1 = c01+u[1]*(c11-c01);
+  if(g) {
+    double dx0 = (c[1]-c[0])+u[1]*((c[3]-c[2])-(c[1]-c[0])), dx1 = (c[5]-c[4])+u[1]*((c[7]-c[6])-(c[5]-c[4]));
+    g[0] = (dx0+u[2]*(dx1-dx0))/opt.voxel;
+    g[1] = ((c10-c00)+u[2]*((c11-c01)-(c10-c00)))/opt.voxel;
+    g[2] = (c1-c0)/opt.voxel;
+  }
+  return c0+u[2]*(c1-c0);
+}
+
+void TSDF::raycast(floatA& depth, uint H, uint W, const arr& Fxypxy, const Transformation& pose) const {
+  const DepthCamera cam(Fxypxy, pose);
+  const double tr=opt.truncation, bs=B*opt.voxel;
+  depth.resize(H, W) = -1.f;
+  if(!blocks.N) return;
+
+  //bounding box of all blocks: rays are clipped to it
+  double lo[3], hi[3];
+  for(uint k=0; k<3; k++) {
+    lo[k] = bs*min(blockCoords.col(k));
+    hi[k] = bs*(max(blockCoords.col(k))+1);
+  }
+
+  rai::taskPool().parallel_for(0, H, [&](uint i) {
+    double dir[3], x[3];
+    for(uint j=0; j<W; j++) {
+      cam.ray(dir, i, j);
+      double s0=opt.voxel, s1=opt.maxDepth;
+      for(uint k=0; k<3; k++) {
+        if(!dir[k]) { if(cam.t[k]<lo[k] || cam.t[k]>hi[k]) s1=-1.;  continue; }
+        double a=(lo[k]-cam.t[k])/dir[k], b=(hi[k]-cam.t[k])/dir[k];
+        if(a>b) std::swap(a, b);
+        s0 = rai::MAX(s0, a);
+        s1 = rai::MIN(s1, b);
+      }
+      double L = ::sqrt(dir[0]*dir[0]+dir[1]*dir[1]+dir[2]*dir[2]);
+      double s=s0, sPrev=0., prev=-1.;
+      while(s<s1) {
+        for(uint k=0; k<3; k++) x[k] = cam.t[k]+s*dir[k];
+        int c[3] = {int(floor(x[0]/bs)), int(floor(x[1]/bs)), int(floor(x[2]/bs))};
+        if(!getBlock(c[0], c[1], c[2])) { //unallocated: jump to where the ray leaves this block
+          double ds=INFINITY;
+          for(uint k=0; k<3; k++) if(dir[k]) ds = rai::MIN(ds, ((c[k]+(dir[k]>0.))*bs-x[k])/dir[k]);
+          sPrev=s;
+          prev=tr;
+          s += ds + 1e-6*opt.voxel;
+          continue;
+        }
+        double f = eval(nullptr, x);
+        if(prev>0. && f<=0. && f>-tr) { depth.p[i*W+j] = sPrev + (s-sPrev)*prev/(prev-f);  break; } //zero crossing from the front
+        sPrev=s;
+        prev=f;
+        s += rai::MAX(opt.voxel, .8*f)/L; //unobserved voxels evaluate to +tr, so they are crossed in steps <tr
+      }
+    }
+  });
+}
+
+void TSDF::getMesh(Mesh& mesh) const {
+  mesh.clear();
+
+  //-- chunks that may contain the surface: those of blocks with observed non-positive values, and of their lower neighbors
+  //   (whose chunk owns the cells across the block boundary)
+  std::unordered_map<uint64_t, uint> chunkIndex;
+  intA chunks;
+  for(uint b=0; b<blocks.N; b++) {
+    const Block& blk = blocks.elem(b);
+    bool inside=false;
+    for(uint v=0; v<B*B*B; v++) if(blk.w[v] && blk.d[v]<=0.f) { inside=true;  break; }
+    if(!inside) continue;
+    const int* c = &blockCoords(b, 0);
+    for(uint k=0; k<8; k++) {
+      int q[3] = {floorDiv(c[0]-int(k&1), C), floorDiv(c[1]-int((k>>1)&1), C), floorDiv(c[2]-int((k>>2)&1), C)};
+      if(chunkIndex.emplace(blockKey(q[0], q[1], q[2]), chunks.d0).second) {
+        chunks.append(intA{q[0], q[1], q[2]});
+        chunks.reshape(-1, 3);
+      }
+    }
+  }
+
+  //-- marching cubes on each chunk (with the first voxel layer of the upper neighbors); unobserved voxels count as free
+  //   space, and vertices on edges or cells touching them are removed with their triangles
+  MeshA M(chunks.d0);
+  rai::taskPool().parallel_for(0, chunks.d0, [&](uint ch) {
+    const int N=C*B+1;
+    int o[3] = {chunks(ch, 0)*(N-1), chunks(ch, 1)*(N-1), chunks(ch, 2)*(N-1)}; //first voxel
+    arr G(N, N, N);
+    byteA observed(N, N, N);
+    bool pos=false, neg=false;
+    for(int i=0; i<N; i++) for(int j=0; j<N; j++) for(int k=0; k<N; k++) {
+          float w, d = voxel(o[0]+i, o[1]+j, o[2]+k, &w);
+          G(i, j, k) = d;
+          observed(i, j, k) = (w>0.f);
+          if(d>0.f) pos=true; else neg=true;
+        }
+    if(!pos || !neg) return;
+    arr lo(3), hi(3);
+    for(uint k=0; k<3; k++) { lo(k) = (o[k]+.5)*opt.voxel;  hi(k) = lo(k)+(N-1)*opt.voxel; }
+    Mesh& m = M(ch);
+    m.setImplicitSurface(G, lo, hi);
+
+    //a vertex is valid if all grid points of the edge (or cell) it lies on are observed
+    boolA valid(m.V.d0);
+    for(uint v=0; v<m.V.d0; v++) {
+      int l[3], u[3];
+      for(uint k=0; k<3; k++) {
+        double g = (m.V(v, k)-lo(k))/opt.voxel, r = ::round(g);
+        if(fabs(g-r)<1e-6) l[k]=u[k]=r; else { l[k]=floor(g);  u[k]=l[k]+1; }
+      }
+      valid(v) = true;
+      for(int i=l[0]; i<=u[0]; i++) for(int j=l[1]; j<=u[1]; j++) for(int k=l[2]; k<=u[2]; k++)
+            if(!observed(i, j, k)) valid(v) = false;
+    }
+    uint n=0;
+    for(uint t=0; t<m.T.d0; t++) {
+      if(!valid(m.T(t, 0)) || !valid(m.T(t, 1)) || !valid(m.T(t, 2))) continue;
+      memmove(&m.T(n, 0), &m.T(t, 0), 3*sizeof(uint));
+      n++;
+    }
+    m.T.resizeCopy(n, 3);
+    m.deleteUnusedVertices();
+  });
+
+  //-- concatenate into preallocated buffers; vertices on chunk boundaries are then fused
+  uintA offV(M.N+1), offT(M.N+1);
+  offV(0)=offT(0)=0;
+  for(uint ch=0; ch<M.N; ch++) { offV(ch+1)=offV(ch)+M(ch).V.d0;  offT(ch+1)=offT(ch)+M(ch).T.d0; }
+  mesh.V.resize(offV.last(), 3);
+  mesh.T.resize(offT.last(), 3);
+  rai::taskPool().parallel_for(0, M.N, [&](uint ch) {
+    const Mesh& m = M(ch);
+    if(m.V.N) memmove(&mesh.V(offV(ch), 0), m.V.p, m.V.N*sizeof(double));
+    for(uint i=0; i<m.T.N; i++) mesh.T.elem(3*offT(ch)+i) = m.T.elem(i)+offV(ch);
+  });
+  if(mesh.V.N) mesh.fuseNearVertices(1e-6*opt.voxel);
+}
+
+} //namespace
@@ -0,0 +1,65 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "mesh.h"
+
+#include <unordered_map>
+
+namespace rai {
+
+//===========================================================================
+
+struct TSDF_Options {
+  RAI_PARAM("TSDF/", double, voxel, .01)        ///< voxel size
+  RAI_PARAM("TSDF/", double, truncation, .04)   ///< distances are truncated to +-truncation (should be a few voxels)
+  RAI_PARAM("TSDF/", double, maxWeight, 64.)    ///< running average over at most this many observations (lower: adapts faster)
+  RAI_PARAM("TSDF/", double, maxDepth, 4.)      ///< depth readings beyond are ignored
+};
+
+/** Truncated signed distance field fused from depth images, on voxel blocks of B^3 that are allocated on demand in a hash
+ *  map (only near observed surfaces). Depth images follow the convention of depthData2pointCloud: the camera looks along
+ *  its -z axis, pixel (i,j) with depth d is the point (d(j-px)/fx, -d(i-py)/fy, -d) in the camera frame given by pose.
+ *  integrate() runs in parallel on rai::taskPool(); all queries are const and may run concurrently with each other, but
+ *  not with integrate(). Distances are positive in observed free space, negative behind surfaces. */
+struct TSDF : NonCopyable {
+  static const uint B=8;   ///< voxels per block side
+
+  TSDF_Options opt;
+
+  struct Block {
+    float d[B*B*B];        ///< truncated distance (x fastest)
+    float w[B*B*B];        ///< accumulated weight (0: unobserved)
+  };
+  rai::Array<Block> blocks;
+  intA blockCoords;        ///< (#blocks, 3) integer coordinates of each block
+  std::unordered_map<uint64_t, uint> index; ///< block coordinates -> index into blocks
+
+  TSDF(const TSDF_Options& _opt=TSDF_Options()) : opt(_opt) {}
+
+  void clear();
+
+  /// fuses a depth image (H,W) taken with intrinsics Fxypxy=(fx,fy,px,py) from the camera pose (world frame)
+  void integrate(const floatA& depth, const arr& Fxypxy, const Transformation& pose);
+
+  /// renders a depth image (same convention) by raycasting the zero crossing; -1 where no surface is hit
+  void raycast(floatA& depth, uint H, uint W, const arr& Fxypxy, const Transformation& pose) const;
+
+  /// trilinearly interpolated distance and (optional) gradient at x (world frame); +truncation where unobserved
+  double eval(double* g, const double* x) const;
+
+  /// zero level set via marching cubes on chunks of blocks; cells with an unobserved corner are left out
+  void getMesh(Mesh& mesh) const;
+
+ private:
+  const Block* getBlock(int bx, int by, int bz) const;
+  float voxel(int x, int y, int z, float* w=nullptr) const; ///< value of a voxel by its global integer coordinates
+};
+
+} //namespace
@@ -32,6 +32,7 @@
 #include "../Optim/opt-nlopt.h"
 #include "../Optim/opt-ipopt.h"
 #include "../Optim/opt-ceres.h"
+#include "../Core/taskPool.h"
 
 #include "../Core/util.ipp"
 
@@ -107,6 +108,7 @@ void KOMO::clone(const KOMO& komo, bool deepCopyFeatures){
 
   if(komo.fcl) fcl=komo.fcl;
   if(komo.swift) swift=komo.swift;
+  clearCollisionCache();
 
   //directly copy pathConfig instead of recreating it (including switches)
   pathConfig.copy(komo.pathConfig, false);
@@ -762,10 +764,19 @@ void KOMO::reset() {
 //default - transcription as sparse, but non-factored NLP
 struct Conv_KOMO_SparseNonfactored : MathematicalProgram {
   KOMO& komo;
+  shared_ptr<KOMO> komoOwner; ///< set if this problem owns its KOMO (see mp_SparseNonFactoredClone)
   bool sparse;
 
   arr quadraticPotentialLinear, quadraticPotentialHessian;
 
+  //-- with KOMO/incrementalSetX: the features of the last evaluation, reused for objectives whose slices did not change
+  arrA sliceX, sliceQ;               ///< per time slice: frame poses and dof states of the last evaluation
+  arrA obValues, obJacobians;        ///< per grounded objective: feature value and Jacobian of the last evaluation
+  rai::Array<GroundedObjective*> obCached;
+  bool cachedJacobians=false;
+  uint cachedActivations=0;
+  boolA getChangedSlices(bool needJacobians); ///< which slices changed since the last evaluation (all, if the cache is invalid)
+
   Conv_KOMO_SparseNonfactored(KOMO& _komo, bool sparse=true);
 
   virtual arr getInitializationSample(const arr& previousOptima= {});
@@ -1191,6 +1202,7 @@ void KOMO::setupPathConfig() {
     if(!opt.useFCL) swift = C.swift();
     else fcl = C.fcl();
   }
+  clearCollisionCache();
 
   for(uint s=0;s<k_order+T;s++) {
 //    for(KinematicSwitch* sw:switches) { //apply potential switches
@@ -1266,45 +1278,125 @@ void reportAfterPhiComputation(KOMO& komo) {
 }
 
 
+//a fresh collision engine on the world's geometries (for parallel queries, each worker needs its own);
+//a swift engine copies the (de)activations of source, if given
+static void newCollisionEngine(rai::Configuration& world, bool useFCL, shared_ptr<SwiftInterface>& swift, shared_ptr<rai::FclInterface>& fcl, const SwiftInterface* source) {
+  if(!useFCL) {
+    swift = make_shared<SwiftInterface>(world.frames, .1, 0);
+    if(source) {
+      swift->replayActivations(*source);
+    } else {
+      swift->deactivate(world.getCollisionExcludeIDs());
+      swift->deactivatePairs(world.getCollisionExcludePairIDs());
+    }
+  } else {
+    rai::Array<ptr<rai::Mesh>> geometries(world.frames.N);
+    for(rai::Frame* f:world.frames) if(f->shape && f->shape->cont) {
+        if(!f->shape->mesh().V.N) f->shape->createMeshes();
+        geometries(f->ID) = f->shape->_mesh;
+      }
+    fcl = make_shared<rai::FclInterface>(geometries, .0);
+  }
+}
+
 void KOMO::set_x(const arr& x, const uintA& selectedConfigurationsOnly) {
   CHECK_EQ(timeSlices.d0, k_order+T, "configurations are not setup yet");
 
   timeKinematics -= rai::cpuTime();
 
   if(!selectedConfigurationsOnly.N){
-    pathConfig.setJointState(x);
+    if(!opt.incrementalSetX || !pathConfig.updateJointState(x)) pathConfig.setJointState(x);
   }else{
-    pathConfig.setJointState(x, timeSlices.sub(selectedConfigurationsOnly+k_order));
-    HALT("this is untested...");
+    //x are the dofs of the selected slices only (as in getConfiguration_qAll); their mimicers in other slices follow
+    pathConfig.setDofState(x, pathConfig.getDofs(timeSlices.sub(selectedConfigurationsOnly+k_order), false));
   }
 
   timeKinematics += rai::cpuTime();
 
   if(computeCollisions) {
     timeCollisions -= rai::cpuTime();
-    pathConfig.proxies.clear();
+
+    //-- collision exclusions changed since the last query (e.g. by swift->deactivate)? then nothing can be reused
+    if(swift && swift->activationLog.d0!=sliceActivations) { clearCollisionCache();  sliceActivations=swift->activationLog.d0; }
+
+    //-- which slices moved since their last query?
+    bool reuse = opt.incrementalSetX && sliceX.N==timeSlices.d0;
+    if(!reuse) { sliceX.resize(timeSlices.d0); sliceCollisions.resize(timeSlices.d0); }
+    uintA dirty;
     arr X;
-    uintA collisionPairs;
-    for(uint s=k_order;s<timeSlices.d0;s++){
+    for(uint s=k_order; s<timeSlices.d0; s++) {
       X = pathConfig.getFrameState(timeSlices[s]);
-      if(!opt.useFCL){
-        collisionPairs = swift->step(X);
-      }else{
-        fcl->step(X);
-        collisionPairs = fcl->collisions;
+      if(reuse && X==sliceX(s)) continue;
+      sliceX(s) = X;
+      dirty.append(s);
+    }
+
+    //-- query only these
+    auto query = [this](uint s, SwiftInterface* sw, rai::FclInterface* fc) {
+      uintA& collisionPairs = sliceCollisions(s);
+      if(sw) {
+        collisionPairs = sw->step(sliceX(s));
+      } else {
+        fc->step(sliceX(s));
+        collisionPairs = fc->collisions;
       }
       collisionPairs += timeSlices.d1 * s; //fcl returns frame IDs related to 'world' -> map them into frameIDs within that time slice
-      pathConfig.addProxies(collisionPairs);
+    };
+    uint nWorkers = opt.parallelCollisions ? rai::MIN(rai::taskPool().numThreads(), dirty.N) : 1;
+    if(nWorkers<=1) {
+      for(uint s:dirty) query(s, swift.get(), fcl.get());
+    } else {
+      if(!opt.useFCL && !swiftWorkers.N) swiftWorkers.append(swift);
+      if(opt.useFCL && !fclWorkers.N) fclWorkers.append(fcl);
+      for(uint w=(opt.useFCL ? fclWorkers.N : swiftWorkers.N); w<nWorkers; w++) {
+        shared_ptr<SwiftInterface> sw;
+        shared_ptr<rai::FclInterface> fc;
+        newCollisionEngine(world, opt.useFCL, sw, fc, swift.get());
+        if(sw) swiftWorkers.append(sw); else fclWorkers.append(fc);
+      }
+      //static assignment: worker w queries every nWorkers-th dirty slice
+      rai::taskPool().parallel_for(0, nWorkers, [&](uint w) {
+        SwiftInterface* sw = opt.useFCL ? nullptr : swiftWorkers(w).get();
+        rai::FclInterface* fc = opt.useFCL ? fclWorkers(w).get() : nullptr;
+        for(uint i=w; i<dirty.N; i+=nWorkers) query(dirty(i), sw, fc);
+      }, 1);
     }
+
+    //-- merge in slice order (deterministic, independent of which slices were re-queried)
+    pathConfig.proxies.clear();
+    for(uint s=k_order; s<timeSlices.d0; s++) pathConfig.addProxies(sliceCollisions(s));
     pathConfig._state_proxies_isGood=true;
     timeCollisions += rai::cpuTime();
   }
 }
 
+void KOMO::clearCollisionCache() {
+  fclWorkers.clear();
+  swiftWorkers.clear();
+  sliceX.clear();
+  sliceCollisions.clear();
+}
+
 shared_ptr<MathematicalProgram> KOMO::mp_SparseNonFactored(){
   return make_shared<Conv_KOMO_SparseNonfactored>(*this, solver==rai::KS_sparse);
 }
 
+shared_ptr<MathematicalProgram> KOMO::mp_SparseNonFactoredClone(){
+  auto komo = make_shared<KOMO>();
+  komo->clone(*this);
+  komo->solver = solver;
+  komo->x = x;
+  if(fcl || swift) { //own collision engine, as clones may be evaluated concurrently
+    komo->fcl.reset();
+    komo->swift.reset();
+    //replay this engine's (de)activations: a clone must exclude the same pairs, or starts would see other collisions
+    newCollisionEngine(komo->world, opt.useFCL, komo->swift, komo->fcl, swift.get());
+  }
+  auto mp = make_shared<Conv_KOMO_SparseNonfactored>(*komo, solver==rai::KS_sparse);
+  mp->komoOwner = komo;
+  return mp;
+}
+
 shared_ptr<MathematicalProgram_Factored> KOMO::mp_Factored(){
   return make_shared<Conv_KOMO_FineStructuredProblem>(*this);
 }
@@ -1545,29 +1637,38 @@ void Conv_KOMO_SparseNonfactored::evaluate(arr& phi, arr& J, const arr& x) {
 
   komo.timeFeatures -= rai::cpuTime();
 
+  boolA changed;
+  if(komo.opt.incrementalSetX) changed = getChangedSlices(!!J);
+
   uint M=0;
-  for(shared_ptr<GroundedObjective>& ob : komo.objs) {
-      //query the task map and check dimensionalities of returns
-      arr y = ob->feat->eval(ob->frames);
-//      cout <<"EVAL '" <<ob->name() <<"' phi:" <<y <<endl <<y.J() <<endl<<endl;
-      if(!y.N) continue;
-      checkNan(y);
-      if(!!J){
-        CHECK(y.jac, "Jacobian needed but missing");
-        CHECK_EQ(y.J().nd, 2, "");
-        CHECK_EQ(y.J().d0, y.N, "");
-        CHECK_EQ(y.J().d1, komo.pathConfig.getJointStateDimension(), "");
+  for(uint i=0; i<komo.objs.N; i++) {
+      shared_ptr<GroundedObjective>& ob = komo.objs(i);
+      arr y, yJ;
+      bool reuse = changed.N && ob->timeSlices.N;
+      if(reuse) for(int t:ob->timeSlices) if(changed(t+komo.k_order)) { reuse=false;  break; }
+      if(reuse) {
+        y = obValues(i);
+        yJ = obJacobians(i);
+      } else {
+        //query the task map and check dimensionalities of returns
+        y = ob->feat->eval(ob->frames);
+//        cout <<"EVAL '" <<ob->name() <<"' phi:" <<y <<endl <<y.J() <<endl<<endl;
+        if(y.N) {
+          checkNan(y);
+          if(!!J){
+            CHECK(y.jac, "Jacobian needed but missing");
+            CHECK_EQ(y.J().nd, 2, "");
+            CHECK_EQ(y.J().d0, y.N, "");
+            CHECK_EQ(y.J().d1, komo.pathConfig.getJointStateDimension(), "");
+          }
+          if(absMax(y)>1e10) RAI_MSG("WARNING y=" <<y);
+          yJ = y.J_reset();
+        }
+        if(changed.N) { obValues(i) = y;  obJacobians(i) = yJ; }
       }
-//      uint d = ob->feat->dim(ob->frames);
-//      if(d!=y.N){
-//        d  = ob->feat->dim(ob->frames);
-//        ob->feat->eval(y, y.J(), ob->frames);
-//      }
-//      CHECK_EQ(d, y.N, "");
-      if(absMax(y)>1e10) RAI_MSG("WARNING y=" <<y);
+      if(!y.N) continue;
 
       //write into phi and J
-      arr yJ = y.J_reset();
       phi.setVectorBlock(y, M);
 
       if(ob->type==OT_sos) komo.sos+=sumOfSqr(y);
@@ -1622,6 +1723,36 @@ void Conv_KOMO_SparseNonfactored::report(std::ostream& os, int verbose) {
   }
 }
 
+boolA Conv_KOMO_SparseNonfactored::getChangedSlices(bool needJacobians) {
+  rai::Configuration& C = komo.pathConfig;
+  uint S = komo.timeSlices.d0;
+  uint activations = komo.swift ? komo.swift->activationLog.d0 : 0;
+  bool valid = sliceX.N==S && obCached.N==komo.objs.N
+               && C.frames.N==komo.timeSlices.N //switches did not add frames outside the slices
+               && (cachedJacobians || !needJacobians) && cachedActivations==activations;
+  for(uint i=0; valid && i<obCached.N; i++) if(obCached(i)!=komo.objs(i).get()) valid=false;
+  if(!valid) {
+    sliceX.resize(S);
+    sliceQ.resize(S);
+    obValues.resize(komo.objs.N);
+    obJacobians.resize(komo.objs.N);
+    obCached.resize(komo.objs.N);
+    for(uint i=0; i<obCached.N; i++) obCached(i) = komo.objs(i).get();
+    cachedActivations = activations;
+  }
+  cachedJacobians = needJacobians; //without, the Jacobians stored in this evaluation are missing
+
+  boolA changed(S);
+  arr X, q;
+  for(uint s=0; s<S; s++) {
+    X = C.getFrameState(komo.timeSlices[s]);
+    q = C.getDofState(C.getDofs(komo.timeSlices[s], false));
+    changed(s) = !valid || !(X==sliceX(s)) || !(q==sliceQ(s));
+    if(changed(s)) { sliceX(s) = X;  sliceQ(s) = q; }
+  }
+  return changed;
+}
+
 Conv_KOMO_SparseNonfactored::Conv_KOMO_SparseNonfactored(KOMO& _komo, bool sparse) : komo(_komo), sparse(sparse) {
   dimension = komo.pathConfig.getJointStateDimension();
 
@@ -38,6 +38,8 @@ namespace rai {
     RAI_PARAM("KOMO/", int, animateOptimization, 0)
     RAI_PARAM("KOMO/", bool, mimicStable, false)
     RAI_PARAM("KOMO/", bool, useFCL, true)
+    RAI_PARAM("KOMO/", bool, incrementalSetX, false)     ///< set_x only touches changed dofs and only re-queries collisions of time slices that moved; mp_SparseNonFactored reuses the features of objectives whose slices did not move -- so don't change feature targets/scales, switches or proxies in place with this on
+    RAI_PARAM("KOMO/", bool, parallelCollisions, false)  ///< query collisions of different time slices in parallel (one engine clone per worker)
   };
 }//namespace
 
@@ -60,6 +62,11 @@ struct KOMO : NonCopyable {
   bool computeCollisions;         ///< whether swift or fcl (collisions/proxies) is evaluated whenever new configurations are set (needed if features read proxy list)
   shared_ptr<rai::FclInterface> fcl;
   shared_ptr<SwiftInterface> swift;
+  rai::Array<shared_ptr<rai::FclInterface>> fclWorkers;  ///< engine clones for parallelCollisions (worker 0 is fcl)
+  rai::Array<shared_ptr<SwiftInterface>> swiftWorkers;   ///< engine clones for parallelCollisions (worker 0 is swift)
+  arrA sliceX;                    ///< per time slice: frame poses of the last collision query
+  rai::Array<uintA> sliceCollisions; ///< per time slice: collision pairs of the last collision query
+  uint sliceActivations=0;        ///< swift->activationLog.d0 of the last collision query: (de)activations since then invalidate the cache
 
   //-- optimizer
   rai::KOMOsolver solver=rai::KS_sparse;
@@ -210,7 +217,8 @@ public:
   void applySwitch(const rai::KinematicSwitch& sw);
   void retrospectApplySwitches();
   void retrospectChangeJointType(int startStep, int endStep, uint frameID, rai::JointType newJointType);
-  void set_x(const arr& x, const uintA& selectedConfigurationsOnly=NoUintA);            ///< set the state trajectory of all configurations
+  void set_x(const arr& x, const uintA& selectedConfigurationsOnly=NoUintA);            ///< set the state trajectory of all configurations, or only of the selected time slices (x is then their getConfiguration_qAll, concatenated)
+  void clearCollisionCache();  ///< drop the per-slice collision results and engine clones (done automatically when swift (de)activations change)
 
 
   //===========================================================================
@@ -219,6 +227,7 @@ public:
   //
 
   shared_ptr<MathematicalProgram> mp_SparseNonFactored();
+  shared_ptr<MathematicalProgram> mp_SparseNonFactoredClone(); ///< the same on a (owned) clone of this KOMO, e.g., for MP_Solver::solveMultiStart
   shared_ptr<MathematicalProgram_Factored> mp_Factored();
 
 
@@ -0,0 +1,303 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "pathPlanner.h"
+#include "../Algo/kdTree.h"
+#include "../Core/taskPool.h"
+
+#include <math.h>
+
+//===========================================================================
+
+rai::ConfigurationProblem::ConfigurationProblem(const Configuration& C, bool _useFCL)
+  : useFCL(_useFCL) {
+  workers.append(make_shared<Configuration>(C));
+  limits = C.getLimits();
+  for(uint i=0; i<limits.d0; i++) if(limits(i, 1)<limits(i, 0)) { limits(i, 0)=-RAI_PI;  limits(i, 1)=RAI_PI; }
+}
+
+void rai::ConfigurationProblem::ensureWorkers(uint n) {
+  //the engines are created here, sequentially: their construction touches the (shared) meshes
+  while(workers.N<n) workers.append(make_shared<Configuration>(*workers(0)));
+  for(shared_ptr<Configuration>& C:workers) { if(useFCL) C->fcl(); else C->swift(); }
+}
+
+arr rai::ConfigurationProblem::sample() const {
+  arr q(dim());
+  for(uint i=0; i<q.N; i++) q.p[i] = rnd.uni(limits(i, 0), limits(i, 1));
+  return q;
+}
+
+bool rai::ConfigurationProblem::isFeasible(const arr& q, uint worker) {
+  if(!worker) ensureWorkers(1);
+  Configuration& C = *workers(worker);
+  C.setJointState(q);
+  if(useFCL) C.stepFcl(); else C.stepSwift();
+  return C.getTotalPenetration()<=0.;
+}
+
+bool rai::ConfigurationProblem::isEdgeFeasible(const arr& a, const arr& b, double resolution, uint worker) {
+  uint n = ::ceil(length(b-a)/resolution);
+  if(n<2) return true;
+  //interior points k/n in bisection order: odd multiples of s, for s = the largest power of 2 below n, then s/2, ...
+  uint s=1;
+  while(2*s<n) s*=2;
+  for(; s; s/=2) for(uint k=s; k<n; k+=2*s) {
+      if(!isFeasible(a + (double(k)/n)*(b-a), worker)) return false;
+    }
+  return true;
+}
+
+void rai::ConfigurationProblem::areEdgesFeasible(boolA& feasible, const arr& A, const arr& B, double resolution) {
+  CHECK_EQ(A.d0, B.d0, "");
+  feasible.resize(A.d0);
+  uint nWorkers = rai::MIN(rai::taskPool().numThreads(), A.d0);
+  if(nWorkers<=1) {
+    for(uint i=0; i<A.d0; i++) feasible(i) = isEdgeFeasible(A[i], B[i], resolution);
+    return;
+  }
+  ensureWorkers(nWorkers);
+  //static assignment: worker w checks every nWorkers-th edge
+  rai::taskPool().parallel_for(0, nWorkers, [&](uint w) {
+    for(uint i=w; i<A.d0; i+=nWorkers) feasible(i) = isEdgeFeasible(A[i], B[i], resolution, w);
+  }, 1);
+}
+
+//===========================================================================
+
+namespace {
+
+//a tree of configurations whose edges (parent -> node) are checked lazily
+struct LazyTree {
+  rai::KDTree kd;
+  uintA parent;
+  byteA checked;  //edge to the parent is known to be feasible
+
+  LazyTree(const arr& root) { add(root, 0, 1); }
+
+  uint add(const arr& q, uint p, byte isChecked) {
+    uint i = kd.add(q);
+    parent.append(p);
+    checked.append(isChecked);
+    return i;
+  }
+
+  //removes node i and all its descendants (children always have larger ids than their parents)
+  void removeSubtree(uint i) {
+    byteA dead(parent.N);
+    dead.setZero();
+    dead(i)=1;
+    kd.remove(i);
+    for(uint j=i+1; j<parent.N; j++) if(kd.contains(j) && dead(parent(j))) { dead(j)=1;  kd.remove(j); }
+  }
+
+  //node ids from the root to i
+  uintA branch(uint i) const {
+    uintA B;
+    for(;;) { B.prepend(i);  if(!i) break;  i=parent(i); }
+    return B;
+  }
+};
+
+enum ExtendStatus { Trapped, Advanced, Reached };
+
+} //namespace
+
+//-- one step of T towards q; the new vertex is checked, its edge not
+static ExtendStatus extend(LazyTree& T, uint& last, const arr& q, rai::ConfigurationProblem& P, double stepsize) {
+  uint n = T.kd.nearest(q);
+  arr x = T.kd.X[n];
+  arr d = q-x;
+  double dist = length(d);
+  if(dist<1e-10) { last=n;  return Reached; }
+  bool reach = dist<=stepsize;
+  arr qNew = reach ? q : x + (stepsize/dist)*d;
+  if(!P.isFeasible(qNew)) return Trapped;
+  last = T.add(qNew, n, 0);
+  return reach ? Reached : Advanced;
+}
+
+static ExtendStatus connectTo(LazyTree& T, uint& last, const arr& q, rai::ConfigurationProblem& P, double stepsize) {
+  ExtendStatus s;
+  do s = extend(T, last, q, P, stepsize); while(s==Advanced);
+  return s;
+}
+
+arr rai::PathPlanner::connect(const arr& q0, const arr& qT, double deadline) {
+  LazyTree A(q0), B(qT);
+  LazyTree* a=&A, *b=&B;
+  for(int iter=0; iter<opt.maxIters && rai::realTime()<deadline; iter++) {
+    arr q = (rnd.uni()<opt.goalBias ? b->kd.X[0] : P.sample());
+    uint ia, ib;
+    if(extend(*a, ia, q, P, opt.stepsize)!=Trapped
+        && connectTo(*b, ib, a->kd.X[ia], P, opt.stepsize)==Reached) {
+      //-- the trees touch: validate the unchecked edges of the connecting path, in parallel
+      uintA brA = a->branch(ia), brB = b->branch(ib);
+      rai::Array<LazyTree*> tree;
+      uintA node;
+      arr from, to;
+      for(LazyTree* T: {a, b}) for(uint i:(T==a ? brA : brB)) if(!T->checked(i)) {
+            tree.append(T);
+            node.append(i);
+            from.append(T->kd.X[T->parent(i)]);
+            to.append(T->kd.X[i]);
+          }
+      boolA feasible;
+      if(node.N) {
+        from.reshape(node.N, P.dim());
+        to.reshape(node.N, P.dim());
+        P.areEdgesFeasible(feasible, from, to, opt.resolution);
+      }
+      bool ok=true;
+      for(uint k=0; k<node.N; k++) if(feasible(k)) tree(k)->checked(node(k))=1;
+      for(uint k=0; k<node.N; k++) if(!feasible(k)) {
+          ok=false;
+          if(tree(k)->kd.contains(node(k))) tree(k)->removeSubtree(node(k));
+        }
+      if(ok) {
+        if(opt.verbose>0) LOG(0) <<"RRT-Connect: path found after " <<iter <<" iterations; tree sizes " <<A.kd.size() <<' ' <<B.kd.size();
+        if(a!=&A) { std::swap(a, b);  std::swap(ia, ib);  std::swap(brA, brB); }
+        arr path;
+        for(uint i:brA) path.append(A.kd.X[i]);
+        for(uint k=brB.N-1; k--;) path.append(B.kd.X[brB(k)]); //the last of brB is the same configuration as the last of brA
+        return path.reshape(-1, P.dim());
+      }
+    }
+    std::swap(a, b);
+  }
+  if(opt.verbose>0) LOG(0) <<"RRT-Connect: no path found";
+  return arr();
+}
+
+//===========================================================================
+
+void rai::PathPlanner::improve(arr& path, double deadline) {
+  //-- RRT* tree seeded with the path (whose edges are checked)
+  KDTree T;
+  uintA parent;
+  arr cost;
+  Array<uintA> children;
+  for(uint i=0; i<path.d0; i++) {
+    T.add(path[i]);
+    parent.append(i ? i-1 : 0);
+    cost.append(i ? cost(i-1)+length(path[i]-path[i-1]) : 0.);
+    children.append(uintA());
+    if(i) children(i-1).append(i);
+  }
+  uint goal = path.d0-1;
+  const arr& q0 = path[0], qT = path[goal];
+  double d=P.dim();
+
+  std::function<void(uint, double)> propagate = [&](uint i, double delta) {
+    cost(i) -= delta;
+    for(uint c:children(i)) propagate(c, delta);
+  };
+
+  uint iter=0;
+  for(; (int)iter<opt.maxIters && rai::realTime()<deadline; iter++) {
+    arr q = P.sample();
+    //reject samples that can't lie on a shorter path (informed set)
+    if(length(q-q0)+length(q-qT) >= cost(goal)) continue;
+    uint n = T.nearest(q);
+    arr x = T.X[n];
+    double dist = length(q-x);
+    if(dist>opt.stepsize) q = x + (opt.stepsize/dist)*(q-x);
+    if(!P.isFeasible(q)) continue;
+
+    //-- neighbors, checked in parallel
+    double n1 = T.size()+1.;
+    double r = rai::MAX(opt.stepsize, 4.*opt.stepsize*pow(::log(n1)/n1, 1./d)); //shrinking rewiring radius
+    uintA nb;
+    arr nbDists;
+    T.radius(nb, nbDists, q, r);
+    if(!nb.N) { nb.append(n);  nbDists.append(sqr(length(q-x))); }
+    arr from(nb.N, P.dim()), to = repmat(~q, nb.N, 1);
+    for(uint k=0; k<nb.N; k++) from[k] = T.X[nb(k)];
+    boolA feasible;
+    P.areEdgesFeasible(feasible, from, to, opt.resolution);
+
+    //-- best parent
+    int best=-1;
+    double bestCost=INFINITY;
+    for(uint k=0; k<nb.N; k++) if(feasible(k)) {
+        double c = cost(nb(k)) + ::sqrt(nbDists(k));
+        if(c<bestCost) { bestCost=c;  best=nb(k); }
+      }
+    if(best<0) continue;
+    uint id = T.add(q);
+    parent.append(best);
+    cost.append(bestCost);
+    children.append(uintA());
+    children(best).append(id);
+
+    //-- rewire the neighbors through the new node
+    for(uint k=0; k<nb.N; k++) if(feasible(k)) {
+        uint j=nb(k);
+        double c = bestCost + ::sqrt(nbDists(k));
+        if(j==(uint)best || c>=cost(j)) continue;
+        children(parent(j)).removeValue(j);
+        parent(j) = id;
+        children(id).append(j);
+        propagate(j, cost(j)-c);
+      }
+  }
+
+  if(opt.verbose>0) LOG(0) <<"RRT*: " <<iter <<" iterations, " <<T.size() <<" nodes, path length " <<path_length(path) <<" -> " <<cost(goal);
+  arr P2;
+  for(uint i=goal;; i=parent(i)) { P2.prepend(T.X[i]);  if(!i) break; }
+  path = P2.reshape(-1, P.dim());
+}
+
+void rai::PathPlanner::shortcut(arr& path, double deadline) {
+  for(int k=0; k<opt.shortcutIters && path.d0>2 && rai::realTime()<deadline; k++) {
+    uint i = rnd(path.d0-2);
+    uint j = i+2+rnd(path.d0-i-2);
+    if(!P.isEdgeFeasible(path[i], path[j], opt.resolution)) continue;
+    path.delRows(i+1, j-i-1);
+  }
+}
+
+arr rai::PathPlanner::plan(const arr& q0, const arr& qT) {
+  CHECK_EQ(q0.N, P.dim(), "");
+  CHECK_EQ(qT.N, P.dim(), "");
+  double deadline = rai::realTime() + opt.maxTime;
+  if(!P.isFeasible(q0) || !P.isFeasible(qT)) {
+    if(opt.verbose>0) LOG(0) <<"start or goal is infeasible";
+    return arr();
+  }
+  arr path = connect(q0, qT, deadline);
+  if(!path.N) return path;
+  if(opt.optimize) improve(path, deadline);
+  shortcut(path, deadline);
+  return path;
+}
+
+//===========================================================================
+
+double rai::path_length(const arr& path) {
+  double L=0.;
+  for(uint i=1; i<path.d0; i++) L += length(path[i]-path[i-1]);
+  return L;
+}
+
+arrA rai::path_toWaypoints(const arr& path, uint T) {
+  CHECK(path.nd==2 && path.d0, "");
+  arrA W(T);
+  double L = path_length(path);
+  uint i=0;
+  double s0=0.; //arc length at path[i]
+  for(uint t=0; t<T; t++) {
+    double s = (T>1 ? L*(t+1)/T : L); //waypoint t is at (t+1)/T: waypoint T-1 is the goal
+    while(i+1<path.d0-1 && s0+length(path[i+1]-path[i])<s) { s0 += length(path[i+1]-path[i]);  i++; }
+    if(path.d0==1) { W(t) = path[0];  continue; }
+    double l = length(path[i+1]-path[i]);
+    double a = (l>0. ? rai::MIN(1., (s-s0)/l) : 1.);
+    W(t) = path[i] + a*(path[i+1]-path[i]);
+  }
+  return W;
+}
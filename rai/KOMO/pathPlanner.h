@@ -0,0 +1,81 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "../Kin/kin.h"
+
+namespace rai {
+
+//===========================================================================
+
+/** Collision queries of a Configuration as a function of its joint state, for sampling-based planning. A state is
+ *  feasible if, after stepFcl() (or stepSwift()), no proxy has a PairCollision penetration. Each worker of
+ *  rai::taskPool() queries its own copy of the configuration (with its own collision engine), so that batches of
+ *  edges are checked in parallel. */
+struct ConfigurationProblem : NonCopyable {
+  arr limits;          ///< (dim,2) lower and upper bounds of the sampling box; initialized to the joint limits (+-pi for unlimited joints)
+  bool useFCL=true;    ///< otherwise SWIFT
+
+  ConfigurationProblem(const Configuration& C, bool _useFCL=true);
+
+  uint dim() const { return limits.d0; }
+  arr sample() const;  ///< uniform in limits
+
+  bool isFeasible(const arr& q, uint worker=0);
+  /// checks the interior of the straight edge at most resolution apart, coarse to fine (bisection order), so that
+  /// collisions are typically found after a few queries; the end points are assumed to be checked
+  bool isEdgeFeasible(const arr& a, const arr& b, double resolution, uint worker=0);
+  /// isEdgeFeasible for the edges between the rows of A and B, in parallel
+  void areEdgesFeasible(boolA& feasible, const arr& A, const arr& B, double resolution);
+
+ private:
+  Array<shared_ptr<Configuration>> workers; //worker 0 always exists
+  void ensureWorkers(uint n);
+};
+
+//===========================================================================
+
+struct PathPlanner_Options {
+  RAI_PARAM("PathPlanner/", double, stepsize, .2)       ///< max extension of a tree per step (in joint space)
+  RAI_PARAM("PathPlanner/", double, resolution, .02)    ///< max distance between collision checks along an edge
+  RAI_PARAM("PathPlanner/", double, maxTime, .1)        ///< seconds (wall clock) for planning and improving
+  RAI_PARAM("PathPlanner/", int, maxIters, 100000)
+  RAI_PARAM("PathPlanner/", double, goalBias, .1)       ///< probability of extending towards the other tree's root
+  RAI_PARAM("PathPlanner/", bool, optimize, false)      ///< after the first solution, use the remaining time to improve it with RRT*
+  RAI_PARAM("PathPlanner/", int, shortcutIters, 100)    ///< random shortcut attempts on the final path
+  RAI_PARAM("PathPlanner/", int, verbose, 0)
+};
+
+/** RRT-Connect with lazy edge validation: the trees only check the new vertices; edges are checked (in parallel) only
+ *  once the trees connect, and a tree loses the subtree below an infeasible edge. Optionally, the first solution seeds
+ *  an RRT* tree (rewiring candidates checked in parallel, samples that can't improve the solution rejected) that
+ *  improves it until maxTime. The result is shortcut within the same deadline. */
+struct PathPlanner {
+  ConfigurationProblem& P;
+  PathPlanner_Options opt;
+
+  PathPlanner(ConfigurationProblem& _P, const PathPlanner_Options& _opt=PathPlanner_Options()) : P(_P), opt(_opt) {}
+
+  /// returns the path as rows of configurations from q0 to qT (empty if none was found)
+  arr plan(const arr& q0, const arr& qT);
+
+  void shortcut(arr& path, double deadline=INFINITY); ///< random shortcuts (opt.shortcutIters), until the deadline (rai::realTime)
+
+ private:
+  arr connect(const arr& q0, const arr& qT, double deadline);
+  void improve(arr& path, double deadline);
+};
+
+/// T configurations at equally spaced arc lengths (t+1)/T along the path (the start is excluded, the goal is the last),
+/// as KOMO::initWithWaypoints(path_toWaypoints(path, komo.T), komo.stepsPerPhase) expects them
+arrA path_toWaypoints(const arr& path, uint T);
+
+double path_length(const arr& path);
+
+} //namespace
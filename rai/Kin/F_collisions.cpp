@@ -26,51 +26,101 @@ uint F_PairCollision::dim_phi2(const FrameL& F){
 }
 
 
+//the convex core (and its radius) used for collision checking of a frame; markers and shape-less frames are points
+static rai::Mesh& getCollisionCore(rai::Frame* f, double& r) {
+  static rai::Mesh dot = []() { rai::Mesh m; m.setDot(); return m; }();
+  r=0.;
+  if(!f->shape || f->shape->type()==rai::ST_marker) return dot;
+  r=f->shape->radius();
+  rai::Mesh* m = &f->shape->sscCore();
+  if(!m->V.N) { m = &f->shape->mesh(); r=0.; }
+  if(!m->V.N) return dot;
+  return *m;
+}
+
+//sphere, capsule, box and ssBox shapes have a primitive core (closed-form collisions without meshes)
+static bool getPrimitiveCore(PrimitiveCore& c, rai::Frame* f) {
+  if(!f->shape) return false;
+  const arr& size = f->shape->size;
+  switch(f->shape->type()) {
+    case rai::ST_sphere:
+      if(!size.N) return false;
+      c.type = PrimitiveCore::_point;
+      c.radius = size(-1);
+      return true;
+    case rai::ST_capsule:
+      if(size.N<2) return false;
+      c.radius = size(-1);
+      c.half[2] = .5*size(-2);
+      c.type = c.half[2]>1e-10 ? PrimitiveCore::_segment : PrimitiveCore::_point;
+      return true;
+    case rai::ST_box:
+    case rai::ST_ssBox:
+      if(size.N<3) return false;
+      c.type = PrimitiveCore::_box;
+      c.radius = (f->shape->type()==rai::ST_ssBox && size.N==4) ? size(3) : 0.;
+      for(uint i=0; i<3; i++) {
+        c.half[i] = .5*size(i) - c.radius;
+        if(c.half[i]<1e-10) return false; //degenerate core: leave it to the mesh
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
 void F_PairCollision::phi2(arr& y, arr& J, const FrameL& F) {
   if(order>0){  Feature::phi2(y, J, F);  return;  }
-  if(F.nd>=2){
-    FrameL _F = F.ref();
-    if(F.nd==3) _F.reshape(F.d1, F.d2);
-    F.last()->C.kinematicsZero(y, J, dim_phi2(_F));
-    arr ysub, Jsub;
-    for(uint i=0;i<_F.d0;i++){
-      F_PairCollision(type).phi2(ysub, Jsub, _F[i]);
-      y.setVectorBlock(ysub, i);
-      if(!!J) J.setMatrixBlock(Jsub, i, 0);
+  FrameL _F = F.ref();
+  if(F.nd==3) _F.reshape(F.d1, F.d2);
+  if(F.nd==1) _F.reshape(1, F.N);
+  CHECK_EQ(_F.d1, 2, "");
+
+  //-- narrow phase: SDF lookups for point/segment cores against SDF meshes, closed form for primitive pairs, all others in one batch
+  rai::Array<shared_ptr<PairCollision>> colls(_F.d0);
+  PairCollisionBatch batch;
+  uintA batchIdx;
+  for(uint i=0;i<_F.d0;i++){
+    PrimitiveCore c1, c2;
+    bool prim1 = getPrimitiveCore(c1, _F(i,0)), prim2 = getPrimitiveCore(c2, _F(i,1));
+    rai::Shape *s1=_F(i,0)->shape, *s2=_F(i,1)->shape;
+    if(prim1 && s2 && s2->_sdf){
+      colls(i) = make_shared<PairCollision>();
+      if(sdfCollision(*colls(i), *s2->_sdf, _F(i,1)->ensure_X(), c1, _F(i,0)->ensure_X())) continue;
+    } else if(prim2 && s1 && s1->_sdf){
+      colls(i) = make_shared<PairCollision>();
+      if(sdfCollision(*colls(i), *s1->_sdf, _F(i,0)->ensure_X(), c2, _F(i,1)->ensure_X(), true)) continue;
     }
-    return;
-  }
-  CHECK_EQ(F.N, 2, "");
-  rai::Frame* f1 = F.elem(0);
-  rai::Frame* f2 = F.elem(1);
-  double r1=0., r2=0.;
-  rai::Mesh dot;
-  dot.setDot();
-  rai::Mesh *m1=&dot, *m2=&dot;
-  if(f1->shape && f1->shape->type()!=rai::ST_marker){
-    r1=f1->shape->radius();
-    m1 = &f1->shape->sscCore();  if(!m1->V.N) { m1 = &f1->shape->mesh(); r1=0.; }
-    if(!m1->V.N) m1 = &dot;
+    if(prim1 && prim2){
+      colls(i) = make_shared<PairCollision>();
+      if(primitiveCollision(*colls(i), c1, c2, _F(i,0)->ensure_X(), _F(i,1)->ensure_X())) continue;
+    }
+    double r1, r2;
+    rai::Mesh& m1 = getCollisionCore(_F(i,0), r1);
+    rai::Mesh& m2 = getCollisionCore(_F(i,1), r2);
+    batch.add(m1, m2, _F(i,0)->ensure_X(), _F(i,1)->ensure_X(), r1, r2);
+    batchIdx.append(i);
   }
-  if(f2->shape && f2->shape->type()!=rai::ST_marker){
-    r2=f2->shape->radius();
-    m2 = &f2->shape->sscCore();  if(!m2->V.N) { m2 = &f2->shape->mesh(); r2=0.; }
-    if(!m2->V.N) m2 = &dot;
+  batch.compute();
+  for(uint j=0;j<batchIdx.N;j++) colls(batchIdx(j)) = batch.colls(j);
+
+  if(F.nd==1){
+    coll = colls(0);
+    phi_coll(y, J, _F(0,0), _F(0,1));
+    return;
   }
 
-  coll.reset();
-#if 0 //use functionals!
-  auto func1=f1->shape->functional();
-  auto func2=f2->shape->functional();
-  if(func1 && func2){
-    coll=make_shared<PairCollision>(*func1, *func2, .5*(f1->getPosition()+f2->getPosition()));
-  }else{
-    coll=make_shared<PairCollision>(*m1, *m2, f1->ensure_X(), f2->ensure_X(), r1, r2);
+  F.last()->C.kinematicsZero(y, J, dim_phi2(_F));
+  arr ysub, Jsub;
+  for(uint i=0;i<_F.d0;i++){
+    coll = colls(i);
+    phi_coll(ysub, Jsub, _F(i,0), _F(i,1));
+    y.setVectorBlock(ysub, i);
+    if(!!J) J.setMatrixBlock(Jsub, i, 0);
   }
-#else
-  coll=make_shared<PairCollision>(*m1, *m2, f1->ensure_X(), f2->ensure_X(), r1, r2);
-#endif
+}
 
+void F_PairCollision::phi_coll(arr& y, arr& J, rai::Frame* f1, rai::Frame* f2) {
   if(neglectRadii) coll->rad1=coll->rad2=0.;
 
   if(type==_negScalar) {
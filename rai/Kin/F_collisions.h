@@ -25,6 +25,8 @@ struct F_PairCollision : Feature {
   }
   virtual void phi2(arr& y, arr& J, const FrameL& F);
   virtual uint dim_phi2(const FrameL& F);
+ private:
+  void phi_coll(arr& y, arr& J, rai::Frame* f1, rai::Frame* f2); ///< feature from the current coll
 };
 
 //===========================================================================
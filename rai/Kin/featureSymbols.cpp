@@ -98,8 +98,9 @@ std::shared_ptr<Feature> Feature::deepCopy(){
 #define _cpy(T) { T* f = dynamic_cast<T*>(this); if(f) return make_shared<T>(*f); }
   _cpy(F_PositionDiff);
   _cpy(F_qItself);
+  _cpy(F_AccumulatedCollisions);
 #undef _cpy
-  HALT("deepCopy not registered for this type: " <<rai::niceTypeidName(typeid(this)));
+  HALT("deepCopy not registered for this type: " <<rai::niceTypeidName(typeid(*this)));
   return make_shared<Feature>();
 }
 
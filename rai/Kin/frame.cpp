@@ -84,6 +84,7 @@ rai::Frame::~Frame() {
     C.frames.remove(ID);
     listReindex(C.frames);
   }
+  C._state_frameIndex_isGood=false;
   C.reset_q();
 }
 
@@ -259,6 +260,7 @@ void rai::Frame::prefixSubtree(const char* prefix) {
   FrameL F = {this};
   getSubtree(F);
   for(auto* f:F) f->name.prepend(prefix);
+  C._state_frameIndex_isGood=false;
 
 }
 
@@ -302,7 +304,7 @@ void rai::Frame::read(const Graph& ats) {
     set_Q()->rot.normalize();
   }
 
-  if(ats["type"]) ats["type"]->key = "shape"; //compatibility with old convention: 'body { type... }' generates shape
+  if(ats["type"]) ats["type"]->setKey("shape"); //compatibility with old convention: 'body { type... }' generates shape
 
   if((n=ats["joint"])) {
     if(ats["B"]) { //there is an extra transform from the joint into this frame -> create an own joint frame
@@ -398,6 +400,12 @@ void rai::Frame::write(std::ostream& os) const {
 
 /************* USER INTERFACE **************/
 
+rai::Frame& rai::Frame::setName(const char* _name) {
+  name = _name;
+  C._state_frameIndex_isGood=false;
+  return *this;
+}
+
 rai::Frame& rai::Frame::setShape(rai::ShapeType shape, const arr& size) {
   getShape().type() = shape;
   getShape().size() = size;
@@ -468,6 +476,8 @@ rai::Frame& rai::Frame::setConvexMesh(const arr& points, const byteA& colors, do
     getShape().mesh().V.clear().operator=(points).reshape(-1, 3);
     getShape().mesh().makeConvexHull();
     getShape().size.clear();
+    getShape()._sscCore.reset();  getShape().coreRadius=0.;
+    getShape().createCollisionLOD();
   } else {
     getShape().type() = ST_ssCvx;
     getShape().sscCore().V.clear().operator=(points).reshape(-1, 3);
@@ -498,6 +508,7 @@ rai::Frame& rai::Frame::setJoint(rai::JointType jointType) {
 
 rai::Frame& rai::Frame::setContact(int cont) {
   getShape().cont = cont;
+  getShape().createCollisionLOD();
   return *this;
 }
 
@@ -1234,9 +1245,11 @@ rai::Shape::Shape(Frame& f, const Shape* copyShape)
     const Shape& s = *copyShape;
     if(s._mesh) _mesh = s._mesh; //shallow shared_ptr copy!
     if(s._sscCore) _sscCore = s._sscCore; //shallow shared_ptr copy!
+    if(s._sdf) _sdf = s._sdf; //shallow shared_ptr copy!
     _type = s._type;
     size = s.size;
     cont = s.cont;
+    coreRadius = s.coreRadius;
   } else {
     mesh().C= {.8, .8, .8};
   }
@@ -1332,6 +1345,14 @@ void rai::Shape::read(const Graph& ats) {
     //    }
   }
 
+  createCollisionLOD(&ats);
+
+  //signed distance field (from the disk cache, or built once)
+  {
+    double d;
+    if(ats.get(d, "sdf")) _sdf = SparseSDF::getCached(mesh(), d, rai::getParameter<double>("SDF/band", .1));
+  }
+
   //compute the bounding radius
 //  if(mesh().V.N) mesh_radius = mesh().getRadius();
 }
@@ -1428,6 +1449,17 @@ void rai::Shape::glDraw(OpenGL& gl) {
 #endif
 }
 
+//collision LOD: a reduced hull as collision core, with its (conservative) error as radius; the full mesh is kept for display
+void rai::Shape::createCollisionLOD(const Graph* ats) {
+  if(!ats) ats = frame.ats.get();
+  double d = rai::getParameter<double>("Kin/collisionLOD", 0.);
+  if(ats) ats->get(d, "lod");
+  if(d<=0. || _type!=ST_mesh || !cont || mesh().V.d0<=d) return;
+  if(_sscCore && _sscCore->V.N) return; //already created (setConvexMesh resets it when the mesh changes)
+  _sscCore = make_shared<Mesh>(mesh());
+  coreRadius = _sscCore->makeConvexHullLOD(d);
+}
+
 void rai::Shape::createMeshes() {
   //create mesh for basic shapes
   switch(_type) {
@@ -1456,6 +1488,8 @@ void rai::Shape::createMeshes() {
     case rai::ST_camera:
       break;
     case rai::ST_mesh:
+      createCollisionLOD();
+      break;
     case rai::ST_pointCloud:
 //      if(!mesh().V.N) LOG(-1) <<"mesh needs to be loaded";
       break;
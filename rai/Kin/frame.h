@@ -12,6 +12,7 @@
 #include "../Geo/geo.h"
 #include "../Core/graph.h"
 #include "../Geo/mesh.h"
+#include "../Geo/sdf.h"
 
 /* TODO:
  * replace the types by more fundamental:
@@ -72,7 +73,7 @@ struct Transformation_Qtoken {
 struct Frame : NonCopyable {
   Configuration& C;        ///< a Frame is uniquely associated with a Configuration
   uint ID;                 ///< unique identifier (index in Configuration.frames)
-  String name;             ///< name
+  String name;             ///< name (prefer setName to rename: direct writes make the next getFrame miss rescan all frames)
   Frame* parent=nullptr;   ///< parent frame
   FrameL children;         ///< list of children
 
@@ -141,6 +142,7 @@ struct Frame : NonCopyable {
   void write(std::ostream& os) const;
 
   //-- HIGHER LEVEL USER INTERFACE
+  Frame& setName(const char* _name);
   Frame& setShape(rai::ShapeType shape, const arr& size);
   Frame& setPose(const rai::Transformation& _X);
   Frame& setPosition(const arr& pos);
@@ -285,15 +287,18 @@ struct Shape : NonCopyable, GLDrawer {
   arr size;
   ptr<Mesh> _mesh;
   ptr<Mesh> _sscCore;
+  ptr<SparseSDF> _sdf;   ///< optional SDF of the mesh (attribute 'sdf: <resolution>'), for static non-convex meshes
   char cont=0;           ///< are contacts registered (or filtered in the callback)
+  double coreRadius=0.;  ///< radius around the sscCore of a mesh shape (collision LOD); other types keep their radius in size
 
-  double radius() { if(size.N) return size(-1); return 0.; }
+  double radius() { if(_type==ST_mesh && _sscCore && _sscCore->V.N) return coreRadius;  if(size.N) return size(-1); return 0.; }
   Enum<ShapeType>& type() { return _type; }
   Mesh& mesh() { if(!_mesh) _mesh = make_shared<Mesh>();  return *_mesh; }
   Mesh& sscCore() { if(!_sscCore) _sscCore = make_shared<Mesh>();  return *_sscCore; }
   double alpha() { arr& C=mesh().C; if(C.N==4) return C(3); return 1.; }
 
   void createMeshes();
+  void createCollisionLOD(const Graph* ats=nullptr); ///< for a contact mesh with 'lod: K' (or Kin/collisionLOD) and no core yet: a hull of K vertices as sscCore, its error as coreRadius
   shared_ptr<ScalarFunction> functional(bool worldCoordinates=true);
 
   Shape(Frame& f, const Shape* copyShape=nullptr); //new Shape, being added to graph and frame's shape lists
@@ -22,6 +22,7 @@
 #include "../Geo/fclInterface.h"
 #include "../Geo/qhull.h"
 #include "../Geo/mesh_readAssimp.h"
+#include "../Geo/meshProcessing.h"
 #include "../GeoOptim/geoOptim.h"
 #include "../Gui/opengl.h"
 #include "../Algo/algos.h"
@@ -29,6 +30,8 @@
 #include <algorithm>
 #include <sstream>
 #include <climits>
+#include <unordered_map>
+#include <mutex>
 
 #ifdef RAI_ASSIMP
 #  include <assimp/Exporter.hpp>
@@ -128,6 +131,11 @@ struct sConfiguration {
   unique_ptr<PhysXInterface> physx;
   unique_ptr<OdeInterface> ode;
   unique_ptr<FeatherstoneInterface> fs;
+
+  //-- name index for getFrame: frames are verified on lookup, so this may be stale w.r.t. renames
+  std::unordered_map<uint64_t, uintA> frameIndex; ///< hash of name -> ascending IDs of frames (with ID<frameIndexN) of that name
+  uint frameIndexN=0;
+  std::mutex frameIndexMutex;
 };
 
 Configuration::Configuration() {
@@ -232,6 +240,7 @@ void Configuration::addAssimp(const char* filename) {
     }
     f->set_X() = A.poses(i);
   }
+  FrameL F; //frames with new shapes
   for(uint i=0;i<A.names.N;i++){
     Frame* f = frames(Nold+i);
     if(A.meshes(i).N==1){
@@ -239,6 +248,7 @@ void Configuration::addAssimp(const char* filename) {
         Shape* s = new Shape(*f);
         s->type() = ST_mesh;
         s->mesh() = A.meshes(i).scalar();
+        F.append(f);
       }
     }else if(A.meshes(i).N>1){
       uint j=0;
@@ -250,10 +260,29 @@ void Configuration::addAssimp(const char* filename) {
           Shape* s = new Shape(*f1);
           s->type() = ST_mesh;
           s->mesh() = mesh;
+          F.append(f1);
         }
       }
     }
   }
+
+  //-- optional fuse, normals, hulls, decomposition (MeshProcessing/* parameters): concurrently for all meshes, and from
+  //   the disk cache if loaded before
+  MeshL M;
+  for(Frame* f:F) M.append(&f->shape->mesh());
+  rai::Array<MeshA> parts;
+  processMeshes(M, MeshProcessing_Options(), &parts);
+  for(uint i=0;i<F.N;i++){ //convex parts become collision shapes
+    for(uint j=0;j<parts(i).N;j++){
+      Frame* f1 = addFrame(STRING(F(i)->name<<"_cvx" <<j));
+      f1->setParent(F(i));
+      f1->set_Q()->setZero();
+      Shape* s = new Shape(*f1);
+      s->type() = ST_mesh;
+      s->mesh() = parts(i)(j);
+      s->cont = 1;
+    }
+  }
 }
 
 #if 0
@@ -354,13 +383,54 @@ void Configuration::addConfiguration(const Configuration& C, double tau){
 
 /// get first frame with given name
 Frame* Configuration::getFrame(const char* name, bool warnIfNotExist, bool reverse) const {
-  if(!reverse) {
-    for(Frame* b: frames) if(b->name==name) return b;
+  auto scan = [&](uint a, uint b) -> Frame* { //search frames [a,b)
+    if(!reverse) {
+      for(uint i=a; i<b; i++) if(frames.elem(i)->name==name) return frames.elem(i);
+    } else {
+      for(uint i=b; i-->a;) if(frames.elem(i)->name==name) return frames.elem(i);
+    }
+    return nullptr;
+  };
+  Frame* f=nullptr;
+  if(frames.N<32) { //small configurations are faster searched linearly
+    f = scan(0, frames.N);
   } else {
-    for(uint i=frames.N; i--;) if(frames.elem(i)->name==name) return frames.elem(i);
+    //the index covers frames [0,frameIndexN); later ones were appended since the last build and are searched linearly
+    //(Frame::setName invalidates the index; frames renamed by writing Frame::name directly are found by the full scan on a miss)
+    sConfiguration& S = *self;
+    std::lock_guard<std::mutex> lock(S.frameIndexMutex);
+    uint64_t h = hashBytes(name, strlen(name));
+    auto build = [&]() {
+      S.frameIndex.clear();
+      for(Frame* a: frames) S.frameIndex[hashBytes(a->name.p, a->name.N)].append(a->ID);
+      S.frameIndexN = frames.N;
+      _state_frameIndex_isGood = true;
+    };
+    if(!_state_frameIndex_isGood || S.frameIndexN>frames.N || frames.N-S.frameIndexN > 32+S.frameIndexN/8) build();
+    auto indexed = [&]() -> Frame* {
+      auto it = S.frameIndex.find(h);
+      if(it==S.frameIndex.end()) return nullptr;
+      const uintA& I = it->second;
+      for(uint k=0; k<I.N; k++) {
+        uint i = I.elem(reverse ? I.N-1-k : k);
+        if(i<S.frameIndexN && frames.elem(i)->name==name) return frames.elem(i);
+      }
+      return nullptr;
+    };
+    if(!reverse) {
+      f = indexed();
+      if(!f) f = scan(S.frameIndexN, frames.N);
+    } else {
+      f = scan(S.frameIndexN, frames.N);
+      if(!f) f = indexed();
+    }
+    if(!f) { //a miss might be due to directly renamed frames: verify, and rebuild if so
+      f = scan(0, S.frameIndexN);
+      if(f) build();
+    }
   }
-  if(warnIfNotExist) RAI_MSG("cannot find frame named '" <<name <<"'");
-  return 0;
+  if(!f && warnIfNotExist) RAI_MSG("cannot find frame named '" <<name <<"'");
+  return f;
 }
 
 /// get all frames of given indices (almost same as \ref frames . Array::sub() )
@@ -510,6 +580,13 @@ const arr& Configuration::getJointState() const {
 }
 
 arr Configuration::getDofState(const DofL& dofs) const {
+  arr x;
+  getDofState(x, dofs);
+  return x;
+}
+
+/// same as above, but writes into x (reusing its memory if the size matches)
+void Configuration::getDofState(arr& x, const DofL& dofs) const {
   ((Configuration*)this)->ensure_q();
 
   uint n=0;
@@ -517,7 +594,7 @@ arr Configuration::getDofState(const DofL& dofs) const {
     if(!dof->mimic) n += dof->dim;
   }
 
-  arr x(n);
+  x.resize(n);
   n=0;
   for(Dof *dof:dofs) {
     if(!dof->mimic){
@@ -530,7 +607,6 @@ arr Configuration::getDofState(const DofL& dofs) const {
     }
   }
   CHECK_EQ(n, x.N, "");
-  return x;
 }
 
 /// get the (F.N,7)-matrix of all poses for all given frames
@@ -565,6 +641,31 @@ void Configuration::setJointState(const arr& _q) {
   calc_Q_from_q();
 }
 
+/// like setJointState, but only sets dofs whose value changed and only invalidates their branches
+bool Configuration::updateJointState(const arr& _q) {
+  if(!_state_q_isGood || q.N!=_q.N) return false;
+  setJointStateCount++; //global counter
+
+  proxies.clear();
+  _state_proxies_isGood=false;
+
+  for(Dof* j:activeDofs) {
+    if(j->mimic) continue;
+    bool changed=false;
+    for(uint i=j->qIndex; i<j->qIndex+j->dim; i++) {
+      if(q.elem(i)!=_q.elem(i)) { q.elem(i)=_q.elem(i); changed=true; }
+    }
+    if(!changed) continue;
+    j->setDofs(q, j->qIndex);
+    if(j->joint() && j->joint()->type!=JT_tau) j->frame->_state_setXBadinBranch();
+    for(Joint* m:j->mimicers) if(m->active) {
+        m->setDofs(q, m->qIndex);
+        m->frame->_state_setXBadinBranch();
+      }
+  }
+  return true;
+}
+
 /// set the DOFs (joints and forces) for the given subset of frames
 void Configuration::setDofState(const arr& _q, const DofL& dofs) {
   setJointStateCount++; //global counter
@@ -581,12 +682,18 @@ void Configuration::setDofState(const arr& _q, const DofL& dofs) {
         for(uint ii=0; ii<j->dim; ii++) q.elem(j->qIndex+ii) = _q(nd+ii);
       }
       j->setDofs(q, j->qIndex);
+      if(j->joint() && j->joint()->type!=JT_tau) j->frame->_state_setXBadinBranch();
+      for(Joint* m:j->mimicers) if(m->active) { //mimicers need not be among the given dofs
+          m->setDofs(q, m->qIndex);
+          m->frame->_state_setXBadinBranch();
+        }
     }else{
 //      if(activesOnly) HALT("frame '" <<f->name <<"' is a joint, but INACTIVE!");
       if(!j->mimic){
         for(uint ii=0; ii<j->dim; ii++) qInactive.elem(j->qIndex+ii) = _q(nd+ii);
       }
       j->setDofs(qInactive, j->qIndex);
+      if(j->joint() && j->joint()->type!=JT_tau) j->frame->_state_setXBadinBranch();
     }
     if(!j->mimic) nd += j->dim;
   }
@@ -1012,6 +1119,7 @@ void Configuration::sortFrames() {
   frames = calc_topSort();
   uint i=0;
   for(Frame* f: frames) f->ID = i++;
+  _state_frameIndex_isGood=false;
 }
 
 void Configuration::makeObjectsFree(const StringA& objects, double H_cost) {
@@ -1276,6 +1384,7 @@ FrameL Configuration::getCollisionAllPairs(){
 void Configuration::prefixNames(bool clear) {
   if(!clear) for(Frame* a: frames) a->name=STRING('_' <<a->ID <<'_' <<a->name);
   else       for(Frame* a: frames) a->name.clear() <<a->ID;
+  _state_frameIndex_isGood=false;
 }
 
 void Configuration::calc_indexedActiveJoints(bool resetActiveJointSet) {
@@ -2171,7 +2280,7 @@ void Configuration::copyProxies(const ProxyA& _proxies) {
 
 /// prototype for \c operator<<
 void Configuration::write(std::ostream& os, bool explicitlySorted) const {
-  for(Frame* f: frames) if(!f->name.N) f->name <<'_' <<f->ID;
+  for(Frame* f: frames) if(!f->name.N) f->setName(STRING('_' <<f->ID));
   if(!explicitlySorted){
     for(Frame* f: frames) f->write(os);
   }else{
@@ -2182,7 +2291,7 @@ void Configuration::write(std::ostream& os, bool explicitlySorted) const {
 }
 
 void Configuration::write(Graph& G) const {
-  for(Frame* f: frames) if(!f->name.N) f->name <<'_' <<f->ID;
+  for(Frame* f: frames) if(!f->name.N) f->setName(STRING('_' <<f->ID));
   for(Frame* f: frames) f->write(G.newSubgraph({f->name}));
 }
 
@@ -2381,16 +2490,16 @@ Graph Configuration::getGraph() const {
     Node* n = G.elem(f->ID);
     if(f->parent) {
       n->addParent(G.elem(f->parent->ID));
-      n->key = STRING("Q= " <<f->get_Q());
+      n->setKey(STRING("Q= " <<f->get_Q()));
     }
     if(f->joint) {
-      n->key = (STRING("joint " <<f->joint->type));
+      n->setKey(STRING("joint " <<f->joint->type));
     }
     if(f->shape) {
-      n->key = (STRING("shape " <<f->shape->type()));
+      n->setKey(STRING("shape " <<f->shape->type()));
     }
     if(f->inertia) {
-      n->key = (STRING("inertia m=" <<f->inertia->mass));
+      n->setKey(STRING("inertia m=" <<f->inertia->mass));
     }
   }
 #else
@@ -72,6 +72,7 @@ struct Configuration : GLDrawer {
   bool _state_indexedJoints_areGood=false; // the active sets, incl. their topological sorting, are up to date
   bool _state_q_isGood=false; // the q-vector represents the current relative transforms (and force dofs)
   bool _state_proxies_isGood=false; // the proxies have been created for the current state
+  mutable bool _state_frameIndex_isGood=false; // the name index of getFrame is in sync with frames (apart from appended frames)
   //TODO: need a _state for all the plugin engines (SWIFT, PhysX)? To auto-reinitialize them when the config changed structurally?
 
   //-- format in which Jacobians are returned
@@ -120,6 +121,7 @@ struct Configuration : GLDrawer {
   uint getJointStateDimension() const;
   const arr& getJointState() const;
   arr getDofState(const DofL& dofs) const;
+  void getDofState(arr& x, const DofL& dofs) const;
   arr getJointState(const FrameL& F) const { return getDofState(getDofs(F, false)); }
   arr getJointState(const uintA& F) const { return getJointState(getFrames(F)); } ///< same as getJointState() with getFrames()
   arr getJointStateSlice(uint t, bool activesOnly=true){  return getJointState(getJointsSlice(t, activesOnly));  }
@@ -129,6 +131,7 @@ struct Configuration : GLDrawer {
 
   /// @name set state
   void setJointState(const arr& _q);
+  bool updateJointState(const arr& _q); ///< same as setJointState, but only touches dofs that changed; returns false (and does nothing) if the current q is not valid
   void setDofState(const arr& _q, const DofL& dofs);
   void setJointState(const arr& _q, const FrameL& F){ setDofState(_q, getDofs(F, false)); }
   void setJointState(const arr& _q, const uintA& F){ setJointState(_q, getFrames(F)); } ///< same as setJointState() with getFrames()
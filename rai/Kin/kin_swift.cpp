@@ -175,7 +175,7 @@ void SwiftInterface::initActivations(const FrameL& frames) {
 void SwiftInterface::deactivate(rai::Frame* s1, rai::Frame* s2) {
   if(swiftID(s1->ID)==-1 || swiftID(s2->ID)==-1) return;
   //cout <<"deactivating shape pair " <<s1->name <<'-' <<s2->name <<endl;
-  scene->Deactivate(swiftID(s1->ID), swiftID(s2->ID));
+  setActive(swiftID(s1->ID), swiftID(s2->ID), false);
 }
 
 void SwiftInterface::deactivate(const FrameL& shapes1, const FrameL& shapes2) {
@@ -195,17 +195,17 @@ void SwiftInterface::deactivate(const FrameL& shapes) {
 void SwiftInterface::activate(rai::Frame* s1, rai::Frame* s2) {
   if(swiftID(s1->ID)==-1 || swiftID(s2->ID)==-1) return;
   //cout <<"deactivating shape pair " <<s1->name <<'-' <<s2->name <<endl;
-  scene->Activate(swiftID(s1->ID), swiftID(s2->ID));
+  setActive(swiftID(s1->ID), swiftID(s2->ID), true);
 }
 
 void SwiftInterface::activate(rai::Frame* s) {
   if(swiftID(s->ID)==-1) return;
-  scene->Activate(swiftID(s->ID));
+  setActive(swiftID(s->ID), -1, true);
 }
 
 void SwiftInterface::deactivate(rai::Frame* s) {
   if(swiftID(s->ID)==-1) return;
-  scene->Deactivate(swiftID(s->ID));
+  setActive(swiftID(s->ID), -1, false);
 }
 
 void SwiftInterface::pushToSwift(const arr& X) {
@@ -371,7 +371,7 @@ void SwiftInterface::deactivate(const uintA& collisionExcludeIDs){
     int a=swiftID(collisionExcludeIDs(i));
     if(a==-1) continue;
     //cout <<"deactivating shape pair " <<s1->name <<'-' <<s2->name <<endl;
-    scene->Deactivate(a);
+    setActive(a, -1, false);
   }
 }
 
@@ -383,10 +383,22 @@ void SwiftInterface::deactivatePairs(const uintA& collisionExcludePairIDs){
     int b=swiftID(collisionExcludePairIDs(i,1));
     if(a==-1 || b==-1) continue;
     //cout <<"deactivating shape pair " <<s1->name <<'-' <<s2->name <<endl;
-    scene->Deactivate(a, b);
+    setActive(a, b, false);
   }
 }
 
+void SwiftInterface::setActive(int a, int b, bool active) {
+  if(b==-1) { if(active) scene->Activate(a); else scene->Deactivate(a); }
+  else { if(active) scene->Activate(a, b); else scene->Deactivate(a, b); }
+  activationLog.append(intA{a, b, active});
+  activationLog.reshape(activationLog.N/3, 3);
+}
+
+void SwiftInterface::replayActivations(const SwiftInterface& S) {
+  CHECK_EQ(swiftID, S.swiftID, "can only replay activations of an interface on the same frames");
+  for(uint i=0;i<S.activationLog.d0;i++) setActive(S.activationLog(i, 0), S.activationLog(i, 1), S.activationLog(i, 2));
+}
+
 uintA SwiftInterface::step(const arr& X, bool dumpReport) {
   pushToSwift(X);
   return pullFromSwift(dumpReport);
@@ -436,6 +448,8 @@ void SwiftInterface::activate(rai::Frame* s1, rai::Frame* s2) { NICO }
 void SwiftInterface::deactivate(rai::Frame* s1, rai::Frame* s2) { NICO }
 void SwiftInterface::deactivate(const FrameL& shapes1, const FrameL& shapes2) { NICO }
 void SwiftInterface::deactivate(const FrameL& shapes) { NICO }
+void SwiftInterface::replayActivations(const SwiftInterface& S) { NICO }
+void SwiftInterface::setActive(int a, int b, bool active) { NICO }
 
 void SwiftInterface::initActivations(const FrameL& frames) { NICO }
 void SwiftInterface::swiftQueryExactDistance() { NICO }
@@ -18,6 +18,7 @@ struct SwiftInterface {
   intA INDEXswift2frame, swiftID;
   double cutoff;
   arr X_lastQuery;  //memory to check whether an object has moved in consecutive queries
+  intA activationLog; ///< all (de)activations in order, rows (swiftID a, swiftID b or -1, active): to notice changes and to replay them on a copy
 
   SwiftInterface(const FrameL& frames, double _cutoff=.2, int verbose=0);
   ~SwiftInterface();
@@ -29,6 +30,7 @@ struct SwiftInterface {
 
   void deactivate(const uintA& collisionExcludeIDs);
   void deactivatePairs(const uintA& collisionExcludePairIDs);
+  void replayActivations(const SwiftInterface& S); ///< apply the (de)activations of S (built on the same frames)
 
   //-- ** will be deprecated! **
   void reinitShape(const rai::Frame* s);
@@ -41,4 +43,7 @@ struct SwiftInterface {
   void initActivations(const FrameL& frames);
   void swiftQueryExactDistance();
   uint countObjects();
+
+ private:
+  void setActive(int a, int b, bool active);
 };
@@ -456,6 +456,41 @@ bool LGP_Tree::execChoice(String& cmd) {
   return true;
 }
 
+void LGP_Fringe::add(LGP_Node* n) {
+  CHECK(n->count(level), "node has not been evaluated on level " <<level);
+  CHECK(!index.count(n), "node is already in the fringe");
+  index[n] = N;
+  append(n);
+  queue.add(n->feasible(level) ? n->cost(level) : INFINITY, n, true);
+}
+
+LGP_Node* LGP_Fringe::popBest() {
+  while(queue.N) {
+    LGP_Node* n = queue.pop();
+    if(n->isInfeasible) continue; //labelled infeasible since added (and removed by clearInfeasibles)
+    removeNode(n);
+    return n;
+  }
+  return nullptr;
+}
+
+void LGP_Fringe::clearInfeasibles() {
+  for(uint i=N; i--;)
+    if(elem(i)->isInfeasible) removeNode(elem(i));
+}
+
+void LGP_Fringe::removeNode(LGP_Node* n) {
+  auto it = index.find(n);
+  CHECK(it!=index.end(), "node is not in the fringe");
+  uint i = it->second;
+  index.erase(it);
+  if(i+1<N) { //move the last node into the gap
+    elem(i) = last();
+    index[elem(i)] = i;
+  }
+  resizeCopy(N-1);
+}
+
 LGP_Node* LGP_Tree::getBest(LGP_NodeL& fringe, uint level) {
   if(!fringe.N) return nullptr;
   LGP_Node* best=nullptr;
@@ -466,14 +501,6 @@ LGP_Node* LGP_Tree::getBest(LGP_NodeL& fringe, uint level) {
   return best;
 }
 
-LGP_Node* LGP_Tree::popBest(LGP_NodeL& fringe, uint level) {
-  if(!fringe.N) return nullptr;
-  LGP_Node* best=getBest(fringe, level);
-  if(!best) return nullptr;
-  fringe.removeValue(best);
-  return best;
-}
-
 LGP_Node* LGP_Tree::expandNext(int stopOnDepth, LGP_NodeL* addIfTerminal) { //expand
   //    MNode *n =  popBest(fringe_expand, 0);
   if(!fringe_expand.N) HALT("the tree is dead!");
@@ -496,9 +523,9 @@ LGP_Node* LGP_Tree::expandNext(int stopOnDepth, LGP_NodeL* addIfTerminal) { //ex
   return n;
 }
 
-void LGP_Tree::optBestOnLevel(BoundType bound, LGP_NodeL& drawFringe, BoundType drawFrom, LGP_NodeL* addIfTerminal, LGP_NodeL* addChildren) { //optimize a seq
+void LGP_Tree::optBestOnLevel(BoundType bound, LGP_Fringe& drawFringe, LGP_Fringe* addIfTerminal, LGP_NodeL* addChildren) { //optimize a seq
   if(!drawFringe.N) return;
-  LGP_Node* n = popBest(drawFringe, drawFrom);
+  LGP_Node* n = drawFringe.popBest();
   if(n && !n->count(bound)) {
     try {
       n->optBound(bound, collisions, verbose-2);
@@ -509,14 +536,14 @@ void LGP_Tree::optBestOnLevel(BoundType bound, LGP_NodeL& drawFringe, BoundType
     }
 
     if(n->feasible(bound)) {
-      if(addIfTerminal && n->isTerminal) addIfTerminal->append(n);
+      if(addIfTerminal && n->isTerminal) addIfTerminal->add(n);
       if(addChildren) for(LGP_Node* c:n->children) addChildren->append(c);
     }
     focusNode = n;
   }
 }
 
-void LGP_Tree::optFirstOnLevel(BoundType bound, LGP_NodeL& fringe, LGP_NodeL* addIfTerminal) {
+void LGP_Tree::optFirstOnLevel(BoundType bound, LGP_NodeL& fringe, LGP_Fringe* addIfTerminal) {
   if(!fringe.N) return;
   LGP_Node* n =  fringe.popFirst();
   if(n && !n->count(bound)) {
@@ -529,7 +556,7 @@ void LGP_Tree::optFirstOnLevel(BoundType bound, LGP_NodeL& fringe, LGP_NodeL* ad
     }
 
     if(n->feasible(bound)) {
-      if(addIfTerminal && n->isTerminal) addIfTerminal->append(n);
+      if(addIfTerminal && n->isTerminal) addIfTerminal->add(n);
     }
     focusNode = n;
   }
@@ -573,9 +600,9 @@ void LGP_Tree::step() {
 
 //  if(rnd.uni()<.5) optBestOnLevel(BD_pose, fringe_pose, BD_symbolic, &fringe_seq, &fringe_pose);
   optFirstOnLevel(BD_pose, fringe_poseToGoal, &fringe_seq);
-  optBestOnLevel(BD_seq, fringe_seq, BD_pose, &fringe_path, nullptr);
+  optBestOnLevel(BD_seq, fringe_seq, &fringe_path, nullptr);
   if(verbose>0 && fringe_path.N) cout <<"EVALUATING PATH " <<fringe_path.last()->getTreePathString() <<endl;
-  optBestOnLevel(BD_seqPath, fringe_path, BD_seq, &fringe_solved, nullptr);
+  optBestOnLevel(BD_seqPath, fringe_path, &fringe_solved, nullptr);
 
   if(fringe_solved.N>numSol) {
     if(verbose>0) cout <<"NEW SOLUTION FOUND! " <<fringe_solved.last()->getTreePathString() <<endl;
@@ -587,8 +614,8 @@ void LGP_Tree::step() {
   clearFromInfeasibles(fringe_expand);
   clearFromInfeasibles(fringe_pose);
   clearFromInfeasibles(fringe_poseToGoal);
-  clearFromInfeasibles(fringe_seq);
-  clearFromInfeasibles(fringe_path);
+  fringe_seq.clearInfeasibles();
+  fringe_path.clearInfeasibles();
   clearFromInfeasibles(terminals);
 
   if(verbose>0) {
@@ -10,6 +10,9 @@
 
 #include "LGP_node.h"
 #include "../Core/thread.h"
+#include "../Algo/priorityQueue.h"
+
+#include <unordered_map>
 
 struct KinPathViewer;
 
@@ -21,6 +24,21 @@ typedef Array<Transformation> TransformationA;
 
 void initFolStateFromKin(FOL_World& L, const Configuration& K);
 
+/// a list of nodes (unordered) together with a heap on their cost at one bound level, to pop the best
+struct LGP_Fringe : LGP_NodeL {
+  BoundType level;
+  PriorityQueue<LGP_Node*> queue;
+  std::unordered_map<LGP_Node*, uint> index; ///< position of each node in the list, for O(1) removal
+
+  LGP_Fringe(BoundType level) : level(level) {}
+  void add(LGP_Node* n);  ///< n needs to be evaluated on the level already
+  LGP_Node* popBest();    ///< lowest cost among the feasible ones (FIFO among equal), otherwise the first infeasible
+  void clearInfeasibles(); ///< removes the nodes labelled infeasible from the list (their queue entries are skipped by popBest)
+
+ private:
+  void removeNode(LGP_Node* n);
+};
+
 struct LGP_Tree_SolutionData : GLDrawer {
   LGP_Tree& tree;
   LGP_Node* node; ///< contains costs, constraints, and solutions for each level
@@ -65,9 +83,9 @@ struct LGP_Tree : GLDrawer {
 
   LGP_NodeL fringe_pose;  //list of nodes that can be pose tested (parent has been tested)
   LGP_NodeL fringe_poseToGoal; //list of nodes towards a terminal -> scheduled for pose testing
-  LGP_NodeL fringe_seq;   //list of terminal nodes that have been pose tested
-  LGP_NodeL fringe_path;  //list of terminal nodes that have been seq tested
-  LGP_NodeL fringe_solved;  //list of terminal nodes that have been path tested
+  LGP_Fringe fringe_seq=BD_pose;   //list of terminal nodes that have been pose tested
+  LGP_Fringe fringe_path=BD_seq;   //list of terminal nodes that have been seq tested
+  LGP_Fringe fringe_solved=BD_seqPath;  //list of terminal nodes that have been path tested
 
   Var<Array<LGP_Tree_SolutionData*>> solutions;
 
@@ -80,11 +98,10 @@ struct LGP_Tree : GLDrawer {
   //-- methods called in the run loop
  private:
   LGP_Node* getBest(LGP_NodeL& fringe, uint level);
-  LGP_Node* popBest(LGP_NodeL& fringe, uint level);
   LGP_Node* expandNext(int stopOnLevel=-1, LGP_NodeL* addIfTerminal=nullptr);
 
-  void optBestOnLevel(BoundType bound, LGP_NodeL& drawFringe, BoundType drawBound, LGP_NodeL* addIfTerminal, LGP_NodeL* addChildren);
-  void optFirstOnLevel(BoundType bound, LGP_NodeL& fringe, LGP_NodeL* addIfTerminal);
+  void optBestOnLevel(BoundType bound, LGP_Fringe& drawFringe, LGP_Fringe* addIfTerminal, LGP_NodeL* addChildren);
+  void optFirstOnLevel(BoundType bound, LGP_NodeL& fringe, LGP_Fringe* addIfTerminal);
   void clearFromInfeasibles(LGP_NodeL& fringe);
 
  public:
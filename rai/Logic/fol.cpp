@@ -672,4 +672,137 @@ double evaluateFunction(Graph& func, Graph& state, int verbose) {
   return f;
 }
 
+//===========================================================================
+
+static uint64_t mix64(uint64_t x) { //splitmix64 finalizer
+  x ^= x>>30; x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x>>27; x *= 0x94d049bb133111ebull;
+  x ^= x>>31;
+  return x;
+}
+
+uint64_t getTupleHash(const NodeL& tuple, uint64_t seed) {
+  uint64_t h = mix64(seed + 0x9e3779b97f4a7c15ull);
+  for(Node* p:tuple) h = mix64(h + (p ? p->index+1 : 0));
+  return h;
+}
+
+uint64_t getFactHash(Node* fact) {
+  uint64_t h=0;
+  for(uint i=0; i<fact->key.N; i++) h = mix64(h + (unsigned char)fact->key(i));
+  h = getTupleHash(fact->parents, h);
+  if(fact->isOfType<bool>()) {
+    h = mix64(h + (fact->get<bool>() ? 1 : 2));
+  } else if(fact->isOfType<double>()) {
+    double d = fact->get<double>();
+    uint64_t bits;
+    memmove(&bits, &d, sizeof(bits));
+    h = mix64(h + 3 + bits);
+  } else {
+    h = mix64(h + std::hash<std::string>()(STRING(*fact).p));
+  }
+  return h;
+}
+
+uint64_t getStateHash(const Graph& state, bool includeAnnotations) {
+  uint64_t h=0;
+  for(Node* fact:state) {
+    if(!includeAnnotations && fact->key.N) continue;
+    h += mix64(getFactHash(fact)); //commutative: independent of the order of facts
+  }
+  return h;
+}
+
+bool CompiledState::compile(const Graph& state) {
+  symbols.clear();
+  tupleEnd.resize(state.N);
+  values.resize(state.N);
+  isDouble.resize(state.N);
+  keys.resize(1);
+  keys(0).clear(); //an empty key that is not null, as the parser creates it
+  keyOf.resize(state.N);
+  std::vector<uint64_t> factHash(state.N);
+  hash=0;
+  for(uint i=0; i<state.N; i++) {
+    Node* fact = state.elem(i);
+    if(fact->isOfType<bool>()) {
+      values.p[i] = fact->get<bool>();
+      isDouble.p[i] = false;
+    } else if(fact->isOfType<double>()) {
+      values.p[i] = fact->get<double>();
+      isDouble.p[i] = true;
+    } else return false;
+    symbols.append(fact->parents);
+    tupleEnd.p[i] = symbols.N;
+    if(!fact->key.p) keyOf.p[i] = -1;
+    else if(!fact->key.N) keyOf.p[i] = 0;
+    else {
+      uint k=1;
+      while(k<keys.N && keys.p[k]!=fact->key) k++;
+      if(k==keys.N) keys.append(fact->key);
+      keyOf.p[i] = k;
+    }
+    factHash[i] = getFactHash(fact);
+    hash += mix64(factHash[i]);
+  }
+  order.setStraightPerm(state.N);
+  std::sort(order.begin(), order.end(), [&factHash](uint i, uint j) { return factHash[i]<factHash[j]; });
+  return true;
+}
+
+bool CompiledState::factEquals(uint i, Node* fact, bool exactKey) const {
+  uint start = i ? tupleEnd.p[i-1] : 0;
+  uint n = tupleEnd.p[i]-start;
+  if(fact->parents.N!=n) return false;
+  if(memcmp(fact->parents.p, symbols.p+start, n*sizeof(Node*))) return false;
+  if(isDouble.p[i]) {
+    if(!fact->isOfType<double>() || fact->get<double>()!=values.p[i]) return false;
+  } else {
+    if(!fact->isOfType<bool>() || fact->get<bool>()!=(values.p[i]!=0.)) return false;
+  }
+  if(keyOf.p[i]==uint(-1)) return exactKey ? !fact->key.p : !fact->key.N;
+  const String& key = keys.p[keyOf.p[i]];
+  if(exactKey) return fact->key==key;
+  return fact->key.N==key.N && (!key.N || !memcmp(fact->key.p, key.p, key.N));
+}
+
+uint CompiledState::matchingPrefix(const Graph& state) const {
+  uint i=0;
+  while(i<tupleEnd.N && i<state.N && factEquals(i, state.elem(i))) i++;
+  return i;
+}
+
+bool CompiledState::equals(const Graph& state, bool anyOrder) const {
+  //keys are compared by content, as in the hash: graph copies do not preserve whether an empty key is null
+  if(state.N!=tupleEnd.N) return false;
+  uint i=0;
+  while(i<state.N && factEquals(i, state.elem(i), false)) i++;
+  if(i==state.N) return true;
+  if(!anyOrder) return false;
+  //compare both in the order of fact hashes (equal hashes of different facts only make this fail, never succeed)
+  std::vector<std::pair<uint64_t, Node*>> facts(state.N);
+  for(uint i=0; i<state.N; i++) facts[i] = {getFactHash(state.elem(i)), state.elem(i)};
+  std::sort(facts.begin(), facts.end(), [](const std::pair<uint64_t, Node*>& a, const std::pair<uint64_t, Node*>& b) { return a.first<b.first; });
+  for(uint k=0; k<order.N; k++) if(!factEquals(order.p[k], facts[k].second, false)) return false;
+  return true;
+}
+
+void CompiledState::restore(Graph& state) const {
+  //-- keep the longest prefix of facts that is unchanged (transitions typically only modify few facts at the end)
+  uint i = matchingPrefix(state);
+  while(state.N>i) delete state.last();
+
+  //-- create the remaining facts
+  uint start = i ? tupleEnd.p[i-1] : 0;
+  NodeL parents;
+  for(; i<tupleEnd.N; i++) {
+    parents.resize(tupleEnd.p[i]-start);
+    for(uint j=0; j<parents.N; j++) parents.p[j] = symbols.p[start+j];
+    const char* key = keyOf.p[i]==uint(-1) ? nullptr : keys.p[keyOf.p[i]].p;
+    if(isDouble.p[i]) state.newNode<double>(key, parents, values.p[i]);
+    else state.newNode<bool>(key, parents, values.p[i]!=0.);
+    start = tupleEnd.p[i];
+  }
+}
+
 } //namespace
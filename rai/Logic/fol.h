@@ -76,4 +76,29 @@ bool forwardChaining_propositional(Graph& KB, Node* q);
 
 double evaluateFunction(Graph& func, Graph& state, int verbose=0);
 
+//------------ state hashing and compiled states
+
+uint64_t getTupleHash(const NodeL& tuple, uint64_t seed=0); ///< hash of the symbol indices
+uint64_t getFactHash(Node* fact);
+uint64_t getStateHash(const Graph& state, bool includeAnnotations=true); ///< order-independent; annotations are facts with a key (e.g. 'decision')
+
+/** A compact snapshot of a state: each fact is a tuple of symbols (the symbol nodes of the KB) plus its value and key,
+ *  in the order of the state graph, together with the 64-bit state hash. Only bool and double valued facts can be compiled. */
+struct CompiledState {
+  NodeL symbols;     ///< the symbol tuples of all facts, concatenated
+  uintA tupleEnd;    ///< end index (in symbols) of each fact's tuple
+  arr values;        ///< the value of each fact (bools as 0/1)
+  boolA isDouble;
+  StringA keys;      ///< the distinct keys; keys(0) is the empty key
+  uintA keyOf;       ///< the index in keys of each fact's key, -1 if the key is null (as for facts created by rules)
+  uintA order;       ///< the facts sorted by their hash (getFactHash)
+  uint64_t hash=0;   ///< =getStateHash(state, true)
+
+  bool compile(const Graph& state); ///< returns false if the state has facts that are neither bool nor double
+  void restore(Graph& state) const; ///< sets the state to the snapshot (keeps the unchanged prefix of facts)
+  bool equals(const Graph& state, bool anyOrder=true) const; ///< whether state has exactly the facts of the snapshot (otherwise: also in the same order)
+  uint matchingPrefix(const Graph& state) const; ///< number of leading facts of state that equal the snapshot
+  bool factEquals(uint i, Node* fact, bool exactKey=true) const; ///< exactKey: a null key differs from an empty one
+};
+
 } //namespace
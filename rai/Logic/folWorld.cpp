@@ -95,6 +95,11 @@ void FOL_World::init(const Graph& _KB) {
     open(fil, "z.FOL_World");
   }
 
+  hasProbabilisticRules=false;
+  for(Node* rule:worldRules) if(rule->graph().last()->isOfType<arr>()) hasProbabilisticRules=true;
+  for(Node* rule:decisionRules) if(rule->graph().last()->isOfType<arr>()) hasProbabilisticRules=true;
+  clearCache();
+
   start_T_step=0;
   start_T_real=0.;
 //  reset_state();
@@ -103,6 +108,12 @@ void FOL_World::init(const Graph& _KB) {
 FOL_World::~FOL_World() {
 }
 
+void FOL_World::clearCache() {
+  actionCache.clear();
+  transitionCache.clear();
+  cacheHits=cacheMisses=0;
+}
+
 TreeSearchDomain::TransitionReturn FOL_World::transition(const Handle& action) {
   lastStepReward = -stepCost;
   lastStepDuration = 0.;
@@ -126,15 +137,46 @@ TreeSearchDomain::TransitionReturn FOL_World::transition(const Handle& action) {
     if(n->key.N) delete n;
   }
 
+  //-- look up the transition cache
+  uint64_t cacheKey=0;
+  bool useTransitionCache = useCache && !hasProbabilisticRules && !verbFil && verbose<=2;
+  if(useTransitionCache) {
+    cacheKey = getStateHash(*state, false) ^ (d->getKey()*0x9e3779b97f4a7c15ull);
+    auto it = transitionCache.find(cacheKey);
+    if(it!=transitionCache.end()
+        && it->second.waitDecision==d->waitDecision && it->second.decision==d->getTuple()
+        && it->second.pre.equals(*state, false)) {
+      cacheHits++;
+      const CachedTransition& c = it->second;
+      c.post.restore(*state);
+      lastDecisionInState = state->getNode("decision");
+      lastStepDuration = c.duration;
+      lastStepObservation = c.observation;
+      successEnd = c.successEnd;
+      T_real += lastStepDuration;
+      lastStepReward -= lastStepDuration*timeCost;
+      lastStepReward += c.stateReward;
+      deadEnd = (T_step>maxHorizon);
+      if(deadEnd) lastStepReward -= deadEndCost;
+      R_total += lastStepReward;
+      return { Handle(new Observation(lastStepObservation)), lastStepReward, lastStepDuration };
+    }
+    cacheMisses++;
+  }
+
+  //-- snapshot of the pre-state, stored with the transition
+  CompiledState pre;
+  if(useTransitionCache && !pre.compile(*state)) useTransitionCache=false;
+
   //-- add the decision as a fact
   if(!d->waitDecision) {
     NodeL decisionTuple = {d->rule};
     decisionTuple.append(d->substitution);
     lastDecisionInState = createNewFact(*state, decisionTuple);
-    lastDecisionInState->key = ("decision");
+    lastDecisionInState->setKey("decision");
   } else {
     lastDecisionInState = createNewFact(*state, {Wait_keyword});
-    lastDecisionInState->key = ("decision");
+    lastDecisionInState->setKey("decision");
   }
 
   //-- apply effects of decision
@@ -207,10 +249,29 @@ TreeSearchDomain::TransitionReturn FOL_World::transition(const Handle& action) {
   deadEnd = (T_step>maxHorizon);
 
   //-- check for rewards
+  double stateReward=0.;
   if(rewardFct) {
-    lastStepReward += evaluateFunction(*rewardFct, *state, verbose-3);
+    stateReward = evaluateFunction(*rewardFct, *state, verbose-3);
   } else {
-    if(successEnd) lastStepReward += 100.;
+    if(successEnd) stateReward = 100.;
+  }
+  lastStepReward += stateReward;
+
+  //-- store in the transition cache
+  if(useTransitionCache) {
+    if(transitionCache.size()>=cacheCapacity) transitionCache.clear();
+    CachedTransition& c = transitionCache[cacheKey];
+    if(c.post.compile(*state)) {
+      c.pre = pre;
+      c.waitDecision = d->waitDecision;
+      c.decision = d->getTuple();
+      c.stateReward = stateReward;
+      c.duration = lastStepDuration;
+      c.observation = lastStepObservation;
+      c.successEnd = successEnd;
+    } else {
+      transitionCache.erase(cacheKey);
+    }
   }
 
   if(deadEnd) lastStepReward -= deadEndCost;
@@ -237,6 +298,17 @@ const std::vector<FOL_World::Handle> FOL_World::get_actions() {
   if(hasWait) {
     decisions.append(Handle(new Decision(true, nullptr, {}, decisions.N))); //the wait decision (true as first argument, no rule, no substitution)
   }
+  uint64_t stateHash=0;
+  if(useCache) {
+    stateHash = getStateHash(*state);
+    auto it = actionCache.find(stateHash);
+    if(it!=actionCache.end() && it->second.pre.equals(*state, false)) {
+      cacheHits++;
+      if(verbose>2) cout <<"-- # possible decisions: " <<it->second.decisions.size() <<" (cached)" <<endl;
+      return it->second.decisions;
+    }
+    cacheMisses++;
+  }
   for(Node* rule:decisionRules) {
     NodeL subs = getRuleSubstitutions2(*state, rule->graph(), verbose-3);
     for(uint s=0; s<subs.d0; s++) {
@@ -246,6 +318,12 @@ const std::vector<FOL_World::Handle> FOL_World::get_actions() {
   if(verbose>2) cout <<"-- # possible decisions: " <<decisions.N <<endl;
   if(verbose>3) for(Handle& d:decisions) { d.get()->write(cout); cout <<endl; }
 //    cout <<"rule " <<d.first->keys(1) <<" SUB "; listWrite(d.second, cout); cout <<endl;
+  if(useCache) {
+    if(actionCache.size()>=cacheCapacity) actionCache.clear();
+    CachedActions& c = actionCache[stateHash];
+    if(c.pre.compile(*state)) c.decisions = decisions.vec();
+    else actionCache.erase(stateHash);
+  }
   return decisions.vec();
 }
 
@@ -255,7 +333,7 @@ bool FOL_World::is_feasible_action(const TreeSearchDomain::Handle& action) {
 }
 
 const TreeSearchDomain::Handle FOL_World::get_stateCopy() {
-  return std::make_shared<const State>(createStateCopy(), *this);
+  return std::make_shared<const State>(createStateCopy(), *this, getStateHash(*state));
 }
 
 void FOL_World::set_state(const TreeSearchDomain::Handle& _state) {
@@ -292,7 +370,7 @@ void FOL_World::make_current_state_new_start() {
   if(!start_state) start_state = &KB.newSubgraph({"START_STATE"}, state->isNodeOfGraph->parents);
   state->index();
   start_state->copy(*state);
-  start_state->isNodeOfGraph->key="START_STATE";
+  start_state->isNodeOfGraph->setKey("START_STATE");
   start_T_step = T_step;
   start_T_real = T_real;
   DEBUG(KB.checkConsistency();)
@@ -590,6 +668,7 @@ void FOL_World::addTerminalRule(const char* literals) {
   effect.newNode<bool>({}, {Quit_keyword}, true); //adds the (QUIT) to the effect
 
   preconditions.read(STRING(literals));
+  clearCache();
   cout <<"CREATED TERMINATION RULE:" <<*rule.isNodeOfGraph <<endl;
 }
 
@@ -606,6 +685,7 @@ void FOL_World::addTerminalRule(const StringAA& literals) {
     for(const String& s:lit) parents.append(KB[s]);
     preconditions.newNode<bool>({}, parents, true);
   }
+  clearCache();
 
   cout <<"CREATED RULE NODE:" <<*rule.isNodeOfGraph <<endl;
 }
@@ -9,9 +9,12 @@
 #pragma once
 
 #include "treeSearchDomain.h"
+#include "fol.h"
 #include "../Core/array.h"
 #include "../Core/graph.h"
 
+#include <unordered_map>
+
 namespace rai {
 
 struct FOL_World : TreeSearchDomain {
@@ -32,10 +35,9 @@ struct FOL_World : TreeSearchDomain {
       return true;
     }
     NodeL getTuple() const;
+    uint64_t getKey() const { return waitDecision ? 1 : getTupleHash(getTuple()); } ///< identifies the decision independent of its id
     void write(ostream&) const;
-    virtual size_t get_hash() const {
-      return std::hash<int>()(id);
-    }
+    virtual size_t get_hash() const { return getKey(); } ///< the same in all worlds loaded from the same file
   };
 
   struct Observation:SAO {
@@ -57,14 +59,31 @@ struct FOL_World : TreeSearchDomain {
     uint T_step;
     double T_real;
     double R_total;
+    uint64_t hash; ///< =getStateHash(*state)
 
-    State(Graph* state, FOL_World& fol_state)
-      : state(state), T_step(fol_state.T_step), T_real(fol_state.T_real), R_total(fol_state.R_total) {}
+    State(Graph* state, FOL_World& fol_state, uint64_t hash=0)
+      : state(state), T_step(fol_state.T_step), T_real(fol_state.T_real), R_total(fol_state.R_total), hash(hash) {}
     virtual bool operator==(const SAO& other) const {
       auto ob = dynamic_cast<const State*>(&other);
       return ob!=nullptr && ob->state==state;
     }
     void write(ostream& os) const { os <<*state; }
+    virtual size_t get_hash() const { return hash; }
+  };
+
+  struct CachedActions {
+    CompiledState pre;   ///< the state the decisions were grounded in (compared on each hit)
+    std::vector<Handle> decisions;
+  };
+
+  struct CachedTransition {
+    CompiledState pre;   ///< the pre-state, without annotations (compared on each hit)
+    bool waitDecision;
+    NodeL decision;      ///< the decision's tuple (compared on each hit)
+    CompiledState post;  ///< the post-state, including the decision fact
+    double stateReward, duration;
+    int observation;
+    bool successEnd;
   };
 
   //-- parameters
@@ -89,6 +108,14 @@ struct FOL_World : TreeSearchDomain {
   Node* Terminate_keyword=0, *Wait_keyword=0, *Quit_keyword=0, *Quit_literal=0, *Subgoal_keyword=0, *Subgoal_literal=0;
   Graph* subgoals=0;
 
+  //-- caches of the symbolic expansion, keyed by 64-bit state hashes: a state is grounded/transitioned only once per decision
+  bool useCache=false; ///< off by default: on pnp-like domains the lookups cost about as much as they save
+  bool hasProbabilisticRules=false; ///< then transitions are not cached
+  uint cacheCapacity=100000; ///< a cache that reaches this many entries is cleared
+  std::unordered_map<uint64_t, CachedActions> actionCache;        ///< state hash -> decisions
+  std::unordered_map<uint64_t, CachedTransition> transitionCache; ///< (state hash, decision) -> transition
+  uint cacheHits=0, cacheMisses=0;
+
   int verbose;
   int verbFil;
   ofstream fil;
@@ -140,6 +167,8 @@ struct FOL_World : TreeSearchDomain {
   void setState(Graph*, int setT_step=-1);
   Graph* createStateCopy();
 
+  void clearCache(); ///< needs to be called when rules are modified from outside
+
   void write(std::ostream& os) const { os <<KB; }
   void writePDDLdomain(std::ostream& os, const char* domainName="raiFolDomain") const;
   void writePDDLproblem(std::ostream& os, const char* domainName="raiFolDomain", const char* problemName="raiFolProblem") const;
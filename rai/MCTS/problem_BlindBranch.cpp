@@ -12,7 +12,7 @@ BlindBranch::BlindBranch(uint H):H(H) {
   actions = { Handle(new Action(-1)), Handle(new Action(+1)) };
 }
 
-void BlindBranch::reset_state() { state=0; T=0; }
+void BlindBranch::reset_state() { state=start; T=startT; }
 
 rai::TreeSearchDomain::TransitionReturn BlindBranch::transition(const rai::TreeSearchDomain::Handle& action) {
   state += std::dynamic_pointer_cast<const Action>(action)->d;
@@ -31,7 +31,7 @@ const std::vector<rai::TreeSearchDomain::Handle> BlindBranch::get_actions() {
   return actions.vec();
 }
 
-const rai::TreeSearchDomain::Handle BlindBranch::get_state() {
+const rai::TreeSearchDomain::Handle BlindBranch::get_stateCopy() {
   return rai::TreeSearchDomain::Handle(new State(state, T));
 }
 
@@ -43,6 +43,8 @@ void BlindBranch::set_state(const rai::TreeSearchDomain::Handle& _state) {
 
 bool BlindBranch::is_terminal_state() const { return T>=H; }
 
+void BlindBranch::make_current_state_new_start() { start=state; startT=T; }
+
 bool BlindBranch::get_info(InfoTag tag) const {
   switch(tag) {
     case hasTerminal: return true;
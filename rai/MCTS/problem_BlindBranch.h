@@ -16,6 +16,7 @@ struct BlindBranch : rai::TreeSearchDomain {
     Action(int d):d(d) {}
     int d;
     bool operator==(const SAO& other) const { return d==dynamic_cast<const Action&>(other).d; }
+    size_t get_hash() const { return std::hash<int>()(d); }
   };
 
   struct State:SAO {
@@ -26,10 +27,12 @@ struct BlindBranch : rai::TreeSearchDomain {
       const State& s = dynamic_cast<const State&>(other);
       return sum==s.sum && T==s.T;
     }
+    size_t get_hash() const { return std::hash<int>()(sum) ^ (std::hash<uint>()(T)<<1); }
   };
 
   int state; //the state = sum of so-far actions
   int T; //current time (part of the state, actually!)
+  int start=0, startT=0; //the state and time reset_state() returns to
   int H; //horizon (parameter of the world)
   rai::Array<Handle> actions; //will contain handles on the -1 and +1 action
 
@@ -38,9 +41,10 @@ struct BlindBranch : rai::TreeSearchDomain {
   TransitionReturn transition(const Handle& action);
   TransitionReturn transition_randomly();
   const std::vector<Handle> get_actions();
-  const Handle get_state();
+  const Handle get_stateCopy();
   void set_state(const Handle& _state);
   bool is_terminal_state() const;
+  void make_current_state_new_start();
 
   bool get_info(InfoTag tag) const;
   double get_info_value(InfoTag tag) const;
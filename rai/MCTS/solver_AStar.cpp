@@ -61,8 +61,7 @@ void AStar_Node::getGraph(rai::Graph& G, rai::Node* n) {
   } else {
     n = G.newNode<bool>({STRING("a:"<<*action)}, {n}, true);
   }
-  n->key <<STRING("d:" <<d <<" t:" <<time <<' ');
-  n->key <<STRING("f:" <<g+h <<" g:" <<g <<" h:" <<h);
+  n->setKey(STRING(n->key <<"d:" <<d <<" t:" <<time <<' ' <<"f:" <<g+h <<" g:" <<g <<" h:" <<h));
 //  if(mcStats && mcStats->n) n->keys.append(STRING("MC best:" <<mcStats->X.first() <<" n:" <<mcStats->n));
 //  n->keys.append(STRING("sym  #" <<mcCount <<" f:" <<symCost <<" terminal:" <<isTerminal));
 //  n->keys.append(STRING("pose #" <<poseCount <<" f:" <<poseCost <<" g:" <<poseConstraints <<" feasible:" <<poseFeasible));
@@ -102,9 +101,16 @@ void AStar_Node::write(ostream& os, bool recursive) const {
 
 //===========================================================================
 
-AStar::AStar(rai::TreeSearchDomain& world) : root(nullptr), size(0), depth(0) {
+AStar::AStar(rai::TreeSearchDomain& world, bool closedSet) : root(nullptr), size(0), depth(0), closedSet(closedSet) {
   root = new AStar_Node(*this, world);
-  queue.add(0., root);
+  uint h = queue.add(0., root);
+  if(closedSet) states.insert({root->state->get_hash(), {root, h, true}});
+}
+
+AStar::StateEntry* AStar::findState(size_t h, const rai::TreeSearchDomain::Handle& state) {
+  auto range = states.equal_range(h);
+  for(auto it=range.first; it!=range.second; ++it) if(*it->second.node->state==*state) return &it->second; //hashes may collide
+  return nullptr;
 }
 
 bool AStar::step() {
@@ -113,13 +119,27 @@ bool AStar::step() {
     return false;
   }
   auto next =  queue.pop();
+  if(closedSet) findState(next->state->get_hash(), next->state)->open = false;
   if(next->isTerminal) {
     solutions.append(next);
     return true;
   }
   next->expand();
   for(AStar_Node* ch:next->children) {
-    queue.add(- ch->g - ch->h, ch, true);
+    double p = - ch->g - ch->h;
+    if(!closedSet) { queue.add(p, ch, true);  continue; }
+    size_t h = ch->state->get_hash();
+    StateEntry* s = findState(h, ch->state);
+    if(!s) { states.insert({h, {ch, queue.add(p, ch, true), true}});  continue; }
+    if(p >= - s->node->g - s->node->h) continue; //reached before at least as well
+    s->node = ch;
+    if(s->open) { //decrease-key instead of a duplicate
+      queue.entry(s->handle).x = ch;
+      queue.update(s->handle, p);
+    } else { //reopen
+      s->handle = queue.add(p, ch, true);
+      s->open = true;
+    }
   }
   return false;
 }
@@ -12,6 +12,8 @@
 #include "../Core/graph.h"
 #include "../Algo/priorityQueue.h"
 
+#include <unordered_map>
+
 //===========================================================================
 
 struct AStar;
@@ -77,13 +79,21 @@ struct AStar {
   PriorityQueue<AStar_Node*> queue;
   rai::Array<AStar_Node*> solutions;
   uint size, depth;
+  bool closedSet; ///< identify equal states (via get_hash() and ==): a state is queued only via its best node so far
+
+  struct StateEntry { AStar_Node* node; uint handle; bool open; };
+  std::unordered_multimap<size_t, StateEntry> states; ///< best node and queue handle of each reached state (by hash)
 
-  AStar(rai::TreeSearchDomain& world);
+  /// closedSet requires the domain's states to implement get_hash()
+  AStar(rai::TreeSearchDomain& world, bool closedSet=false);
 
   bool step();
   void run();
 
   void reportQueue();
+
+ private:
+  StateEntry* findState(size_t h, const rai::TreeSearchDomain::Handle& state);
 };
 
 //===========================================================================
@@ -0,0 +1,196 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "solver_ParallelMCTS.h"
+#include "../Core/taskPool.h"
+
+#include <random>
+
+namespace {
+void atomicAdd(std::atomic<double>& x, double d) {
+  double old = x.load(std::memory_order_relaxed);
+  while(!x.compare_exchange_weak(old, old+d, std::memory_order_relaxed)) {}
+}
+}
+
+ParallelMCTS::ParallelMCTS(const rai::Array<rai::TreeSearchDomain*>& _worlds)
+  : worlds(_worlds), rollouts(0), claimed(0) {
+  CHECK(worlds.N, "needs at least one world");
+}
+
+ParallelMCTS::~ParallelMCTS() {
+  clearTree();
+}
+
+void ParallelMCTS::clearTree() {
+  for(ParallelMCTS_Node* r:roots) delete r;
+  roots.clear();
+}
+
+void ParallelMCTS::run(uint numRollouts, double maxTime) {
+  uint R = rootParallel ? worlds.N : 1;
+  if(roots.N!=R) {
+    clearTree();
+    for(uint r=0; r<R; r++) roots.append(new ParallelMCTS_Node(nullptr, 0, nullptr));
+  }
+  claimed = rollouts.load();
+  uint64_t target = claimed + (uint64_t)numRollouts;
+  double start = rai::realTime();
+  rai::Array<uint64_t> seeds(worlds.N);
+  for(uint64_t& s:seeds) s = rnd();
+  rai::taskPool().parallel_for(0, worlds.N, [&](uint w) {
+    worker(w, target, maxTime>0. ? start+maxTime : -1., seeds(w));
+  }, 1);
+}
+
+ParallelMCTS_Node* ParallelMCTS::select(ParallelMCTS_Node* n) {
+  //untried children first
+  for(ParallelMCTS_Node* ch:n->children) if(!ch->N.load(std::memory_order_relaxed) && !ch->virtualLoss.load(std::memory_order_relaxed)) return ch;
+  //UCB, where rollouts in progress count as returns of virtualLoss
+  double logN = ::log(double(n->N.load(std::memory_order_relaxed) + n->virtualLoss.load(std::memory_order_relaxed)) + 1.);
+  ParallelMCTS_Node* best=nullptr;
+  double bestScore=-INFINITY;
+  for(ParallelMCTS_Node* ch:n->children) {
+    double vl = ch->virtualLoss.load(std::memory_order_relaxed);
+    double N = ch->N.load(std::memory_order_relaxed) + vl;
+    if(!N) return ch;
+    double score = (ch->Q.load(std::memory_order_relaxed) + vl*virtualLoss)/N + beta*::sqrt(2.*logN/N);
+    if(score>bestScore) { bestScore=score;  best=ch; }
+  }
+  return best;
+}
+
+void ParallelMCTS::worker(uint w, uint64_t target, double endTime, uint64_t seed) {
+  rai::TreeSearchDomain& world = *worlds(w);
+  ParallelMCTS_Node* root = roots(rootParallel ? w : 0);
+  std::mt19937_64 gen(seed);
+  rai::Array<ParallelMCTS_Node*> path;
+  arr rewards;
+
+  for(;;) {
+    if(endTime>0. && rai::realTime()>endTime) break;
+    if(claimed++>=target) break;
+
+    world.reset_state();
+    path.clear();
+    rewards.clear();
+    ParallelMCTS_Node* n = root;
+    n->virtualLoss++;
+    path.append(n);
+    rewards.append(0.);
+    int step=0;
+
+    //-- tree policy
+    while(!world.is_terminal_state() && (stepAbort<0 || step<stepAbort)) {
+      std::vector<rai::TreeSearchDomain::Handle> A = world.get_actions();
+      if(!n->expanded.load(std::memory_order_acquire)) {
+        if(n!=root && !n->N.load(std::memory_order_relaxed)) break; //freshmen -> rollout first
+        bool expect=false;
+        if(!n->expanding.compare_exchange_strong(expect, true)) break; //another worker is expanding -> rollout from here
+        for(const rai::TreeSearchDomain::Handle& a:A) {
+          size_t key = a->get_hash();
+          CHECK(!getChild(n, key), "two decisions of the same state have the same get_hash()");
+          n->children.append(new ParallelMCTS_Node(n, key, a));
+        }
+        n->expanded.store(true, std::memory_order_release);
+      }
+      CHECK_EQ(n->children.N, A.size(), "the decisions of the same state differ between visits");
+      if(!n->children.N) break;
+      n = select(n);
+      n->virtualLoss++;
+      path.append(n);
+      uint i=0;
+      while(i<A.size() && A[i]->get_hash()!=n->key) i++;
+      CHECK(i<A.size(), "the decisions of the same state differ between visits");
+      rewards.append(world.transition(A[i]).reward);
+      step++;
+    }
+
+    //-- rollout
+    double R=0.;
+    while(!world.is_terminal_state() && (stepAbort<0 || step<stepAbort)) {
+      std::vector<rai::TreeSearchDomain::Handle> A = world.get_actions();
+      if(!A.size()) break;
+      R += world.transition(A[std::uniform_int_distribution<size_t>(0, A.size()-1)(gen)]).reward;
+      step++;
+    }
+    if(stepAbort>=0 && step>=stepAbort) R += stepAbortPenalty;
+
+    //-- backup
+    for(uint k=path.N; k--;) {
+      R += rewards(k);
+      ParallelMCTS_Node* p = path(k);
+      atomicAdd(p->Q, R);
+      p->N++;
+      p->virtualLoss--;
+    }
+    rollouts++;
+  }
+}
+
+ParallelMCTS_Node* ParallelMCTS::getChild(ParallelMCTS_Node* n, size_t key) {
+  for(ParallelMCTS_Node* ch:n->children) if(ch->key==key) return ch;
+  return nullptr;
+}
+
+void ParallelMCTS::getRootStatistics(uintA& visits, arr& Qmean) {
+  visits.clear();
+  Qmean.clear();
+  if(!roots.N || !roots(0)->expanded) return;
+  const rai::Array<ParallelMCTS_Node*>& C = roots(0)->children;
+  visits.resize(C.N).setZero();
+  Qmean.resize(C.N).setZero();
+  for(ParallelMCTS_Node* r:roots) {
+    if(!r->expanded) continue;
+    CHECK_EQ(r->children.N, C.N, "roots differ");
+    for(uint i=0; i<C.N; i++) {
+      ParallelMCTS_Node* ch = getChild(r, C(i)->key);
+      CHECK(ch, "roots differ");
+      visits(i) += ch->N;
+      Qmean(i) += ch->Q;
+    }
+  }
+  for(uint i=0; i<visits.N; i++) if(visits(i)) Qmean(i) /= visits(i);
+}
+
+uint ParallelMCTS::getBestActionIdx() {
+  uintA visits;
+  arr Q;
+  getRootStatistics(visits, Q);
+  CHECK(visits.N, "no rollouts yet");
+  int best=-1;
+  for(uint i=0; i<Q.N; i++) if(visits(i) && (best<0 || Q(i)>Q(best))) best=i;
+  CHECK_GE(best, 0, "no rollouts yet");
+  return best;
+}
+
+rai::TreeSearchDomain::Handle ParallelMCTS::getBestAction() {
+  size_t key = roots(0)->children(getBestActionIdx())->key;
+  worlds(0)->reset_state();
+  for(const rai::TreeSearchDomain::Handle& a:worlds(0)->get_actions()) if(a->get_hash()==key) return a;
+  HALT("the best decision is not available in worlds(0)");
+}
+
+uint ParallelMCTS::Nnodes() {
+  uint n=0;
+  rai::Array<ParallelMCTS_Node*> stack = roots;
+  while(stack.N) {
+    ParallelMCTS_Node* x = stack.popLast();
+    n++;
+    if(x->expanded) stack.append(x->children);
+  }
+  return n;
+}
+
+void ParallelMCTS::report(std::ostream& os) {
+  uintA visits;
+  arr Q;
+  getRootStatistics(visits, Q);
+  os <<"ParallelMCTS: #rollouts=" <<rollouts <<" #nodes=" <<Nnodes() <<" #workers=" <<worlds.N <<(rootParallel?" (root parallel)":"") <<endl;
+  for(uint i=0; i<visits.N; i++) os <<"  decision " <<*roots(0)->children(i)->decision <<" N=" <<visits(i) <<" Q=" <<Q(i) <<endl;
+}
@@ -0,0 +1,73 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "../Logic/treeSearchDomain.h"
+#include "../Core/array.h"
+
+#include <atomic>
+
+//===========================================================================
+
+/// a tree node; its statistics are updated lock-free by concurrent workers
+struct ParallelMCTS_Node {
+  ParallelMCTS_Node* parent;
+  size_t key;                       ///< get_hash() of the decision leading here, which identifies it in every world
+  rai::TreeSearchDomain::Handle decision; ///< that decision, as given by the world of the expanding worker (only to report)
+  rai::Array<ParallelMCTS_Node*> children; ///< valid once 'expanded' is set
+
+  std::atomic<uint> N;              ///< # of completed rollouts through this node
+  std::atomic<double> Q;            ///< total returns (from this node on, including its immediate reward)
+  std::atomic<int> virtualLoss;     ///< # of rollouts currently passing this node
+  std::atomic<bool> expanding, expanded;
+
+  ParallelMCTS_Node(ParallelMCTS_Node* parent, size_t key, const rai::TreeSearchDomain::Handle& decision)
+    : parent(parent), key(key), decision(decision), N(0), Q(0.), virtualLoss(0), expanding(false), expanded(false) {}
+  ~ParallelMCTS_Node() { for(ParallelMCTS_Node* ch:children) delete ch; }
+};
+
+//===========================================================================
+
+/** Tree-parallel MCTS (UCT) with virtual loss: workers descend the shared tree concurrently; a rollout in progress
+ *  counts as a loss for every node on its path, which steers the other workers to different branches. With
+ *  rootParallel, each worker instead grows its own tree and the root statistics are merged.
+ *  Each worker owns its own world (one per worker, all in the same start state, e.g. separately loaded
+ *  FOL_Worlds); as decision handles are specific to a world, tree nodes refer to decisions by their get_hash(),
+ *  which needs to be the same in all worlds and distinct among the decisions of a state. Rollouts pick random
+ *  decisions with a per-worker generator. */
+struct ParallelMCTS {
+  rai::Array<rai::TreeSearchDomain*> worlds; ///< one per worker
+  rai::Array<ParallelMCTS_Node*> roots;      ///< one, or one per worker with rootParallel
+  double beta=1.;          ///< UCB exploration
+  double virtualLoss=1.;   ///< return assumed for each rollout in progress (use the min reward of the domain)
+  bool rootParallel=false;
+  int stepAbort=-1;        ///< max steps per rollout (then stepAbortPenalty is added to the return)
+  double stepAbortPenalty=-100.;
+  std::atomic<uint> rollouts; ///< total # of completed rollouts
+
+  ParallelMCTS(const rai::Array<rai::TreeSearchDomain*>& _worlds);
+  ~ParallelMCTS();
+
+  /// runs all workers until numRollouts more rollouts are done or maxTime (sec wall clock, if >0) elapsed; use numRollouts=UINT_MAX for a pure time budget
+  void run(uint numRollouts, double maxTime=-1.);
+
+  /// root statistics (merged over the roots, in the order of roots(0)->children): visits and mean returns of each decision
+  void getRootStatistics(uintA& visits, arr& Qmean);
+  uint getBestActionIdx();  ///< index (in roots(0)->children) of the highest mean return among the visited decisions
+  rai::TreeSearchDomain::Handle getBestAction(); ///< that decision in worlds(0) (in its start state)
+  uint Nnodes();
+  void report(std::ostream& os=std::cout);
+
+ private:
+  void clearTree();
+  std::atomic<uint64_t> claimed; //rollouts started or done in the current run
+  void worker(uint w, uint64_t target, double endTime, uint64_t seed);
+  ParallelMCTS_Node* select(ParallelMCTS_Node* n);
+  static ParallelMCTS_Node* getChild(ParallelMCTS_Node* n, size_t key);
+};
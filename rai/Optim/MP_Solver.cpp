@@ -8,6 +8,7 @@
 #include "opt-ceres.h"
 #include "MathematicalProgram.h"
 #include "constrained.h"
+#include "../Core/taskPool.h"
 
 template<> const char* rai::Enum<MP_SolverID>::names []= {
   "gradientDescent", "rprop", "LBFGS", "newton",
@@ -87,6 +88,7 @@ shared_ptr<SolverReturn> MP_Solver::solve(int resampleInitialization){
       ret->eq = optCon->L.get_sumOfHviolations();
       ret->sos = optCon->L.get_cost_sos();
       ret->f = optCon->L.get_cost_f();
+      ret->feasible = (ret->ineq + ret->eq < feasibleTolerance);
   }
 
   //checkJacobianCP(*P, x, 1e-4);
@@ -98,3 +100,79 @@ shared_ptr<SolverReturn> MP_Solver::solve(int resampleInitialization){
   ret->time = time;
   return ret;
 }
+
+void MP_Solver::evaluateReturn(SolverReturn& ret){
+  arr phi;
+  P->P->evaluate(phi, NoArr, ret.x); //(untraced)
+  ret.f = ret.sos = ret.ineq = ret.eq = 0.;
+  for(uint i=0; i<phi.N; i++) {
+    ObjectiveType ot = P->featureTypes.p[i];
+    if(ot==OT_f) ret.f += phi.p[i];
+    if(ot==OT_sos) ret.sos += rai::sqr(phi.p[i]);
+    if((ot==OT_ineq || ot==OT_ineqB) && phi.p[i]>0.) ret.ineq += phi.p[i];
+    if(ot==OT_eq) ret.eq += fabs(phi.p[i]);
+  }
+  ret.feasible = (ret.ineq + ret.eq < feasibleTolerance);
+}
+
+shared_ptr<MP_MultiStartReturn> MP_Solver::solveMultiStart(uint K, const std::function<shared_ptr<MathematicalProgram>()>& newProblem,
+                                                       bool stopAtFeasible, double distinctTolerance){
+  CHECK(P, "problem not set");
+  auto ret = make_shared<MP_MultiStartReturn>();
+  double start = rai::realTime();
+
+  //-- draw all initializations here: samplers use the global rnd and the problem's state
+  arrA X0(K);
+  for(uint k=0; k<K; k++) X0(k) = P->getInitializationSample();
+
+  //-- one problem instance per worker
+  rai::Array<shared_ptr<MathematicalProgram>> problems;
+  if(newProblem){
+    uint W = rai::MIN(K, rai::MAX(1u, rai::taskPool().numThreads()));
+    for(uint w=0; w<W; w++) problems.append(newProblem());
+  }else{
+    problems.append(P->P);
+  }
+
+  rai::Array<shared_ptr<SolverReturn>> results(K);
+  std::atomic<uint> next(0);
+  std::atomic<bool> found(false);
+  std::mutex mx;
+  rai::taskPool().parallel_for(0, problems.N, [&](uint w){
+    for(;;){
+      if(stopAtFeasible && found) break;
+      uint k = next++;
+      if(k>=K) break;
+      double time = -rai::realTime();
+      MP_Solver S;
+      S.setProblem(problems(w)).setSolver(solverID).setOptions(opt).setInitialization(X0(k));
+      S.feasibleTolerance = feasibleTolerance;
+      S.P->setTracing(false, false, false, false);
+      results(k) = S.solve(0);
+      if(results(k)->ineq<0.) S.evaluateReturn(*results(k)); //the solver did not report violations
+      results(k)->time = time + rai::realTime(); //cpuTime would count all threads
+      if(results(k)->feasible){
+        std::lock_guard<std::mutex> lock(mx);
+        if(ret->timeToFeasible<0.) ret->timeToFeasible = rai::realTime()-start;
+        found = true;
+      }
+    }
+  }, 1);
+
+  //-- sort (feasible first, then by cost) and keep the distinct optima
+  rai::Array<shared_ptr<SolverReturn>> all;
+  for(shared_ptr<SolverReturn>& r:results) if(r) all.append(r);
+  ret->starts = all.N;
+  std::stable_sort(all.p, all.p+all.N, [](const shared_ptr<SolverReturn>& a, const shared_ptr<SolverReturn>& b){
+    if(a->feasible!=b->feasible) return a->feasible;
+    return a->f+a->sos < b->f+b->sos;
+  });
+  for(shared_ptr<SolverReturn>& r:all){
+    bool isNew=true;
+    for(shared_ptr<SolverReturn>& o:ret->optima) if(maxDiff(r->x, o->x)<distinctTolerance){ isNew=false; break; }
+    if(isNew) ret->optima.append(r);
+  }
+  if(ret->optima.N){ x = ret->optima(0)->x;  dual = ret->optima(0)->dual; }
+  ret->time = rai::realTime()-start;
+  return ret;
+}
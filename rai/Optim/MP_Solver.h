@@ -28,7 +28,7 @@ struct SolverReturn {
   uint evals=0;
   double time=0.;
   bool feasible=false;
-  double sos=-1., f=-1., ineq=-1., eq=-1.;
+  double sos=-1., f=-1., ineq=-1., eq=-1.; ///< -1: unknown (see MP_Solver::evaluateReturn)
   void write(ostream& os) const{
     os <<"SolverReturn: time: " <<time <<" evals: " <<evals;
     os <<" feasible: " <<feasible;
@@ -37,12 +37,25 @@ struct SolverReturn {
 };
 stdOutPipe(SolverReturn)
 
+/// result of MP_Solver::solveMultiStart
+struct MP_MultiStartReturn {
+  rai::Array<shared_ptr<SolverReturn>> optima; ///< distinct local optima; feasible ones first, each sorted by cost f+sos
+  uint starts=0;             ///< # of initializations solved (fewer than requested after an early stop)
+  double time=0.;            ///< wall clock time
+  double timeToFeasible=-1.; ///< wall clock time until the first feasible solution was found, -1 if none
+  void write(ostream& os) const{
+    os <<"MP_MultiStartReturn: starts: " <<starts <<" optima: " <<optima.N <<" time: " <<time <<" timeToFeasible: " <<timeToFeasible;
+  }
+};
+stdOutPipe(MP_MultiStartReturn)
+
 /** User Interface: Meta class to call several different solvers in a unified manner. */
 struct MP_Solver : NonCopyable {
   MP_SolverID solverID=MPS_augmentedLag;
   arr x, dual;
   shared_ptr<MP_Traced> P;
   rai::OptOptions opt;
+  double feasibleTolerance=.1; ///< a solution is feasible if its summed ineq and eq violations are below this
 
   MP_Solver& setSolver(MP_SolverID _solverID){ solverID=_solverID; return *this; }
   MP_Solver& setProblem(const shared_ptr<MathematicalProgram>& _P){ CHECK(!P, "problem was already set!"); P = make_shared<MP_Traced>(_P); return *this; }
@@ -52,6 +65,16 @@ struct MP_Solver : NonCopyable {
   MP_Solver& setTracing(bool trace_x, bool trace_costs, bool trace_phi, bool trace_J){ P->setTracing(trace_x, trace_costs, trace_phi, trace_J); return *this; }
 
   shared_ptr<SolverReturn> solve(int resampleInitialization=-1); ///< -1: only when not yet set
+  /// fills f, sos, ineq, eq and feasible of ret by one evaluation at ret.x (solve() only knows them for the constrained solvers)
+  void evaluateReturn(SolverReturn& ret);
+
+  /** Parallel multi-start: K initializations from getInitializationSample are solved concurrently on rai::taskPool().
+   *  Problems usually have internal state, so each worker solves on its own instance from newProblem (e.g.,
+   *  [&komo](){ return komo.mp_SparseNonFactoredClone(); }); without newProblem the starts run one after another on P.
+   *  With stopAtFeasible, no further starts are begun once a solution is feasible. Optima closer than distinctTolerance
+   *  (max norm) are merged. x and dual are set to the best optimum. */
+  shared_ptr<MP_MultiStartReturn> solveMultiStart(uint K, const std::function<shared_ptr<MathematicalProgram>()>& newProblem={},
+                                                  bool stopAtFeasible=true, double distinctTolerance=1e-2);
 
   arr getTrace_x(){ return P->xTrace; }
   arr getTrace_costs(){ return P->costTrace; }
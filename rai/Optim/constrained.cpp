@@ -215,6 +215,50 @@ uint OptConstrained::run() {
   return newton.evals;
 }
 
+//real-time iteration: no inner convergence -- take at most maxNewtonSteps on the current Lagrangian
+//(the problem data may have changed since the last call, e.g. a new start state), do the dual update
+//whenever the inner Newton converged, and never start an evaluation or step that is expected to overrun the deadline
+uint OptConstrained::runRealtime(double timeBudget, uint maxNewtonSteps) {
+  double start = rai::realTime();
+  double deadline = start + timeBudget;
+  newton.logFile = logFile;
+  L.logFile = logFile;
+
+  //the problem data changed: re-evaluate at the warm start (this counts against the budget)
+  if(start+rtEvalTime>=deadline) { rtEvalTime *= .5;  rtEvaluated=false;  return 0; } //(retry in later ticks in case the measurement was an outlier)
+  newton.reinit(newton.x);
+  rtEvalTime = rai::realTime()-start;
+  newton.numTinyFSteps=newton.numTinyXSteps=0;
+
+  bool hasConstraints = L.get_dimOfType(OT_ineq) || L.get_dimOfType(OT_ineqB) || L.get_dimOfType(OT_eq);
+
+  uint k=0;
+  double stepTime = rai::MAX(rtStepTime, rtEvalTime); //a step takes at least one evaluation
+  for(; k<maxNewtonSteps; k++) {
+    double now = rai::realTime();
+    if(now+stepTime>=deadline) break;
+    newton.step();
+    stepTime = rtStepTime = rai::realTime()-now;
+    if(newton.stopCriterion==OptNewton::stopStepFailed) continue;
+    if(newton.stopCriterion>=OptNewton::stopDeltaConverge) {
+      if(!hasConstraints || opt.constrainedMethod==rai::squaredPenaltyFixed) break;
+      L.autoUpdate(opt, &newton.fx, newton.gx, newton.Hx);
+      if(!!dual) dual=L.lambda;
+      its++;
+    }
+  }
+
+  //L was last evaluated at the last line search probe, which is not x if that was rejected
+  rtEvaluated = (L.x==newton.x);
+
+  if(opt.verbose>0) {
+    cout <<"** optConstr. realtime: " <<k <<" Newton steps, f(x)=" <<L.get_costs()
+         <<" \tg_compl=" <<L.get_sumOfGviolations()
+         <<" \th_compl=" <<L.get_sumOfHviolations() <<endl;
+  }
+  return k;
+}
+
 OptConstrained::~OptConstrained() {
 }
 
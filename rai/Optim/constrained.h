@@ -31,6 +31,10 @@ struct OptConstrained {
   ~OptConstrained();
   bool step();
   uint run();
+  double rtEvalTime=0., rtStepTime=0.; ///< measured durations of the last realtime evaluation and Newton step (to predict overruns)
+  bool rtEvaluated=false; ///< whether L holds the values (costs, violations) of x after the last runRealtime -- not so after an early return
+
+  uint runRealtime(double timeBudget, uint maxNewtonSteps=1); ///< bounded latency: a few Newton steps from the current (warm start) x, returns at the deadline
 //  void reinit();
 };
 
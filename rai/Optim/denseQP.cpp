@@ -0,0 +1,152 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "denseQP.h"
+
+#include <math.h>
+
+//in-place Cholesky of the (upper triangle of the) n-by-n matrix K; the lower triangle holds L afterwards
+static bool cholesky_inPlace(double* K, uint n) {
+  for(uint j=0; j<n; j++) {
+    double s = K[j*n+j];
+    for(uint k=0; k<j; k++) s -= K[j*n+k]*K[j*n+k];
+    if(s<=0.) return false;
+    s = ::sqrt(s);
+    K[j*n+j] = s;
+    for(uint i=j+1; i<n; i++) {
+      double t = K[j*n+i]; //upper triangle = symmetric input
+      for(uint k=0; k<j; k++) t -= K[i*n+k]*K[j*n+k];
+      K[i*n+j] = t/s;
+    }
+  }
+  return true;
+}
+
+//solves L L^T x = b in place
+static void cholesky_solve(const double* L, double* b, uint n) {
+  for(uint i=0; i<n; i++) {
+    double t = b[i];
+    for(uint k=0; k<i; k++) t -= L[i*n+k]*b[k];
+    b[i] = t/L[i*n+i];
+  }
+  for(uint i=n; i--;) {
+    double t = b[i];
+    for(uint k=i+1; k<n; k++) t -= L[k*n+i]*b[k];
+    b[i] = t/L[i*n+i];
+  }
+}
+
+void DenseQP::resize(uint n, uint m) {
+  bool keep = (x.N==n && y.N==m);
+  H.resize(n, n).setZero();
+  g.resize(n).setZero();
+  A.resize(m, n).setZero();
+  lo.resize(m) = -INFINITY;
+  up.resize(m) = +INFINITY;
+  if(!keep) {
+    x.resize(n);
+    z.resize(m);
+    y.resize(m);
+    clearWarmStart();
+  }
+}
+
+void DenseQP::clearWarmStart() {
+  x.setZero();
+  z.setZero();
+  y.setZero();
+}
+
+bool DenseQP::factor() {
+  uint n=H.d0, m=A.d0;
+  //-- penalty per row
+  rhoVec.resize(m);
+  for(uint i=0; i<m; i++) {
+    if(lo.p[i]==up.p[i]) rhoVec.p[i] = 1e3*rho;
+    else if(lo.p[i]==-INFINITY && up.p[i]==INFINITY) rhoVec.p[i] = 1e-6;
+    else rhoVec.p[i] = rho;
+  }
+  //-- K = H + sigma I + A^T diag(rho) A (upper triangle)
+  K.resize(n, n);
+  double* Kp=K.p;
+  const double* Ap=A.p;
+  for(uint j=0; j<n; j++) for(uint k=j; k<n; k++) {
+      double s = H.p[j*n+k];
+      for(uint i=0; i<m; i++) s += rhoVec.p[i]*Ap[i*n+j]*Ap[i*n+k];
+      Kp[j*n+k] = s;
+    }
+  for(uint j=0; j<n; j++) Kp[j*n+j] += sigma;
+  return cholesky_inPlace(Kp, n);
+}
+
+void DenseQP::residuals() {
+  uint n=H.d0, m=A.d0;
+  //primal: A x - z
+  primalResidual=0.;
+  for(uint i=0; i<m; i++) {
+    double s=0.;
+    for(uint j=0; j<n; j++) s += A.p[i*n+j]*x.p[j];
+    s -= z.p[i];
+    if(fabs(s)>primalResidual) primalResidual=fabs(s);
+  }
+  //dual: H x + g + A^T y
+  dualResidual=0.;
+  for(uint j=0; j<n; j++) {
+    double s = g.p[j];
+    for(uint k=0; k<n; k++) s += (k<j ? H.p[k*n+j] : H.p[j*n+k])*x.p[k];
+    for(uint i=0; i<m; i++) s += A.p[i*n+j]*y.p[i];
+    if(fabs(s)>dualResidual) dualResidual=fabs(s);
+  }
+}
+
+bool DenseQP::solve() {
+  uint n=H.d0, m=A.d0;
+  CHECK_EQ(H.d1, n, "");
+  CHECK_EQ(g.N, n, "");
+  CHECK_EQ(A.d1, n, "");
+  CHECK_EQ(lo.N, m, "");
+  CHECK_EQ(up.N, m, "");
+  CHECK_EQ(x.N, n, "call resize first");
+
+  if(!factor()) HALT("DenseQP: H + sigma I + A^T rho A is not positive definite");
+
+  xt.resize(n);
+  zt.resize(m);
+  tmp.resize(m);
+  bool converged=false;
+  for(iters=0; iters<maxIters;) {
+    //-- x-update: solve K xt = sigma x - g + A^T (rho z - y)
+    for(uint i=0; i<m; i++) tmp.p[i] = rhoVec.p[i]*z.p[i] - y.p[i];
+    for(uint j=0; j<n; j++) {
+      double s = sigma*x.p[j] - g.p[j];
+      for(uint i=0; i<m; i++) s += A.p[i*n+j]*tmp.p[i];
+      xt.p[j] = s;
+    }
+    cholesky_solve(K.p, xt.p, n);
+
+    //-- relaxed z- and y-update
+    for(uint i=0; i<m; i++) {
+      double s=0.;
+      for(uint j=0; j<n; j++) s += A.p[i*n+j]*xt.p[j];
+      double zr = alpha*s + (1.-alpha)*z.p[i];
+      double zn = zr + y.p[i]/rhoVec.p[i];
+      if(zn<lo.p[i]) zn=lo.p[i];
+      if(zn>up.p[i]) zn=up.p[i];
+      y.p[i] += rhoVec.p[i]*(zr - zn);
+      z.p[i] = zn;
+    }
+    for(uint j=0; j<n; j++) x.p[j] = alpha*xt.p[j] + (1.-alpha)*x.p[j];
+
+    iters++;
+    if(!(iters%checkInterval) || iters==maxIters) {
+      residuals();
+      if(primalResidual<tolerance && dualResidual<tolerance) { converged=true; break; }
+    }
+  }
+  return converged;
+}
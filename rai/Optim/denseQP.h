@@ -0,0 +1,50 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "../Core/array.h"
+
+//===========================================================================
+
+/** A small dense QP
+ *    min_x  1/2 x^T H x + g^T x   s.t.   lo <= A x <= up
+ *  solved with ADMM (OSQP-style operator splitting). Equalities are rows with lo=up, one-sided rows use +-inf.
+ *  Intended for tiny problems solved at high rate (e.g., one control step): all buffers are members and are
+ *  reused across calls (no allocations once the dimensions are stable), and x, z, y are kept as warm start,
+ *  which implicitly carries over the previous active set. */
+struct DenseQP {
+  //-- the problem: fill these after resize()
+  arr H, g;        ///< n-by-n Hessian (only the upper triangle is read), n linear term
+  arr A, lo, up;   ///< m-by-n constraint matrix, m lower and upper bounds
+
+  //-- parameters
+  double rho=.1;          ///< ADMM penalty (equality rows use 1e3*rho)
+  double sigma=1e-6;      ///< primal regularization
+  double alpha=1.6;       ///< over-relaxation
+  double tolerance=1e-5;  ///< absolute tolerance on primal and dual residuals
+  uint maxIters=500;
+  uint checkInterval=5;   ///< check convergence every so many iterations
+
+  //-- solution and warm start
+  arr x, z, y;     ///< primal, constraint values (A x), constraint duals (>0 on upper, <0 on lower bounds)
+
+  //-- report of the last solve
+  uint iters=0;
+  double primalResidual=0., dualResidual=0.;
+
+  /// sets the dimensions; keeps the warm start if they did not change, otherwise resets it
+  void resize(uint n, uint m);
+  void clearWarmStart();
+  bool solve(); ///< returns true if converged within maxIters
+
+ private:
+  arr K, rhoVec, xt, zt, tmp;
+  bool factor();
+  void residuals();
+};
@@ -7,6 +7,7 @@
     --------------------------------------------------------------  */
 
 #include "colorseg.h"
+#include "../Core/taskPool.h"
 
 //#define RAI_libcolorseg
 #ifdef RAI_libcolorseg
@@ -121,17 +122,156 @@ uint get_single_color_segmentation_rgb(uintA& segmentation,  // segmented image
   return (uint) num_segments;
 }
 
+// Unsupervised graph-cut-based segmentation (multi-scale)
+//
+// INPUT
+//    const byteA& image         - zi input image
+//    floatA& sigma              - an array of blurring factors to pre-smoothen the image
+//    floatA& k                  - an array of pixel-similarity thresholds
+//    intA& min                  - an array of minimum sizes of segments
+//
+// NOTE
+//    "sigma.N == k.N == min.N"
+//
+// OUTPUT
+//    MultiSegmentations& segmentation - scale hierarchy of segmented input image
+//
+// NOTE
+//  The segment indices of the output are enumerated from 0...N, i.e.
+//  the number of segments at scale level i can be queried by
+//    uint num_segments = segmentations.p[i].p[segmentation.maxIndex()];
+//
+void get_multiple_color_segmentations(
+  MultiSegmentations& segmentations,  // scale-hierarchy of segmented input
+  const byteA& image,                 // input image
+  const doubleA& sigma,
+  const doubleA& k,
+  const intA& min
+) {
+  // TODO phtread to speed up segmentation (one thread per level)
+  if((sigma.d0 != k.d0) || (sigma.d0 != min.d0))
+    HALT("size of sigma, k, and min has to be equal");
+
+  uint num_levels = sigma.d0;
+  segmentations.resize(num_levels);
+  for(uint i = 0; i < num_levels; i++)
+    get_single_color_segmentation(segmentations.p[i], image, sigma.p[i], k.p[i], min.p[i]);
+}
+
+#else
+
+uint get_single_color_segmentation(uintA& segmentation,
+                                   const byteA& image,
+                                   float sigma,
+                                   float k,
+                                   int min
+                                  ) {NICO}
+
+uint get_single_color_segmentation_rgb(uintA& segmentation,
+                                       byteA& rgb,
+                                       const byteA& image,
+                                       float sigma,
+                                       float k,
+                                       int min) {NICO}
+
+void get_multiple_color_segmentations(MultiSegmentations& segmentations,
+                                      const byteA& image,
+                                      const arr& sigma,
+                                      const arr& k,
+                                      const intA& min
+                                     ) {NIY}
+
+#endif
+
+//===========================================================================
+//
+// patch analysis
+//
+
+namespace {
+
+inline uint findRoot(uint* parent, uint i) { //with path halving
+  while(parent[i]!=i) { parent[i]=parent[parent[i]];  i=parent[i]; }
+  return i;
+}
+
+inline uint findRootConst(const uint* parent, uint i) {
+  while(parent[i]!=i) i=parent[i];
+  return i;
+}
+
+//the root is always the smallest index of a set, which makes ids follow the order of first occurrence
+inline void unite(uint* parent, uint a, uint b) {
+  a=findRoot(parent, a);
+  b=findRoot(parent, b);
+  if(a<b) parent[b]=a; else if(b<a) parent[a]=b;
+}
+
+//integer BT.601 conversion of n rgb pixels into planar rows Y, Cb, Cr (stored consecutively)
+void rgb2ycc(byte* out, const byte* rgb, uint n) {
+  byte *Y=out, *Cb=out+n, *Cr=out+2*n;
+  for(uint x=0; x<n; x++) {
+    int r=rgb[3*x], g=rgb[3*x+1], b=rgb[3*x+2];
+    Y[x] = (77*r + 150*g + 29*b)>>8;
+    Cb[x] = ((-43*r - 85*g + 128*b)>>8) + 128;
+    Cr[x] = ((128*r - 107*g - 21*b)>>8) + 128;
+  }
+}
+
+//m[x] = whether pixel x of the planar YCbCr rows a and b (plane stride s) are similar; a plain loop that vectorizes
+void similarityMask(byte* m, const byte* a, const byte* b, uint n, uint s, int thr) {
+  for(uint x=0; x<n; x++) m[x] = (abs(a[x]-b[x])>>1) + abs(a[s+x]-b[s+x]) + abs(a[2*s+x]-b[2*s+x]) <= thr;
+}
+
+//accumulates patch moments over contiguous row ranges in parallel (one dense partial sum per range); the geometric moments
+//of a run of equal ids within a row are added in closed form; row(y) returns the ids of row y
+void accumulateMoments(arr& M, arrA& partial, const std::function<const uint*(uint)>& row, const byte* img, uint H, uint W, uint np) {
+  uint P = rai::MIN(H, rai::taskPool().numThreads()+1);
+  if(!P) P=1;
+  partial.resize(P);
+  rai::taskPool().parallel_for(0, P, [&](uint t) {
+    arr& S = partial(t);
+    S.resize(np, 12).setZero();
+    for(uint y=(t*H)/P; y<((t+1)*H)/P; y++) {
+      const uint* ids = row(y);
+      for(uint x0=0, x1; x0<W; x0=x1) {
+        for(x1=x0+1; x1<W && ids[x1]==ids[x0]; x1++) {}
+        double n=x1-x0, sx=.5*(x0+x1-1)*n, sxx=((x1-1.)*x1*(2.*x1-1.) - (x0-1.)*x0*(2.*x0-1.))/6.;
+        double* s = S.p+12*ids[x0];
+        s[0]+=n;  s[1]+=sx;  s[2]+=n*y;  s[3]+=sxx;  s[4]+=sx*y;  s[5]+=n*y*y;
+        if(img) {
+          uint c[6]= {0, 0, 0, 0, 0, 0};
+          for(const byte* p=img+3*(y*W+x0); p<img+3*(y*W+x1); p+=3) {
+            c[0]+=p[0];  c[1]+=p[1];  c[2]+=p[2];
+            c[3]+=p[0]*p[0];  c[4]+=p[1]*p[1];  c[5]+=p[2]*p[2];
+          }
+          for(uint k=0; k<6; k++) s[6+k]+=c[k];
+        }
+      }
+    }
+  }, 1);
+  M = partial(0);
+  for(uint t=1; t<P; t++) M += partial(t);
+}
+
+} //namespace
+
+void patch_moments(arr& M, const uintA& patches, const byteA& image, uint np) {
+  CHECK_EQ(patches.nd, 2, "");
+  if(!np) np = max(patches)+1;
+  if(image.N) CHECK_EQ(image.N, 3*patches.N, "need an rgb image of the same size");
+  arrA partial;
+  accumulateMoments(M, partial, [&patches](uint y) { return patches.p+y*patches.d1; }, image.N?image.p:nullptr, patches.d0, patches.d1, np);
+}
+
 void get_patch_centroids(arr& pch_cen, uintA& pch, uint np) {
-  uint x, y, Y=pch.d0, X=pch.d1;
-  pch_cen.resize(np, 2);  pch_cen.setZero();
-  uintA  pch_size(np);    pch_size.setZero();
-  for(y=0; y<Y; y++) for(x=0; x<X; x++) {
-      pch_cen(pch(y, x), 0) += (double)x;
-      pch_cen(pch(y, x), 1) += (double)y;
-      pch_size(pch(y, x))++;
+  arr M;
+  patch_moments(M, pch, NoByteA, np);
+  pch_cen.resize(np, 2).setZero();
+  for(uint i=0; i<np; i++) if(M(i, 0)) {
+      pch_cen(i, 0) = M(i, 1)/M(i, 0);
+      pch_cen(i, 1) = M(i, 2)/M(i, 0);
     }
-  for(uint i=0; i<np; i++)
-    if(pch_size(i)) pch_cen[i]()/=(double)pch_size(i);
 }
 
 // Determine per patch color statistics: mean RGB + standard deviation
@@ -142,48 +282,18 @@ void get_patch_centroids(arr& pch_cen, uintA& pch, uint np) {
 //  doubleA& stats                - N-by-6 matrix, #N patches, 1-3: RGB, 4-6: std. dev.
 //
 void patch_color_statistics(doubleA& stats, const uintA& patches, const byteA& image) {
-  uint num_patches = patches.p[patches.maxIndex()]+1;
-  uint num_pixels = image.d0*image.d1;
   if(image.d2 != 3)
     NIY;
-
-  stats.resize(num_patches, 6);                          // Avg. R, G, B, and std dev
-  stats = 0;
-
-  // sum RGB values
-  intA sum_rgb(num_patches, 3), patch_sizes(num_patches);
-  sum_rgb = 0;
-  patch_sizes = 0;
-  int patch_id = -1, counter = 0;
-  for(uint i = 0; i < num_pixels; i++) {
-    patch_id = patches.p[i];
-    patch_sizes(patch_id) += 1;
-    for(int j = 0; j < 3; j++)
-      sum_rgb(patch_id, j) += image.p[counter+j];
-    counter+=3;
-  }
-
-  // mean RGB-values for each patch
-  for(uint i = 0; i < num_patches; i++)
-    if(patch_sizes(i) > 0)
-      for(int j = 0; j < 3; j++)
-        stats(i, j) = (double) sum_rgb(i, j) / (double) patch_sizes(i);
-
-  // RGB standard deviation
-  double d;
-  counter = 0;
-  for(uint i = 0; i < num_pixels; i++) {
-    patch_id = patches.p[i];
-    for(int j = 0; j < 3; j++) {
-      d = image.p[counter+j] - stats(patch_id, j);
-      stats(patch_id, 3+j) += (d*d);
+  arr M;
+  patch_moments(M, patches, image);
+  stats.resize(M.d0, 6).setZero();
+  for(uint i=0; i<M.d0; i++) if(M(i, 0)) {
+      for(uint j=0; j<3; j++) {
+        double mean = M(i, 6+j)/M(i, 0);
+        stats(i, j) = mean;
+        stats(i, 3+j) = sqrt(rai::MAX(0., M(i, 9+j)/M(i, 0) - mean*mean));
+      }
     }
-    counter += 3;
-  }
-  for(uint i = 0; i < num_patches; i++)
-    if(patch_sizes(i) > 0)
-      for(int j = 3; j < 6; j++)
-        stats(i, j) = sqrt(stats(i, j) / (double) patch_sizes(i));
 }
 
 void get_patch_colors(floatA& pch_col, byteA& img, uintA& pch, uint np) {
@@ -219,56 +329,17 @@ void colorize_patches(byteA& coloration, const uintA& patches, const doubleA& st
       coloration.p[counter++] = stats(patches.p[i], j);
 }
 
-// Unsupervised graph-cut-based segmentation (multi-scale)
-//
-// INPUT
-//    const byteA& image         - zi input image
-//    floatA& sigma              - an array of blurring factors to pre-smoothen the image
-//    floatA& k                  - an array of pixel-similarity thresholds
-//    intA& min                  - an array of minimum sizes of segments
-//
-// NOTE
-//    "sigma.N == k.N == min.N"
-//
-// OUTPUT
-//    MultiSegmentations& segmentation - scale hierarchy of segmented input image
-//
-// NOTE
-//  The segment indices of the output are enumerated from 0...N, i.e.
-//  the number of segments at scale level i can be queried by
-//    uint num_segments = segmentations.p[i].p[segmentation.maxIndex()];
-//
-void get_multiple_color_segmentations(
-  MultiSegmentations& segmentations,  // scale-hierarchy of segmented input
-  const byteA& image,                 // input image
-  const doubleA& sigma,
-  const doubleA& k,
-  const intA& min
-) {
-  // TODO phtread to speed up segmentation (one thread per level)
-  if((sigma.d0 != k.d0) || (sigma.d0 != min.d0))
-    HALT("size of sigma, k, and min has to be equal");
-
-  uint num_levels = sigma.d0;
-  segmentations.resize(num_levels);
-  for(uint i = 0; i < num_levels; i++)
-    get_single_color_segmentation(segmentations.p[i], image, sigma.p[i], k.p[i], min.p[i]);
-}
 
 uint incremental_patch_ids(uintA& pch) {
-  uint i, N=pch.N;
-  uintA pch_old(pch);
-  uintA old_ids;
-  int idx;
-  for(i=0; i<N; i++) {
-    idx = old_ids.findValue(pch_old.elem(i));
-    if(idx<0) {
-      idx = old_ids.N;
-      old_ids.append(pch_old.elem(i));
-    }
-    pch.elem(i) = idx;
+  if(!pch.N) return 0;
+  uintA ids(max(pch)+1);
+  ids = UINT_MAX;
+  uint n=0;
+  for(uint& p:pch) {
+    if(ids(p)==UINT_MAX) ids(p)=n++;
+    p = ids(p);
   }
-  return old_ids.N;
+  return n;
 }
 
 void pch2img(byteA& img, const uintA& pch, floatA& pch_col) {
@@ -295,43 +366,130 @@ void random_colorMap(floatA& pch_col, uint np) {
   rndUniform(pch_col, 0, 255);
 }
 
-#else
-
-#include "../Core/util.h"
-void pch2img(byteA& img, const uintA& pch, floatA& pch_colormap) {NICO}
-void random_colorMap(floatA& pch_colormap, uint np) {NICO}
-uint incremental_patch_ids(uintA& pch) {NICO}
-void get_patch_colors(floatA& pch_col, byteA& img, uintA& pch, uint np) {NICO}
-void get_patch_centroids(doubleA& pch_cen, byteA& img, uintA& pch, uint np) {NICO}
-
-uint get_single_color_segmentation(uintA& segmentation,
-                                   const byteA& image,
-                                   float sigma,
-                                   float k,
-                                   int min
-                                  ) {NICO}
 
-uint get_single_color_segmentation_rgb(uintA& segmentation,
-                                       byteA& rgb,
-                                       const byteA& image,
-                                       float sigma,
-                                       float k,
-                                       int min) {NICO}
-
-void get_patch_centers(arr& centers, const uintA& patches) {NICO}
-
-void get_patch_centroids(arr& pch_cen, uintA& pch, uint np) {NICO}
-
-void patch_color_statistics(arr& stats, const uintA& patches, const byteA& image) {NICO}
-
-void colorize_patches(byteA& coloration, const uintA& patches, const arr& stats) {NICO}
+//===========================================================================
+//
+// ColorSegmentation
+//
 
-typedef rai::Array<uintA> MultiSegmentations;
-void get_multiple_color_segmentations(MultiSegmentations& segmentations,
-                                      const byteA& image,
-                                      const arr& sigma,
-                                      const arr& k,
-                                      const intA& min
-                                     ) {NIY}
+uint ColorSegmentation::compute(uintA& patches, const byteA& image) {
+  CHECK(image.nd==3 && image.d2==3, "need an rgb image");
+  const uint H=image.d0, W=image.d1, N=H*W;
+  if(!N) { patches.clear();  moments.clear();  return 0; }
+  const uint nTiles=(H+rowsPerTile-1)/rowsPerTile;
+  parent.resize(N);
+  patches.resize(H, W);
+  roots.resize(nTiles);
+  rowBuf.resize(nTiles);
+  const int thr=threshold;
+
+  //-- union-find within each tile of rows, on YCbCr rows converted on the fly; afterwards every pixel points to its
+  //   tile-local root, and roots[t] lists the tile's roots
+  rai::taskPool().parallel_for(0, nTiles, [&](uint t) {
+    uint y0=t*rowsPerTile, y1=rai::MIN(H, y0+rowsPerTile);
+    uint* P = parent.p;
+    std::vector<uint>& R = roots[t];
+    R.clear();
+    std::vector<byte>& buf = rowBuf[t];
+    buf.resize(9*W);
+    byte *cur=buf.data(), *up=cur+3*W;
+    byte *L=up+3*W, *Lup=L+W, *U=Lup+W; //similar to the left, the left mask of the row above, similar to above
+    L[0]=Lup[0]=0;
+    for(uint y=y0; y<y1; y++) {
+      uint p=y*W;
+      rgb2ycc(cur, image.p+3*p, W);
+      similarityMask(L+1, cur+1, cur, W-1, W, thr);
+      for(uint x=0; x<W; x++) {
+        if(L[x]) P[p+x] = P[p+x-1];
+        else { P[p+x] = p+x;  R.push_back(p+x); }
+      }
+      if(y>y0) {
+        similarityMask(U, cur, up, W, W, thr);
+        for(uint x=0; x<W; x++) {
+          //skip if already connected via the left neighbor: p+x ~ p+x-1 ~ p+x-1-W ~ p+x-W
+          if(U[x] && !(x && L[x] && U[x-1] && Lup[x])) unite(P, p+x, p+x-W);
+        }
+      }
+      std::swap(cur, up);
+      std::swap(L, Lup);
+    }
+    for(uint p=y0*W; p<y1*W; p++) P[p] = P[P[p]]; //roots precede their members, so this flattens completely
+    uint n=0;
+    for(uint r:R) if(P[r]==r) R[n++]=r;
+    R.resize(n);
+  }, 1);
+
+  //-- join across tile borders (this links tile-local roots only)
+  std::vector<byte>& buf = borderBuf;
+  buf.resize(7*W);
+  for(uint t=1; t<nTiles; t++) {
+    uint p=t*rowsPerTile*W;
+    rgb2ycc(buf.data(), image.p+3*(p-W), W);
+    rgb2ycc(buf.data()+3*W, image.p+3*p, W);
+    similarityMask(buf.data()+6*W, buf.data()+3*W, buf.data(), W, W, thr);
+    for(uint x=0; x<W; x++) if(buf[6*W+x]) unite(parent.p, p+x, p+x-W);
+  }
 
-#endif
+  //-- consecutive ids in order of first occurrence (a root is the first pixel of its set)
+  id.resize(N);
+  uint np=0;
+  for(std::vector<uint>& R:roots) for(uint r:R) if(parent.p[r]==r) id.p[r]=np++;
+
+  //-- label pixels on the fly while accumulating moments; their first column are the patch sizes
+  accumulateMoments(moments, partial, [&](uint y) {
+    uint* ids = patches.p+y*W;
+    const uint* P = parent.p+y*W;
+    for(uint x=0, last=UINT_MAX, i=0; x<W; x++) {
+      if(P[x]!=last) { last=P[x];  i=id.p[findRootConst(parent.p, last)]; }
+      ids[x] = i;
+    }
+    return ids;
+  }, image.p, H, W, np);
+  if(minSize<=1) return np;
+  size.resize(np);
+  bool small=false;
+  for(uint i=0; i<np; i++) { size.p[i]=moments.p[12*i];  if(size.p[i]<minSize) small=true; }
+  if(!small) return np;
+
+  //-- merge small patches into a neighbor: collect neighboring pairs involving one (in parallel), then unite in order
+  pairs.resize(nTiles);
+  rai::taskPool().parallel_for(0, nTiles, [&](uint t) {
+    std::vector<uint>& P = pairs[t];
+    P.clear();
+    const uint* pch = patches.p;
+    auto add = [&](uint a, uint b) {
+      if(size.p[a]>=minSize && size.p[b]>=minSize) return;
+      if(P.size() && P[P.size()-2]==a && P.back()==b) return;
+      P.push_back(a);  P.push_back(b);
+    };
+    for(uint y=t*rowsPerTile; y<rai::MIN(H, (t+1)*rowsPerTile); y++) {
+      const uint* row = pch+y*W;
+      for(uint x=1; x<W; x++) if(row[x]!=row[x-1]) add(row[x-1], row[x]);
+      if(y+1<H) for(uint x=0; x<W; x++) if(row[x]!=row[x+W]) add(row[x], row[x+W]);
+    }
+  }, 1);
+  uint* pp = id.p; //reuse (without resizing, to keep the buffer): union-find over patch ids
+  for(uint i=0; i<np; i++) pp[i]=i;
+  for(std::vector<uint>& P:pairs) for(uint k=0; k<P.size(); k+=2) {
+      uint a=findRoot(pp, P[k]), b=findRoot(pp, P[k+1]);
+      if(a==b || (size.p[a]>=minSize && size.p[b]>=minSize)) continue;
+      if(b<a) std::swap(a, b);
+      pp[b]=a;
+      size.p[a]+=size.p[b];
+    }
+  remap.resize(np);
+  uint n=0;
+  for(uint i=0; i<np; i++) remap.p[i] = (pp[i]==i ? n++ : remap.p[findRoot(pp, i)]); //roots precede their members
+  if(n==np) return np;
+
+  //-- relabel, and fold the moments of merged patches (moments are sums)
+  rai::taskPool().parallel_for(0, nTiles, [&](uint t) {
+    for(uint p=t*rowsPerTile*W; p<rai::MIN(N, (t+1)*rowsPerTile*W); p++) patches.p[p] = remap.p[patches.p[p]];
+  }, 1);
+  arr& M = partial(0);
+  M.resize(n, 12).setZero();
+  for(uint i=0; i<np; i++) for(uint k=0; k<12; k++) M.p[12*remap.p[i]+k] += moments.p[12*i+k];
+  moments = M;
+  np=n;
+  return np;
+}
@@ -18,6 +18,11 @@ void get_patch_colors(floatA& pch_col, byteA& img, uintA& pch, uint np);
 void patch_color_statistics(arr& stats, const uintA& patches, const byteA& image);
 void get_patch_centroids(arr& pch_cen, uintA& pch, uint np);
 
+/** per-patch moments in one (parallel) pass: row i of M holds for patch i
+ *  {n, sum x, sum y, sum xx, sum xy, sum yy, sum r, sum g, sum b, sum rr, sum gg, sum bb}, x the column, y the row;
+ *  the color moments are zero if image is empty. np=0: max patch id+1 */
+void patch_moments(arr& M, const uintA& patches, const byteA& image, uint np=0);
+
 uint get_single_color_segmentation(uintA& segmentation,  // segmented image
                                    const byteA& image,   // input image
                                    float sigma = 0.75,   // (Gaussian!?) blurring factor
@@ -35,6 +40,27 @@ uint get_single_color_segmentation_rgb(uintA& segmentation,  // segmented image
 
 void colorize_patches(byteA& coloration, const uintA& patches, const arr& stats);
 
+/** Fast segmentation into connected patches of similar color, for streaming use: buffers are kept across frames.
+ *  Neighboring pixels are joined if their YCbCr difference |dY|/2+|dCb|+|dCr| is at most threshold (union-find over
+ *  row tiles in parallel, then across tile borders); patches smaller than minSize are merged into a neighbor. */
+struct ColorSegmentation {
+  int threshold=10;
+  uint minSize=64;
+  uint rowsPerTile=32;
+
+  arr moments;          ///< patch_moments of the last image (computed on the fly)
+
+  /// patches (H,W) with ids 0..np-1 in order of first occurrence; returns np
+  uint compute(uintA& patches, const byteA& image);
+
+ private:
+  uintA parent, id, size, remap;
+  std::vector<std::vector<uint>> roots, pairs;
+  std::vector<std::vector<byte>> rowBuf; ///< per tile: two YCbCr rows and three similarity masks
+  std::vector<byte> borderBuf;
+  arrA partial;
+};
+
 typedef rai::Array<uintA> MultiSegmentations;
 void get_multiple_color_segmentations(MultiSegmentations& segmentations,  // scale-hierarchy of segmented input
                                       const byteA& image,                 // input image
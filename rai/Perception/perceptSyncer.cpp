@@ -24,6 +24,7 @@ void SyncFiltered::step() {
   uintA existingIDs;
 
   percepts.writeAccess();
+  matchPercepts(percepts());
   for(PerceptPtr& p:percepts()) {
     p->syncWith(kin.set());
     existingIDs.append(p->id);
@@ -48,3 +49,49 @@ void SyncFiltered::step() {
 
 }
 
+void SyncFiltered::matchPercepts(PerceptL& P) {
+  for(PerceptPtr& p:P) if(p->id>=nextId) nextId=p->id+1;
+
+  std::map<uint, double> newPrices;
+  uintA fused;
+  for(int t=0; t<Percept::Type::PT_end; t++) {
+    PerceptL input, tracked;
+    uintA inputIndex;
+    for(uint i=0; i<P.N; i++) if(P(i)->type==Percept::Type(t)) {
+        if(P(i)->id) tracked.append(P(i));
+        else { input.append(P(i));  inputIndex.append(i); }
+      }
+    if(!input.N) {
+      for(PerceptPtr& p:tracked) if(prices.count(p->id)) newPrices[p->id] = prices[p->id];
+      continue;
+    }
+
+    //gated costs: negative (incompatible) or above the gate are not admissible
+    arr C(input.N, tracked.N);
+    for(uint i=0; i<input.N; i++) for(uint j=0; j<tracked.N; j++) {
+        double c = input(i)->idMatchingCost(*tracked(j));
+        C(i, j) = (c<0. || c>matchingGate) ? INFINITY : c;
+      }
+    assignment.prices.resize(tracked.N);
+    for(uint j=0; j<tracked.N; j++) {
+      auto it = prices.find(tracked(j)->id);
+      assignment.prices(j) = it==prices.end() ? 0. : it->second;
+    }
+    assignment.solve(C, matchingGate, true);
+    for(uint j=0; j<tracked.N; j++) newPrices[tracked(j)->id] = assignment.prices(j);
+
+    for(uint i=0; i<input.N; i++) {
+      int j = assignment.rowMatch(i);
+      if(j>=0) {
+        tracked(j)->fuse(input(i));
+        fused.append(inputIndex(i));
+      } else {
+        input(i)->id = nextId++;
+      }
+    }
+  }
+  prices = newPrices;
+
+  fused.sort();
+  for(uint k=fused.N; k--;) P.remove(fused(k));
+}
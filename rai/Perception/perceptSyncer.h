@@ -10,14 +10,27 @@
 
 #include "percept.h"
 #include "../Core/thread.h"
+#include "../Algo/hungarian.h"
 
-/// syncs percepts with modelWorld
+#include <map>
+
+/// syncs percepts with modelWorld; new percepts (id==0) are first matched to the tracked ones (id>0) and fused
 struct SyncFiltered : Thread {
   Var<PerceptL> percepts;
   Var<rai::Configuration> kin;
+  double matchingGate = rai::getParameter<double>("SyncFiltered/matchingGate", .2); ///< max idMatchingCost of a match; also the cost of starting a new track
 
   SyncFiltered(Var<PerceptL>& _percepts, Var<rai::Configuration>& _kin);
   ~SyncFiltered();
 
   virtual void step();
+
+  /// assigns new percepts to tracked ones of the same type (min total idMatchingCost); matched ones are fused
+  /// and removed, unmatched ones get a new id
+  void matchPercepts(PerceptL& P);
+
+ private:
+  uint nextId=1;
+  LinearAssignment assignment;
+  std::map<uint, double> prices; //dual prices of the tracked percepts by id, warm starting the next frame's matching
 };
@@ -0,0 +1,132 @@
+#include <Algo/hungarian.h>
+
+//===========================================================================
+
+//brute force min cost over all (partial) assignments
+double bruteForce(const arr& C, double unassignedCost, uint i, boolA& used) {
+  if(i==C.d0) return 0.;
+  double best=INFINITY;
+  if(unassignedCost>=0.) best = unassignedCost + bruteForce(C, unassignedCost, i+1, used);
+  for(uint j=0; j<C.d1; j++) if(!used(j) && !std::isinf(C(i, j))) {
+      used(j)=true;
+      best = rai::MIN(best, C(i, j) + bruteForce(C, unassignedCost, i+1, used));
+      used(j)=false;
+    }
+  return best;
+}
+
+void checkSolution(const LinearAssignment& A, const arr& C, double unassignedCost) {
+  double cost=0.;
+  for(uint i=0; i<C.d0; i++) {
+    int j=A.rowMatch(i);
+    if(j<0) { if(unassignedCost>=0.) cost+=unassignedCost; continue; }
+    CHECK_EQ(A.colMatch(j), (int)i, "inconsistent matching");
+    CHECK(!std::isinf(C(i, j)), "gated pair assigned");
+    cost += C(i, j);
+  }
+  CHECK_ZERO(cost-A.cost, 1e-10, "");
+}
+
+void TEST(Random) {
+  for(uint k=0; k<300; k++) {
+    uint n=1+rnd(6), m=1+rnd(6);
+    arr C = rand(n, m);
+    for(double& x:C) if(rnd.uni()<.3) x=INFINITY;
+    double unassignedCost = rnd.uni()<.5 ? -1. : .5*rnd.uni();
+    LinearAssignment A;
+    A.solve(C, unassignedCost);
+    checkSolution(A, C, unassignedCost);
+
+    if(unassignedCost>=0.) {
+      boolA used(m);
+      used.setZero();
+      CHECK_ZERO(A.cost-bruteForce(C, unassignedCost, 0, used), 1e-10, "not optimal");
+    } else if(!C.contains(INFINITY)) {
+      //all of the smaller side is assigned at min cost
+      boolA used(rai::MAX(n, m));
+      used.setZero();
+      double opt = n<=m ? bruteForce(C, -1., 0, used) : bruteForce(~C, -1., 0, used);
+      CHECK_ZERO(A.cost-opt, 1e-10, "not optimal");
+      //dual certificate
+      arr R = A.reducedCosts(C);
+      CHECK_GE(min(R), -1e-10, "dual infeasible");
+      for(uint i=0; i<n; i++) if(A.rowMatch(i)>=0) CHECK_ZERO(R(i, A.rowMatch(i)), 1e-10, "not tight");
+    }
+
+    //the same with a sparse matrix of the admissible entries
+    arr S = C;
+    for(double& x:S) if(std::isinf(x)) x=0.;
+    S.sparse(); //converts, keeping the nonzeros
+    LinearAssignment B;
+    B.solve(S, unassignedCost);
+    CHECK_ZERO(A.cost-B.cost, 1e-10, "sparse differs");
+  }
+
+  //the old interface
+  arr C = rand(5, 5);
+  Hungarian H(C);
+  LinearAssignment A(C);
+  for(uint i=0; i<5; i++) CHECK_EQ(H.getMatch_row(i), (uint)A.rowMatch(i), "");
+}
+
+//===========================================================================
+
+//tracking: objects move a bit, percepts are noisy and shuffled; match percepts (rows) to objects (columns)
+void TEST(Tracking) {
+  uint n=300;
+  double gate=.1;
+  arr X = rand(n, 3);
+  LinearAssignment A;
+  double tCold=0., tWarm=0.;
+  uint T=50;
+  for(uint t=0; t<T; t++) {
+    X += .002*randn(n, 3);
+    uintA perm;
+    perm.setRandomPerm(n);
+    arr C(n, n);
+    for(uint i=0; i<n; i++) for(uint j=0; j<n; j++) {
+        double d = length(X[perm(i)] - X[j]);
+        C(i, j) = d<gate ? d : INFINITY;
+      }
+
+    rai::timerRead(true);
+    LinearAssignment cold(C, gate);
+    tCold += rai::timerRead(true);
+    A.solve(C, gate, t>0);
+    tWarm += rai::timerRead(true);
+
+    CHECK_ZERO(A.cost-cold.cost, 1e-10, "warm start changed the optimum");
+    for(uint i=0; i<n; i++) CHECK_EQ(A.rowMatch(i), (int)perm(i), "wrong track");
+  }
+  cout <<"tracking " <<n <<" objects: cold " <<1e3*tCold/T <<"ms, warm " <<1e3*tWarm/T <<"ms per frame" <<endl;
+
+  //a column that goes free keeps its (negative) warm price: the warm solve must not prefer the dummy
+  double g=.2;
+  A.solve(arr{.05, .06}.reshape(2, 1), g);
+  CHECK_ZERO(A.prices(0)+.14, 1e-10, "");
+  A.solve(arr{.1}.reshape(1, 1), g, true);
+  CHECK_EQ(A.rowMatch(0), 0, "warm start assigned the dummy");
+  CHECK_ZERO(A.cost-.1, 1e-10, "");
+
+  //dense, ungated
+  arr C = rand(n, n);
+  rai::timerRead(true);
+  A.solve(C);
+  cout <<"dense random " <<n <<'x' <<n <<": " <<1e3*rai::timerRead(true) <<"ms" <<endl;
+  rai::timerRead(true);
+  Hungarian H(C);
+  cout <<"Hungarian: " <<1e3*rai::timerRead(true) <<"ms" <<endl;
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv) {
+  rai::initCmdLine(argc, argv);
+
+  rnd.clockSeed();
+
+  testRandom();
+  testTracking();
+
+  return 0;
+}
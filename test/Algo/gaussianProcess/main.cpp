@@ -0,0 +1,122 @@
+#include <Algo/gaussianProcess.h>
+
+//===========================================================================
+
+//posterior mean and sdv at the rows of Q, the textbook way with an explicit inverse
+void bruteForce(arr& Y, arr& S, GaussianProcess& gp, const arr& Q) {
+  uint n=gp.X.d0;
+  arr G(n, n), K(Q.d0, n);
+  for(uint i=0; i<n; i++) for(uint j=0; j<n; j++) G(i, j) = gp.cov(gp.kernelP, gp.X[i], gp.X[j]) + (i==j ? gp.obsVar : 0.);
+  for(uint q=0; q<Q.d0; q++) for(uint i=0; i<n; i++) K(q, i) = gp.cov(gp.kernelP, Q[q], gp.X[i]);
+  arr Ginv = inverse_SymPosDef(G);
+  Y = K*Ginv*(gp.Y-gp.mu) + gp.mu;
+  S.resize(Q.d0);
+  for(uint q=0; q<Q.d0; q++) S(q) = ::sqrt(gp.cov(gp.kernelP, Q[q], Q[q]) - scalarProduct(K[q], Ginv*K[q]));
+}
+
+void TEST(Incremental) {
+  GaussKernelParams kp(1., .3, .1);
+  GaussianProcess gp;
+  gp.setGaussKernelGP(&kp, .5);
+  gp.obsVar=.01;
+
+  arr Q = rand(50, 2), Y, S, Y0, S0;
+  for(uint t=0; t<200; t++) {
+    arr x = rand(2);
+    gp.appendObservation(x, sin(5.*x(0))*x(1));
+    if(t>20 && rnd.uni()<.2) gp.removeObservation(rnd(gp.X.d0));
+    if(!(t%40)) {
+      gp.evaluate(Q, Y, S);
+      bruteForce(Y0, S0, gp, Q);
+      CHECK_ZERO(maxDiff(Y, Y0), 1e-6, "mean");
+      CHECK_ZERO(maxDiff(S, S0), 1e-6, "sdv");
+      double y, s;
+      gp.evaluate(Q[3], y, s);
+      CHECK_ZERO(y-Y(3), 1e-10, "");
+      CHECK_ZERO(s-S(3), 1e-10, "");
+    }
+  }
+
+  //push/pop
+  double y0, s0, y, s;
+  gp.evaluate(Q[0], y0, s0);
+  gp.push(Q[0], 3.);
+  gp.evaluate(Q[0], y, s);
+  CHECK_GE(fabs(y-y0), 1e-3, "");
+  gp.pop();
+  gp.evaluate(Q[0], y, s);
+  CHECK_ZERO(y-y0, 1e-8, "");
+  CHECK_ZERO(s-s0, 1e-8, "");
+}
+
+//the sampled function is conditioned with the GP's own obsVar afterwards
+void TEST(RandomFunction) {
+  GaussKernelParams kp(1., .3, .1);
+  GaussianProcess gp;
+  gp.setGaussKernelGP(&kp, .5);
+  gp.obsVar=.01;
+
+  arr Xbase = rand(30, 1), Q = rand(20, 1), Y, S, Y0, S0;
+  randomFunction(gp, Xbase, false);
+  CHECK_EQ(gp.obsVar, .01, "");
+  gp.evaluate(Q, Y, S);
+  bruteForce(Y0, S0, gp, Q);
+  CHECK_ZERO(maxDiff(Y, Y0), 1e-6, "mean");
+  CHECK_ZERO(maxDiff(S, S0), 1e-6, "sdv");
+}
+
+void TEST(Sparse) {
+  GaussKernelParams kp(1., .2, .1);
+  GaussianProcess gp;
+  gp.setGaussKernelGP(&kp, 0.);
+  gp.obsVar=.01;
+  for(uint i=0; i<100; i++) { arr x=rand(1);  gp.appendObservation(x, sin(6.*x(0))); }
+
+  arr Q = rand(30, 1), Y, S, Ys, Ss;
+  gp.evaluate(Q, Y, S);
+
+  //inducing points at all data: the DTC approximation is exact
+  gp.setInducingPoints(gp.X);
+  gp.evaluate(Q, Ys, Ss);
+  CHECK_ZERO(maxDiff(Y, Ys), 1e-5, "");
+  CHECK_ZERO(maxDiff(S, Ss), 1e-3, "");
+
+  //few inducing points, incremental appends
+  gp.setInducingPoints(20);
+  for(uint i=0; i<2000; i++) { arr x=rand(1);  gp.appendObservation(x, sin(6.*x(0))); }
+  gp.removeObservation(7);
+  arr Yi, Si;
+  gp.evaluate(Q, Yi, Si);
+  gp.recompute();
+  gp.evaluate(Q, Ys, Ss);
+  CHECK_ZERO(maxDiff(Yi, Ys), 1e-6, "incremental sparse update");
+  CHECK_ZERO(maxDiff(Si, Ss), 1e-6, "incremental sparse update");
+  CHECK_ZERO(maxDiff(Ys, sin(6.*Q).reshape(-1)), .05, "");
+}
+
+void TEST(Timing) {
+  GaussKernelParams kp(1., .2, .1);
+  GaussianProcess gp;
+  gp.setGaussKernelGP(&kp, 0.);
+  uint n=1000;
+  arr X = rand(n, 3), Q = rand(1000, 3), Y, S;
+  rai::timerStart();
+  for(uint i=0; i<n; i++) gp.appendObservation(X[i], sum(X[i]));
+  double tAppend=rai::timerRead(true);
+  gp.evaluate(Q, Y, S);
+  double tEval=rai::timerRead(true);
+  cout <<n <<" appends: " <<tAppend <<"sec, " <<Q.d0 <<" batched predictions: " <<tEval <<"sec" <<endl;
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv) {
+  rai::initCmdLine(argc, argv);
+
+  testIncremental();
+  testRandomFunction();
+  testSparse();
+  testTiming();
+
+  return 0;
+}
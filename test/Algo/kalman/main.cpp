@@ -0,0 +1,113 @@
+#include <Algo/kalman.h>
+
+//===========================================================================
+
+arr randSymPosDef(uint n) {
+  arr X = randn(n, n);
+  return X*~X + .1*eye(n);
+}
+
+//the bank agrees with individual filters
+void checkBank(uint n, uint m, uint N, bool joseph) {
+  arr A = eye(n) + .1*randn(n, n), a = randn(n), Q = randSymPosDef(n);
+  arr C = randn(m, n), c = randn(m), W = randSymPosDef(m);
+
+  KalmanBank B(N, zeros(n), eye(n));
+  B.joseph = joseph;
+  rai::Array<Kalman> K(N);
+  for(uint f=0; f<N; f++) {
+    arr x0 = randn(n), P0 = randSymPosDef(n);
+    B.set(f, x0, P0);
+    K(f).initialize(x0, P0);
+  }
+
+  for(uint t=0; t<5; t++) {
+    B.stepPredict(A, a, Q);
+    arr y = randn(m, N);
+    byteA observed(N);
+    for(byte& o:observed) o = rnd.uni()<.8;
+    byteA accepted;
+    uint count = B.stepObserve(y, C, c, W, observed, accepted);
+    CHECK_EQ(accepted, observed, "no gate: all observed ones are accepted");
+    CHECK_EQ(count, sum(convert<uint>(observed)), "");
+    for(uint f=0; f<N; f++) {
+      K(f).stepPredict(A, a, Q);
+      if(observed(f)) K(f).stepObserve(y.col(f).reshape(m), C, c, W);
+      CHECK_ZERO(maxDiff(B.getMean(f), K(f).b_mean), 1e-8*(1.+absMax(K(f).b_mean)), "mean differs, filter " <<f);
+      CHECK_ZERO(maxDiff(B.getVar(f), K(f).b_var), 1e-8*(1.+absMax(K(f).b_var)), "covariance differs, filter " <<f);
+    }
+  }
+}
+
+void TEST(Bank) {
+  for(uint n:{1u, 2u, 4u, 6u, 7u}) for(uint m:{1u, 2u, 3u, 5u}) {
+      checkBank(n, m, 37, true);
+      checkBank(n, m, 37, false);
+    }
+  checkBank(4, 2, 3000, true); //in parallel
+}
+
+//===========================================================================
+
+void TEST(Gating) {
+  uint N=100;
+  KalmanBank B(N, zeros(2), eye(2));
+  B.gate = 9.; //3 sigma in 1D
+  arr C = {1., 0.}, c = {0.}, W = {.01};
+  C.reshape(1, 2);
+  W.reshape(1, 1);
+  arr y = zeros(1, N);
+  y(0, 7) = 100.; //outlier
+  byteA accepted;
+  arr nis;
+  uint count = B.stepObserve(y, C, c, W, NoByteA, accepted, nis);
+  CHECK_EQ(count, N-1, "");
+  CHECK(!accepted(7), "outlier not rejected");
+  CHECK_ZERO(B.getMean(7)(0), 0., "rejected observation changed the mean");
+  CHECK_ZERO(nis(7)-100.*100./1.01, 1e-8, "");
+}
+
+//===========================================================================
+
+void TEST(Speed) {
+  //constant velocity in 3D: state (pos, vel), observe pos
+  uint N=1000;
+  double tau=.01;
+  arr A = eye(6), a = zeros(6), Q = 1e-4*eye(6);
+  for(uint i=0; i<3; i++) A(i, 3+i) = tau;
+  arr C = zeros(3, 6), c = zeros(3), W = 1e-2*eye(3);
+  for(uint i=0; i<3; i++) C(i, i) = 1.;
+  KalmanBank B(N, zeros(6), eye(6));
+  B.gate = 16.;
+  arr y = randn(3, N);
+
+  uint T=100;
+  rai::timerRead(true);
+  for(uint t=0; t<T; t++) {
+    B.stepPredict(A, a, Q);
+    B.stepObserve(y, C, c, W);
+  }
+  double tBank = rai::timerRead(true)/T;
+
+  rai::Array<Kalman> K(N);
+  for(Kalman& k:K) k.initialize(zeros(6), eye(6));
+  rai::timerRead(true);
+  for(uint t=0; t<10; t++) for(uint f=0; f<N; f++) K(f).step(A, a, Q, y.col(f).reshape(3), C, c, W);
+  double tSingle = rai::timerRead(true)/10;
+
+  cout <<N <<" filters (6D state, 3D observation): bank " <<1e6*tBank <<"us, individual " <<1e6*tSingle <<"us per step" <<endl;
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv) {
+  rai::initCmdLine(argc, argv);
+
+  rnd.clockSeed();
+
+  testBank();
+  testGating();
+  testSpeed();
+
+  return 0;
+}
@@ -0,0 +1,132 @@
+#include <Algo/kdTree.h>
+#include <Algo/ann.h>
+
+//===========================================================================
+
+//brute force k nearest, compared to the tree's result by distances (ties may permute ids)
+void checkKnn(const rai::KDTree& T, const arr& x, uint k) {
+  arr D;
+  for(uint i=0; i<T.X.d0; i++) if(T.contains(i)) D.append(T.sqrDistance(T.X[i].p, x.p));
+  std::sort(D.p, D.p+D.N);
+  uintA idx;
+  arr dists;
+  T.knn(idx, dists, x, k);
+  CHECK_EQ(idx.N, rai::MIN(k, D.N), "");
+  for(uint i=0; i<idx.N; i++) {
+    CHECK(T.contains(idx(i)), "removed point returned");
+    CHECK_ZERO(dists(i)-T.sqrDistance(T.X[idx(i)].p, x.p), 1e-12, "");
+    CHECK_ZERO(dists(i)-D(i), 1e-12, "wrong neighbor " <<i);
+  }
+}
+
+void checkRadius(const rai::KDTree& T, const arr& x, double r) {
+  uint m=0;
+  for(uint i=0; i<T.X.d0; i++) if(T.contains(i) && T.sqrDistance(T.X[i].p, x.p)<=r*r) m++;
+  uintA idx;
+  arr dists;
+  T.radius(idx, dists, x, r);
+  CHECK_EQ(idx.N, m, "");
+  for(uint i=1; i<idx.N; i++) CHECK_LE(dists(i-1), dists(i), "not sorted");
+}
+
+void runRandom(rai::KDTree& T, const std::function<arr()>& sample) {
+  uintA ids;
+  for(uint t=0; t<3000; t++) {
+    if(ids.N>20 && rnd.uni()<.3) {
+      uint i=rnd(ids.N);
+      T.remove(ids(i));
+      ids.remove(i);
+    } else {
+      ids.append(T.add(sample()));
+    }
+    CHECK_EQ(T.size(), ids.N, "");
+    if(!(t%50)) {
+      arr x=sample();
+      checkKnn(T, x, 1);
+      checkKnn(T, x, 7);
+      checkRadius(T, x, .3);
+    }
+  }
+}
+
+void TEST(Euclidean) {
+  rai::KDTree T;
+  runRandom(T, []() { return randn(3); });
+
+  //duplicates and a static build
+  arr X = rand(500, 2);
+  X.append(repmat(~arr{.5, .5}, 100, 1));
+  T.set(X);
+  for(uint t=0; t<20; t++) checkKnn(T, rand(2), 5);
+  checkKnn(T, arr{.5, .5}, 120);
+}
+
+void TEST(Metrics) {
+  //a planar pose (x, y, angle) with weights
+  rai::KDTree T;
+  T.setMetric({1., 2., .3}, {2});
+  runRandom(T, []() { return arr{rnd.uni(), rnd.uni(), rnd.uni(-RAI_PI, RAI_PI)}; });
+
+  //SE(3): position and quaternion
+  rai::KDTree S;
+  S.setMetric({1., 1., 1., .5, .5, .5, .5}, {}, {3});
+  runRandom(S, []() { arr q=randn(4);  q/=length(q);  return (rand(3), q); });
+}
+
+void TEST(Batch) {
+  rai::KDTree T(randn(2000, 4));
+  arr Q = randn(100, 4);
+  uintA idx;
+  arr dists;
+  T.knnBatch(idx, dists, Q, 5);
+  rai::Array<uintA> I;
+  T.radiusBatch(I, Q, .5);
+  for(uint q=0; q<Q.d0; q++) {
+    uintA i;
+    arr d;
+    T.knn(i, d, Q[q], 5);
+    CHECK_EQ(i, idx[q], "");
+    T.radius(i, d, Q[q], .5);
+    CHECK_EQ(i.N, I(q).N, "");
+  }
+}
+
+void TEST(Incremental) {
+  uint N=100000;
+  arr X = rand(N, 3);
+  arr Q = rand(1000, 3);
+
+  rai::timerStart();
+  rai::KDTree T;
+  for(uint i=0; i<N; i++) T.add(X[i]);
+  double add=rai::timerRead();
+  for(uint q=0; q<Q.d0; q++) T.nearest(Q[q]);
+  double query=rai::timerRead();
+  cout <<"kd-tree: " <<N <<" incremental inserts: " <<add <<"sec, " <<Q.d0 <<" queries: " <<query <<"sec" <<endl;
+
+  //ANN (used by RRT) is now based on it: append & query interleaved
+  ANN ann;
+  rai::timerStart();
+  for(uint i=0; i<N/10; i++) { ann.append(X[i]);  ann.getNN(Q[i%Q.d0]); }
+  cout <<"ANN: " <<N/10 <<" interleaved appends & queries: " <<rai::timerRead() <<"sec" <<endl;
+  for(uint q=0; q<20; q++) {
+    uint i=ann.getNN(Q[q]);
+    double d=sqrDistance(X[i], Q[q]);
+    for(uint j=0; j<N/10; j++) CHECK_LE(d, sqrDistance(X[j], Q[q]), "");
+  }
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv) {
+  rai::initCmdLine(argc, argv);
+
+  rnd.clockSeed();
+
+  testEuclidean();
+  testMetrics();
+  testBatch();
+  testIncremental();
+
+  return 0;
+}
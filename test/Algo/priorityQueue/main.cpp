@@ -0,0 +1,131 @@
+#include <Algo/priorityQueue.h>
+#include <Algo/astar.h>
+
+#include <map>
+
+//===========================================================================
+
+//random adds, pops, updates and erases against a std::multimap keyed by (priority, insertion order)
+void TEST(Queue) {
+  PriorityQueue<uint> Q;
+  std::map<std::pair<double, uint>, uint> ref; //(p, order) -> handle
+  rai::Array<std::pair<double, uint>> key; //handle -> key in ref
+  uint order=0, maxN=0;
+  for(uint t=0; t<20000; t++) {
+    double r=rnd.uni();
+    if(r<.4 || !ref.size()) {
+      double p = rnd(20); //many ties
+      uint h = Q.add(p, order, true);
+      maxN = rai::MAX(maxN, Q.N);
+      CHECK_LT(h, maxN, "handles of popped/erased entries are not reused");
+      if(h>=key.N) key.resizeCopy(h+1);
+      key(h) = std::make_pair(p, order);
+      ref[key(h)] = h;
+      order++;
+    } else if(r<.7) {
+      uint h = ref.begin()->second;
+      CHECK_EQ(Q.first().handle, h, "wrong top");
+      CHECK_EQ(Q.pop(), key(h).second, "");
+      CHECK(!Q.contains(h), "");
+      ref.erase(ref.begin());
+    } else {
+      //pick some queued handle
+      auto it = ref.begin();
+      std::advance(it, rnd(ref.size()));
+      uint h = it->second;
+      CHECK(Q.contains(h), "");
+      ref.erase(it);
+      if(r<.9) {
+        double p = rnd(20);
+        Q.update(h, p);
+        key(h).first = p;
+        ref[key(h)] = h;
+      } else {
+        Q.erase(h);
+        CHECK(!Q.contains(h), "");
+      }
+    }
+    CHECK_EQ(Q.N, ref.size(), "");
+  }
+  //drain in order
+  for(auto& it:ref) {
+    CHECK_EQ(Q.first().handle, it.second, "");
+    Q.pop();
+  }
+  CHECK_EQ(Q.N, 0, "");
+}
+
+//===========================================================================
+
+struct Cell {
+  int x, y;
+  bool isFeasible=true;
+  double astar_g=INFINITY;
+  Cell* astar_parent=nullptr;
+  bool astar_isClosed=false, astar_isOnPath=false;
+  rai::Array<Cell*> neighbors;
+  double astar_cost(Cell* from) { return from->x==x || from->y==y ? 1. : 1.4142; }
+  double astar_heuristic(Cell* goal) { double dx=fabs(goal->x-x), dy=fabs(goal->y-y);  return rai::MAX(dx, dy) + .4142*rai::MIN(dx, dy); }
+};
+
+rai::Array<Cell*> getNeighbors(Cell* c) { return c->neighbors; }
+
+void TEST(AStar) {
+  uint n=300;
+  rai::Array<Cell> grid(n, n);
+  for(uint i=0; i<n; i++) for(uint j=0; j<n; j++) {
+      Cell& c = grid(i, j);
+      c.x=i;  c.y=j;
+      c.isFeasible = rnd.uni()>.2;
+      for(int di=-1; di<=1; di++) for(int dj=-1; dj<=1; dj++) {
+          int a=i+di, b=j+dj;
+          if((di||dj) && a>=0 && b>=0 && a<(int)n && b<(int)n) c.neighbors.append(&grid(a, b));
+        }
+    }
+  Cell* start=&grid(0, 0), *goal=&grid(n-1, n-1);
+  start->isFeasible=goal->isFeasible=true;
+
+  //reference: Dijkstra with the same costs
+  arr D(n, n);
+  D = INFINITY;
+  D(0, 0) = 0.;
+  {
+    PriorityQueue<Cell*> Q;
+    Q.add(0., start);
+    while(Q.N) {
+      double d = Q.first().p;
+      Cell* c = Q.pop();
+      if(d>D(c->x, c->y)) continue;
+      for(Cell* ch:c->neighbors) if(ch->isFeasible) {
+          double dd = d + ch->astar_cost(c);
+          if(dd<D(ch->x, ch->y)) { D(ch->x, ch->y)=dd;  Q.add(dd, ch); }
+        }
+    }
+  }
+
+  rai::Graph G;
+  AStarOnGraph<Cell> A(G, start, goal);
+  rai::timerRead(true);
+  uint maxQueue=0;
+  while(!A.step()) {
+    if(!A.queue.N) break;
+    A.iters++;
+    maxQueue = rai::MAX(maxQueue, A.queue.N);
+  }
+  double time=rai::timerRead(true);
+  cout <<"A* on " <<n <<'x' <<n <<" grid: cost " <<goal->astar_g <<" (Dijkstra " <<D(n-1, n-1) <<") iterations " <<A.iters <<" max queue " <<maxQueue <<" time " <<time <<"sec" <<endl;
+  CHECK_ZERO(goal->astar_g - D(n-1, n-1), 1e-8, "A* not optimal");
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv) {
+  rai::initCmdLine(argc, argv);
+
+  rnd.clockSeed();
+
+  testQueue();
+  testAStar();
+
+  return 0;
+}
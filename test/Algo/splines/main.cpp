@@ -47,7 +47,7 @@ void TEST(Basics){
 void TEST(Speed){
 
   uint N=1000000, n=2;
-  arr X = randn(N, 2);
+  arr X = randn(N, n);
   arr T = integral(rand(N)+0.1);
 //  cout <<X <<endl <<T <<endl;
 
@@ -61,6 +61,59 @@ void TEST(Speed){
     S.eval(t,2);
   }
   cout <<"time: " <<rai::timerRead() <<endl;
+
+  //a 1kHz control loop on 30 dofs, with preallocated outputs
+  X = randn(100, 30);
+  T = integral(rand(100)+.5);
+  S.set(2, X, T);
+  arr x(30), xDot(30), xDDot(30);
+  rai::timerStart();
+  for(double t=0.;t<T.last();t+=1e-3) S.eval(x, xDot, xDDot, t);
+  cout <<"1kHz loop over " <<T.last() <<"sec: " <<rai::timerRead() <<"sec" <<endl;
+
+  //resampling on a fine grid
+  arr ts = range(S.begin(), S.end(), 1000000);
+  rai::timerStart();
+  S.eval(x, xDot, NoArr, ts);
+  cout <<"batch eval of " <<ts.N <<" times: " <<rai::timerRead() <<"sec" <<endl;
+}
+
+//==============================================================================
+
+//the precomputed polynomials vs. the basis functions over all knots
+void TEST(Polynomials){
+  for(uint degree=1; degree<=3; degree++){
+    rai::Spline S;
+    S.set(degree, randn(10, 5), integral(rand(10)));
+    S.append(randn(5, 5), integral(rand(5)+.1));
+    if(degree==2) S.set_vel(2, randn(6, 5), randn(6, 5), integral(rand(6)+.1));
+
+    arr ts = S.begin()-.1 + (S.end()-S.begin()+.2)*rand(1000);
+    arr X, XDot, XDDot;
+    S.eval(X, XDot, XDDot, ts);
+    for(uint i=0; i<ts.N; i++){
+      double t=ts(i);
+      arr b, db, ddb, x, xDot, xDDot;
+      rai::Spline::getCoeffs2(b, db, ddb, t, degree, S.knotTimes.p, S.knotPoints.d0, S.knotTimes.N, 2);
+      S.eval(x, xDot, xDDot, t);
+      CHECK_ZERO(maxDiff(x, ~b*S.knotPoints), 1e-10, "");
+      CHECK_ZERO(maxDiff(xDot, ~db*S.knotPoints), 1e-8, "");
+      if(degree>1) CHECK_ZERO(maxDiff(xDDot, ~ddb*S.knotPoints), 1e-6, "");
+      CHECK_ZERO(maxDiff(x, X[i]) + maxDiff(xDot, XDot[i]) + maxDiff(xDDot, XDDot[i]), 1e-12, "batch differs");
+    }
+  }
+
+  rai::CubicSpline C;
+  C.set(randn(10, 4), randn(10, 4), integral(rand(10)+.1));
+  C.append(randn(3, 4), randn(3, 4), integral(rand(3)+.1));
+  for(uint i=0; i<1000; i++){
+    double t = C.begin() + (C.end()-C.begin())*rnd.uni();
+    uint k = C.times.rankInSorted(t, rai::lowerEqual<double>, true)-1;
+    arr x, xDot, xDDot, y, yDot, yDDot;
+    C.eval(x, xDot, xDDot, t);
+    C.pieces(k).eval(y, yDot, yDDot, t-C.times(k));
+    CHECK_ZERO(maxDiff(x, y) + maxDiff(xDot, yDot) + maxDiff(xDDot, yDDot), 1e-10, "");
+  }
 }
 
 //==============================================================================
@@ -103,6 +156,7 @@ void TEST(Path){
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc, argv);
 
+  testPolynomials();
   testBasics();
 //  testSpeed();
 
@@ -45,6 +45,46 @@ void testMinimal(){
 
 //===========================================================================
 
+void testFastQP(){
+  //the condensed QP step (useQP) against the full KOMO solve, both started from the same state in each tick
+  rai::Configuration C;
+  C.addFile("scene.g");
+  double tau=.01;
+
+  auto makeSet = [&](){
+    CtrlSet CS;
+    CS.add_qControlObjective(2, 1e-2*sqrt(tau), C);
+    CS.add_qControlObjective(1, 1e-1*sqrt(tau), C);
+    CS.addObjective(make_feature(FS_poseDiff, {"gripper", "target"}, C, {1e0}), OT_sos, .1);
+    CS.addObjective(make_feature<F_AccumulatedCollisions>({"ALL"}, C, {1e0}), OT_eq);
+    return CS;
+  };
+  CtrlSet CSfull = makeSet(), CSfast = makeSet(); //(separate sets: moving targets are stepped in each update)
+  CtrlSolver full(C, tau, 2), fast(C, tau, 2);
+  fast.useQP = true;
+  fast.damping = 1e-6;
+  fast.maxVel = fast.maxAcc = 1e3; //the full solve has no velocity and acceleration bounds
+
+  double maxErr=0.;
+  for(uint t=0;t<100;t++){
+    full.set(CSfull);
+    fast.set(CSfast);
+    arr q = C.getJointState();
+    full.update(q, {}, C);
+    fast.update(q, {}, C);
+    arr qFull = full.solve();
+    arr qFast = fast.solve();
+    double err = maxDiff(qFast, qFull)/(maxDiff(qFull, q)+1e-10);
+    maxErr = rai::MAX(maxErr, err);
+    C.setJointState(qFull);
+    C.stepSwift();
+  }
+  cout <<"fast QP vs. full solve: max relative step error " <<maxErr <<endl;
+  CHECK_LE(maxErr, 5e-2, "the QP step deviates from the full solve"); //(the full solve stops at stopTolerance 1e-4)
+}
+
+//===========================================================================
+
 void testGrasp(){
   rai::Configuration C;
   C.addFile("pandas.g");
@@ -155,6 +195,7 @@ int main(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
   testMinimal();
+  testFastQP();
 //  testGrasp();
 //  testIneqCarrot();
 
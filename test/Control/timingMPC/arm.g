@@ -0,0 +1,13 @@
+body stem { X=<T t(0 0 1)> shape:capsule size=[0.1 0.1 2 .1] }
+
+body arm1 { shape:capsule size=[0.1 0.1 .4 .1] }
+body arm2 { shape:capsule size=[0.1 0.1 .4 .1] }
+body arm3 { shape:capsule size=[0.1 0.1 .4 .1] }
+
+joint (stem arm1) { joint:hingeX A=<T t(0 0 1) d(90 1 0 0)> B=<T t(0 0 .2)>  Q=<T d(1 0 0 0)> }
+joint (arm1 arm2) { joint:hingeX A=<T t(0 0 0.2) d(45 0 0 1)> B=<T t(0 0 .2)>  Q=<T d(1 0 0 0)> }
+joint (arm2 arm3) { joint:hingeX A=<T t(0 0 0.2) d(45 0 0 1)> B=<T t(0 0 .2)>  Q=<T d(1 0 0 0)> }
+
+body target { X=<T t(.3 -.3 1.6)>  shape:sphere size=[.1 .1 .1 .05] color=[0 .5 0] }
+
+shape endeff(arm3){ shape:marker rel=<T t(0 0 .3)> size=[.1 .1 .1 0] }
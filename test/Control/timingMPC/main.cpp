@@ -0,0 +1,129 @@
+#include <Control/timingMPC.h>
+#include <Control/LeapMPC.h>
+#include <Control/timingOpt.h>
+#include <Optim/MP_Solver.h>
+
+//===========================================================================
+
+//a recorded waypoint stream: one (K x d) waypoint set per control tick (file 'z.waypoints' if present),
+//otherwise a synthetic stream of slowly drifting waypoints
+arrA loadWaypointStream(uint ticks, uint K, uint d){
+  arrA stream;
+  if(rai::FileToken("z.waypoints", false).exists()){
+    FILE("z.waypoints") >>stream;
+    return stream;
+  }
+  arr W = randn(K, d);
+  for(uint k=1;k<K;k++) W[k] += W[k-1];
+  stream.resize(ticks);
+  for(uint t=0;t<ticks;t++){
+    stream(t) = W;
+    for(uint k=0;k<K;k++) W(k,0) += .001*sin(.01*t+k);
+  }
+  return stream;
+}
+
+void histogram(const arr& lat, const char* name){
+  arr bins = {1e-5, 2e-5, 5e-5, 1e-4, 2e-4, 5e-4, 1e-3, 2e-3, 5e-3, 1e0};
+  uintA counts(bins.N);
+  counts.setZero();
+  for(double l:lat){ uint i=0; while(l>bins(i)) i++; counts(i)++; }
+  cout <<"-- " <<name <<" latency histogram (" <<lat.N <<" ticks, mean " <<sum(lat)/lat.N <<"sec, max " <<max(lat) <<"sec)" <<endl;
+  for(uint i=0;i<bins.N;i++) cout <<"  <=" <<bins(i) <<": " <<counts(i) <<endl;
+}
+
+void TEST(RealtimeReplay){
+  uint ticks=500, K=5, d=7;
+  double dt=1e-3, budget=5e-4;
+  arrA stream = loadWaypointStream(ticks, K, d);
+
+  TimingMPC full(stream(0), 1e0, 1e0);
+  TimingMPC rt(stream(0), 1e0, 1e0);
+  full.opt.verbose=0;
+  rt.opt.verbose=0;
+
+  arr x0 = zeros(d), v0 = zeros(d);
+  arr latFull, latRT;
+  for(uint t=0;t<stream.N;t++){
+    if(rt.done()) break;
+    full.update_waypoints(stream(t), false);
+    rt.update_waypoints(stream(t), false);
+
+    double time = -rai::realTime();
+    if(t<50) full.solve(x0, v0, 0);
+    latFull.append(time + rai::realTime());
+
+    time = -rai::realTime();
+    rt.solve_realtime(x0, v0, budget, 2);
+    latRT.append(time + rai::realTime());
+    CHECK_ZERO(maxDiff(rt.rt_mp->waypoints, rt.getWaypoints()), 1e-12, "the realtime problem has stale waypoints");
+
+    //after some ticks on the same problem, the realtime iterate is close to the converged solution
+    if(t==49){
+      double err = maxDiff(rt.tau, full.tau)/absMax(full.tau);
+      cout <<"realtime vs. converged timing: rel. error " <<err <<endl;
+      CHECK_LE(err, 1e-2, "the realtime iterate does not approach the converged solution");
+    }
+
+    //follow the realtime reference for one tick
+    rai::CubicSpline S;
+    rt.getCubicSpline(S, x0, v0);
+    if(S.pieces.N){
+      arr x, xDot, xDDot;
+      S.eval(x, xDot, xDDot, dt);
+      x0 = x;  v0 = xDot;
+    }
+    rt.update_progressTime(dt);
+    full.update_progressTime(dt);
+  }
+
+  histogram(latFull({0,49}), "full solve");
+  histogram(latRT, "realtime");
+
+  //the deadline holds, up to the scheduling jitter of the machine
+  uint overruns=0;
+  for(double l:latRT) if(l>1.5*budget) overruns++;
+  cout <<"deadline overruns (>1.5*budget): " <<overruns <<endl;
+  CHECK_LE(overruns, latRT.N/20, "realtime solves overrun the budget");
+}
+
+//===========================================================================
+
+void TEST(LeapRealtime){
+  //the realtime iteration of LeapMPC approaches the converged solution within its deadline
+  rai::Configuration C("arm.g");
+  LeapMPC full(C), rt(C);
+  for(LeapMPC* mpc:{&full, &rt}) mpc->komo.addObjective({1.}, FS_positionDiff, {"endeff", "target"}, OT_eq, {1e1});
+  arr x = C.getJointState(), v = zeros(x.N);
+  full.reinit(x, v);
+  full.solve();
+
+  double budget=1e-3;
+  arr lat;
+  for(uint t=0;t<200;t++){
+    rt.reinit(x, v);
+    double time = -rai::realTime();
+    rt.solve_realtime(budget, 2);
+    lat.append(time + rai::realTime());
+  }
+  histogram(lat, "LeapMPC realtime");
+
+  double err = maxDiff(rt.x1, full.x1);
+  cout <<"realtime vs. converged x1: error " <<err <<endl;
+  CHECK_LE(err, 1e-2, "the realtime iterate does not approach the converged solution");
+
+  uint overruns=0;
+  for(double l:lat) if(l>1.5*budget) overruns++;
+  CHECK_LE(overruns, lat.N/20, "realtime solves overrun the budget");
+}
+
+//===========================================================================
+
+int MAIN(int argc,char** argv){
+  rai::initCmdLine(argc, argv);
+
+  testRealtimeReplay();
+  testLeapRealtime();
+
+  return 0;
+}
@@ -161,6 +161,119 @@ void TEST(Manual){
 
 //===========================================================================
 
+void TEST(KeyIndex){
+  //large graphs are searched via a hash index: compare with linear search under creation, renaming, and deletion
+  rai::Graph G;
+  uint n=30000;
+  for(uint i=0;i<n;i++) G.newNode<double>(STRING("n" <<i%(n/2)), {}, i); //each key twice
+  rai::timerStart();
+  for(uint i=0;i<n;i++) CHECK_EQ(G.findNode(STRING("n" <<i%(n/2)))->get<double>(), i%(n/2), "the first one");
+  cout <<"indexed finds: " <<rai::timerRead() <<"sec" <<endl;
+  CHECK_EQ(G.findNodes("n7").N, 2, "");
+  CHECK(!G.findNode("x"), "");
+
+  G(3)->setKey("x");
+  G.elem(n-1)->setKey("x");
+  delete G(10);
+  G.newNode<double>("x", {}, -1.);
+  G.checkConsistency();
+  rai::NodeL X = G.findNodes("x");
+  CHECK_EQ(X.N, 3, "");
+  CHECK(X(0)==G(3) && X(1)==G.elem(n-2) && X(2)==G.last(), "in graph order");
+  CHECK_EQ(G.findNode("n3")->get<double>(), n/2+3, "the other one remains");
+  CHECK_EQ(G.findNode("n10")->get<double>(), n/2+10, "the deleted one is gone");
+  CHECK_EQ(G.findNodesOfType(typeid(double), "x").N, 3, "");
+
+  //deleting a node whose key was written directly (bypassing setKey) leaves no dangling index entry
+  G(5)->key = "y";
+  delete G(5);
+  CHECK(!G.findNode("y"), "");
+  G.newNode<double>("y", {}, -2.);
+  CHECK_EQ(G.findNode("y")->get<double>(), -2., "");
+  G.checkConsistency();
+  G.clear();
+  G.checkConsistency();
+}
+
+//===========================================================================
+
+//a scene with n frames and a knowledge base with n facts
+void writeLargeFiles(uint n){
+  ofstream fil("z.scene.g");
+  for(uint i=0;i<n;i++){
+    fil <<"frame" <<i;
+    if(i) fil <<" (frame" <<(i-1)/2 <<")";
+    fil <<" { shape:ssBox, size:[.1 .2 .3 .01], Q:<t(0 0 .1) d(" <<i%90 <<" 0 0 1)>, color:[.8 .2 .2], mass:" <<.1*i
+        <<", mesh:'mesh" <<i <<".stl', contact, joint:hingeX, limits:[-1 1] }" <<endl;
+  }
+  fil.close();
+  fil.open("z.kb.g");
+  fil <<"Terminate\nQUIT\nobject\non" <<endl;
+  for(uint i=0;i<n;i++) fil <<"o" <<i <<endl;
+  fil <<"START_STATE {" <<endl;
+  for(uint i=0;i<n;i++) fil <<"(object o" <<i <<") (on o" <<i <<" o" <<(i+1)%n <<")" <<endl;
+  fil <<"}\nREWARD {}" <<endl;
+}
+
+void TEST(FastRead){
+  //the memory-mapped parser gives the same graph as the stream parser
+  writeLargeFiles(2000);
+  for(const char* file:{"example.g", "relational.g", "schunk.g", "coffee_shop.fg", "z.scene.g", "z.kb.g"}){
+    rai::Graph A(file, true), B(file);
+    A.checkConsistency();
+    B.checkConsistency();
+    CHECK_EQ(STRING(A), STRING(B), "different graphs from " <<file);
+    for(uint i=0;i<A.N;i++) CHECK_EQ(!A(i)->key.p, !B(i)->key.p, "nodes without tags need a null key, as from the stream parser");
+
+    //binary round trip
+    std::stringstream buf;
+    B.writeBinary(buf);
+    rai::Graph C;
+    C.readBinary(buf);
+    C.checkConsistency();
+    CHECK_EQ(STRING(B), STRING(C), "binary round trip of " <<file);
+  }
+
+  //a programmatically built graph with references to later nodes and into subgraphs
+  rai::Graph G;
+  G.newNode<int>("i", {}, -3);
+  G.newNode<uintA>("u", {}, uintA{1, 2, 3});
+  G.newNode<StringA>("s", {}, {"a", "b c"});
+  G.newNode<arrA>("aa", {}, {arr{1., 2.}, eye(2)});
+  rai::Graph& sub = G.newSubgraph("sub", {G(0)});
+  sub.newNode<bool>("x", {G(1)}, true);
+  rai::Node* y = G.newNode<double>("y", {G(1)}, 1.);
+  sub(0)->addParent(y);
+  G.newNode<rai::NodeL>("refs", {}, {y, sub(0), G(0)});
+  std::stringstream buf;
+  G.writeBinary(buf);
+  rai::Graph C;
+  C.readBinary(buf);
+  C.checkConsistency();
+  CHECK_EQ(STRING(G), STRING(C), "");
+  CHECK_EQ(C["sub"]->graph()(0)->parents.last(), C["y"], "");
+}
+
+void TEST(ReadSpeed){
+  writeLargeFiles(20000);
+  for(const char* file:{"z.scene.g", "z.kb.g"}){
+    rai::timerStart();
+    rai::Graph A;
+    A.read(FILE(file));
+    double stream=rai::timerRead(true);
+    rai::Graph B(file);
+    double fast=rai::timerRead(true);
+    B.writeBinary(FILE("z.bin").getOs());
+    rai::timerRead(true);
+    rai::Graph C("z.bin");
+    double binary=rai::timerRead(true);
+    CHECK_EQ(A.N, C.N, "");
+    cout <<file <<": stream parser: " <<stream <<"sec, memory-mapped parser: " <<fast <<"sec, binary: " <<binary <<"sec" <<endl;
+  }
+}
+
+//===========================================================================
+
 int MAIN(int argc, char** argv){
   rai::initCmdLine(argc, argv);
 
@@ -172,6 +285,9 @@ int MAIN(int argc, char** argv){
   testDot();
 
   testManual();
+  testKeyIndex();
+  testFastRead();
+  testReadSpeed();
 
   return 0;
 }
@@ -1,4 +1,5 @@
 #include <Core/thread.h>
+#include <Core/taskPool.h>
 
 //===========================================================================
 
@@ -190,6 +191,174 @@ void TEST(Logging){
   t2.threadClose();
 }
 
+//===========================================================================
+//
+// read jitter of a high-rate stream: Var (rwlocked) vs RingVar (lock-free)
+//
+
+struct StreamMsg{
+  double time=0.;
+  double q[14];
+  int rev=0;
+};
+
+template<class V> arr measureReadJitter(V& x, uint nReaders, double duration){
+  std::atomic<bool> stop(false);
+  std::thread writer([&x, &stop](){
+    Metronome tic(.001);
+    while(!stop){
+      { auto w = x.set(); w->time = rai::realTime(); for(double& q:w->q) q = w->time; }
+      tic.waitForTic();
+    }
+  });
+  arr maxLatency(nReaders);
+  rai::Array<std::thread*> readers(nReaders);
+  for(uint i=0;i<nReaders;i++) readers(i) = new std::thread([&x, &stop, &maxLatency, i](){
+    double m=0.;
+    while(!stop){
+      double t = -rai::realTime();
+      { auto r = x.get(); CHECK_EQ(r->q[13], r->time, "inconsistent read"); }
+      t += rai::realTime();
+      if(t>m) m=t;
+    }
+    maxLatency(i) = m;
+  });
+  rai::wait(duration);
+  stop = true;
+  writer.join();
+  for(std::thread* r:readers){ r->join(); delete r; }
+  return maxLatency;
+}
+
+void TEST(RingVar){
+  Var<StreamMsg> x;
+  RingVar<StreamMsg> y;
+
+  uint rev=0;
+  y.addCallback([&rev](Var_base*){ rev++; });
+  y.set() = StreamMsg();
+  CHECK_EQ(rev, 1, "");
+  CHECK_EQ(y.getRevision(), 1, "");
+
+  arr lx = measureReadJitter(x, 3, 1.);
+  arr ly = measureReadJitter(y, 3, 1.);
+  cout <<"worst-case read latency Var:     " <<max(lx) <<"sec" <<endl;
+  cout <<"worst-case read latency RingVar: " <<max(ly) <<"sec" <<endl;
+  CHECK_GE(y.getRevision(), 100, "writer did not stream");
+
+  //a read reports the revision of the data it got, not of a later write: the writer stamps each message with its revision
+  { auto w = y.overwrite(); w->rev = y.getRevision()+1; }
+  std::atomic<bool> stop(false);
+  std::thread writer([&y, &stop](){
+    for(uint k=0;k<20000;k++){ auto w = y.overwrite(); w->rev = y.getRevision()+1; }
+    stop = true;
+  });
+  RingVar<StreamMsg> r(nullptr, y);
+  uint reads=0;
+  while(!stop){
+    { auto d = r.get(); CHECK_EQ(r.last_read_revision, d->rev, "revision does not match the data read");  CHECK_EQ(d.revision(), d->rev, ""); }
+    reads++;
+  }
+  writer.join();
+  CHECK_GE(reads, 1, "");
+}
+
+//===========================================================================
+//
+// work-stealing task pool
+//
+
+struct MyPeriodicThread : Thread{
+  std::atomic<uint> n{0};
+  bool fail=false;
+  MyPeriodicThread() : Thread("periodic", .01){}
+  ~MyPeriodicThread(){ threadClose(); }
+  void step(){ n++;  if(fail && n==1) HALT("error in periodic step"); }
+};
+
+struct MyTicker : Thread{ //(its destructor does not call threadClose)
+  std::atomic<uint> n{0};
+  MyTicker() : Thread("ticker", .01){}
+  void step(){ n++; }
+};
+
+void TEST(TaskPool){
+  rai::TaskPool& pool = rai::taskPool();
+  cout <<"task pool with " <<pool.numThreads() <<" workers" <<endl;
+
+  //-- parallel_for with nested parallel_for (callers help, no deadlock)
+  uint n=100;
+  arr x(n, n);
+  pool.parallel_for(0, n, [&](uint i){
+    pool.parallel_for(0, n, [&](uint j){ x(i,j) = i+j; });
+  });
+  double s=0.;
+  for(uint i=0;i<n;i++) for(uint j=0;j<n;j++) s += i+j;
+  CHECK_EQ(sum(x), s, "");
+
+  //-- futures
+  auto f = pool.async([](){ return 42; });
+  CHECK_EQ(pool.get(f), 42, "");
+
+  //-- task graph: a -> {b,c} -> d
+  std::atomic<int> order(0);
+  int a=-1, b=-1, c=-1, d=-1;
+  rai::TaskGraph G;
+  uint ia = G.add([&](){ a=order++; });
+  uint ib = G.add([&](){ b=order++; }, {ia});
+  uint ic = G.add([&](){ c=order++; }, {ia});
+  G.add([&](){ d=order++; }, {ib, ic});
+  G.run();
+  CHECK(a==0 && d==3 && b>0 && c>0, "");
+
+  //-- exceptions propagate to the waiting thread
+  bool caught=false;
+  try{
+    rai::TaskGroup T;
+    T.run([](){ HALT("error in task"); });
+    T.wait();
+  }catch(...){ caught=true; }
+  CHECK(caught, "");
+
+  //-- a Thread module as periodic task instead of an own thread
+  MyPeriodicThread th;
+  double time = -rai::realTime();
+  th.threadLoopOnPool();
+  rai::wait(.5);
+  th.threadClose();
+  time += rai::realTime();
+  cout <<"periodic steps: " <<th.n.load() <<endl;
+  CHECK(th.n>0 && th.n<=time/.01+2, "at most one step per tick"); //no tighter lower bound: ticks are dropped under load
+
+  //-- a throwing step releases the step mutex (later steps and close still run)
+  MyPeriodicThread th2;
+  th2.fail=true;
+  th2.threadLoopOnPool();
+  while(th2.n<3) rai::wait(.01);
+  th2.threadClose();
+
+  //-- a Thread destroyed without threadClose removes its periodic task
+  auto numPeriodics = [&pool](){ std::lock_guard<std::mutex> lock(pool.periodicMutex);  return pool.periodics.N; };
+  uint np = numPeriodics();
+  {
+    MyTicker th3;
+    th3.threadLoopOnPool();
+    CHECK_EQ(numPeriodics(), np+1, "");
+    while(th3.n<2) rai::wait(.01);
+  }
+  CHECK_EQ(numPeriodics(), np, "the periodic task outlived its Thread");
+
+  //-- a failing periodic task is reported and stays scheduled
+  std::atomic<int> calls(0);
+  int id = pool.addPeriodic(.01, [&](){ if(!calls++) HALT("error in periodic task"); });
+  while(calls.load()<2) rai::wait(.01);
+  pool.removePeriodic(id);
+
+  caught=false;
+  try{ pool.addPeriodic(0., [](){}); }catch(...){ caught=true; }
+  CHECK(caught, "zero interval");
+}
+
 //===========================================================================
 
 int MAIN(int argc,char** argv){
@@ -201,6 +370,8 @@ int MAIN(int argc,char** argv){
   testWay0();
   testWay1();
   testLogging();
+  testRingVar();
+  testTaskPool();
 
   return 0;
 }
@@ -94,6 +94,14 @@ void TEST(Exception){
 
 void TEST(Paths){
   std::cout <<rai::raiPath("here") <<endl;
+
+  //nested directories are created at once, existing ones are fine, files are not directories
+  rai::createDirectories("z.dirs/a/b/");
+  rai::createDirectories("z.dirs/a/b");
+  std::ofstream("z.dirs/a/file") <<"x";
+  bool caught=false;
+  try{ rai::createDirectories("z.dirs/a/file/c"); }catch(...){ caught=true; }
+  CHECK(caught, "a path through a file must fail");
 }
 
 void TEST(Inotify){
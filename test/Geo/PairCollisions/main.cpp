@@ -4,6 +4,7 @@
 #include <Geo/mesh.h>
 #include <Gui/opengl.h>
 #include <Geo/pairCollision.h>
+#include <Geo/sdf.h>
 #include <Kin/kin.h>
 #include <Kin/frame.h>
 
@@ -66,11 +67,130 @@ void TEST(PairCollision){
 
 //===========================================================================
 
+void TEST(Batch){
+  //cores as used by sphere, capsule, ssBox, and a general hull
+  rai::Mesh dot;  dot.setDot();
+  rai::Mesh seg;  seg.V = arr({2,3}, {0.,0.,-.1, 0.,0.,.1});
+  rai::Mesh box;  box.setBox();  box.scale(.2, .1, .3);
+  rai::Mesh hull; hull.setRandom(20);  hull.scale(.1);
+  rai::Array<rai::Mesh*> M = {&dot, &seg, &box, &hull};
+
+  uint K=2000;
+  rai::Array<rai::Transformation> X1(K), X2(K);
+  uintA i1(K), i2(K);
+  PairCollisionBatch batch;
+  for(uint k=0;k<K;k++){
+    X1(k).setRandom();  X1(k).pos *= .5;
+    X2(k).setRandom();  X2(k).pos *= .5;
+    i1(k)=rnd(M.N);  i2(k)=rnd(M.N);
+    batch.add(*M(i1(k)), *M(i2(k)), X1(k), X2(k));
+  }
+
+  rai::timerStart();
+  batch.compute();
+  cout <<"batch time: " <<rai::timerRead() <<"sec  (fallbacks: " <<batch.fallbacks <<")" <<endl;
+
+  rai::timerStart();
+  for(uint k=0;k<K;k++){
+    PairCollision pc(*M(i1(k)), *M(i2(k)), X1(k), X2(k));
+    PairCollision& b = *batch.colls(k);
+    CHECK_ZERO(pc.distance-b.distance, 1e-6, "batch and single pair collision disagree");
+    if(pc.distance>1e-6){
+      CHECK_ZERO(maxDiff(pc.p1, b.p1), 1e-4, "");
+      CHECK_ZERO(maxDiff(pc.p2, b.p2), 1e-4, "");
+    }
+  }
+  cout <<"single time: " <<rai::timerRead() <<"sec" <<endl;
+
+  //GJK that runs out of iterations is not trusted: those pairs take the exact path
+  batch.maxIters=1;
+  batch.compute();
+  CHECK_EQ(batch.fallbacks, K, "");
+  for(uint k=0;k<K;k++){
+    PairCollision pc(*M(i1(k)), *M(i2(k)), X1(k), X2(k));
+    CHECK_ZERO(pc.distance-batch.colls(k)->distance, 1e-6, "");
+  }
+}
+
+//===========================================================================
+
+void TEST(Primitives){
+  //closed-form cores vs. the same cores as meshes
+  PrimitiveCore P[3];
+  P[0].type=PrimitiveCore::_point;
+  P[1].type=PrimitiveCore::_segment;  P[1].half[2]=.1;
+  P[2].type=PrimitiveCore::_box;  P[2].half[0]=.1;  P[2].half[1]=.05;  P[2].half[2]=.15;
+  rai::Mesh dot;  dot.setDot();
+  rai::Mesh seg;  seg.V = arr({2,3}, {0.,0.,-.1, 0.,0.,.1});
+  rai::Mesh box;  box.setBox();  box.scale(.2, .1, .3);
+  rai::Mesh* M[3] = {&dot, &seg, &box};
+
+  for(uint k=0;k<2000;k++){
+    rai::Transformation X1, X2;
+    X1.setRandom();  X1.pos *= .3;
+    X2.setRandom();  X2.pos *= .3;
+    uint i=rnd(3), j=rnd(3);
+    PairCollision a;
+    if(!primitiveCollision(a, P[i], P[j], X1, X2)) continue;
+    CHECK_ZERO(scalarProduct(a.normal, a.p1-a.p2) - a.distance, 1e-10, "");
+    PairCollision b(*M[i], *M[j], X1, X2);
+    if(a.distance<0.){ //point in box: closed form gives the minimal penetration
+      CHECK_GE(a.distance, b.distance-1e-6, "");
+      continue;
+    }
+    CHECK_ZERO(a.distance-b.distance, 1e-8, "primitive and mesh collision disagree");
+    CHECK_ZERO(maxDiff(a.p1, b.p1), 1e-6, "");
+    CHECK_EQ(a.simplex1.d0, b.simplex1.d0, "");
+    CHECK_EQ(a.simplex2.d0, b.simplex2.d0, "");
+  }
+}
+
+//===========================================================================
+
+void TEST(SDF){
+  //SDF of a box vs. the analytic box distance, and sdfCollision vs. closed-form point/segment-box
+  rai::Mesh box;  box.setBox();  box.scale(.4, .2, .6);
+  double h[3] = {.2, .1, .3};
+  rai::SparseSDF sdf;
+  sdf.build(box, .01, .1);
+
+  for(uint k=0;k<10000;k++){
+    arr x = .5*randn(3);
+    double q[3], out=0., in=-1e10;
+    for(uint i=0;i<3;i++){ q[i]=fabs(x(i))-h[i];  if(q[i]>0.) out+=q[i]*q[i];  if(q[i]>in) in=q[i]; }
+    double d = ::sqrt(out) + (in<0. ? in : 0.);
+    double e = sdf.eval(nullptr, x.p);
+    if(fabs(d)<.09){ CHECK_ZERO(e-d, 5e-3, "SDF value off"); }
+    else{ CHECK_GE(e*d, 0., "SDF sign wrong"); }
+  }
+
+  PrimitiveCore P[2], B;
+  P[0].type=PrimitiveCore::_point;
+  P[1].type=PrimitiveCore::_segment;  P[1].half[2]=.1;
+  B.type=PrimitiveCore::_box;  B.half[0]=h[0];  B.half[1]=h[1];  B.half[2]=h[2];
+  for(uint k=0;k<2000;k++){
+    rai::Transformation X1, X2;
+    X1.setRandom();  X1.pos *= .2;
+    X2.setRandom();  X2.pos *= .4;
+    uint i=rnd(2);
+    PairCollision a, b;
+    if(!sdfCollision(a, sdf, X1, P[i], X2)) continue;
+    CHECK_ZERO(scalarProduct(a.normal, a.p1-a.p2) - a.distance, 1e-10, "");
+    if(!primitiveCollision(b, P[i], B, X2, X1) || b.distance>.08 || b.distance<=0.) continue;
+    CHECK_ZERO(a.distance-b.distance, 5e-3, "SDF and closed-form collision disagree");
+  }
+}
+
+//===========================================================================
+
 int MAIN(int argc, char** argv){
   rai::initCmdLine(argc, argv);
 
 //  rnd.clockSeed();
 
+  testBatch();
+  testPrimitives();
+  testSDF();
   testPairCollision();
 
   return 0;
@@ -1,10 +1,13 @@
 #include <stdlib.h>
+#include <map>
+#include <thread>
 #include <GL/gl.h>
 
 #include <Geo/mesh.h>
 #include <Gui/opengl.h>
 #include <Geo/qhull.h>
 #include <Geo/analyticShapes.h>
+#include <Geo/meshProcessing.h>
 
 void drawInit(void*, OpenGL& gl){
   glStandardLight(nullptr, gl);
@@ -232,6 +235,135 @@ void TEST(SimpleImplicitSurfaces) {
 
 //===========================================================================
 
+void TEST(MarchingCubes){
+  //sphere SDF, evaluated row-wise; the sparse mode must give the identical mesh
+  double r=.7;
+  VectorFunction sdf = [r](const arr& X){
+    arr y(X.d0);
+    for(uint i=0;i<X.d0;i++) y(i) = length(X[i])-r;
+    return y;
+  };
+  rai::Mesh m, s;
+  rai::timerStart();
+  m.setImplicitSurface(sdf, {-1.,-1.,-1.}, {1.,1.,1.}, 128);
+  cout <<"dense time: " <<rai::timerRead(true) <<"sec" <<endl;
+  s.setImplicitSurface(sdf, {-1.,-1.,-1.}, {1.,1.,1.}, 128, true);
+  cout <<"sparse time: " <<rai::timerRead() <<"sec" <<endl;
+  CHECK_EQ(m.V, s.V, "");
+  CHECK_EQ(m.T, s.T, "");
+  CHECK_ZERO(m.getVolume() - 4./3.*RAI_PI*r*r*r, 1e-3, "");
+
+  //a ScalarFunction is evaluated on the calling thread only (it needs not be thread safe), on the same grid
+  std::thread::id caller = std::this_thread::get_id();
+  uint calls=0;
+  ScalarFunction f = [&](arr& g, arr& H, const arr& x){
+    CHECK(std::this_thread::get_id()==caller, "ScalarFunction called concurrently");
+    calls++;
+    return length(x)-r;
+  };
+  rai::Mesh c;
+  c.setImplicitSurface(f, -1., 1., 128);
+  CHECK_EQ(calls, 128*128*128, "");
+  CHECK_EQ(c.V, m.V, "");
+  CHECK_EQ(c.T, m.T, "");
+
+  //closed and consistently oriented across slab boundaries: each directed edge once, its reverse once
+  std::map<std::pair<uint,uint>, uint> E;
+  for(uint t=0;t<m.T.d0;t++) for(uint i=0;i<3;i++) E[{m.T(t,i), m.T(t,(i+1)%3)}]++;
+  for(auto& e:E){
+    CHECK_EQ(e.second, 1, "");
+    CHECK(E.count({e.first.second, e.first.first}), "open edge");
+  }
+
+  //the same from grid values (with different sizes per axis)
+  arr G(50, 60, 70);
+  for(uint i=0;i<G.d0;i++) for(uint j=0;j<G.d1;j++) for(uint k=0;k<G.d2;k++)
+    G(i,j,k) = length(arr{-1.+2.*i/(G.d0-1), -1.+2.*j/(G.d1-1), -1.+2.*k/(G.d2-1)})-r;
+  rai::Mesh g;
+  g.setImplicitSurface(G, {-1.,-1.,-1.}, {1.,1.,1.});
+  CHECK_ZERO(g.getVolume() - m.getVolume(), 1e-2, "");
+}
+
+//===========================================================================
+
+void TEST(Decomposition){
+  //an L-shape of two boxes splits into exactly these
+  rai::Mesh m, b;
+  m.setBox();  m.scale(2., 1., 1.);
+  b.setBox();  b.translate(-.5, 0., 1.);
+  m.addMesh(b);
+  MeshA parts;
+  rai::decomposeConvex(parts, m, .05, 4);
+  CHECK_EQ(parts.N, 2, "");
+  CHECK_ZERO(parts(0).getVolume()+parts(1).getVolume()-3., 1e-6, "");
+
+  //the pipeline on many copies, second time from the disk cache
+  MeshA M(50), M2;
+  for(uint i=0;i<M.N;i++){ M(i)=m;  M(i).translate(i, 0., 0.); }
+  M2 = M;
+  rai::MeshProcessing_Options opt;
+  rai::Array<MeshA> P, P2;
+  rai::processMeshes(getList(M), opt, &P); //all steps are opt-in: the defaults change nothing
+  CHECK_EQ(M(0).V, m.V, "");
+  CHECK(!M(0).Vn.N && !P(0).N, "");
+  opt.set_decompose(.05).set_normals(true).set_cachePath("z.cache/mesh"); //(nested directories are created)
+  rai::timerStart();
+  rai::processMeshes(getList(M), opt, &P);
+  cout <<"processing time: " <<rai::timerRead(true) <<"sec" <<endl;
+  rai::processMeshes(getList(M2), opt, &P2);
+  cout <<"cached time: " <<rai::timerRead() <<"sec" <<endl;
+  for(uint i=0;i<M.N;i++){
+    CHECK_EQ(M(i).V, M2(i).V, "");
+    CHECK_EQ(M(i).Vn, M2(i).Vn, "");
+    CHECK_EQ(P(i).N, 2, "");
+    CHECK_EQ(P(i)(1).V, P2(i)(1).V, "");
+  }
+
+  //textured meshes are not fused, also not via a cache entry of the same untextured geometry
+  rai::Mesh u=m, tx=m;
+  tx.texImg.resize(2, 2, 3).setZero();
+  tx.tex = zeros(m.V.d0, 2);
+  tx.Tt = m.T;
+  rai::MeshProcessing_Options opt2;
+  opt2.set_fuseTolerance(1e-6).set_cachePath("z.cache/mesh");
+  rai::processMeshes({&u}, opt2);
+  rai::processMeshes({&tx}, opt2);
+  CHECK(u.V.d0<m.V.d0, "the touching boxes share vertices");
+  CHECK_EQ(tx.V.d0, m.V.d0, "");
+}
+
+//===========================================================================
+
+void TEST(LOD){
+  rai::Mesh m;
+  m.V = randn(2000, 3);
+  for(uint i=0;i<m.V.d0;i++){ m.V[i]() /= length(m.V[i]);  m.V(i,0)*=.3;  m.V(i,1)*=.2;  m.V(i,2)*=.1; }
+  m.makeConvexHull();
+
+  //hill-climbing support (cold, and warm-started at the previous support) vs. brute force
+  uint start=0;
+  for(uint k=0;k<1000;k++){
+    arr d = randn(3);
+    arr q = m.V*d;
+    CHECK_ZERO(q(m.support(d.p)) - max(q), 1e-12, "");
+    CHECK_ZERO(q(m.support(d.p, start)) - max(q), 1e-12, "");
+  }
+
+  //the LOD inflated by r contains the full hull
+  for(uint K:{8u, 32u}){
+    rai::Mesh L = m;
+    double r = L.makeConvexHullLOD(K);
+    CHECK_LE(L.V.d0, K, "");
+    cout <<"LOD " <<K <<": r=" <<r <<endl;
+    for(uint k=0;k<1000;k++){
+      arr d = randn(3);  d /= length(d);
+      CHECK_LE(max(m.V*d), max(L.V*d)+r+1e-10, "LOD not conservative");
+    }
+  }
+}
+
+//===========================================================================
+
 int MAIN(int argc, char** argv){
   rai::initCmdLine(argc, argv);
 
@@ -243,6 +375,9 @@ int MAIN(int argc, char** argv){
   testDistanceFunctions();
 //  testDistanceFunctions2();
   testSimpleImplicitSurfaces();
+  testMarchingCubes();
+  testDecomposition();
+  testLOD();
 
   return 0;
 }
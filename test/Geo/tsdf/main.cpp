@@ -0,0 +1,89 @@
+#include <Geo/tsdf.h>
+#include <Core/taskPool.h>
+
+//===========================================================================
+
+//depth image of a sphere (radius r at the origin), in the depthData2pointCloud convention
+floatA renderSphere(const arr& Fxypxy, const rai::Transformation& pose, double r, uint H, uint W){
+  floatA depth(H, W);
+  arr R = pose.rot.getArr();
+  arr c = pose.pos.getArr();
+  for(uint i=0;i<H;i++) for(uint j=0;j<W;j++){
+    arr dir = R*arr{(j-Fxypxy(2))/Fxypxy(0), -(i-Fxypxy(3))/Fxypxy(1), -1.}; //camera depth 1
+    double a=sumOfSqr(dir), b=2.*scalarProduct(dir, c), cc=sumOfSqr(c)-r*r;
+    double disc = b*b-4.*a*cc;
+    depth(i,j) = (disc<0. ? -1. : (-b-::sqrt(disc))/(2.*a));
+  }
+  return depth;
+}
+
+rai::Transformation cameraLookingAtOrigin(double azimuth, double elevation, double dist){
+  rai::Transformation X;
+  X.pos.set(dist*cos(elevation)*cos(azimuth), dist*cos(elevation)*sin(azimuth), dist*sin(elevation));
+  rai::Vector z = X.pos / dist;
+  X.rot.setDiff(rai::Vector(0.,0.,1.), z); //the camera looks along its -z
+  return X;
+}
+
+void TEST(Fusion){
+  const uint H=480, W=640;
+  const double r=.3;
+  arr Fxypxy = {500., 500., 320., 240.};
+  rai::TSDF tsdf;
+
+  double time=0.;
+  uint n=0;
+  for(double el:{-.6, 0., .6}) for(uint k=0;k<8;k++){
+    rai::Transformation X = cameraLookingAtOrigin(k*RAI_2PI/8, el, 1.2);
+    floatA depth = renderSphere(Fxypxy, X, r, H, W);
+    rai::timerStart();
+    tsdf.integrate(depth, Fxypxy, X);
+    time += rai::timerRead();
+    n++;
+  }
+  cout <<"integration: " <<time/n <<"sec/frame, blocks: " <<tsdf.blocks.N <<endl;
+
+  //fused distances near the surface (projective distances overestimate under oblique views)
+  for(uint k=0;k<1000;k++){
+    arr x = randn(3);
+    x *= (r + rnd.uni(-.01, .01))/length(x);
+    double d = tsdf.eval(nullptr, x.p), e = length(x)-r;
+    CHECK_ZERO(d - e, .01 + fabs(e), "TSDF value off");
+  }
+
+  //raycast from a new view
+  rai::Transformation X = cameraLookingAtOrigin(.3, .3, 1.);
+  floatA truth = renderSphere(Fxypxy, X, r, H, W), depth;
+  rai::timerStart();
+  tsdf.raycast(depth, H, W, Fxypxy, X);
+  cout <<"raycast: " <<rai::timerRead() <<"sec" <<endl;
+  uint hit=0, visible=0;
+  double err=0.;
+  for(uint i=0;i<depth.N;i++) if(truth.elem(i)>0.){
+    visible++;
+    if(depth.elem(i)<0.) continue;
+    err += fabs(depth.elem(i)-truth.elem(i));
+    hit++;
+  }
+  cout <<"raycast hits: " <<hit <<'/' <<visible <<", mean error: " <<err/hit <<endl;
+  CHECK_GE(hit, .95*visible, "");
+  CHECK_LE(err/hit, .003, "");
+
+  //mesh
+  rai::Mesh m;
+  rai::timerStart();
+  tsdf.getMesh(m);
+  cout <<"meshing: " <<rai::timerRead() <<"sec, vertices: " <<m.V.d0 <<endl;
+  for(uint i=0;i<m.V.d0;i++) CHECK_ZERO(length(m.V[i])-r, .01, "");
+  CHECK_ZERO(m.getVolume()/(4./3.*RAI_PI*r*r*r) - 1., .05, "");
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv){
+  rai::initCmdLine(argc, argv);
+
+  testFusion();
+
+  return 0;
+}
@@ -211,6 +211,96 @@ void TEST(PR2){
 
 //===========================================================================
 
+void TEST(IncrementalSetX){
+  //incremental set_x and parallel collision queries must not change any feature value or Jacobian
+  rai::Configuration C("arm.g");
+  KOMO A, B;
+  A.opt.set_incrementalSetX(false);
+  B.opt.set_incrementalSetX(true).set_parallelCollisions(true);
+  for(KOMO* komo:{&A, &B}){
+    komo->opt.verbose=0;
+    komo->setModel(C);
+    komo->setTiming(1., 20, 5., 2);
+    komo->add_qControlObjective({}, 2, 1.);
+    komo->addObjective({1.}, FS_positionDiff, {"endeff", "target"}, OT_eq, {1e2});
+    komo->addObjective({}, FS_accumulatedCollisions, {}, OT_eq, {1e0});
+    komo->run_prepare(0.);
+  }
+  auto mpA = A.mp_SparseNonFactored();
+  auto mpB = B.mp_SparseNonFactored();
+
+  arr x = A.x, phiA, JA, phiB, JB;
+  for(uint k=0;k<20;k++){
+    if(k%2) x += .1*randn(x.N); //all slices move
+    else x(rnd(x.N)) += .3*rnd.gauss(); //a single dof moves: most slices are reused
+    mpA->evaluate(phiA, JA, x);
+    if(k%5==3) mpB->evaluate(phiB, NoArr, x); //features without Jacobians must not be reused when Jacobians are needed
+    mpB->evaluate(phiB, JB, x);
+    if(JA.isSparse()) JA = JA.sparse().unsparse();
+    if(JB.isSparse()) JB = JB.sparse().unsparse();
+    CHECK_ZERO(maxDiff(phiA, phiB), 1e-10, "features differ");
+    CHECK_ZERO(maxDiff(JA, JB), 1e-10, "Jacobians differ");
+    CHECK_EQ(A.pathConfig.proxies.N, B.pathConfig.proxies.N, "");
+  }
+  cout <<"incremental set_x: " <<B.pathConfig.proxies.N <<" proxies, same features and Jacobians" <<endl;
+}
+
+//===========================================================================
+
+void TEST(SetSelectedSlices){
+  //setting the dofs of selected slices only gives the same path as setting all of x
+  rai::Configuration C("arm.g");
+  KOMO A, B;
+  for(KOMO* komo:{&A, &B}){
+    komo->opt.verbose=0;
+    komo->setModel(C);
+    komo->setTiming(1., 20, 5., 2);
+    komo->add_qControlObjective({}, 2, 1.);
+    komo->addObjective({}, FS_accumulatedCollisions, {}, OT_eq, {1e0});
+    komo->run_prepare(0.);
+  }
+  arr x = A.x + .1*randn(A.x.N);
+  A.set_x(x);
+  B.set_x(B.x);
+  for(uint t=0;t<B.T;t+=2) B.set_x(A.getConfiguration_qAll(t), {t});
+  B.set_x(cat(A.getConfiguration_qAll(1), A.getConfiguration_qAll(B.T-1)), {1, B.T-1}); //two slices at once
+  for(uint t=3;t<B.T-1;t+=2) B.set_x(A.getConfiguration_qAll(t), {t});
+  CHECK_ZERO(maxDiff(A.pathConfig.getJointState(), B.pathConfig.getJointState()), 1e-10, "");
+  CHECK_ZERO(maxDiff(A.pathConfig.getFrameState(), B.pathConfig.getFrameState()), 1e-10, "");
+  CHECK_EQ(A.pathConfig.proxies.N, B.pathConfig.proxies.N, "");
+}
+
+//===========================================================================
+
+void TEST(MultiStart){
+  //multi-start on cloned KOMO problems: each start owns its clone, evaluated concurrently
+  rai::Configuration C("arm.g");
+  KOMO komo;
+  komo.opt.verbose=0;
+  komo.setModel(C);
+  komo.setTiming(1., 10, 2., 2);
+  komo.add_qControlObjective({}, 2, 1.);
+  komo.addObjective({1.}, FS_positionDiff, {"endeff", "target"}, OT_eq, {1e2});
+  komo.addObjective({}, FS_accumulatedCollisions, {}, OT_eq, {1e0});
+  komo.run_prepare(0.);
+
+  rai::OptOptions opt;
+  opt.verbose=0;
+  uint K=8;
+  MP_Solver S;
+  S.setProblem(komo.mp_SparseNonFactoredClone()).setOptions(opt);
+  auto r = S.solveMultiStart(K, [&komo](){ return komo.mp_SparseNonFactoredClone(); }, false);
+  cout <<"KOMO multi-start: " <<*r <<endl;
+
+  CHECK_EQ(r->starts, K, "");
+  CHECK_GE(r->optima.N, 1, "");
+  CHECK(r->optima(0)->feasible, "");
+  CHECK_EQ(S.x.N, komo.x.N, "");
+  for(uint i=1; i<r->optima.N; i++) CHECK(r->optima(i-1)->feasible>=r->optima(i)->feasible, "feasible ones first");
+}
+
+//===========================================================================
+
 void TEST(Threading) {
   rai::Configuration C;
   C.addFile(rai::raiPath("../rai-robotModels/scenarios/workshopTable.g"));
@@ -258,6 +348,9 @@ int main(int argc,char** argv){
 
 //  rnd.clockSeed();
 
+  testIncrementalSetX();
+  testSetSelectedSlices();
+  testMultiStart();
   testEasy();
   testAlign();
   testThin();
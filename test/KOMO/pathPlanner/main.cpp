@@ -0,0 +1,71 @@
+#include <KOMO/komo.h>
+#include <KOMO/pathPlanner.h>
+#include <Kin/F_collisions.h>
+#include <Kin/frame.h>
+
+//===========================================================================
+
+//a disc robot moving in the plane through three walls with gaps at alternating ends
+void createMaze(rai::Configuration& C) {
+  C.addFrame("world");
+  C.addFrame("ego", "world")
+  ->setJoint(rai::JT_transXY)
+  .setShape(rai::ST_sphere, {.03})
+  .setContact(1);
+  for(uint i=0; i<3; i++) {
+    double x=.25*(i+1), y=(i%2 ? -.1 : .1);
+    C.addFrame(STRING("wall" <<i), "world")
+    ->setShape(rai::ST_ssBox, {.04, .9, .2, .01})
+    .setPosition({x, y+.5, 0.})
+    .setContact(1);
+  }
+}
+
+void TEST(Maze) {
+  rai::Configuration C;
+  createMaze(C);
+
+  rai::ConfigurationProblem P(C);
+  P.limits = {0., 1., 0., 1.};
+  P.limits.reshape(2, 2);
+
+  arr q0 = {.05, .5}, qT = {.95, .5};
+  CHECK(!P.isEdgeFeasible(q0, qT, .01), "the straight path should be blocked");
+
+  for(bool optimize: {false, true}) {
+    rai::PathPlanner planner(P, rai::PathPlanner_Options().set_optimize(optimize).set_verbose(1));
+    rai::timerStart(true);
+    arr path = planner.plan(q0, qT);
+    double time = rai::timerRead();
+    CHECK(path.N, "no path found");
+    CHECK_ZERO(maxDiff(path[0], q0), 1e-10, "");
+    CHECK_ZERO(maxDiff(path[-1], qT), 1e-10, "");
+    for(uint i=1; i<path.d0; i++) CHECK(P.isEdgeFeasible(path[i-1], path[i], planner.opt.resolution), "");
+    cout <<"optimize=" <<optimize <<": " <<time <<"sec, length " <<rai::path_length(path) <<endl;
+    CHECK_LE(time, planner.opt.maxTime+.05, "planning (including shortcutting) overran maxTime");
+
+    //-- initialize KOMO with it
+    KOMO komo;
+    komo.setModel(C, true);
+    komo.setTiming(1., 20, 1., 2);
+    komo.add_qControlObjective({}, 2, 1.);
+    komo.addObjective({1.}, FS_qItself, {}, OT_eq, {1e1}, qT);
+    komo.addObjective({}, FS_accumulatedCollisions, {}, OT_eq, {1e1});
+    komo.initWithWaypoints(rai::path_toWaypoints(path, komo.T), komo.stepsPerPhase);
+    komo.optimize(0.);
+    rai::Graph report = komo.getReport(false);
+    cout <<report <<endl;
+    CHECK_LE(report.get<double>("eq"), .1, "KOMO initialized with the waypoints fails");
+    CHECK_LE(report.get<double>("ineq"), .1, "");
+  }
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv) {
+  rai::initCmdLine(argc, argv);
+
+  testMaze();
+
+  return 0;
+}
@@ -200,6 +200,35 @@ void TEST(Copy){
   cout <<"** copy operator success" <<endl;
 }
 
+//===========================================================================
+
+void TEST(FrameIndex){
+  //large configurations look up frames via a name index: compare with linear search under appending, renaming, and deletion
+  rai::Configuration C;
+  uint n=1000;
+  for(uint i=0;i<n;i++) C.addFrame(STRING("f" <<i%(n/2))); //each name twice
+  for(uint i=0;i<n;i++) CHECK_EQ(C.getFrame(STRING("f" <<i%(n/2)))->ID, i%(n/2), "the first one");
+  for(uint i=0;i<n;i++) CHECK_EQ(C.getFrame(STRING("f" <<i%(n/2)), true, true)->ID, n/2+i%(n/2), "the last one");
+  CHECK(!C.getFrame("x", false), "");
+
+  C.addFrame("x"); //appended after the index was built
+  CHECK_EQ(C.getFrame("x")->ID, n, "");
+  C.frames(3)->setName("y"); //renamed in place
+  CHECK_EQ(C.getFrame("y")->ID, 3, "");
+  CHECK_EQ(C.getFrame("f3")->ID, n/2+3, "the other one remains");
+  delete C.frames(5);
+  CHECK_EQ(C.getFrame("f5")->ID, n/2+4, "IDs shifted by the deletion");
+  CHECK_EQ(C.getFrame("f6")->ID, 5, "");
+  CHECK_EQ(C.getFrames(C.getFrameIDs({"y", "x", "f6"})).N, 3, "");
+  C.checkConsistency();
+
+  C.frames(7)->name = "z"; //renamed without setName (was "f8"): the stale index entry is skipped, a miss rescans all frames
+  CHECK_EQ(C.getFrame("f8")->ID, n/2+7, "the other one remains");
+  CHECK_EQ(C.getFrame("z")->ID, 7, "");
+  CHECK_EQ(C.getFrame("z", true, true)->ID, 7, "");
+  C.checkConsistency();
+}
+
 //===========================================================================
 //
 // Kinematic speed test
@@ -647,6 +676,7 @@ int MAIN(int argc,char **argv){
 
   testLoadSave();
   testCopy();
+  testFrameIndex();
   testGraph();
   testPlayStateSequence();
   testViewerUpdate();
@@ -0,0 +1,160 @@
+#include <Logic/fol.h>
+#include <Logic/folWorld.h>
+
+//===========================================================================
+
+//expand the decision tree breadth first up to depth H; returns a signature of all transitions (rewards, #decisions, state hashes)
+arr expandTree(rai::FOL_World& world, uint H, uint& numTransitions){
+  arr signature;
+  typedef rai::TreeSearchDomain::Handle Handle;
+  world.reset_state();
+  rai::Array<Handle> layer = {world.get_stateCopy()};
+  numTransitions=0;
+  for(uint h=0;h<H;h++){
+    rai::Array<Handle> next;
+    for(Handle& s:layer){
+      world.set_state(s);
+      std::vector<Handle> actions = world.get_actions();
+      signature.append(actions.size());
+      for(Handle& a:actions){
+        world.set_state(s);
+        auto ret = world.transition(a);
+        numTransitions++;
+        signature.append(ret.reward);
+        signature.append(double(rai::getStateHash(*world.state) & 0xffffff));
+        if(!world.is_terminal_state()) next.append(world.get_stateCopy());
+      }
+    }
+    layer = next;
+  }
+  return signature;
+}
+
+void TEST(CachedExpansion){
+  uint H=rai::getParameter<uint>("H", 4);
+  uint numObjects=rai::getParameter<uint>("numObjects", 10);
+  arr sig[2];
+  for(uint useCache=0;useCache<2;useCache++){
+    rai::FOL_World world("pnp.g");
+    for(uint i=4;i<numObjects;i++){ //more objects on table1
+      world.addFact({"obj", STRING("obj"<<i)});
+      world.addFact({"on", "table1", STRING("obj"<<i)});
+    }
+    world.useCache = useCache;
+    uint n;
+    double time=-rai::cpuTime();
+    sig[useCache] = expandTree(world, H, n);
+    time += rai::cpuTime();
+    cout <<"useCache=" <<useCache <<" #transitions=" <<n <<" time=" <<time <<"sec"
+         <<" #distinct states=" <<world.actionCache.size() <<" hits=" <<world.cacheHits <<" misses=" <<world.cacheMisses <<endl;
+  }
+  CHECK_EQ(sig[0].N, sig[1].N, "cached expansion differs");
+  CHECK_ZERO(maxDiff(sig[0], sig[1]), 1e-10, "cached expansion differs");
+}
+
+//===========================================================================
+
+void TEST(StateHash){
+  rai::FOL_World world("pnp.g");
+  world.reset_state();
+  rai::Graph& state = *world.state;
+  uint64_t h0 = rai::getStateHash(state);
+
+  //the hash does not depend on the order of facts
+  rai::CompiledState C;
+  CHECK(C.compile(state), "");
+  CHECK_EQ(C.hash, h0, "");
+  state.reverse();
+  state.index();
+  CHECK_EQ(rai::getStateHash(state), h0, "");
+
+  //restoring a compiled state gives the same hash; changing a fact changes the hash
+  C.restore(state);
+  CHECK_EQ(rai::getStateHash(state), h0, "");
+  delete state.last();
+  CHECK(rai::getStateHash(state)!=h0, "");
+}
+
+//===========================================================================
+
+//random rollouts in a cached and an uncached world get the same decisions in the same order and must stay in the same states
+void TEST(CachedRollouts){
+  typedef rai::TreeSearchDomain::Handle Handle;
+  rai::FOL_World A("pnp.g"), B("pnp.g");
+  A.useCache=true;
+  for(uint k=0;k<2000;k++){
+    A.reset_state();
+    B.reset_state();
+    for(uint t=0;t<10 && !A.is_terminal_state();t++){
+      std::vector<Handle> a = A.get_actions(), b = B.get_actions();
+      CHECK_EQ(a.size(), b.size(), "cached decisions differ");
+      if(!a.size()) break;
+      auto key = [](const Handle& d){ return std::dynamic_pointer_cast<const rai::FOL_World::Decision>(d)->getKey(); };
+      for(uint i=0;i<a.size();i++) CHECK_EQ(key(a[i]), key(b[i]), "cached decisions come in a different order");
+      uint64_t k = key(a[rnd(a.size())]);
+      for(Handle& d:a) if(key(d)==k) A.transition(d);
+      for(Handle& d:b) if(key(d)==k) B.transition(d);
+      CHECK_EQ(rai::getStateHash(*A.state), rai::getStateHash(*B.state), "cached transition differs");
+      CHECK_EQ(A.is_terminal_state(), B.is_terminal_state(), "");
+    }
+  }
+  cout <<"cached rollouts: hits=" <<A.cacheHits <<" misses=" <<A.cacheMisses <<endl;
+
+  //restoring a state copy links the state to it in the KB
+  A.reset_state();
+  A.transition(A.get_actions()[0]);
+  Handle s = A.get_stateCopy();
+  A.transition(A.get_actions()[0]);
+  A.set_state(s);
+  auto S = std::dynamic_pointer_cast<const rai::FOL_World::State>(s);
+  CHECK_EQ(A.state->isNodeOfGraph->parents(0), S->state->isNodeOfGraph, "");
+}
+
+//===========================================================================
+
+//cache entries whose hash collides with the current state or decision are not used
+void TEST(CacheCollisions){
+  typedef rai::TreeSearchDomain::Handle Handle;
+  rai::FOL_World world("pnp.g");
+  world.useCache=true;
+  world.reset_state();
+  std::vector<Handle> actions = world.get_actions();
+  CHECK_GE(actions.size(), 2, "");
+  Handle start = world.get_stateCopy();
+  uint64_t post[2];
+  for(uint i=0;i<2;i++){
+    world.set_state(start);
+    world.transition(actions[i]);
+    post[i] = rai::getStateHash(*world.state);
+  }
+  CHECK(post[0]!=post[1], "");
+
+  //pretend both decisions hash equally: the entry of decision 0 is stored under the key of decision 1
+  world.set_state(start);
+  uint64_t stateHash = rai::getStateHash(*world.state, false);
+  auto key = [&](uint i){ return stateHash ^ (std::dynamic_pointer_cast<const rai::FOL_World::Decision>(actions[i])->getKey()*0x9e3779b97f4a7c15ull); };
+  CHECK_EQ(world.transitionCache.size(), 2, "");
+  world.transitionCache[key(1)] = world.transitionCache[key(0)];
+  world.transition(actions[1]);
+  CHECK_EQ(rai::getStateHash(*world.state), post[1], "a colliding transition was used");
+
+  //pretend the successor state hashes as the start state
+  world.transition(world.get_actions()[0]);
+  world.actionCache[rai::getStateHash(*world.state)] = world.actionCache[std::dynamic_pointer_cast<const rai::FOL_World::State>(start)->hash];
+  std::vector<Handle> cached = world.get_actions();
+  world.useCache=false;
+  CHECK_EQ(cached.size(), world.get_actions().size(), "colliding decisions were used");
+}
+
+//===========================================================================
+
+int MAIN(int argc,char** argv){
+  rai::initCmdLine(argc,argv);
+
+  testStateHash();
+  testCachedExpansion();
+  testCachedRollouts();
+  testCacheCollisions();
+
+  return 0;
+}
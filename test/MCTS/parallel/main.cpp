@@ -0,0 +1,68 @@
+#include <MCTS/solver_ParallelMCTS.h>
+#include <MCTS/problem_BlindBranch.h>
+#include <Logic/folWorld.h>
+#include <Core/taskPool.h>
+
+//===========================================================================
+
+//BlindBranch: the return is the (normalized) sum of +-1 decisions -> +1 is always best
+void TEST(BlindBranch) {
+  uint W = rai::MAX(2u, rai::taskPool().numThreads()+1);
+  for(uint w:{1u, W}) for(bool rootParallel: {false, true}) {
+      if(w==1 && rootParallel) continue;
+      rai::Array<BlindBranch*> B;
+      rai::Array<rai::TreeSearchDomain*> worlds;
+      for(uint i=0; i<w; i++) { B.append(new BlindBranch(20));  worlds.append(B.last()); }
+      ParallelMCTS M(worlds);
+      M.rootParallel = rootParallel;
+      M.virtualLoss = 0.; //the min reward
+      double time = rai::realTime();
+      M.run(40000);
+      time = rai::realTime()-time;
+      CHECK_EQ(M.rollouts, 40000, "");
+      CHECK_EQ(M.getBestActionIdx(), 1, "+1 is the best decision");
+      cout <<"BlindBranch workers=" <<w <<(rootParallel?" root parallel":"") <<" time=" <<time <<"sec #nodes=" <<M.Nnodes() <<endl;
+      for(BlindBranch* b:B) delete b;
+    }
+}
+
+//===========================================================================
+
+//FOL_World: rollouts within a fixed wall time
+void TEST(FOL) {
+  uint W = rai::MAX(2u, rai::taskPool().numThreads()+1);
+  double maxTime = rai::getParameter<double>("maxTime", 1.);
+  for(uint w:{1u, W}) {
+    rai::Array<rai::FOL_World*> F;
+    rai::Array<rai::TreeSearchDomain*> worlds;
+    for(uint i=0; i<w; i++) {
+      F.append(new rai::FOL_World("pnp.g"));
+      F.last()->verbose=0;
+      F.last()->verbFil=0;
+      worlds.append(F.last());
+    }
+    ParallelMCTS M(worlds);
+    M.stepAbort = 10;
+    M.virtualLoss = -M.stepAbort;
+    M.run(UINT_MAX, maxTime);
+    cout <<"FOL_World workers=" <<w <<" #rollouts in " <<maxTime <<"sec: " <<M.rollouts <<endl;
+    M.report();
+    F(0)->reset_state();
+    CHECK_LT(M.getBestActionIdx(), F(0)->get_actions().size(), "");
+    CHECK(M.getBestAction(), "");
+    for(rai::FOL_World* f:F) delete f;
+  }
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv) {
+  rai::initCmdLine(argc, argv);
+
+  rnd.clockSeed();
+
+  testBlindBranch();
+  testFOL();
+
+  return 0;
+}
@@ -85,9 +85,34 @@ void TEST(MathematicalProgram){
 
 //==============================================================================
 
+void TEST(Realtime){
+  //the values in L must be those of the returned x -- or be reported as not evaluated
+  ChoiceConstraintFunction P;
+  arr x = {.2,.2};
+  OptConstrained opt(x, NoArr, P.ptr());
+
+  opt.runRealtime(1., 5);
+  CHECK(opt.rtEvaluated, "");
+  CHECK_ZERO(maxDiff(opt.L.x, x), 1e-10, "");
+
+  //a new warm start without time to evaluate it: L still holds the earlier iterate
+  x = {.3,.1};
+  uint k = opt.runRealtime(0., 5);
+  CHECK_EQ(k, 0, "");
+  CHECK(!opt.rtEvaluated, "an early return must not report the values of an earlier iterate");
+
+  opt.runRealtime(1., 5);
+  CHECK(opt.rtEvaluated, "");
+  CHECK_ZERO(maxDiff(opt.L.x, x), 1e-10, "");
+}
+
+//==============================================================================
+
 int main(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
+  testRealtime();
+
   rnd.clockSeed();
 
   ChoiceConstraintFunction F;
@@ -0,0 +1,84 @@
+#include <Optim/denseQP.h>
+
+//===========================================================================
+
+//random strictly convex QP with box bounds and some general inequalities, similar to a control step
+void randomQP(DenseQP& qp, uint n, uint mIneq, double shift=0.){
+  qp.resize(n, mIneq+n);
+  arr J = randn(2*n, n);
+  qp.H = ~J*J + .1*eye(n);
+  qp.g = randn(n) + shift;
+  for(uint i=0;i<mIneq;i++){
+    for(uint j=0;j<n;j++) qp.A(i,j) = rnd.gauss();
+    qp.up(i) = .5;
+  }
+  for(uint j=0;j<n;j++){
+    qp.A(mIneq+j, j) = 1.;
+    qp.lo(mIneq+j) = -.3;
+    qp.up(mIneq+j) = +.3;
+  }
+  qp.A(mIneq, 0) = 1.; //one equality row on the first dof
+  qp.lo(mIneq) = qp.up(mIneq) = .1;
+}
+
+//check the KKT conditions
+void checkKKT(DenseQP& qp, double tol){
+  arr Ax = qp.A*qp.x;
+  for(uint i=0;i<Ax.N;i++){
+    CHECK_GE(Ax(i), qp.lo(i)-tol, "primal infeasible");
+    CHECK_LE(Ax(i), qp.up(i)+tol, "primal infeasible");
+    if(qp.y(i)> tol) CHECK_ZERO(Ax(i)-qp.up(i), 10.*tol, "complementarity");
+    if(qp.y(i)<-tol) CHECK_ZERO(Ax(i)-qp.lo(i), 10.*tol, "complementarity");
+  }
+  arr H = qp.H;
+  for(uint i=0;i<H.d0;i++) for(uint j=0;j<i;j++) H(i,j) = H(j,i);
+  double stat = absMax(H*qp.x + qp.g + ~qp.A*qp.y);
+  CHECK_LE(stat, 10.*tol, "stationarity");
+}
+
+//===========================================================================
+
+void TEST(DenseQP){
+  for(uint n:{7u, 14u}){
+    DenseQP qp;
+    qp.tolerance = 1e-7;
+    qp.maxIters = 10000;
+    uint coldIters=0, warmIters=0;
+    double coldTime=0., warmTime=0.;
+    uint K=100;
+    for(uint k=0;k<K;k++){
+      rnd.seed(k);
+      randomQP(qp, n, n/2);
+      qp.clearWarmStart();
+      double t=rai::realTime();
+      bool conv = qp.solve();
+      coldTime += rai::realTime()-t;
+      coldIters += qp.iters;
+      CHECK(conv, "not converged");
+      checkKKT(qp, 1e-6);
+
+      //slightly perturbed problem -- as in a subsequent control step
+      rnd.seed(k);
+      randomQP(qp, n, n/2, 1e-2);
+      t=rai::realTime();
+      conv = qp.solve();
+      warmTime += rai::realTime()-t;
+      warmIters += qp.iters;
+      CHECK(conv, "not converged");
+      checkKKT(qp, 1e-6);
+    }
+    cout <<"n=" <<n
+         <<" cold: iters=" <<double(coldIters)/K <<" time=" <<1e6*coldTime/K <<"us"
+         <<" warm: iters=" <<double(warmIters)/K <<" time=" <<1e6*warmTime/K <<"us" <<endl;
+  }
+}
+
+//===========================================================================
+
+int MAIN(int argc,char** argv){
+  rai::initCmdLine(argc,argv);
+
+  testDenseQP();
+
+  return 0;
+}
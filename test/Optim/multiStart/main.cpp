@@ -0,0 +1,101 @@
+#include <Optim/MP_Solver.h>
+#include <Core/taskPool.h>
+
+//===========================================================================
+
+/// many local optima (sines) within bounds, and (if constrained) the constraint x(0)>=.5
+struct MP_Sines : MathematicalProgram {
+  bool constrained;
+  MP_Sines(uint n=3, bool _constrained=true) : constrained(_constrained) {
+    dimension=n;
+    bounds_lo = consts<double>(-3., n);
+    bounds_up = consts<double>(+3., n);
+    featureTypes = consts<ObjectiveType>(OT_sos, 2*n);
+    if(constrained) featureTypes.append(OT_ineq);
+  }
+  virtual void evaluate(arr& phi, arr& J, const arr& x) {
+    uint n=x.N;
+    phi.resize(featureTypes.N).setZero();
+    if(!!J) J.resize(featureTypes.N, n).setZero();
+    for(uint i=0; i<n; i++) {
+      phi(i) = sin(3.*x(i));    if(!!J) J(i, i) = 3.*cos(3.*x(i));
+      phi(n+i) = .3*x(i);       if(!!J) J(n+i, i) = .3;
+    }
+    if(constrained){
+      phi(2*n) = .5-x(0);       if(!!J) J(2*n, 0) = -1.;
+    }
+  }
+};
+
+//===========================================================================
+
+void TEST(MultiStart){
+  rai::OptOptions opt;
+  opt.verbose=0;
+  uint K=24;
+
+  //-- all starts, serially on the problem itself
+  MP_Solver S1;
+  S1.setProblem(make_shared<MP_Sines>()).setOptions(opt);
+  auto r1 = S1.solveMultiStart(K, {}, false);
+  cout <<"serial:   " <<*r1 <<endl;
+
+  //-- all starts, in parallel on problem instances
+  MP_Solver S;
+  S.setProblem(make_shared<MP_Sines>()).setOptions(opt);
+  auto r = S.solveMultiStart(K, [](){ return make_shared<MP_Sines>(); }, false);
+  cout <<"parallel: " <<*r <<endl;
+  for(auto& o:r->optima) cout <<"  " <<*o <<" x=" <<o->x <<endl;
+
+  CHECK_EQ(r->starts, K, "");
+  CHECK_GE(r->optima.N, 2, "the problem has many local optima");
+  CHECK(r->optima(0)->feasible, "");
+  CHECK_GE(r->timeToFeasible, 0., "");
+  for(uint i=1; i<r->optima.N; i++) {
+    auto &a = r->optima(i-1), &b = r->optima(i);
+    CHECK(a->feasible>=b->feasible, "feasible ones first");
+    if(a->feasible==b->feasible) CHECK_LE(a->f+a->sos, b->f+b->sos, "sorted by cost");
+    for(uint j=0; j<i; j++) CHECK_GE(maxDiff(r->optima(j)->x, b->x), 1e-2, "optima are distinct");
+  }
+  CHECK_EQ(S.x, r->optima(0)->x, "");
+
+  //-- stop at the first feasible solution
+  MP_Solver S2;
+  S2.setProblem(make_shared<MP_Sines>()).setOptions(opt);
+  auto r2 = S2.solveMultiStart(K, [](){ return make_shared<MP_Sines>(); });
+  cout <<"early stop: " <<*r2 <<endl;
+  CHECK_LE(r2->starts, K, "");
+  CHECK(r2->optima(0)->feasible, "");
+  CHECK_GE(r2->timeToFeasible, 0., "");
+  CHECK_LE(r2->timeToFeasible, r2->time, "");
+
+  //-- every start is feasible: each worker stops after its first start (none is begun after the first feasible one)
+  uint W = rai::MAX(1u, rai::taskPool().numThreads());
+  uint K3 = 4*W+4;
+  MP_Solver S3;
+  S3.setProblem(make_shared<MP_Sines>(3, false)).setOptions(opt);
+  auto r3 = S3.solveMultiStart(K3, [](){ return make_shared<MP_Sines>(3, false); });
+  cout <<"early stop (all feasible): " <<*r3 <<endl;
+  CHECK_LE(r3->starts, W, "only the starts in flight at the first feasible one");
+  CHECK_LT(r3->starts, K3, "");
+
+  //-- unconstrained solvers do not report violations: only multi-start evaluates them
+  MP_Solver S4;
+  S4.setProblem(make_shared<MP_Sines>(3, false)).setOptions(opt).setSolver(MPS_newton);
+  auto r4 = S4.solve();
+  CHECK_LT(r4->ineq, 0., "unknown");
+  auto r5 = S4.solveMultiStart(4, [](){ return make_shared<MP_Sines>(3, false); }, false);
+  for(auto& o:r5->optima) CHECK(o->ineq==0. && o->eq==0. && o->feasible, "");
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv){
+  rai::initCmdLine(argc, argv);
+
+  rnd.clockSeed();
+
+  testMultiStart();
+
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include <Perception/colorseg.h>
+#include <Core/taskPool.h>
+
+//===========================================================================
+
+void TEST(ColorSegmentation){
+  //a grid of rectangles with pairwise distinct colors (channels are digits 20+60*{0..3}) and a bit of noise
+  uint H=1080, W=1920, nx=8, ny=6;
+  byteA img(H, W, 3);
+  byteA colors(nx*ny, 3);
+  for(uint i=0;i<nx*ny;i++){ colors(i,0) = 20+60*(i%4);  colors(i,1) = 20+60*((i/4)%4);  colors(i,2) = 20+60*(i/16); }
+  for(uint y=0;y<H;y++) for(uint x=0;x<W;x++){
+    uint r = (y*ny/H)*nx + x*nx/W;
+    for(uint c=0;c<3;c++) img(y,x,c) = colors(r,c) + rnd(3);
+  }
+  for(uint k=0;k<200;k++) img(rnd(H), rnd(W), 0) = 255; //specks are merged into their surrounding
+
+  ColorSegmentation seg;
+  uintA patches;
+  uint np=0;
+  rai::timerStart();
+  for(uint k=0;k<10;k++) np = seg.compute(patches, img); //buffers are reused
+  double time = rai::timerRead()/10.;
+  uint threads = rai::taskPool().numThreads();
+  cout <<"segmentation of " <<W <<'x' <<H <<": " <<time <<"sec, #patches: " <<np <<" (" <<threads <<" pool threads)" <<endl;
+  //the tiles run on the task pool: with a few cores, a 1080p frame is well within a 30Hz budget (33ms);
+  //a single core needs about twice that, so the budget is only asserted with enough threads
+  if(threads>=4){ CHECK_LE(time, .02, "segmentation exceeds the per-frame budget"); }
+  else cout <<"(budget not asserted with fewer than 4 pool threads)" <<endl;
+  CHECK_EQ(np, nx*ny, "one patch per rectangle");
+  for(uint r=0;r<nx*ny;r++){ //rectangles first occur in raster order, so the patch ids are the rectangle indices
+    uint y = (2*(r/nx)+1)*H/(2*ny), x = (2*(r%nx)+1)*W/(2*nx);
+    if(img(y,x,0)==255) x++;
+    CHECK_EQ(patches(y,x), r, "ids follow first occurrence");
+  }
+
+  //moments vs. brute force
+  arr stats, cen;
+  patch_color_statistics(stats, patches, img);
+  get_patch_centroids(cen, patches, np);
+  arr S(np, 3), C(np, 2), n(np);
+  S.setZero();  C.setZero();  n.setZero();
+  for(uint y=0;y<H;y++) for(uint x=0;x<W;x++){
+    uint i=patches(y,x);
+    n(i)++;  C(i,0)+=x;  C(i,1)+=y;
+    for(uint c=0;c<3;c++) S(i,c) += img(y,x,c);
+  }
+  for(uint i=0;i<np;i++){
+    CHECK_EQ(seg.moments(i,0), n(i), "");
+    CHECK_ZERO(cen(i,0)-C(i,0)/n(i), 1e-6, "");
+    CHECK_ZERO(cen(i,1)-C(i,1)/n(i), 1e-6, "");
+    for(uint c=0;c<3;c++) CHECK_ZERO(stats(i,c)-S(i,c)/n(i), 1e-6, "");
+    CHECK_LE(stats(i,3), 20., "patch mixes colors");
+  }
+}
+
+//===========================================================================
+
+int MAIN(int argc, char** argv){
+  rai::initCmdLine(argc, argv);
+
+  testColorSegmentation();
+
+  return 0;
+}